@@ -810,6 +810,7 @@ template simulationFile(SimCode simCode, String guid)
     extern int <%symbolName(modelNamePrefixStr,"checkForAsserts")%>(DATA *data);
     extern int <%symbolName(modelNamePrefixStr,"function_ZeroCrossingsEquations")%>(DATA *data);
     extern int <%symbolName(modelNamePrefixStr,"function_ZeroCrossings")%>(DATA *data, double* gout);
+    extern int <%symbolName(modelNamePrefixStr,"function_ZeroCrossingsValues")%>(DATA *data, double* gout);
     extern int <%symbolName(modelNamePrefixStr,"function_updateRelations")%>(DATA *data, int evalZeroCross);
     extern int <%symbolName(modelNamePrefixStr,"checkForDiscreteChanges")%>(DATA *data);
     extern const char* <%symbolName(modelNamePrefixStr,"zeroCrossingDescription")%>(int i, int **out_EquationIndexes);
@@ -859,6 +860,7 @@ template simulationFile(SimCode simCode, String guid)
        <%symbolName(modelNamePrefixStr,"checkForAsserts")%>,
        <%symbolName(modelNamePrefixStr,"function_ZeroCrossingsEquations")%>,
        <%symbolName(modelNamePrefixStr,"function_ZeroCrossings")%>,
+       <%symbolName(modelNamePrefixStr,"function_ZeroCrossingsValues")%>,
        <%symbolName(modelNamePrefixStr,"function_updateRelations")%>,
        <%symbolName(modelNamePrefixStr,"checkForDiscreteChanges")%>,
        <%symbolName(modelNamePrefixStr,"zeroCrossingDescription")%>,
@@ -1021,6 +1023,7 @@ template populateModelInfo(ModelInfo modelInfo, String fileNamePrefix, String gu
     data->modelData.nRelations = <%varInfo.numRelations%>;
     data->modelData.nMathEvents = <%varInfo.numMathEventFunctions%>;
     data->modelData.nExtObjs = <%varInfo.numExternalObjects%>;
+    data->modelData.nExtFunctions = 0<%functions |> EXTERNAL_FUNCTION(__) => '+1'%>;
     setupModelInfoFunctions(<%if Flags.isSet(Flags.MODEL_INFO_JSON) then 1 else 0%>);
     data->modelData.modelDataXml.fileName = "<%fileNamePrefix%>_info.<%if Flags.isSet(Flags.MODEL_INFO_JSON) then "json" else "xml"%>";
     data->modelData.modelDataXml.modelInfoXmlLength = 0;
@@ -3643,6 +3646,11 @@ template functionZeroCrossing(list<ZeroCrossing> zeroCrossings, list<SimEqSystem
   let &varDecls2 = buffer ""
   let zeroCrossingsCode = zeroCrossingsTpl(zeroCrossings, &varDecls2, &auxFunction)
 
+  let &varDecls3 = buffer ""
+  let zeroCrossingsValuesCode = (zeroCrossings |> ZERO_CROSSING(__) hasindex i0 =>
+    zeroCrossingValueTpl(i0, relation_, &varDecls3, &auxFunction)
+  ;separator="\n";empty)
+
   let resDesc = (zeroCrossings |> ZERO_CROSSING(__) => '"<%Util.escapeModelicaStringToCString(ExpressionDump.printExpStr(relation_))%>"'
     ;separator=",\n")
 
@@ -3699,6 +3707,17 @@ template functionZeroCrossing(list<ZeroCrossing> zeroCrossings, list<SimEqSystem
     TRACE_POP
     return 0;
   }
+
+  int <%symbolName(modelNamePrefix,"function_ZeroCrossingsValues")%>(DATA *data, double *gout)
+  {
+    TRACE_PUSH
+    <%varDecls3%>
+
+    <%zeroCrossingsValuesCode%>
+
+    TRACE_POP
+    return 0;
+  }
   >>
 end functionZeroCrossing;
 
@@ -3711,6 +3730,34 @@ template zeroCrossingsTpl(list<ZeroCrossing> zeroCrossings, Text &varDecls, Text
 end zeroCrossingsTpl;
 
 
+template zeroCrossingValueTpl(Integer index1, Exp relation, Text &varDecls, Text &auxFunction)
+ "Generates code for the continuous value of a zero crossing, which is positive
+  if the relation is true. Used by the event locator to interpolate the root.
+  Zero crossings without a continuous value fall back to the sign."
+::=
+  match relation
+  case rel as RELATION(optionExpisASUB=NONE()) then
+    let &preExp = buffer ""
+    let e1 = daeExp(rel.exp1, contextZeroCross, &preExp, &varDecls, &auxFunction)
+    let e2 = daeExp(rel.exp2, contextZeroCross, &preExp, &varDecls, &auxFunction)
+    match rel.operator
+    case LESS(__)
+    case LESSEQ(__) then
+      <<
+      <%preExp%>
+      gout[<%index1%>] = (<%e2%>) - (<%e1%>);
+      >>
+    case GREATER(__)
+    case GREATEREQ(__) then
+      <<
+      <%preExp%>
+      gout[<%index1%>] = (<%e1%>) - (<%e2%>);
+      >>
+    else zeroCrossingTpl(index1, relation, &varDecls, &auxFunction)
+    end match
+  else zeroCrossingTpl(index1, relation, &varDecls, &auxFunction)
+end zeroCrossingValueTpl;
+
 template zeroCrossingTpl(Integer index1, Exp relation, Text &varDecls, Text &auxFunction)
  "Generates code for a zero crossing."
 ::=
@@ -4323,6 +4370,9 @@ template equation_(SimEqSystem eq, Context context, Text &varDecls, Text &eqs, S
   else
     "NOT IMPLEMENTED EQUATION equation_"
   let &varD += addRootsTempArray()
+  /* the pooled allocator of parallel code reclaims the temporaries of every equation */
+  let poolMark = if boolOr(Flags.isSet(Flags.PARMODAUTO), Flags.isSet(HPCOM)) then 'memory_pool_mark_t mem_state = memory_pool_mark();'
+  let poolRelease = if poolMark then 'memory_pool_release(mem_state);'
   let &eqs +=
   <<
 
@@ -4335,7 +4385,9 @@ template equation_(SimEqSystem eq, Context context, Text &varDecls, Text &eqs, S
     TRACE_PUSH
     const int equationIndexes[2] = {1,<%ix%>};
     <%&varD%>
+    <%poolMark%>
     <%x%>
+    <%poolRelease%>
     TRACE_POP
   }
   >>
@@ -4955,7 +5007,7 @@ case SIMCODE(modelInfo=MODELINFO(__), makefileParams=MAKEFILE_PARAMS(__), simula
   let libsStr = (makefileParams.libs |> lib => lib ;separator=" ")
   let libsPos1 = if not dirExtra then libsStr //else ""
   let libsPos2 = if dirExtra then libsStr // else ""
-  let ParModelicaExpLibs = if acceptParModelicaGrammar() then '-lOMOCLRuntime -lOpenCL' // else ""
+  let ParModelicaExpLibs = if acceptParModelicaGrammar() then '-lOMOCLRuntime -lOpenCL<%if not stringEq(makefileParams.platform, "win32") then " -ldl"%>' // else ""
   let ParModelicaAutoLibs = if Flags.isSet(Flags.PARMODAUTO) then '-lom_pm_autort -L. -ltbb' // else ""
   let extraCflags = match sopt case SOME(s as SIMULATION_SETTINGS(__)) then
     match s.method case "dassljac" then "-D_OMC_JACOBIAN "
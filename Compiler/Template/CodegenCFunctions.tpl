@@ -212,7 +212,7 @@ template functionsMakefile(FunctionCode fnCode)
 match fnCode
 case FUNCTIONCODE(makefileParams=MAKEFILE_PARAMS(__)) then
   let libsStr = (makefileParams.libs ;separator=" ")
-  let ParModelicaExpLibs = if acceptParModelicaGrammar() then '-lOMOCLRuntime -lOpenCL' // else ""
+  let ParModelicaExpLibs = if acceptParModelicaGrammar() then '-lOMOCLRuntime -lOpenCL<%if not stringEq(makefileParams.platform, "win32") then " -ldl"%>' // else ""
 
   <<
   # Makefile generated by OpenModelica
@@ -1223,7 +1223,7 @@ case KERNEL_FUNCTION(__) then
     <%cl_kernelVar%> = ocl_create_kernel(omc_ocl_program, "omc_<%fname%>");
     <%kernelArgSets%>
     ocl_execute_kernel(<%cl_kernelVar%>);
-    clReleaseKernel(<%cl_kernelVar%>);
+    ocl_release_kernel(<%cl_kernelVar%>);
     /*functionBodyKernelFunctionInterface : <%fname%> kernel execution ends here.*/
 
     <%outVarAssign%>
@@ -2812,10 +2812,10 @@ case STMT_PARFOR(range=rng as RANGE(__)) then
         <%argStr%>)
   {
     /* algStmtParForRangeBody : Thread managment for parfor loops */
-    modelica_integer inner_start = (get_global_id(0) * loop_step) + (loop_start);
-    modelica_integer stride = get_global_size(0) * loop_step;
+    modelica_integer inner_start, inner_count, stride;
+    parfor_iterations(loop_start, loop_step, loop_end, &inner_start, &inner_count, &stride);
 
-    for(modelica_integer <%iterName%> = (modelica_integer) inner_start; in_range_integer(<%iterName%>, loop_start, loop_end); <%iterName%> += stride)
+    for(modelica_integer <%iterName%> = (modelica_integer) inner_start; inner_count > 0; <%iterName%> += stride, inner_count--)
     {
       /* algStmtParForRangeBody : Reconstruct Arrays */
       <%reconstrucedArrays%>
@@ -2892,7 +2892,7 @@ case RANGE(__) then
   <%kernelArgSets%>
 
   ocl_execute_kernel(<%cl_kernelVar%>);
-  clReleaseKernel(<%cl_kernelVar%>);
+  ocl_release_kernel(<%cl_kernelVar%>);
 
 
   >> /* else we're looping over a zero-length range */
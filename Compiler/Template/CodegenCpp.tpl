@@ -6456,7 +6456,7 @@ case SES_NONLINEAR(nlSystem = nls as NONLINEARSYSTEM(__)) then
 
     _dimAEq = <%size%>;
     AlgLoopDefaultImplementation::initialize();
-
+    <%initAlgloopSparsityPattern(nls.jacobianMatrix, listLength(nls.crefs))%>
   >>
   case SES_LINEAR(lSystem = ls as LINEARSYSTEM(__)) then
     match ls.jacobianMatrix
@@ -6479,6 +6479,22 @@ case SES_NONLINEAR(nlSystem = nls as NONLINEARSYSTEM(__)) then
 
 end initAlgloopDimension;
 
+template initAlgloopSparsityPattern(Option<JacobianMatrix> jacobianMatrix, Integer size)
+ "Passes the sparsity pattern of the Jacobian of a non linear system to the algloop, which colors its columns."
+::=
+match jacobianMatrix
+case SOME((_, _, _, (sparsepattern as _::_, _), _, _, _)) then
+  let columnNonZeros = (sparsepattern |> (_, indexes) => listLength(indexes) ;separator=",")
+  let rowIndex = (sparsepattern |> (_, indexes) => (indexes |> row => row ;separator=",") ;separator=",")
+  if intEq(listLength(sparsepattern), size) then
+  <<
+  // Sparsity pattern of the Jacobian in compressed column format
+  const int columnNonZeros[] = {<%columnNonZeros%>};
+  const int rowIndex[] = {<%rowIndex%>};
+  AlgLoopDefaultImplementation::setSparsityPattern(columnNonZeros, rowIndex);
+  >>
+end initAlgloopSparsityPattern;
+
 template alocateLinearSystem(SimEqSystem eq)
  "Generates a non linear equation system."
 ::=
@@ -7277,6 +7293,12 @@ bool  <%modelname%>Algloop<%ls.index%>::isConsistent()
     return _system->isConsistent();
 };
 
+/// Provide the sparsity pattern of the Jacobian and the coloring of its columns
+bool  <%modelname%>Algloop<%ls.index%>::getSparsityPattern(const int*& colPtr, const int*& rowIndex, const int*& colorPtr, const int*& colorCols, int& numColors)
+{
+    return AlgLoopDefaultImplementation::getSparsityPattern(colPtr, rowIndex, colorPtr, colorCols, numColors);
+};
+
 /// Provide variables with given index to the system
 void  <%modelname%>Algloop<%ls.index%>::getReal(double* vars)
 {
@@ -7321,6 +7343,12 @@ bool  <%modelname%>Algloop<%nls.index%>::isConsistent()
     return _system->isConsistent();
 };
 
+/// Provide the sparsity pattern of the Jacobian and the coloring of its columns
+bool  <%modelname%>Algloop<%nls.index%>::getSparsityPattern(const int*& colPtr, const int*& rowIndex, const int*& colorPtr, const int*& colorCols, int& numColors)
+{
+    return AlgLoopDefaultImplementation::getSparsityPattern(colPtr, rowIndex, colorPtr, colorCols, numColors);
+};
+
 /// Provide variables with given index to the system
 void  <%modelname%>Algloop<%nls.index%>::getReal(double* vars)
 {
@@ -7506,6 +7534,8 @@ case SIMCODE(modelInfo = MODELINFO(__)) then
     virtual bool isLinear();
     virtual bool isLinearTearing();
     virtual bool isConsistent();
+    /// Provide the sparsity pattern of the Jacobian and the coloring of its columns
+    virtual bool getSparsityPattern(const int*& colPtr, const int*& rowIndex, const int*& colorPtr, const int*& colorCols, int& numColors);
 
 >>
 //void writeOutput(HistoryImplType::value_type_v& v ,vector<string>& head ,const IMixedSystem::OUTPUT command  = IMixedSystem::UNDEF_OUTPUT);
@@ -90,7 +90,7 @@ case SIMCODE(__) then
   <<
   <?xml version="1.0" encoding="UTF-8"?>
   <%
-  if isFMIVersion20(FMUVersion) then CodegenFMU2.fmiModelDescription(simCode,guid)
+  if isFMIVersion20(FMUVersion) then CodegenFMU2.fmiModelDescription(simCode,guid,FMUType)
   else CodegenFMU1.fmiModelDescription(simCode,guid,FMUType)
   %>
   >>
@@ -263,6 +263,12 @@ let numberOfBooleans = intAdd(varInfo.numBoolAlgVars,intAdd(varInfo.numBoolParam
   #define STATES { <%vars.stateVars |> SIMVAR(__) => if stringEq(crefStr(name),"$dummy") then '' else '<%cref(name)%>_'  ;separator=", "%> }
   #define STATESDERIVATIVES { <%vars.derivativeVars |> SIMVAR(__) => if stringEq(crefStr(name),"der($dummy)") then '' else '<%cref(name)%>_'  ;separator=", "%> }
 
+  // define inputs and outputs as vectors of value references, in the order of the seeds of the jacobians B and D and the results of C and D
+  #define NUMBER_OF_INPUTS <%varInfo.numInVars%>
+  #define NUMBER_OF_OUTPUTS <%varInfo.numOutVars%>
+  #define INPUTS { <%vars.inputVars |> SIMVAR(__) => '<%cref(name)%>_' ;separator=", "%> }
+  #define OUTPUTS { <%vars.outputVars |> SIMVAR(__) => '<%cref(name)%>_' ;separator=", "%> }
+
   <%System.tmpTickReset(0)%>
   <%(functions |> fn => defineExternalFunction(fn) ; separator="\n")%>
   >>
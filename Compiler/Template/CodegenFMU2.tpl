@@ -51,8 +51,8 @@ import CodegenUtil.*;
 import CodegenC.*; //unqualified import, no need the CodegenC is optional when calling a template; or mandatory when the same named template exists in this package (name hiding)
 import CodegenFMUCommon.*;
 
-// Code for generating modelDescription.xml file for FMI 2.0 ModelExchange.
-template fmiModelDescription(SimCode simCode, String guid)
+// Code for generating modelDescription.xml file for FMI 2.0 ModelExchange and CoSimulation.
+template fmiModelDescription(SimCode simCode, String guid, String FMUType)
  "Generates code for ModelDescription file for FMU target."
 ::=
 //  <%UnitDefinitions(simCode)%>
@@ -63,6 +63,7 @@ case SIMCODE(__) then
   <fmiModelDescription
     <%fmiModelDescriptionAttributes(simCode,guid)%>>
     <%ModelExchange(simCode)%>
+    <%if isFMICSType(FMUType) then CoSimulation(simCode)%>
     <%fmiTypeDefinitions(modelInfo, "2.0")%>
     <LogCategories>
       <Category name="logEvents" />
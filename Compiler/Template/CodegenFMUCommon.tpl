@@ -59,11 +59,52 @@ case SIMCODE(__) then
   let modelIdentifier = modelNamePrefix(simCode)
   <<
   <ModelExchange
-    modelIdentifier="<%modelIdentifier%>">
+    modelIdentifier="<%modelIdentifier%>"
+    canGetAndSetFMUstate="true"
+    canSerializeFMUstate="true"
+    providesDirectionalDerivative="<%providesDirectionalDerivative(simCode)%>">
   </ModelExchange>
   >>
 end ModelExchange;
 
+template CoSimulation(SimCode simCode)
+ "Generates CoSimulation code for ModelDescription file for FMU target."
+::=
+match simCode
+case SIMCODE(__) then
+  let modelIdentifier = modelNamePrefix(simCode)
+  <<
+  <CoSimulation
+    modelIdentifier="<%modelIdentifier%>"
+    canHandleVariableCommunicationStepSize="true"
+    canGetAndSetFMUstate="true"
+    canSerializeFMUstate="true"
+    providesDirectionalDerivative="<%providesDirectionalDerivative(simCode)%>">
+  </CoSimulation>
+  >>
+end CoSimulation;
+
+template providesDirectionalDerivative(SimCode simCode)
+ "Generates true if the columns of the symbolic Jacobians used by fmi2GetDirectionalDerivative
+  were generated, without symbolic linearization only their sparsity patterns are. A is needed
+  for the states, B, C and D only if the model has inputs or outputs."
+::=
+match simCode
+case SIMCODE(modelInfo = MODELINFO(varInfo = vi as VARINFO(__))) then
+  let jacobianA = symbolicJacobianColumns(jacobianMatrixes, "A")
+  let jacobianB = if intGt(vi.numInVars, 0) then symbolicJacobianColumns(jacobianMatrixes, "B") else "true"
+  let jacobianC = if intGt(vi.numOutVars, 0) then symbolicJacobianColumns(jacobianMatrixes, "C") else "true"
+  let jacobianD = if boolAnd(intGt(vi.numInVars, 0), intGt(vi.numOutVars, 0)) then symbolicJacobianColumns(jacobianMatrixes, "D") else "true"
+  if jacobianA then (if jacobianB then (if jacobianC then (if jacobianD then "true" else "false") else "false") else "false") else "false"
+end providesDirectionalDerivative;
+
+template symbolicJacobianColumns(list<JacobianMatrix> jacobianMatrixes, String matrixName)
+ "Generates true if the symbolic columns of the named Jacobian were generated."
+::=
+  jacobianMatrixes |> (columns, _, name, _, _, _, _) =>
+    if stringEq(name, matrixName) then (columns |> (_, _::_, _) => "true")
+end symbolicJacobianColumns;
+
 template fmiModelVariables(ModelInfo modelInfo, String FMUVersion)
  "Generates code for ModelVariables file for FMU target."
 ::=
@@ -160,7 +160,7 @@ case SIMCODE(__) then
   <<
   <?xml version="1.0" encoding="UTF-8"?>
   <%
-    if isFMIVersion20(FMUVersion) then CodegenFMU2.fmiModelDescription(simCode, guid)
+    if isFMIVersion20(FMUVersion) then CodegenFMU2.fmiModelDescription(simCode, guid, "me")
     else fmiModelDescriptionCpp(simCode, extraFuncs ,extraFuncsDecl, extraFuncsNamespace,guid)
   %>
   >>
@@ -1,34 +1,48 @@
-//#include <iostream>
-//#include <omp.h>
-//
-//#ifdef WIN32
-//#include <windows.h>
-//#endif
-//
-//#define THREAD_NUM 2
-//#define REPLICATIONS 10000
-//#define WARMUP 10000
-//
-//#define PACKAGE_SIZE_BIG 128
-//#define PACKAGE_SIZE_SMALL 1
-//
-//int itemCount = 0;
-//double items[PACKAGE_SIZE_BIG];
-//unsigned long long comTimes[REPLICATIONS];
-//
-//inline volatile long long RDTSC() {
-//   register long long TSC asm("eax");
-//   asm volatile (".byte 15, 49" : : : "eax", "edx");
-//   return TSC;
-//}
 #include "expat.h"
 #include <list>
 #include <string>
 #include <sstream>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <fstream>
+#include <algorithm>
+#include <vector>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
 #include "cJSON.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define HPCOM_HAVE_RDTSC
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define HPCOM_HAVE_RDTSC
+#endif
+
+#define HPCOM_CALIBRATION_VERSION 1
+
+#define REPLICATIONS 10000
+#define WARMUP 1000
+#define WAKE_REPLICATIONS 2000
+
+#define PACKAGE_SIZE_BIG 128
+#define PACKAGE_SIZE_SMALL 1
+
+#define CACHE_LINE_SIZE 64
+
 struct Equation {
   int id;
   unsigned long calcTimeCount;
@@ -39,180 +53,502 @@ struct Equation {
   }
 };
 
+/**
+ * Measured costs of the machine the compiler runs on. All times are in cycles
+ * (time stamp counter ticks, nanoseconds on platforms without rdtsc).
+ * Latencies that could not be measured are negative.
+ */
+struct MachineCalibration {
+  int opCostM, opCostN;              //y=mx+n for x floating point operations
+  int commCostM, commCostN;          //y=mx+n for x doubles send to another core
+  double lineLatencySameCore;        //cache line transfer between two hardware threads of one core
+  double lineLatencySameSocket;      //cache line transfer between two cores of one socket
+  double lineLatencyCrossSocket;     //cache line transfer between two sockets
+  double threadWakeLatency;          //wake up of a thread blocked on a condition variable
+
+  MachineCalibration() :
+      opCostM(1), opCostN(24), commCostM(4), commCostN(70),
+      lineLatencySameCore(-1.0), lineLatencySameSocket(-1.0), lineLatencyCrossSocket(-1.0), threadWakeLatency(-1.0) {
+  }
+};
+
+static MachineCalibration calibration;
+static bool calibrationDone = false;
+
+static inline unsigned long long readCycles() {
+#if defined(HPCOM_HAVE_RDTSC)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline void memoryBarrier() {
+#if defined(_MSC_VER)
+  MemoryBarrier();
+#else
+  __sync_synchronize();
+#endif
+}
+
+static double median(std::vector<unsigned long long> &values) {
+  std::sort(values.begin(), values.end());
+  return (double) values[values.size() / 2];
+}
+
+/**
+ * Pin the calling thread to the given cpu. Returns false if the platform does not support it.
+ * Only used with the cpu numbers of findCpuPairs.
+ */
+static bool pinThread(int cpu) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Time for the given number of independent floating point operations (mult,add).
+ */
+static unsigned long long timeForOps(int ops) {
+  double a0 = 1.0, a1 = 1.1, a2 = 1.2, a3 = 1.3;
+  const double m = 0.9999999, c = 1e-7;
+  volatile double sink;
+
+  unsigned long long t1 = readCycles();
+  for (int i = 0; i < ops / 8; i++) {
+    a0 = a0 * m + c;
+    a1 = a1 * m + c;
+    a2 = a2 * m + c;
+    a3 = a3 * m + c;
+  }
+  unsigned long long t2 = readCycles();
+  sink = a0 + a1 + a2 + a3;
+  (void) sink;
+  return t2 - t1;
+}
+
+static void calibrateOp(MachineCalibration *calib) {
+  const int opsSmall = 800, opsBig = 800000;
+  unsigned long long tSmall = ~0ULL, tBig = ~0ULL;
+
+  //warmup, then take the fastest of some runs
+  timeForOps(opsBig);
+  for (int i = 0; i < 10; i++) {
+    tSmall = std::min(tSmall, timeForOps(opsSmall));
+    tBig = std::min(tBig, timeForOps(opsBig));
+  }
+
+  double m = ((double) tBig - (double) tSmall) / (opsBig - opsSmall);
+  double n = (double) tSmall - m * opsSmall;
+  calib->opCostM = std::max(1, (int) (m + 0.5));
+  calib->opCostN = std::max(0, (int) (n + 0.5));
+}
+
+struct PingPongData {
+  volatile int itemCount;
+  char pad[CACHE_LINE_SIZE - sizeof(int)];
+  volatile double items[PACKAGE_SIZE_BIG];
+  int packageSize;
+  int cpu[2];
+  std::vector<unsigned long long> comTimes;
+};
+
+static void* sendMessage(void *arg) {
+  PingPongData *data = (PingPongData*) arg;
+  if (data->cpu[0] >= 0)
+    pinThread(data->cpu[0]);
+
+  for (int i = 0; i < WARMUP + REPLICATIONS; i++) {
+    for (int j = 0; j < data->packageSize; j++)
+      data->items[j] = 672364.8897 + i + j;
+    memoryBarrier();
+    unsigned long long t1 = readCycles();
+    data->itemCount = 1;
+    while (data->itemCount > 0);
+    unsigned long long t2 = readCycles();
+    if (i >= WARMUP)
+      data->comTimes[i - WARMUP] = t2 - t1;
+  }
+  return 0;
+}
+
+static void* waitForMessage(void *arg) {
+  PingPongData *data = (PingPongData*) arg;
+  volatile double last = 0.0;
+  if (data->cpu[1] >= 0)
+    pinThread(data->cpu[1]);
+
+  for (int i = 0; i < WARMUP + REPLICATIONS; i++) {
+    while (data->itemCount == 0);
+    memoryBarrier();
+    for (int j = 0; j < data->packageSize; j++)
+      last = last + data->items[j];
+    memoryBarrier();
+    data->itemCount = 0;
+  }
+  return 0;
+}
+
+/**
+ * Send packages of doubles from cpu0 to cpu1 and back. Returns the median one-way time.
+ * cpu numbers < 0 leave the threads unpinned.
+ */
+static double timeForComm(int cpu0, int cpu1, int packageSize) {
+  PingPongData *data = new PingPongData();
+  pthread_t sender, receiver;
+  double res;
+
+  data->itemCount = 0;
+  data->packageSize = packageSize;
+  data->cpu[0] = cpu0;
+  data->cpu[1] = cpu1;
+  data->comTimes.resize(REPLICATIONS);
+
+  pthread_create(&receiver, NULL, waitForMessage, data);
+  pthread_create(&sender, NULL, sendMessage, data);
+  pthread_join(sender, NULL);
+  pthread_join(receiver, NULL);
+
+  res = median(data->comTimes) / 2;
+  delete data;
+  return res;
+}
+
+struct WakeData {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  int turn;
+  std::vector<unsigned long long> wakeTimes;
+};
+
+static void* wakeResponder(void *arg) {
+  WakeData *data = (WakeData*) arg;
+  pthread_mutex_lock(&data->mutex);
+  for (int i = 0; i < WAKE_REPLICATIONS; i++) {
+    while (data->turn != 1)
+      pthread_cond_wait(&data->cond, &data->mutex);
+    data->turn = 0;
+    pthread_cond_broadcast(&data->cond);
+  }
+  pthread_mutex_unlock(&data->mutex);
+  return 0;
+}
+
+/**
+ * Wake a thread blocked on a condition variable and wait until it answers. Returns the median one-way time.
+ */
+static double timeForThreadWake() {
+  WakeData *data = new WakeData();
+  pthread_t responder;
+  double res;
+
+  pthread_mutex_init(&data->mutex, NULL);
+  pthread_cond_init(&data->cond, NULL);
+  data->turn = 0;
+  data->wakeTimes.resize(WAKE_REPLICATIONS);
+
+  pthread_create(&responder, NULL, wakeResponder, data);
+  pthread_mutex_lock(&data->mutex);
+  for (int i = 0; i < WAKE_REPLICATIONS; i++) {
+    unsigned long long t1 = readCycles();
+    data->turn = 1;
+    pthread_cond_broadcast(&data->cond);
+    while (data->turn != 0)
+      pthread_cond_wait(&data->cond, &data->mutex);
+    data->wakeTimes[i] = readCycles() - t1;
+  }
+  pthread_mutex_unlock(&data->mutex);
+  pthread_join(responder, NULL);
+
+  res = median(data->wakeTimes) / 2;
+  pthread_cond_destroy(&data->cond);
+  pthread_mutex_destroy(&data->mutex);
+  delete data;
+  return res;
+}
+
+static int numberOfCpus() {
+#if defined(_WIN32)
+  SYSTEM_INFO sysinfo;
+  GetSystemInfo(&sysinfo);
+  return sysinfo.dwNumberOfProcessors;
+#else
+  return (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+#if defined(__linux__)
+static int readTopologyValue(int cpu, const char *name) {
+  char path[256];
+  int value = -1;
+  FILE *f;
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+  f = fopen(path, "r");
+  if (f) {
+    if (fscanf(f, "%d", &value) != 1)
+      value = -1;
+    fclose(f);
+  }
+  return value;
+}
+#endif
+
+/**
+ * Find a partner of the first usable cpu for each topology level (same core, same socket, cross socket).
+ * Entries without a partner stay -1. Returns the first usable cpu or -1 if the topology is unknown.
+ */
+static int findCpuPairs(int *sameCore, int *sameSocket, int *crossSocket) {
+  *sameCore = *sameSocket = *crossSocket = -1;
+#if defined(__linux__)
+  cpu_set_t allowed;
+  int first = -1;
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0)
+    return -1;
+
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET(cpu, &allowed))
+      continue;
+    if (first < 0) {
+      first = cpu;
+      continue;
+    }
+    int samePackage = readTopologyValue(cpu, "physical_package_id") == readTopologyValue(first, "physical_package_id");
+    int sameCoreId = readTopologyValue(cpu, "core_id") == readTopologyValue(first, "core_id");
+    if (samePackage && sameCoreId && *sameCore < 0)
+      *sameCore = cpu;
+    else if (samePackage && !sameCoreId && *sameSocket < 0)
+      *sameSocket = cpu;
+    else if (!samePackage && *crossSocket < 0)
+      *crossSocket = cpu;
+  }
+  return first;
+#else
+  return -1;
+#endif
+}
+
+static void calibrateComm(MachineCalibration *calib) {
+  int first, sameCore, sameSocket, crossSocket;
+  int cpu0 = -1, cpu1 = -1;
+  double latency;
+
+  //spinning threads on a single cpu would never see each other
+  if (numberOfCpus() < 2)
+    return;
+
+  first = findCpuPairs(&sameCore, &sameSocket, &crossSocket);
+  if (first >= 0) {
+    if (sameCore >= 0)
+      calib->lineLatencySameCore = timeForComm(first, sameCore, PACKAGE_SIZE_SMALL);
+    if (sameSocket >= 0)
+      calib->lineLatencySameSocket = timeForComm(first, sameSocket, PACKAGE_SIZE_SMALL);
+    if (crossSocket >= 0)
+      calib->lineLatencyCrossSocket = timeForComm(first, crossSocket, PACKAGE_SIZE_SMALL);
+  } else {
+    //unknown topology, let the os place the threads
+    calib->lineLatencySameSocket = timeForComm(-1, -1, PACKAGE_SIZE_SMALL);
+  }
+
+  //the scheduler does not know where its threads run, plan with the slowest path between two cores
+  if (calib->lineLatencyCrossSocket >= 0) {
+    cpu0 = first; cpu1 = crossSocket;
+    latency = calib->lineLatencyCrossSocket;
+  } else if (calib->lineLatencySameSocket >= 0) {
+    cpu0 = first; cpu1 = sameSocket;
+    latency = calib->lineLatencySameSocket;
+  } else if (calib->lineLatencySameCore >= 0) {
+    cpu0 = first; cpu1 = sameCore;
+    latency = calib->lineLatencySameCore;
+  } else {
+    return;
+  }
+
+  double m = (timeForComm(cpu0, cpu1, PACKAGE_SIZE_BIG) - latency) / (PACKAGE_SIZE_BIG - PACKAGE_SIZE_SMALL);
+  calib->commCostN = std::max(1, (int) (latency + 0.5));
+  calib->commCostM = std::max(1, (int) (m + 0.5));
+}
+
+static std::string getHostName() {
+#if defined(_WIN32)
+  const char *name = getenv("COMPUTERNAME");
+  return name ? std::string(name) : std::string("unknown");
+#else
+  char name[256];
+  if (gethostname(name, sizeof(name)) != 0)
+    return std::string("unknown");
+  name[sizeof(name) - 1] = 0;
+  return std::string(name);
+#endif
+}
+
+/**
+ * Path of the calibration cache of this host, empty if no home directory is known.
+ */
+static std::string getCalibrationFile() {
+#if defined(_WIN32)
+  const char *home = getenv("APPDATA");
+#else
+  const char *home = getenv("HOME");
+#endif
+  if (home == NULL || *home == 0)
+    return std::string("");
+
+  std::string dir = std::string(home) + "/.openmodelica";
+#if defined(_WIN32)
+  _mkdir(dir.c_str());
+#else
+  mkdir(dir.c_str(), 0755);
+#endif
+  return dir + "/hpcom_calibration_" + getHostName() + ".json";
+}
+
+static bool readCalibration(std::string filePath, MachineCalibration *calib) {
+  FILE *fp;
+  long lSize;
+  char *buffer;
+  cJSON *root, *item;
+  bool valid = false;
+
+  fp = fopen(filePath.c_str(), "rb");
+  if (!fp)
+    return false;
+
+  fseek(fp, 0L, SEEK_END);
+  lSize = ftell(fp);
+  rewind(fp);
+
+  buffer = (char*) calloc(1, lSize + 1);
+  if (!buffer || 1 != fread(buffer, lSize, 1, fp)) {
+    fclose(fp);
+    free(buffer);
+    return false;
+  }
+  fclose(fp);
+
+  root = cJSON_Parse(buffer);
+  free(buffer);
+  if (root == 0)
+    return false;
+
+  //the cache is only valid for the same version on the same machine
+  item = cJSON_GetObjectItem(root, "version");
+  if (item && item->valueint == HPCOM_CALIBRATION_VERSION) {
+    cJSON *host = cJSON_GetObjectItem(root, "host");
+    cJSON *cpus = cJSON_GetObjectItem(root, "cpus");
+    valid = host && host->type == cJSON_String && getHostName() == host->valuestring &&
+            cpus && cpus->valueint == numberOfCpus();
+  }
+
+  const char *names[] = {"opCostM", "opCostN", "commCostM", "commCostN",
+                         "lineLatencySameCore", "lineLatencySameSocket", "lineLatencyCrossSocket", "threadWakeLatency"};
+  cJSON *items[8];
+  for (int i = 0; valid && i < 8; i++) {
+    items[i] = cJSON_GetObjectItem(root, names[i]);
+    valid = items[i] && items[i]->type == cJSON_Number;
+  }
+
+  if (valid) {
+    calib->opCostM = items[0]->valueint;
+    calib->opCostN = items[1]->valueint;
+    calib->commCostM = items[2]->valueint;
+    calib->commCostN = items[3]->valueint;
+    calib->lineLatencySameCore = items[4]->valuedouble;
+    calib->lineLatencySameSocket = items[5]->valuedouble;
+    calib->lineLatencyCrossSocket = items[6]->valuedouble;
+    calib->threadWakeLatency = items[7]->valuedouble;
+  }
+
+  cJSON_Delete(root);
+  return valid;
+}
+
+static void writeCalibration(std::string filePath, MachineCalibration *calib) {
+  cJSON *root = cJSON_CreateObject();
+  char *text;
+  FILE *fp;
+
+  cJSON_AddNumberToObject(root, "version", HPCOM_CALIBRATION_VERSION);
+  cJSON_AddStringToObject(root, "host", getHostName().c_str());
+  cJSON_AddNumberToObject(root, "cpus", numberOfCpus());
+#if defined(HPCOM_HAVE_RDTSC)
+  cJSON_AddStringToObject(root, "unit", "cycles");
+#else
+  cJSON_AddStringToObject(root, "unit", "ns");
+#endif
+  cJSON_AddNumberToObject(root, "opCostM", calib->opCostM);
+  cJSON_AddNumberToObject(root, "opCostN", calib->opCostN);
+  cJSON_AddNumberToObject(root, "commCostM", calib->commCostM);
+  cJSON_AddNumberToObject(root, "commCostN", calib->commCostN);
+  cJSON_AddNumberToObject(root, "lineLatencySameCore", calib->lineLatencySameCore);
+  cJSON_AddNumberToObject(root, "lineLatencySameSocket", calib->lineLatencySameSocket);
+  cJSON_AddNumberToObject(root, "lineLatencyCrossSocket", calib->lineLatencyCrossSocket);
+  cJSON_AddNumberToObject(root, "threadWakeLatency", calib->threadWakeLatency);
+
+  text = cJSON_Print(root);
+  cJSON_Delete(root);
+  if (text == 0)
+    return;
+
+  fp = fopen(filePath.c_str(), "wb");
+  if (fp) {
+    fputs(text, fp);
+    fclose(fp);
+  }
+  free(text);
+}
+
+/**
+ * Calibrate the cost model on the current machine. The results are cached per host in
+ * ~/.openmodelica/hpcom_calibration_<host>.json, so the benchmarks run only once.
+ */
+static MachineCalibration* getCalibration() {
+  if (calibrationDone)
+    return &calibration;
+
+  std::string filePath = getCalibrationFile();
+  if (filePath.empty() || !readCalibration(filePath, &calibration)) {
+    calibrateOp(&calibration);
+    calibrateComm(&calibration);
+    calibration.threadWakeLatency = timeForThreadWake();
+    if (!filePath.empty())
+      writeCalibration(filePath, &calibration);
+  }
+  calibrationDone = true;
+  return &calibration;
+}
+
 /**
  * Approximate the required time for operations (mult,add).
  * result: 2-parameters (m,n) y=mx+n
+ * The testsuite gets fixed values, so that its schedules do not depend on the machine.
  */
-void* HpcOmBenchmarkExtImpl__requiredTimeForOp() {
-//  unsigned long long calcTimesMul[REPLICATIONS];
-//  unsigned long long calcTimesAdd[REPLICATIONS];
-//  unsigned int sumCalc = 0;
-//  void *res = mmc_mk_nil();
-//
-//  //warmup
-//  for (int i = 0; i < REPLICATIONS; i++)
-//  {
-//    double last = 1234.123 + i;
-//    last = last * 3.6424;
-//  }
-//
-//  //bench mul
-//  for (int i = 0; i < REPLICATIONS; i++)
-//  {
-//    double last = 1234.123 + i;
-//    unsigned long long t1 = RDTSC();
-//    double res = last * 3.6424;
-//    unsigned long long t2 = RDTSC();
-//    calcTimesMul[i] = (t2-t1);
-//  }
-//
-//  //bench add
-//  for (int i = 0; i < REPLICATIONS; i++)
-//  {
-//    double last = 1234.123 + i;
-//    unsigned long long t1 = RDTSC();
-//    double res = last + 3.6424;
-//    unsigned long long t2 = RDTSC();
-//    calcTimesAdd[i] = (t2-t1);
-//  }
-//
-//  for (int i = 0; i < REPLICATIONS; i++)
-//  {
-//    sumCalc += calcTimesAdd[i];
-//    sumCalc += calcTimesMul[i];
-//  }
-//
-//  int m = 1;
-//  res = mmc_mk_cons(mmc_mk_icon((sumCalc/(REPLICATIONS*2))),res); //push n
-//  res = mmc_mk_cons(mmc_mk_icon(m),res); //push m
+void* HpcOmBenchmarkExtImpl__requiredTimeForOp(int runningTestsuite) {
+  MachineCalibration defaults;
+  MachineCalibration *calib = runningTestsuite ? &defaults : getCalibration();
   void *res = mmc_mk_nil();
-  res = mmc_mk_cons(mmc_mk_icon(24), res); //push n
-  res = mmc_mk_cons(mmc_mk_icon(1), res); //push m
+  res = mmc_mk_cons(mmc_mk_icon(calib->opCostN), res); //push n
+  res = mmc_mk_cons(mmc_mk_icon(calib->opCostM), res); //push m
   return res;
 }
 
-//void sendMessage (int warmUp, int replications, int packageSize)
-//{
-//  for (int i = 0; i < warmUp; i++)
-//  {
-//    for(int j=0; j < packageSize; j++)
-//    {
-//      items[j] = 672364.8897+i+j;
-//    }
-//    itemCount++;
-//    while(itemCount > 0);
-//  }
-//
-//  for (int i = 0; i < replications; i++)
-//  {
-//    for(int j=0; j < packageSize; j++)
-//    {
-//      items[j] = 672364.8897+i+j;
-//    }
-//    itemCount++;
-//    unsigned long long t1 = RDTSC();
-//    while(itemCount > 0);
-//    unsigned long long t2 = RDTSC();
-//    comTimes[i] = (t2-t1);
-//  }
-//}
-//
-//void waitForMessage(int warmUp, int replications, int packageSize)pt..str()
-//{
-//  double last[packageSize];
-//
-//  for (int i = 0; i < warmUp; i++)
-//  {
-//    while(itemCount == 0);
-//    for(int j=0; j < packageSize; j++)
-//    {
-//      last[j] = items[j];
-//    }
-//    itemCount--;
-//  }
-//
-//  for (int i = 0; i < replications; i++)
-//  {
-//    while(itemCount == 0);
-//    for(int j=0; j < packageSize; j++)
-//    {
-//      last[j] = items[j];
-//    }
-//    itemCount--;
-//  }
-//}
-
 /**
  * Approximate the required time to send doubles to another cpu.
  * result: 2-parameters (m,n) y=mx+n
+ * The testsuite gets fixed values, so that its schedules do not depend on the machine.
  */
-void* HpcOmBenchmarkExtImpl__requiredTimeForComm() {
-//  void *res = mmc_mk_nil();
-//  unsigned int sumComSmall = 0;
-//  unsigned int sumComBig = 0;
-//
-//  omp_set_num_threads(THREAD_NUM);
-//  omp_set_dynamic(0);
-//
-//  //Benchmark for small package
-//  #pragma omp parallel for shared(items) shared(itemCount)
-//  for (int i=0; i < THREAD_NUM; i++)
-//  {
-//    if((i % 2) == 0)
-//    {
-//#ifdef WIN32
-//      DWORD_PTR mask = (1 << omp_get_thread_num());
-//      SetThreadAffinityMask( GetCurrentThread(), mask );
-//      SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
-//#endif
-//      sendMessage(WARMUP,REPLICATIONS, PACKAGE_SIZE_SMALL);
-//    }
-//    else
-//    {
-//#ifdef WIN32
-//      DWORD_PTR mask = (1 << omp_get_thread_num());
-//      SetThreadAffinityMask( GetCurrentThread(), mask );
-//      SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
-//#endif
-//      waitForMessage(WARMUP,REPLICATIONS, PACKAGE_SIZE_SMALL);
-//    }
-//  }
-//
-//  for (int i = 0; i < REPLICATIONS; i++)
-//    sumComSmall += comTimes[i];
-//
-//  //Benchmark for big package
-//  #pragma omp parallel for shared(items) shared(itemCount)
-//  for (int i=0; i < THREAD_NUM; i++)
-//  {
-//    if((i % 2) == 0)
-//    {
-//#ifdef WIN32
-//      DWORD_PTR mask = (1 << omp_get_thread_num());
-//      SetThreadAffinityMask( GetCurrentThread(), mask );
-//      SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
-//#endif
-//      sendMessage(WARMUP,REPLICATIONS, PACKAGE_SIZE_BIG);
-//    }
-//    else
-//    {
-//#ifdef WIN32
-//      DWORD_PTR mask = (1 << omp_get_thread_num());
-//      SetThreadAffinityMask( GetCurrentThread(), mask );
-//      SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
-//#endif
-//      waitForMessage(WARMUP,REPLICATIONS, PACKAGE_SIZE_BIG);
-//    }
-//  }
-//
-//  for (int i = 0; i < REPLICATIONS; i++)
-//    sumComBig += comTimes[i];
-//
-//  res = mmc_mk_cons(mmc_mk_icon(sumComSmall/(REPLICATIONS*2)),res); //push n
-//  res = mmc_mk_cons(mmc_mk_icon((sumComBig-sumComSmall)/((PACKAGE_SIZE_BIG-PACKAGE_SIZE_SMALL)*(REPLICATIONS*2))),res); //push m
+void* HpcOmBenchmarkExtImpl__requiredTimeForComm(int runningTestsuite) {
+  MachineCalibration defaults;
+  MachineCalibration *calib = runningTestsuite ? &defaults : getCalibration();
   void *res = mmc_mk_nil();
-  res = mmc_mk_cons(mmc_mk_icon(70), res); //push n
-  res = mmc_mk_cons(mmc_mk_icon(4), res); //push m
+  res = mmc_mk_cons(mmc_mk_icon(calib->commCostN), res); //push n
+  res = mmc_mk_cons(mmc_mk_icon(calib->commCostM), res); //push m
   return res;
 }
 
@@ -5,14 +5,14 @@
 #include "HpcOmBenchmarkExt.cpp"
 
 extern "C" {
-extern void* HpcOmBenchmarkExt_requiredTimeForOp()
+extern void* HpcOmBenchmarkExt_requiredTimeForOp(int runningTestsuite)
 {
-  return HpcOmBenchmarkExtImpl__requiredTimeForOp();
+  return HpcOmBenchmarkExtImpl__requiredTimeForOp(runningTestsuite);
 }
 
-extern void* HpcOmBenchmarkExt_requiredTimeForComm()
+extern void* HpcOmBenchmarkExt_requiredTimeForComm(int runningTestsuite)
 {
-  return HpcOmBenchmarkExtImpl__requiredTimeForComm();
+  return HpcOmBenchmarkExtImpl__requiredTimeForComm(runningTestsuite);
 }
 
 extern void* HpcOmBenchmarkExt_readCalcTimesFromXml(const char *filename)
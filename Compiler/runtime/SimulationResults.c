@@ -57,6 +57,14 @@ static void SimulationResultsImpl__close(SimulationResult_Globals* simresglob)
   simresglob->curFileName = NULL;
 }
 
+/* The columns of a MAT-file that are cached by the reader are limited to
+ * $OPENMODELICA_MAT_CACHE_LIMIT megabytes; no limit if it is not set */
+static size_t SimulationResultsImpl__matCacheLimit()
+{
+  const char *limit = getenv("OPENMODELICA_MAT_CACHE_LIMIT");
+  return limit ? (size_t)strtoul(limit, NULL, 10) << 20 : 0;
+}
+
 static PlotFormat SimulationResultsImpl__openFile(const char *filename, SimulationResult_Globals* simresglob)
 {
   PlotFormat format;
@@ -80,6 +88,7 @@ static PlotFormat SimulationResultsImpl__openFile(const char *filename, Simulati
 
   if (len < 5) format = UNKNOWN_PLOT;
   else if (0 == strcmp(filename+len-4, ".mat")) format = MATLAB4;
+  else if (0 == strcmp(filename+len-5, ".matc")) format = MATLAB4; /* chunked MAT v4, handled by the same reader */
   else if (0 == strcmp(filename+len-4, ".plt")) format = PLT;
   else if (0 == strcmp(filename+len-4, ".csv")) format = CSV;
   else {
@@ -94,6 +103,7 @@ static PlotFormat SimulationResultsImpl__openFile(const char *filename, Simulati
       c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_error, gettext("Failed to open simulation result %s: %s"), msg, 2);
       return UNKNOWN_PLOT;
     }
+    omc_matlab4_set_cache_limit(&simresglob->matReader, SimulationResultsImpl__matCacheLimit());
     break;
   case PLT:
     simresglob->pltReader = fopen(filename, "r");
@@ -339,6 +349,19 @@ static void* SimulationResultsImpl__readDataset(const char *filename, void *vars
     }
     if (suggestReadAllVars) {
       omc_matlab4_read_all_vals(&simresglob->matReader);
+    } else {
+      /* Gather all requested variables in a single pass over the file */
+      void *v;
+      int nindexes = 0;
+      int *indexes = (int*) GC_malloc_atomic(listLength(vars)*sizeof(int));
+      for (v = vars; MMC_NILHDR != MMC_GETHDR(v); v = MMC_CDR(v)) {
+        mat_var = omc_matlab4_find_var(&simresglob->matReader,MMC_STRINGDATA(MMC_CAR(v)));
+        if (mat_var != NULL && !mat_var->isParam) {
+          indexes[nindexes++] = mat_var->index;
+        }
+      }
+      omc_matlab4_read_vars_vals(&simresglob->matReader, nindexes, indexes);
+      GC_free(indexes);
     }
     while (MMC_NILHDR != MMC_GETHDR(vars)) {
       var = MMC_STRINGDATA(MMC_CAR(vars));
@@ -412,6 +435,219 @@ static int endsWith(const char *s, const char *suffix)
     return 0;
   }
 }
+/* filterSimulationResults streams data_2 in blocks of FILTER_BLOCK_ROWS
+ * rows, so only one block of the selected variables is kept in memory */
+#define FILTER_BLOCK_ROWS 1024
+
+enum {
+  FILTER_OK = 0,
+  FILTER_READ_ERROR,
+  FILTER_WRITE_ERROR,
+  FILTER_RESAMPLE_ERROR
+};
+
+typedef struct filter_stream filter_stream;
+struct filter_stream {
+  ModelicaMatReader *reader;
+  int nvars;              /* selected variables of data_2; the first one is time */
+  const int *varIndexes;
+  double *out;            /* output rows; column-major with FILTER_BLOCK_ROWS rows */
+  uint32_t nout;          /* rows in out */
+  uint32_t nflushed;      /* rows written before the ones in out */
+  int (*flush)(filter_stream *stream);
+  void *data;
+  int nevents;
+  int neventpoints;
+  double failedTime;
+};
+
+/* Outputs w1*y1 + (1-w1)*y2 (or y1 if y2 is NULL); the values of a row are
+ * stride elements apart, like in a column-major block */
+static int filterEmitRow(filter_stream *s, const double *y1, uint32_t stride1, const double *y2, uint32_t stride2, double w1)
+{
+  int i;
+  if (y2) {
+    double w2 = 1.0 - w1;
+    for (i=0; i<s->nvars; i++) {
+      s->out[(size_t)i*FILTER_BLOCK_ROWS + s->nout] = w1*y1[(size_t)i*stride1] + w2*y2[(size_t)i*stride2];
+    }
+  } else {
+    for (i=0; i<s->nvars; i++) {
+      s->out[(size_t)i*FILTER_BLOCK_ROWS + s->nout] = y1[(size_t)i*stride1];
+    }
+  }
+  if (++s->nout == FILTER_BLOCK_ROWS) {
+    if (s->flush(s)) {
+      return FILTER_WRITE_ERROR;
+    }
+    s->nflushed += s->nout;
+    s->nout = 0;
+  }
+  return FILTER_OK;
+}
+
+/* Reads data_2 once, counting the events and resampling to numberOfIntervals
+ * intervals on the fly (if non-zero). Like omc_matlab4_val, each point
+ * takes the right limit at events and interpolates linearly between the
+ * closest points otherwise. */
+static int filterStreamRows(filter_stream *s, int numberOfIntervals, double start, double stop)
+{
+  ModelicaMatReader *reader = s->reader;
+  double *block = GC_malloc_atomic((size_t)s->nvars*FILTER_BLOCK_ROWS*sizeof(double));
+  double *prev = GC_malloc_atomic(s->nvars*sizeof(double));
+  double t = start;
+  uint32_t row0, r, n;
+  int i, j = 0, havePrev = 0, inEvent = 0, res = FILTER_OK;
+
+  s->out = GC_malloc_atomic((size_t)s->nvars*FILTER_BLOCK_ROWS*sizeof(double));
+  s->nout = 0;
+  s->nflushed = 0;
+  s->nevents = 0;
+  s->neventpoints = 0;
+  for (row0=0; row0<reader->nrows && res==FILTER_OK; row0+=n) {
+    n = reader->nrows-row0 < FILTER_BLOCK_ROWS ? reader->nrows-row0 : FILTER_BLOCK_ROWS;
+    if (omc_matlab4_read_vars_rows(reader, s->nvars, s->varIndexes, row0, n, block)) {
+      res = FILTER_READ_ERROR;
+      break;
+    }
+    for (r=0; r<n && res==FILTER_OK; r++) {
+      double time = block[r];
+      const double *before = r ? block+r-1 : (havePrev ? prev : NULL);
+      uint32_t strideBefore = r ? n : 1;
+      if (before && before[0] == time) {
+        s->neventpoints++;
+        s->nevents += !inEvent;
+        inEvent = 1;
+      } else {
+        inEvent = 0;
+      }
+      if (!numberOfIntervals) {
+        res = filterEmitRow(s, block+r, n, NULL, 0, 1.0);
+        continue;
+      }
+      /* Output the points between the previous row and this one */
+      while (j<=numberOfIntervals && t<time && res==FILTER_OK) {
+        if (!before) {
+          s->failedTime = t;
+          res = FILTER_RESAMPLE_ERROR;
+        } else if (before[0] == t) {
+          res = filterEmitRow(s, before, strideBefore, NULL, 0, 1.0);
+        } else {
+          res = filterEmitRow(s, block+r, n, before, strideBefore, (t-before[0]) / (time-before[0]));
+        }
+        j++;
+        t = j==numberOfIntervals ? stop : start + (stop-start)*((double)j)/numberOfIntervals;
+      }
+    }
+    if (n) {
+      for (i=0; i<s->nvars; i++) {
+        prev[i] = block[(size_t)i*n + n-1];
+      }
+      havePrev = 1;
+    }
+  }
+  /* The remaining points are only defined at the time of the last row */
+  while (numberOfIntervals && j<=numberOfIntervals && res==FILTER_OK) {
+    if (!havePrev || prev[0] != t) {
+      s->failedTime = t;
+      res = FILTER_RESAMPLE_ERROR;
+      break;
+    }
+    res = filterEmitRow(s, prev, 1, NULL, 0, 1.0);
+    j++;
+    t = j==numberOfIntervals ? stop : start + (stop-start)*((double)j)/numberOfIntervals;
+  }
+  if (res==FILTER_OK && s->nout) {
+    if (s->flush(s)) {
+      res = FILTER_WRITE_ERROR;
+    }
+    s->nflushed += s->nout;
+    s->nout = 0;
+  }
+  GC_free(block);
+  GC_free(prev);
+  GC_free(s->out);
+  s->out = NULL;
+  return res;
+}
+
+typedef struct {
+  FILE *fout;
+  int64_t data2Start; /* file offset of the data_2 values */
+  uint32_t nrows;
+} filter_mat_data;
+
+/* data_2 is column-major; each variable gets its own segment of the block */
+static int filterFlushMat(filter_stream *s)
+{
+  filter_mat_data *d = (filter_mat_data*) s->data;
+  int i;
+  for (i=0; i<s->nvars; i++) {
+    int64_t offset = d->data2Start + ((int64_t)i*d->nrows + s->nflushed)*sizeof(double);
+    if (omc_matlab4_fseek(d->fout, offset, SEEK_SET) || s->nout != fwrite(s->out + (size_t)i*FILTER_BLOCK_ROWS, sizeof(double), s->nout, d->fout)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+typedef struct {
+  FILE *fout;
+  int ncols;
+  const int *streamColumn; /* index in the stream, or -1 for parameters */
+  const double *constants; /* the values of the parameters */
+} filter_csv_data;
+
+static int filterFlushCsv(filter_stream *s)
+{
+  filter_csv_data *d = (filter_csv_data*) s->data;
+  uint32_t r;
+  int i;
+  for (r=0; r<s->nout; r++) {
+    for (i=0; i<d->ncols; i++) {
+      double val = d->streamColumn[i] < 0 ? d->constants[i] : s->out[(size_t)d->streamColumn[i]*FILTER_BLOCK_ROWS + r];
+      if (0 > fprintf(d->fout, i ? ",%.15g" : "%.15g", val)) {
+        return 1;
+      }
+    }
+    if (0 > fprintf(d->fout, "\n")) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Reports the errors of filterStreamRows; always returns 0 */
+static int filterStreamFailed(filter_stream *s, int res, const char *inFile, const char *outFile)
+{
+  const char *msg[3] = {"","",""};
+  switch (res) {
+  case FILTER_WRITE_ERROR:
+    return failedToWriteToFile(outFile);
+  case FILTER_RESAMPLE_ERROR:
+    msg[2] = inFile;
+    GC_asprintf((char**)msg+1, "%d", s->varIndexes[0]);
+    GC_asprintf((char**)msg+0, "%.15g", s->failedTime);
+    c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_error, gettext("Resampling %s failed to get variable %s at time %s.\n"), msg, 3);
+    return 0;
+  default:
+    msg[0] = inFile;
+    c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_error, gettext("Failed to read simulation result %s."), msg, 1);
+    return 0;
+  }
+}
+
+static void filterResamplingNotification(filter_stream *s, const char *inFile, int numberOfIntervals)
+{
+  const char *msg[5] = {"","","","",""};
+  msg[4] = inFile;
+  GC_asprintf((char**)msg+3, "%d", s->reader->nrows);
+  GC_asprintf((char**)msg+2, "%d", numberOfIntervals);
+  GC_asprintf((char**)msg+1, "%d", s->nevents);
+  GC_asprintf((char**)msg+0, "%d", s->neventpoints);
+  c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_notification, gettext("Resampling %s from %s points to %s points, removing %s events stored in %s points.\n"), msg, 5);
+}
+
 int SimulationResults_filterSimulationResults(const char *inFile, const char *outFile, void *vars, int numberOfIntervals)
 {
   const char *msg[5] = {"","","","",""};
@@ -434,9 +670,13 @@ int SimulationResults_filterSimulationResults(const char *inFile, const char *ou
     int *indexesToOutput = NULL;
     int *parameter_indexesToOutput = NULL;
     parameter_indexes[0] = 1; /* time */
-    omc_matlab4_read_all_vals(&simresglob.matReader);
     if (endsWith(outFile,".csv")) {
-      double **vals = GC_malloc(sizeof(double*)*numToFilter);
+      int *streamColumn = GC_malloc_atomic(numToFilter*sizeof(int));
+      int *streamIndexes = GC_malloc_atomic(numToFilter*sizeof(int));
+      double *constants = GC_malloc_atomic(numToFilter*sizeof(double));
+      filter_csv_data csv;
+      filter_stream stream = {0};
+      int res;
       for (i=0; i<numToFilter; i++) {
         const char *var = MMC_STRINGDATA(MMC_CAR(vars));
         vars = MMC_CDR(vars);
@@ -447,22 +687,42 @@ int SimulationResults_filterSimulationResults(const char *inFile, const char *ou
           c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_error, gettext("Could not read variable %s in file %s."), msg, 2);
           return 0;
         }
-        vals[i] = omc_matlab4_read_vals(&simresglob.matReader, mat_var[i]->index);
+        if (mat_var[i]->isParam) {
+          streamColumn[i] = -1;
+          constants[i] = (mat_var[i]->index < 0 ? -1 : 1) * simresglob.matReader.params[abs(mat_var[i]->index)-1];
+        } else {
+          streamColumn[i] = numUnique;
+          streamIndexes[numUnique++] = mat_var[i]->index;
+        }
       }
       FILE *fout = fopen(outFile, "w");
+      if (fout == NULL) {
+        return failedToWriteToFile(outFile);
+      }
       fprintf(fout, "time");
       for (i=1; i<numToFilter; i++) {
         fprintf(fout, ",\"%s\"", mat_var[i]->name);
       }
-      fprintf(fout, ",nrows=%d\n", simresglob.matReader.nrows);
-      for (i=0; i<simresglob.matReader.nrows; i++) {
-        fprintf(fout, "%.15g", vals[0][i]);
-        for (j=1; j<numToFilter; j++) {
-          fprintf(fout, ",%.15g", vals[j][i]);
-        }
-        fprintf(fout, "\n");
+      fprintf(fout, ",nrows=%d\n", numberOfIntervals ? numberOfIntervals+1 : simresglob.matReader.nrows);
+      csv.fout = fout;
+      csv.ncols = numToFilter;
+      csv.streamColumn = streamColumn;
+      csv.constants = constants;
+      stream.reader = &simresglob.matReader;
+      stream.nvars = numUnique;
+      stream.varIndexes = streamIndexes;
+      stream.flush = filterFlushCsv;
+      stream.data = &csv;
+      res = filterStreamRows(&stream, numberOfIntervals, omc_matlab4_startTime(&simresglob.matReader), omc_matlab4_stopTime(&simresglob.matReader));
+      if (fclose(fout) && res == FILTER_OK) {
+        res = FILTER_WRITE_ERROR;
+      }
+      if (res != FILTER_OK) {
+        return filterStreamFailed(&stream, res, inFile, outFile);
+      }
+      if (numberOfIntervals) {
+        filterResamplingNotification(&stream, inFile, numberOfIntervals);
       }
-      fclose(fout);
       return 1;
     } /* Not CSV */
 
@@ -598,64 +858,27 @@ int SimulationResults_filterSimulationResults(const char *inFile, const char *ou
       }
     }
 
-    if (numberOfIntervals) {
-      double *timevals = omc_matlab4_read_vals(&simresglob.matReader, 1);
-      int last_found=0;
-      int nevents=0, neventpoints=0;
-      for (i=1; i<numberOfIntervals; i++) {
-        double t = start + (stop-start)*((double)i)/numberOfIntervals;
-        while (timevals[j]<=t) {
-          if (timevals[j]==timevals[j+1]) {
-            while (timevals[j]==timevals[j+1]) {
-              j++;
-              neventpoints++;
-            }
-            nevents++;
-          }
-          j++;
-        }
-      }
-      msg[4] = inFile;
-      GC_asprintf((char**)msg+3, "%d", simresglob.matReader.nrows);
-      GC_asprintf((char**)msg+2, "%d", numberOfIntervals);
-      GC_asprintf((char**)msg+1, "%d", nevents);
-      GC_asprintf((char**)msg+0, "%d", neventpoints);
-      c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_notification, gettext("Resampling %s from %s points to %s points, removing %s events stored in %s points.\n"), msg, 5);
-    }
-
     if (writeMatVer4MatrixHeader(fout, "data_2", numberOfIntervals ? numberOfIntervals+1 : simresglob.matReader.nrows, numUnique, sizeof(double))) {
       return failedToWriteToFile(outFile);
     }
-    for (i=0; i<numUnique; i++) {
-      double *vals = NULL;
-      int nrows;
-      if (numberOfIntervals) {
-        omc_matlab4_read_all_vals(&simresglob.matReader);
-        nrows = numberOfIntervals+1;
-        vals = GC_malloc_atomic(sizeof(double)*nrows);
-        for (j=0; j<=numberOfIntervals; j++) {
-          double t = j==numberOfIntervals ? stop : start + (stop-start)*((double)j)/numberOfIntervals;
-          ModelicaMatVariable_t var = {.name="", .descr="", .isParam=0, .index=indexesToOutput[i]};
-          if (omc_matlab4_val(vals+j, &simresglob.matReader, &var, t)) {
-            msg[2] = inFile;
-            GC_asprintf((char**)msg+1, "%d", indexesToOutput[i]);
-            GC_asprintf((char**)msg+0, "%.15g", t);
-            c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_error, gettext("Resampling %s failed to get variable %s at time %s.\n"), msg, 3);
-            return 0;
-          }
-        }
-      } else {
-        vals = omc_matlab4_read_vals(&simresglob.matReader, indexesToOutput[i]);
-        nrows = simresglob.matReader.nrows;
-      }
-      if (1!=fwrite(vals, sizeof(double)*nrows, 1, fout)) {
-        return failedToWriteToFile(outFile);
-      }
-      if (numberOfIntervals) {
-        GC_free(vals);
-      }
+    filter_mat_data matData = {fout, omc_matlab4_ftell(fout), numberOfIntervals ? numberOfIntervals+1 : simresglob.matReader.nrows};
+    filter_stream stream = {0};
+    int res;
+    stream.reader = &simresglob.matReader;
+    stream.nvars = numUnique;
+    stream.varIndexes = indexesToOutput;
+    stream.flush = filterFlushMat;
+    stream.data = &matData;
+    res = filterStreamRows(&stream, numberOfIntervals, start, stop);
+    if (fclose(fout) && res == FILTER_OK) {
+      res = FILTER_WRITE_ERROR;
+    }
+    if (res != FILTER_OK) {
+      return filterStreamFailed(&stream, res, inFile, outFile);
+    }
+    if (numberOfIntervals) {
+      filterResamplingNotification(&stream, inFile, numberOfIntervals);
     }
-    fclose(fout);
     return 1;
   }
   default:
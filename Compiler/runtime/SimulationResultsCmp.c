@@ -36,6 +36,7 @@
 #include <assert.h>
 
 #include "systemimpl.h"
+#include "rtclock.h"
 
 /* Size of the buffer for warnings and other messages */
 #define WARNINGBUFFSIZE 4096
@@ -98,6 +99,24 @@ static DataField getData(const char *varname,const char *filename, unsigned int
   res.n = 0;
   res.data = NULL;
 
+  /* Copy MATLAB4 variables straight from the reader instead of going through a list */
+  if (MATLAB4 == SimulationResultsImpl__openFile(filename,srg)) {
+    ModelicaMatVariable_t *mat_var = omc_matlab4_find_var(&srg->matReader,varname);
+    if (mat_var != NULL && !mat_var->isParam && (size == 0 || size == srg->matReader.nrows) && srg->matReader.nrows > 0) {
+      double *vals;
+      if (suggestRealAll) {
+        omc_matlab4_read_all_vals(&srg->matReader);
+      }
+      vals = omc_matlab4_read_vals(&srg->matReader,mat_var->index);
+      if (vals) {
+        res.n = srg->matReader.nrows;
+        res.data = (double*) malloc(sizeof(double)*res.n);
+        memcpy(res.data, vals, sizeof(double)*res.n);
+        return res;
+      }
+    }
+  }
+
   /* fprintf(stderr, "getData of Var: %s from file %s\n", varname,filename);  */
   cmpvar = mmc_mk_nil();
   cmpvar =  mmc_mk_cons(mmc_mk_scon(varname),cmpvar);
@@ -159,7 +178,9 @@ static char almostEqualWithDefaultTolerance(double a, double b)
   return almostEqualRelativeAndAbs(a,b,DOUBLEEQUAL_REL,DOUBLEEQUAL_TOTAL);
 }
 
-static unsigned int cmpData(int isResultCmp, char* varname, DataField *time, DataField *reftime, DataField *data, DataField *refdata, double reltol, double abstol, DiffDataField *ddf, char **cmpdiffvars, unsigned int vardiffindx, int keepEqualResults, void **diffLst, const char *prefix)
+/* Compares one variable; returns 1 if it differs. Does not touch any shared
+ * state, so several variables can be compared at the same time. */
+static char cmpData(int isResultCmp, char* varname, DataField *time, DataField *reftime, DataField *data, DataField *refdata, double reltol, double abstol, DiffDataField *ddf, int keepEqualResults, const char *prefix)
 {
   unsigned int i,j,k,j_event;
   double t,tr,d,dr,err,d_left,d_right,dr_left,dr_right,t_event;
@@ -226,7 +247,7 @@ static unsigned int cmpData(int isResultCmp, char* varname, DataField *time, Dat
     /* events, in case of an event compare only the left and right values of the absolute event time range,
     * this means ta_left = min(t_left,tr_left) and
     * ta_right = max(t_right,ta_right) */
-    if(i<time->n) {
+    if(i+1<time->n) {
 #ifdef DEBUGOUTPUT
        fprintf(stderr, "check event: %.15g  - %.15g = %.15g\n",t,time->data[i+1],fabs(t-time->data[i+1]));
 #endif
@@ -470,13 +491,6 @@ static unsigned int cmpData(int isResultCmp, char* varname, DataField *time, Dat
       }
     }
   }
-  if (isdifferent) {
-    cmpdiffvars[vardiffindx] = varname;
-    vardiffindx++;
-    if (!isResultCmp) {
-      *diffLst = mmc_mk_cons(mmc_mk_scon(varname),*diffLst);
-    }
-  }
   if (fout) {
     fclose(fout);
   }
@@ -486,7 +500,7 @@ static unsigned int cmpData(int isResultCmp, char* varname, DataField *time, Dat
   if (fname) {
     free(fname);
   }
-  return vardiffindx;
+  return isdifferent;
 }
 
 static int writeLogFile(const char *filename,DiffDataField *ddf,const char *f,const char *reff,double reltol,double abstol)
@@ -528,8 +542,144 @@ static const char* getTimeVarName(void *vars) {
 
 #include "SimulationResultsCmpTubes.c"
 
+/* Number of variables loaded before the workers compare them; bounds the
+ * memory used for the copies of the data */
+#define CMP_BATCH_SIZE 1024
+
+/* A variable of the comparison. The data is loaded by the main thread since
+ * the result file readers are not thread-safe; a worker compares it and keeps
+ * the results here until they are merged in the original order. */
+typedef struct {
+  char *name;         /* as requested, used in the output */
+  char *readName;     /* without quotes, used to read the data */
+  DataField data;
+  DataField dataref;
+  DiffDataField ddf;
+  char loaded;
+  char isdifferent;
+} CmpVariable;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  unsigned int current;
+  unsigned int n;
+  CmpVariable *vars;
+  int isResultCmp;
+  int isHtml;
+  int keepEqualResults;
+  DataField *time;
+  DataField *timeref;
+  double reltol;
+  double abstol;
+  double reltolDiffMaxMin;
+  double rangeDelta;
+  const char *prefix;
+  char **htmlOut;
+} CmpWorkerData;
+
+static struct {
+  unsigned int signals;
+  int threads;
+  double time;
+} cmpStatistics = {0,0,0};
+
+static void cmpVariable(CmpWorkerData *cwd, CmpVariable *v)
+{
+  if (!v->loaded) {
+    return;
+  }
+  if (cwd->isHtml) {
+    v->isdifferent = cmpDataTubes(cwd->isResultCmp,v->name,cwd->time,cwd->timeref,&v->data,&v->dataref,cwd->reltol,cwd->rangeDelta,cwd->reltolDiffMaxMin,&v->ddf,cwd->keepEqualResults,cwd->prefix,1,cwd->htmlOut);
+  } else if (cwd->isResultCmp) {
+    v->isdifferent = cmpData(cwd->isResultCmp,v->name,cwd->time,cwd->timeref,&v->data,&v->dataref,cwd->reltol,cwd->abstol,&v->ddf,cwd->keepEqualResults,cwd->prefix);
+  } else {
+    v->isdifferent = cmpDataTubes(cwd->isResultCmp,v->name,cwd->time,cwd->timeref,&v->data,&v->dataref,cwd->reltol,cwd->rangeDelta,cwd->reltolDiffMaxMin,&v->ddf,cwd->keepEqualResults,cwd->prefix,0,0);
+  }
+}
+
+static void* cmpWorkerThread(void *arg)
+{
+  CmpWorkerData *cwd = (CmpWorkerData*) arg;
+  while (1) {
+    unsigned int i;
+    pthread_mutex_lock(&cwd->mutex);
+    i = cwd->current++;
+    pthread_mutex_unlock(&cwd->mutex);
+    if (i >= cwd->n) break;
+    cmpVariable(cwd, &cwd->vars[i]);
+  }
+  return NULL;
+}
+
+static void cmpVariablesParallel(CmpWorkerData *cwd, int numThreads)
+{
+  int i;
+  pthread_t *th;
+  if (numThreads > (int) cwd->n) {
+    numThreads = cwd->n;
+  }
+  cwd->current = 0;
+  if (numThreads <= 1) {
+    cmpWorkerThread(cwd);
+    return;
+  }
+  th = (pthread_t*) malloc(sizeof(pthread_t)*numThreads);
+  for (i=0; i<numThreads; i++) {
+    GC_pthread_create(&th[i],NULL,cmpWorkerThread,cwd);
+  }
+  for (i=0; i<numThreads; i++) {
+    GC_pthread_join(th[i], NULL);
+  }
+  free(th);
+}
+
+/* Reads the columns of all variables of a batch in one pass over a MAT-file;
+ * getData then only copies them from the reader */
+static void prefetchMatVariables(SimulationResult_Globals *srg, const char *filename, CmpVariable *vars, unsigned int n)
+{
+  int *indexes, nindexes = 0;
+  unsigned int i;
+  if (MATLAB4 != SimulationResultsImpl__openFile(filename,srg) || srg->matReader.readAll) {
+    return;
+  }
+  indexes = (int*) malloc(sizeof(int)*n);
+  if (!indexes) {
+    return;
+  }
+  for (i=0; i<n; i++) {
+    ModelicaMatVariable_t *mat_var = omc_matlab4_find_var(&srg->matReader,vars[i].readName);
+    if (mat_var != NULL && !mat_var->isParam) {
+      indexes[nindexes++] = mat_var->index;
+    }
+  }
+  if (nindexes > 0 && srg->matReader.nrows > 0) {
+    omc_matlab4_read_vars_vals(&srg->matReader,nindexes,indexes);
+  }
+  free(indexes);
+}
+
+static void appendDiffData(DiffDataField *ddf, DiffDataField *vddf)
+{
+  if (vddf->n == 0) {
+    return;
+  }
+  if (ddf->n + vddf->n > ddf->n_max) {
+    DiffData *newData;
+    unsigned int n_max = ddf->n_max ? ddf->n_max : 1024;
+    while (n_max < ddf->n + vddf->n) {
+      n_max *= 2;
+    }
+    newData = (DiffData*) realloc(ddf->data, sizeof(DiffData)*n_max);
+    if (!newData) return; /* realloc failed... pretty bad, but let's continue */
+    ddf->data = newData;
+    ddf->n_max = n_max;
+  }
+  memcpy(ddf->data + ddf->n, vddf->data, sizeof(DiffData)*vddf->n);
+  ddf->n += vddf->n;
+}
+
 /* Common, huge function, for both result comparison and result diff */
-void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite, const char *filename, const char *reffilename, const char *resultfilename, double reltol, double abstol, double reltolDiffMaxMin, double rangeDelta, void *vars, int keepEqualResults, int *success, int isHtml, char **htmlOut)
+void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite, int numThreads, const char *filename, const char *reffilename, const char *resultfilename, double reltol, double abstol, double reltolDiffMaxMin, double rangeDelta, void *vars, int keepEqualResults, int *success, int isHtml, char **htmlOut)
 {
   char **cmpvars=NULL;
   char **cmpdiffvars=NULL;
@@ -537,13 +687,19 @@ void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite,
   unsigned int ncmpvars = 0;
   unsigned int ngetfailedvars = 0;
   void *allvars,*allvarsref,*res;
-  unsigned int i,size,size_ref,len,j,k;
-  char *var,*var1,*var2;
-  DataField time,timeref,data,dataref;
+  unsigned int i,size,size_ref,len,j,k,batch;
+  unsigned int ncompared = 0;
+  char *var,*var1;
+  DataField time,timeref;
   DiffDataField ddf;
+  CmpVariable *cmpvarsBatch;
+  CmpWorkerData cwd;
+  rtclock_t clk;
   const char *msg[2] = {"",""};
   const char *timeVarName, *timeVarNameRef;
   int suggestReadAll=0;
+  rt_ext_tp_tick(&clk);
+  memset(&cmpStatistics, 0, sizeof(cmpStatistics));
   ddf.data=NULL;
   ddf.n=0;
   ddf.n_max=0;
@@ -615,79 +771,96 @@ void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite,
     "File[%d]=%f\n",timeref.n,timeref.data[timeref.n-1],time.n,time.data[time.n-1]);
     c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_warning, buf, NULL, 0);
   }
-  var1=NULL;
-  var2=NULL;
-  /* compare vars */
-  /* fprintf(stderr, "compare vars\n"); */
-  for (i=0;i<ncmpvars;i++) {
-    var = cmpvars[i];
-    len = strlen(var);
-    if (var1) {
-      free(var1);
-      var1 = NULL;
-    }
-    var1 = (char*) GC_malloc(len+10);
-    k = 0;
-    for (j=0;j<len;j++) {
-      if (var[j] !='\"' ) {
-        var1[k] = var[j];
-        k +=1;
+  /* compare vars in batches: load serially, compare in parallel, merge in order */
+  cmpvarsBatch = (CmpVariable*) malloc(sizeof(CmpVariable)*(ncmpvars < CMP_BATCH_SIZE ? ncmpvars : CMP_BATCH_SIZE));
+  cwd.isResultCmp = isResultCmp;
+  cwd.isHtml = isHtml;
+  cwd.keepEqualResults = keepEqualResults;
+  cwd.time = &time;
+  cwd.timeref = &timeref;
+  cwd.reltol = reltol;
+  cwd.abstol = abstol;
+  cwd.reltolDiffMaxMin = reltolDiffMaxMin;
+  cwd.rangeDelta = rangeDelta;
+  cwd.prefix = resultfilename;
+  cwd.htmlOut = htmlOut;
+  cwd.vars = cmpvarsBatch;
+  pthread_mutex_init(&cwd.mutex,NULL);
+  for (batch=0; batch<ncmpvars; batch+=CMP_BATCH_SIZE) {
+    cwd.n = ncmpvars-batch < CMP_BATCH_SIZE ? ncmpvars-batch : CMP_BATCH_SIZE;
+    for (i=0;i<cwd.n;i++) {
+      CmpVariable *v = &cmpvarsBatch[i];
+      memset(v, 0, sizeof(CmpVariable));
+      var = cmpvars[batch+i];
+      len = strlen(var);
+      v->name = var;
+      var1 = v->readName = (char*) GC_malloc_atomic(len+10);
+      k = 0;
+      for (j=0;j<len;j++) {
+        if (var[j] !='\"' ) {
+          var1[k] = var[j];
+          k +=1;
+        }
       }
+      var1[k] = 0;
     }
-    var1[k] = 0;
-    /* fprintf(stderr, "compare var: %s\n",var); */
-    /* check if in ref_file */
-    dataref = getData(var1,reffilename,size_ref,suggestReadAll,&simresglob_ref,runningTestsuite);
-    if (dataref.n==0) {
-      if (dataref.data) {
-        free(dataref.data);
-      }
-      if (var1) {
+    /* read the columns of the batch in bulk */
+    prefetchMatVariables(&simresglob_ref,reffilename,cmpvarsBatch,cwd.n);
+    prefetchMatVariables(&simresglob_c,filename,cmpvarsBatch,cwd.n);
+    for (i=0;i<cwd.n;i++) {
+      CmpVariable *v = &cmpvarsBatch[i];
+      var1 = v->readName;
+      var = v->name;
+      /* check if in ref_file */
+      v->dataref = getData(var1,reffilename,size_ref,suggestReadAll,&simresglob_ref,runningTestsuite);
+      if (v->dataref.n==0) {
+        free(v->dataref.data);
+        v->dataref.data = NULL;
         GC_free(var1);
-        var1 = NULL;
-      }
-      msg[0] = runningTestsuite ? SystemImpl__basename(reffilename) : reffilename;
-      msg[1] = var;
-      c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_warning, gettext("Get data of variable %s from file %s failed!\n"), msg, 2);
-      ngetfailedvars++;
-      continue;
-    }
-    /*  check if in file */
-    data = getData(var1,filename,size,suggestReadAll,&simresglob_c,runningTestsuite);
-    if (data.n==0)  {
-      if (data.data) {
-        free(data.data);
+        msg[0] = runningTestsuite ? SystemImpl__basename(reffilename) : reffilename;
+        msg[1] = var;
+        c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_warning, gettext("Get data of variable %s from file %s failed!\n"), msg, 2);
+        ngetfailedvars++;
+        continue;
       }
-      if (var1) {
-        GC_free(var1);
-        var1 = NULL;
+      /*  check if in file */
+      v->data = getData(var1,filename,size,suggestReadAll,&simresglob_c,runningTestsuite);
+      GC_free(var1);
+      if (v->data.n==0)  {
+        free(v->data.data);
+        v->data.data = NULL;
+        msg[0] = runningTestsuite ? SystemImpl__basename(filename) : filename;
+        msg[1] = var;
+        c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_warning, gettext("Get data of variable %s from file %s failed!\n"), msg, 2);
+        ngetfailedvars++;
+        continue;
       }
-      msg[0] = runningTestsuite ? SystemImpl__basename(filename) : filename;
-      msg[1] = var;
-      c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_warning, gettext("Get data of variable %s from file %s failed!\n"), msg, 2);
-      ngetfailedvars++;
-      continue;
+      v->loaded = 1;
+      ncompared++;
     }
     /* compare */
-    if (isHtml) {
-      vardiffindx = cmpDataTubes(isResultCmp,var,&time,&timeref,&data,&dataref,reltol,rangeDelta,reltolDiffMaxMin,&ddf,cmpdiffvars,vardiffindx,keepEqualResults,&res,resultfilename,1,htmlOut);
-    } else if (isResultCmp) {
-      vardiffindx = cmpData(isResultCmp,var,&time,&timeref,&data,&dataref,reltol,abstol,&ddf,cmpdiffvars,vardiffindx,keepEqualResults,&res,resultfilename);
-    } else {
-      vardiffindx = cmpDataTubes(isResultCmp,var,&time,&timeref,&data,&dataref,reltol,rangeDelta,reltolDiffMaxMin,&ddf,cmpdiffvars,vardiffindx,keepEqualResults,&res,resultfilename,0,0);
-    }
-    /* free */
-    if (dataref.data) {
-      free(dataref.data);
-    }
-    if (data.data) {
-      free(data.data);
-    }
-    if (var1) {
-      GC_free(var1);
-      var1 = NULL;
+    cmpVariablesParallel(&cwd, numThreads);
+    /* merge and free */
+    for (i=0;i<cwd.n;i++) {
+      CmpVariable *v = &cmpvarsBatch[i];
+      if (v->isdifferent) {
+        cmpdiffvars[vardiffindx++] = v->name;
+        if (!isResultCmp) {
+          res = mmc_mk_cons(mmc_mk_scon(v->name),res);
+        }
+      }
+      appendDiffData(&ddf,&v->ddf);
+      if (v->ddf.data) free(v->ddf.data);
+      if (v->dataref.data) free(v->dataref.data);
+      if (v->data.data) free(v->data.data);
     }
   }
+  pthread_mutex_destroy(&cwd.mutex);
+  free(cmpvarsBatch);
+
+  cmpStatistics.signals = ncompared;
+  cmpStatistics.threads = numThreads < (int) ncompared ? numThreads : (int) ncompared;
+  cmpStatistics.time = rt_ext_tp_tock(&clk);
 
   if (isResultCmp) {
     if (writeLogFile(resultfilename,&ddf,filename,reffilename,reltol,abstol)) {
@@ -712,8 +885,6 @@ void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite,
     }
   }
 
-  // if (var1) free(var1);
-  // if (var2) free(var2);
   if (ddf.data) free(ddf.data);
   if (cmpvars) GC_free(cmpvars);
   if (time.data) free(time.data);
@@ -636,9 +636,11 @@ static double* validate(int n, addTargetEventTimesRes ref, double *low, double *
   return NULL;
 }
 
-static unsigned int cmpDataTubes(int isResultCmp, char* varname, DataField *time, DataField *reftime, DataField *data, DataField *refdata, double reltol, double rangeDelta, double reltolDiffMaxMin, DiffDataField *ddf, char **cmpdiffvars, unsigned int vardiffindx, int keepEqualResults, void **diffLst, const char *prefix, int isHtml, char **htmlOut)
+/* Returns 1 if the variable is outside the tubes */
+static char cmpDataTubes(int isResultCmp, char* varname, DataField *time, DataField *reftime, DataField *data, DataField *refdata, double reltol, double rangeDelta, double reltolDiffMaxMin, DiffDataField *ddf, int keepEqualResults, const char *prefix, int isHtml, char **htmlOut)
 {
   int withTubes = 0 == rangeDelta;
+  char isdifferent;
   FILE *fout = NULL;
   char *fname = NULL;
   char *html;
@@ -765,13 +767,7 @@ static unsigned int cmpDataTubes(int isResultCmp, char* varname, DataField *time
     }
     fputs(isHtml ? "],\n" : "\n", fout);
   }
-  if (error) {
-    cmpdiffvars[vardiffindx] = varname;
-    vardiffindx++;
-    if (!isResultCmp) {
-      *diffLst = mmc_mk_cons(mmc_mk_scon(varname),*diffLst);
-    }
-  }
+  isdifferent = error != NULL;
   if (fout) {
     if (isHtml) {
 fprintf(fout, "{title: '%s',\n"
@@ -817,5 +813,5 @@ fprintf(fout, "{title: '%s',\n"
   GC_free(priv->yLow);
   GC_free(priv);
   GC_free(calibrated_values);
-  return vardiffindx;
+  return isdifferent;
 }
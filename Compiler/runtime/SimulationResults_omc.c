@@ -67,23 +67,33 @@ double SimulationResults_val(const char *filename, const char *varname, double t
   return SimulationResultsImpl__val(filename,varname,timeStamp,&simresglob);
 }
 
-void* SimulationResults_cmpSimulationResults(int runningTestsuite, const char *filename,const char *reffilename,const char *logfilename, double refTol, double absTol, void *vars)
+void* SimulationResults_cmpSimulationResults(int runningTestsuite, int numThreads, const char *filename,const char *reffilename,const char *logfilename, double refTol, double absTol, void *vars)
 {
-  return SimulationResultsCmp_compareResults(1,runningTestsuite,filename,reffilename,logfilename,refTol,absTol,0,0,vars,0,NULL,0,NULL);
+  return SimulationResultsCmp_compareResults(1,runningTestsuite,numThreads,filename,reffilename,logfilename,refTol,absTol,0,0,vars,0,NULL,0,NULL);
 }
 
-void* SimulationResults_diffSimulationResults(int runningTestsuite, const char *filename,const char *reffilename,const char *logfilename, double refTol, double reltolDiffMaxMin, double rangeDelta, void *vars, int keepEqualResults, int *success)
+void* SimulationResults_diffSimulationResults(int runningTestsuite, int numThreads, const char *filename,const char *reffilename,const char *logfilename, double refTol, double reltolDiffMaxMin, double rangeDelta, void *vars, int keepEqualResults, int *success)
 {
-  return SimulationResultsCmp_compareResults(0,runningTestsuite,filename,reffilename,logfilename,refTol,0,reltolDiffMaxMin,rangeDelta,vars,keepEqualResults,success,0,NULL);
+  return SimulationResultsCmp_compareResults(0,runningTestsuite,numThreads,filename,reffilename,logfilename,refTol,0,reltolDiffMaxMin,rangeDelta,vars,keepEqualResults,success,0,NULL);
 }
 
-const char* SimulationResults_diffSimulationResultsHtml(int runningTestsuite, const char *var, const char *filename,const char *reffilename, double refTol, double reltolDiffMaxMin, double rangeDelta)
+const char* SimulationResults_diffSimulationResultsHtml(int runningTestsuite, int numThreads, const char *var, const char *filename,const char *reffilename, double refTol, double reltolDiffMaxMin, double rangeDelta)
 {
   char *res = "";
-  SimulationResultsCmp_compareResults(0,runningTestsuite,filename,reffilename,"",0,refTol,reltolDiffMaxMin,rangeDelta,mmc_mk_cons(mmc_mk_scon(var),mmc_mk_nil()),0,NULL,1,&res);
+  SimulationResultsCmp_compareResults(0,runningTestsuite,numThreads,filename,reffilename,"",0,refTol,reltolDiffMaxMin,rangeDelta,mmc_mk_cons(mmc_mk_scon(var),mmc_mk_nil()),0,NULL,1,&res);
   return res;
 }
 
+const char* SimulationResults_comparisonStatistics()
+{
+  char buf[WARNINGBUFFSIZE];
+  snprintf(buf,WARNINGBUFFSIZE,"Compared %u signals in %.4g s (%.4g signals/s) using %d threads",
+    cmpStatistics.signals, cmpStatistics.time,
+    cmpStatistics.time > 0 ? cmpStatistics.signals/cmpStatistics.time : 0.0,
+    cmpStatistics.threads);
+  return GC_strdup(buf);
+}
+
 void SimulationResults_close()
 {
   SimulationResultsImpl__close(&simresglob);
@@ -88,6 +88,7 @@ extern int SystemImpl__removeFile(const char* filename);
 extern const char* SystemImpl__basename(const char *str);
 extern int SystemImpl__systemCall(const char* str, const char* outFile);
 extern void* SystemImpl__systemCallParallel(void *lst, int numThreads);
+extern int System_numProcessors(void);
 extern int SystemImpl__spawnCall(const char* path, const char* str);
 extern int SystemImpl__plotCallBackDefined(threadData_t *threadData);
 extern void SystemImpl__plotCallBack(threadData_t *threadData, int externalWindow, const char* filename, const char* title, const char* grid, const char* plotType,
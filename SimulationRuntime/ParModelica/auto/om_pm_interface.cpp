@@ -39,6 +39,7 @@
 
 #include "om_pm_interface.hpp"
 #include "om_pm_model.hpp"
+#include "simulation_data.h"
 
 
 extern "C" {
@@ -79,7 +80,11 @@ void PM_functionDAE(int size, void* data, FunctionType* functionDAE_systems) {
 
 void PM_functionODE(int size, void* data, FunctionType* functionODE_systems) {
 
-    pm_om_model.ODE_scheduler.execute();
+    if(!pm_om_model.ODE_scheduler)
+        pm_om_model.select_ode_scheduler(((DATA*)data)->simulationInfo.parmodautoScheduler);
+
+    pm_om_model.ODE_scheduler->execute();
+    pm_om_model.save_ode_profile();
 
   // pm_om_model.ODE_scheduler.execution_timer.start_timer();
     // for(int i = 0; i < size; ++i)
@@ -101,8 +106,11 @@ void PM_functionAlg(int size, void* data, FunctionType* functionAlg_systems) {
 void dump_times() {
     utility::log("") << "Total INI: " << pm_om_model.INI_scheduler.execution_timer.get_elapsed_time() << std::endl;
     utility::log("") << "Total DAE: " << pm_om_model.DAE_scheduler.execution_timer.get_elapsed_time() << std::endl;
-    utility::log("") << "Total ODE: " << pm_om_model.ODE_scheduler.execution_timer.get_elapsed_time() << std::endl;
-  utility::log("") << "Total ODE: " << pm_om_model.ODE_scheduler.clustering_timer.get_elapsed_time() << std::endl;
+    if(pm_om_model.ODE_scheduler) {
+        utility::log("") << "ODE scheduler: " << pm_om_model.ODE_scheduler->name() << std::endl;
+        utility::log("") << "Total ODE: " << pm_om_model.ODE_scheduler->execution_time() << std::endl;
+        utility::log("") << "Total ODE clustering: " << pm_om_model.ODE_scheduler->clustering_time() << std::endl;
+    }
     utility::log("") << "Total ALG: " << pm_om_model.total_alg_time.get_elapsed_time() << std::endl;
 }
 
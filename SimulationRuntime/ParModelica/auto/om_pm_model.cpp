@@ -37,8 +37,10 @@
 
 
 #include "om_pm_model.hpp"
+#include "util/simulation_options.h"
 
 #include <cstring>
+#include <map>
 #include <pugixml.hpp>
 
 
@@ -82,10 +84,17 @@ void Equation::execute() {
 
 OMModel::OMModel() :
     INI_scheduler(INI_system),
-    DAE_scheduler(DAE_system),
-    ODE_scheduler(ODE_system)
+    DAE_scheduler(DAE_system)
 {
     intialized = false;
+    ode_profile_saved = false;
+    ode_level_scheduler = NULL;
+    ODE_scheduler = NULL;
+}
+
+OMModel::~OMModel() {
+    for(size_t i = 0; i < ode_schedulers.size(); ++i)
+        delete ode_schedulers[i];
 }
 
 
@@ -99,7 +108,6 @@ void OMModel::initialize(const char* model_name_, void* data_, FunctionType* ode
     data = data_;
     ode_system_funcs = ode_system_;
 
-    load_from_xml(ODE_system, "ode-equations", ode_system_funcs);
     // ODE_system.construct_graph();
     // ODE_scheduler.set_up_executor(ode_system_funcs, data);
     // ODE_scheduler.schedule(4);
@@ -110,6 +118,58 @@ void OMModel::initialize(const char* model_name_, void* data_, FunctionType* ode
 }
 
 
+RuntimeSchedulerBase* OMModel::create_ode_scheduler(int kind) {
+
+    RuntimeSchedulerBase* scheduler = NULL;
+
+    switch(kind) {
+    case PARMODAUTO_SCHEDULER_SERIAL: {
+        SerialSchedulerT* serial = new SerialSchedulerT("serial");
+        load_from_xml(serial->task_system, "ode-equations", ode_system_funcs);
+        scheduler = serial;
+        break;
+    }
+    case PARMODAUTO_SCHEDULER_DYNAMIC: {
+        DynamicSchedulerT* dynamic = new DynamicSchedulerT("dynamic");
+        load_from_xml(dynamic->task_system, "ode-equations", ode_system_funcs);
+        scheduler = dynamic;
+        break;
+    }
+    case PARMODAUTO_SCHEDULER_AUTO: {
+        AutoScheduler* automatic = new AutoScheduler();
+        automatic->add_candidate(create_ode_scheduler(PARMODAUTO_SCHEDULER_LEVEL));
+        automatic->add_candidate(create_ode_scheduler(PARMODAUTO_SCHEDULER_DYNAMIC));
+        automatic->add_candidate(create_ode_scheduler(PARMODAUTO_SCHEDULER_SERIAL));
+        scheduler = automatic;
+        break;
+    }
+    case PARMODAUTO_SCHEDULER_LEVEL:
+    default: {
+        LevelSchedulerT* level = new LevelSchedulerT("level");
+        load_from_xml(level->task_system, "ode-equations", ode_system_funcs);
+        if(load_profile(level->task_system, "ode-equations")) {
+            level->scheduler.set_profiled();
+            ode_profile_saved = true;
+        }
+        ode_level_scheduler = level;
+        scheduler = level;
+        break;
+    }
+    }
+
+    ode_schedulers.push_back(scheduler);
+    return scheduler;
+}
+
+void OMModel::select_ode_scheduler(int kind) {
+
+    if(ODE_scheduler)
+        return;
+
+    ODE_scheduler = create_ode_scheduler(kind);
+}
+
+
 void load_equation(Equation& current_node, pugi::xml_node& xml_equ) {
 
     pugi::xml_node eq_type = xml_equ.first_child();
@@ -282,6 +342,111 @@ void OMModel::load_from_xml(TaskSystemT& task_system, const std::string& eq_to_r
 
 }
 
+bool OMModel::load_profile(TaskSystemT& task_system, const std::string& eq_to_read) {
+
+    typedef TaskSystemT::ClusterType ClusterType;
+
+    std::string profile_file = model_name + "_tasks_profile.xml";
+
+    pugi::xml_document doc;
+    if(!doc.load_file(profile_file.c_str()))
+        return false;
+
+    pugi::xml_node xml_tasks = doc.child("taskprofile").child(eq_to_read.c_str());
+    if(!xml_tasks)
+        return false;
+
+    std::map<long, double> costs;
+    for (pugi::xml_node xml_task = xml_tasks.child("task"); xml_task; xml_task = xml_task.next_sibling("task")) {
+        costs[xml_task.attribute("index").as_int()] = xml_task.attribute("cost").as_double();
+    }
+
+    TaskSystemT::GraphType& sys_graph = task_system.sys_graph;
+    TaskSystemT::vertex_iterator vert_iter, vert_end;
+
+    /*! Check first that every task has a cost. If the model changed since the
+      profile was written we profile again instead of using part of it.*/
+    long task_count = 0;
+    boost::tie(vert_iter, vert_end) = vertices(sys_graph);
+    /*! skip the root node. */
+    ++vert_iter;
+    for ( ; vert_iter != vert_end; ++vert_iter) {
+        ClusterType& curr_clust = sys_graph[*vert_iter];
+        for(ClusterType::iterator t_iter = curr_clust.begin(); t_iter != curr_clust.end(); ++t_iter) {
+            if(costs.find(t_iter->index) == costs.end()) {
+                utility::warning("") << "Ignoring " << profile_file << ": no cost for equation " << t_iter->index << newl;
+                return false;
+            }
+            ++task_count;
+        }
+    }
+
+    if(task_count != (long)costs.size()) {
+        utility::warning("") << "Ignoring " << profile_file << ": task count mismatch" << newl;
+        return false;
+    }
+
+    task_system.total_cost = 0;
+    boost::tie(vert_iter, vert_end) = vertices(sys_graph);
+    ++vert_iter;
+    for ( ; vert_iter != vert_end; ++vert_iter) {
+        ClusterType& curr_clust = sys_graph[*vert_iter];
+        for(ClusterType::iterator t_iter = curr_clust.begin(); t_iter != curr_clust.end(); ++t_iter) {
+            t_iter->cost = costs[t_iter->index];
+        }
+        curr_clust.update_cost();
+        task_system.total_cost += curr_clust.cost;
+    }
+
+    utility::log("") << "Loaded task costs from " << profile_file << newl;
+    return true;
+}
+
+void OMModel::save_profile(TaskSystemT& task_system, const std::string& eq_to_read, int number_of_steps) {
+
+    typedef TaskSystemT::ClusterType ClusterType;
+
+    std::string profile_file = model_name + "_tasks_profile.xml";
+
+    /*! Keep the profiles of the other systems if the file exists already.*/
+    pugi::xml_document doc;
+    doc.load_file(profile_file.c_str());
+
+    pugi::xml_node xml_profile = doc.child("taskprofile");
+    if(!xml_profile)
+        xml_profile = doc.append_child("taskprofile");
+    xml_profile.remove_child(eq_to_read.c_str());
+
+    pugi::xml_node xml_tasks = xml_profile.append_child(eq_to_read.c_str());
+    xml_tasks.append_attribute("steps") = number_of_steps;
+
+    TaskSystemT::GraphType& sys_graph = task_system.sys_graph;
+    TaskSystemT::vertex_iterator vert_iter, vert_end;
+    boost::tie(vert_iter, vert_end) = vertices(sys_graph);
+    /*! skip the root node. */
+    ++vert_iter;
+    for ( ; vert_iter != vert_end; ++vert_iter) {
+        ClusterType& curr_clust = sys_graph[*vert_iter];
+        for(ClusterType::iterator t_iter = curr_clust.begin(); t_iter != curr_clust.end(); ++t_iter) {
+            pugi::xml_node xml_task = xml_tasks.append_child("task");
+            xml_task.append_attribute("index") = (int)t_iter->index;
+            xml_task.append_attribute("cost") = t_iter->cost;
+        }
+    }
+
+    if(!doc.save_file(profile_file.c_str()))
+        utility::warning("") << "Could not write " << profile_file << newl;
+}
+
+void OMModel::save_ode_profile() {
+
+    if(ode_profile_saved || !ode_level_scheduler || !ode_level_scheduler->scheduler.is_profiled())
+        return;
+
+    save_profile(ode_level_scheduler->task_system, "ode-equations", ode_level_scheduler->scheduler.profile_steps);
+    ode_profile_saved = true;
+}
+
 
 } // openmodelica
 } // parmodelica
@@ -47,6 +47,7 @@
 #include "pm_level_scheduler.hpp"
 #include "pm_dynamic_scheduler.hpp"
 
+#include "pm_runtime_scheduler.hpp"
 #include "pm_timer.hpp"
 
 #include "om_pm_equation.hpp"
@@ -95,15 +96,28 @@ class OMModel : boost::noncopyable {
     // typedef ClusterDynamicScheduler<Equation> SchedulerT;
     typedef TaskSystem_v2<Equation> TaskSystemT;
 
+    /*! The schedulers the ODE system can be run with. Picked at runtime
+      with -parmodautoScheduler.*/
+    typedef RuntimeScheduler<StepLevels<Equation> > LevelSchedulerT;
+    typedef RuntimeScheduler<ClusterDynamicScheduler<Equation> > DynamicSchedulerT;
+    typedef RuntimeScheduler<SerialScheduler<Equation> > SerialSchedulerT;
+
 
 
 private:
     std::string model_name;
     bool intialized;
+    bool ode_profile_saved;
     void* data;
 
+    std::vector<RuntimeSchedulerBase*> ode_schedulers;
+    LevelSchedulerT* ode_level_scheduler;
+
+    RuntimeSchedulerBase* create_ode_scheduler(int);
+
 public:
     OMModel();
+    ~OMModel();
     void initialize(const char* , void* , FunctionType*);
 
     FunctionType* ini_system_funcs;
@@ -115,13 +129,21 @@ public:
     SchedulerT DAE_scheduler;
 
     FunctionType* ode_system_funcs;
-    TaskSystemT ODE_system;
-    SchedulerT ODE_scheduler;
+    /*! NULL until select_ode_scheduler is called on the first evaluation,
+      after the simulation flags have been read.*/
+    RuntimeSchedulerBase* ODE_scheduler;
+    void select_ode_scheduler(int);
 
     PMTimer total_alg_time;
     TaskSystemT ALG_system;
 
     void load_from_xml(TaskSystemT&, const std::string&, FunctionType*);
+
+    /*! Measured task costs are kept in <model>_tasks_profile.xml so that a
+      rerun of the same model can be clustered without profiling first.*/
+    bool load_profile(TaskSystemT&, const std::string&);
+    void save_profile(TaskSystemT&, const std::string&, int);
+    void save_ode_profile();
 };
 
 
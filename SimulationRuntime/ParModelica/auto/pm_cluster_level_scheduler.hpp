@@ -105,6 +105,7 @@ private:
     TaskSystemType& task_system;
     bool profiled;
     bool schedule_valid;
+    int profiled_steps;
 
     tbb::task_scheduler_init tbb_system;
     TBBConcurrentStepExecutor<TaskType> step_executor;
@@ -114,6 +115,9 @@ public:
     PMTimer execution_timer;
 	PMTimer clustering_timer;
 
+    /*! Number of steps executed serially and timed before the first clustering.*/
+    int profile_steps;
+
     StepLevels(TaskSystemType& ts) :
       task_system(ts)
       , tbb_system(4)
@@ -121,6 +125,17 @@ public:
     {
         profiled = false;
         schedule_valid = false;
+        profiled_steps = 0;
+        profile_steps = 10;
+    }
+
+    bool is_profiled() const { return profiled; }
+
+    /*! Use the task costs already in the system (e.g. loaded from a previous
+      run) and skip profiling. The clustering is done on the next execute().*/
+    void set_profiled() {
+        profiled = true;
+        schedule_valid = false;
     }
 
     void estimate_speedup() {
@@ -194,6 +209,9 @@ public:
         if(!this->profiled)
             return profile_execute();
 
+        if(!this->schedule_valid)
+            schedule();
+
         execution_timer.start_timer();
 
         // GraphType& sys_graph = task_system.sys_graph;
@@ -243,11 +261,27 @@ public:
         /*! skip the root node. */
         ++vert_iter;
         for ( ; vert_iter != vert_end; ++vert_iter) {
+            if(profiled_steps == 0)
+                sys_graph[*vert_iter].reset_profile();
             sys_graph[*vert_iter].profile_execute();
         }
+        ++profiled_steps;
 
         execution_timer.stop_timer();
 
+        if(profiled_steps < profile_steps)
+            return;
+
+        /*! Average the accumulated times. A single step is too noisy to
+          balance the levels on.*/
+        task_system.total_cost = 0;
+        boost::tie(vert_iter, vert_end) = vertices(sys_graph);
+        ++vert_iter;
+        for ( ; vert_iter != vert_end; ++vert_iter) {
+            sys_graph[*vert_iter].average_profile(profiled_steps);
+            task_system.total_cost += sys_graph[*vert_iter].cost;
+        }
+
         this->profiled = true;
         this->schedule_valid = false;
         schedule();
@@ -134,9 +134,28 @@ public:
         }
     }
 
-    void profile_execute()
+    void update_cost()
     {
         this->cost = 0;
+        iterator t_iter;
+        for(t_iter = this->begin(); t_iter != this->end(); ++t_iter) {
+            cost += t_iter->cost;
+        }
+    }
+
+    void reset_profile()
+    {
+        iterator t_iter;
+        for(t_iter = this->begin(); t_iter != this->end(); ++t_iter) {
+            t_iter->cost = 0;
+        }
+        this->cost = 0;
+    }
+
+    /*! Executes the tasks one by one and adds the time each one took to its
+      cost. Costs accumulate over calls until average_profile is called.*/
+    void profile_execute()
+    {
         double elapsed = 0;
         PMTimer task_timer;
 
@@ -146,17 +165,25 @@ public:
             t_iter->execute();
             task_timer.stop_timer();
             elapsed = task_timer.get_elapsed_time();
-            if(elapsed == 0)
-                t_iter->cost = 0.0005;
-            else
-                t_iter->cost = elapsed * 10000;
+            t_iter->cost += elapsed * 10000;
 
-            cost += t_iter->cost;
+            cost += elapsed * 10000;
 
             task_timer.reset_timer();
         }
     }
 
+    void average_profile(int number_of_steps)
+    {
+        iterator t_iter;
+        for(t_iter = this->begin(); t_iter != this->end(); ++t_iter) {
+            t_iter->cost /= number_of_steps;
+            if(t_iter->cost == 0)
+                t_iter->cost = 0.0005;
+        }
+        update_cost();
+    }
+
 
     static bool
     cost_comparator(const TaskCluster<TaskType>& lhs,
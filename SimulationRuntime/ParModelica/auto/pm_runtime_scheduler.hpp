@@ -0,0 +1,242 @@
+#pragma once
+#ifndef id2892EBE9_2A43_4954_B437AD390FDFD550
+#define id2892EBE9_2A43_4954_B437AD390FDFD550
+
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Linköping University,
+ * Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3
+ * AND THIS OSMC PUBLIC LICENSE (OSMC-PL).
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES RECIPIENT'S
+ * ACCEPTANCE OF THE OSMC PUBLIC LICENSE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from Linköping University, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS
+ * OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+
+
+
+#include <string>
+#include <vector>
+
+#include "pm_cluster_level_scheduler.hpp"
+#include "pm_cluster_dynamic_scheduler.hpp"
+
+
+namespace openmodelica {
+namespace parmodelica {
+
+
+/*! Runs the clusters one after the other in the order the equations
+  were added, i.e. the sorted order from the compiler. This is the baseline
+  for models too small to gain anything from the parallel schedulers.*/
+template<typename TaskType>
+class SerialScheduler : boost::noncopyable {
+public:
+    typedef TaskSystem_v2<TaskType> TaskSystemType;
+    typedef typename TaskSystemType::GraphType GraphType;
+
+private:
+    TaskSystemType& task_system;
+
+public:
+    PMTimer execution_timer;
+    PMTimer clustering_timer;
+
+    SerialScheduler(TaskSystemType& ts) :
+      task_system(ts)
+    {}
+
+    void execute()
+    {
+        execution_timer.start_timer();
+
+        GraphType& sys_graph = task_system.sys_graph;
+
+        typename GraphType::vertex_iterator vert_iter, vert_end;
+        boost::tie(vert_iter, vert_end) = vertices(sys_graph);
+        /*! skip the root node. */
+        ++vert_iter;
+        for ( ; vert_iter != vert_end; ++vert_iter) {
+            sys_graph[*vert_iter].execute();
+        }
+
+        execution_timer.stop_timer();
+    }
+};
+
+
+/*! Common interface of the schedulers so that one can be picked at runtime.*/
+class RuntimeSchedulerBase : boost::noncopyable {
+public:
+    virtual ~RuntimeSchedulerBase() {}
+
+    virtual const char* name() const = 0;
+    virtual void execute() = 0;
+
+    /*! False while the scheduler still runs set-up steps (e.g. profiling)
+      which should not be counted when comparing schedulers.*/
+    virtual bool is_ready() const { return true; }
+
+    virtual double execution_time() = 0;
+    virtual double clustering_time() = 0;
+};
+
+
+template<typename SchedulerT>
+bool scheduler_is_ready(const SchedulerT&) {
+    return true;
+}
+
+template<typename T, typename C1, typename C2, typename C3, typename C4, typename C5>
+bool scheduler_is_ready(const StepLevels<T, C1, C2, C3, C4, C5>& scheduler) {
+    return scheduler.is_profiled();
+}
+
+
+/*! Owns a task system together with the scheduler working on it. Each
+  scheduler clusters the graph in its own way so they can not share one.*/
+template<typename SchedulerT>
+class RuntimeScheduler : public RuntimeSchedulerBase {
+public:
+    typedef typename SchedulerT::TaskSystemType TaskSystemType;
+
+private:
+    std::string scheduler_name;
+
+public:
+    TaskSystemType task_system;
+    SchedulerT scheduler;
+
+    RuntimeScheduler(const std::string& name_) :
+      scheduler_name(name_)
+      , scheduler(task_system)
+    {}
+
+    const char* name() const { return scheduler_name.c_str(); }
+    void execute() { scheduler.execute(); }
+    bool is_ready() const { return scheduler_is_ready(scheduler); }
+
+    double execution_time() { return scheduler.execution_timer.get_elapsed_time(); }
+    double clustering_time() { return scheduler.clustering_timer.get_elapsed_time(); }
+};
+
+
+/*! Times each of the candidate schedulers over a few steps of the actual
+  simulation and keeps the fastest one. Every call is executed by exactly one
+  candidate, so the results do not depend on where the calibration stands.*/
+class AutoScheduler : public RuntimeSchedulerBase {
+
+    std::vector<RuntimeSchedulerBase*> candidates;
+    std::vector<double> step_times;
+    RuntimeSchedulerBase* chosen;
+
+    size_t current;
+    int timed_steps;
+    bool warmed_up;
+    PMTimer window_timer;
+
+public:
+    /*! Number of steps each candidate is timed over.*/
+    int calibration_steps;
+
+    AutoScheduler() :
+      chosen(NULL)
+      , current(0)
+      , timed_steps(0)
+      , warmed_up(false)
+      , calibration_steps(20)
+    {}
+
+    void add_candidate(RuntimeSchedulerBase* candidate) {
+        candidates.push_back(candidate);
+        step_times.push_back(0);
+    }
+
+    const char* name() const { return chosen ? chosen->name() : "auto"; }
+
+    void execute() {
+
+        if(chosen)
+            return chosen->execute();
+
+        RuntimeSchedulerBase* candidate = candidates[current];
+
+        /*! The first ready step still pays for thread start up and building the
+          flow graphs. Do not count it.*/
+        if(!candidate->is_ready() || !warmed_up) {
+            warmed_up = candidate->is_ready();
+            return candidate->execute();
+        }
+
+        window_timer.start_timer();
+        candidate->execute();
+        window_timer.stop_timer();
+        ++timed_steps;
+
+        if(timed_steps < calibration_steps)
+            return;
+
+        step_times[current] = window_timer.get_elapsed_time()/timed_steps;
+        utility::log("") << "Scheduler " << candidate->name() << ": " << step_times[current] << " s per step" << newl;
+
+        window_timer.reset_timer();
+        timed_steps = 0;
+        warmed_up = false;
+        ++current;
+
+        if(current < candidates.size())
+            return;
+
+        size_t fastest = 0;
+        for(size_t i = 1; i < candidates.size(); ++i) {
+            if(step_times[i] < step_times[fastest])
+                fastest = i;
+        }
+        chosen = candidates[fastest];
+        utility::log("") << "Using scheduler " << chosen->name() << newl;
+    }
+
+    double execution_time() {
+        double total = 0;
+        for(size_t i = 0; i < candidates.size(); ++i)
+            total += candidates[i]->execution_time();
+        return total;
+    }
+
+    double clustering_time() {
+        double total = 0;
+        for(size_t i = 0; i < candidates.size(); ++i)
+            total += candidates[i]->clustering_time();
+        return total;
+    }
+};
+
+
+
+} // parmodelica
+} // openmodelica
+
+
+
+#endif // header
@@ -81,7 +81,8 @@
 #define cos(v,m) (cos(v))
 
 
-#ifdef __x86_64__
+// The CPU backend shares memory with the host and uses its integer type.
+#if defined(__x86_64__) || defined(OMC_OCL_CPU_KERNEL)
 typedef long  modelica_integer;
 #else
 typedef int  modelica_integer;
@@ -166,6 +167,39 @@ modelica_integer  oclGetNumGroups(modelica_integer dim) {
 #define oclLocalBarrier() barrier(CLK_LOCAL_MEM_FENCE)
 
 
+// Iterations of a parfor loop run by the calling work-item: count iterations
+// from start on, stride apart. On devices neighbouring work-items take
+// neighbouring iterations (coalesced memory access). On the CPU backend
+// each work-item takes one contiguous block so that threads do not share
+// cache lines and the loop can be vectorized.
+void parfor_iterations(modelica_integer loop_start,
+         modelica_integer loop_step,
+         modelica_integer loop_end,
+         modelica_integer* start,
+         modelica_integer* count,
+         modelica_integer* stride)
+{
+    modelica_integer n = 0;
+    modelica_integer id = get_global_id(0);
+    modelica_integer size = get_global_size(0);
+
+    if ((loop_step > 0 && loop_start <= loop_end) || (loop_step < 0 && loop_start >= loop_end))
+        n = (loop_end - loop_start) / loop_step + 1;
+
+#ifdef OMC_OCL_CPU_KERNEL
+    modelica_integer chunk = (n + size - 1) / size;
+    modelica_integer first = id * chunk;
+    *count = first < n ? (n - first < chunk ? n - first : chunk) : 0;
+    *start = loop_start + first * loop_step;
+    *stride = loop_step;
+#else
+    *count = id < n ? (n - id - 1) / size + 1 : 0;
+    *start = loop_start + id * loop_step;
+    *stride = size * loop_step;
+#endif
+}
+
+
 
 inline int in_range_integer(modelica_integer i,
          modelica_integer start,
@@ -67,6 +67,7 @@ void ocl_initialize();
 void ocl_error_check(int operation, cl_int error_code);
 cl_program ocl_build_p_from_src(const char* source, int isfile);
 cl_kernel ocl_create_kernel(cl_program program, const char* kernel_name);
+void ocl_release_kernel(cl_kernel kernel);
 
 
 //executes a kernel
@@ -0,0 +1,780 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Linköping University,
+ * Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3
+ * AND THIS OSMC PUBLIC LICENSE (OSMC-PL).
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES RECIPIENT'S
+ * ACCEPTANCE OF THE OSMC PUBLIC LICENSE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from Linköping University, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS
+ * OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+
+/*
+
+ Native CPU backend for the ParModelica OpenCL runtime.
+ The kernels are compiled with the host C compiler and the
+ work-groups are run by a pool of threads.
+
+ See the header file for more comments.
+
+*/
+
+#include "omc_ocl_cpu.h"
+#include "omc_ocl_cpu_kernel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if !defined(__MINGW32__) && !defined(_MSC_VER)
+#include <dlfcn.h>
+#include <pthread.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+
+int ocl_cpu_backend = 0;
+
+// Defined in the generated code and omc_ocl_util.cpp
+extern const char* omc_ocl_kernels_source;
+extern cl_program omc_ocl_program;
+char* load_source_file(const char* file_name);
+
+int ocl_cpu_backend_requested(){
+    const char* backend = getenv("OMC_OCL_BACKEND");
+    return backend != NULL && strcmp(backend, "cpu") == 0;
+}
+
+
+#if defined(__MINGW32__) || defined(_MSC_VER)
+
+static void ocl_cpu_not_available(){
+    printf("The ParModelica CPU backend is not available on this platform.\n");
+    exit(1);
+}
+
+void ocl_cpu_initialize(){ ocl_cpu_not_available(); }
+cl_program ocl_cpu_build_program(const char* source_file){ ocl_cpu_not_available(); return NULL; }
+cl_kernel ocl_cpu_create_kernel(cl_program program, const char* kernel_name){ ocl_cpu_not_available(); return NULL; }
+void ocl_cpu_release_kernel(cl_kernel kernel){ ocl_cpu_not_available(); }
+void ocl_cpu_set_kernel_arg(cl_kernel kernel, int arg_nr, const void* value, size_t size){ ocl_cpu_not_available(); }
+void ocl_cpu_set_local_kernel_arg(cl_kernel kernel, int arg_nr, size_t size){ ocl_cpu_not_available(); }
+void ocl_cpu_execute_kernel(cl_kernel kernel, int work_dim, const size_t* global_size, const size_t* local_size){ ocl_cpu_not_available(); }
+cl_mem ocl_cpu_alloc(const void* src_data, size_t size){ ocl_cpu_not_available(); return NULL; }
+void ocl_cpu_free(cl_mem buffer){ ocl_cpu_not_available(); }
+void ocl_cpu_clean_up(){}
+
+#else
+
+#define OCL_CPU_MAX_ARGS 128
+// Bytes stored for each (non __local) kernel argument.
+#define OCL_CPU_ARG_SIZE 16
+// Alignment of buffers. Keeps vectorized loads/stores aligned.
+#define OCL_CPU_ALIGNMENT 64
+#define OCL_CPU_FIBER_STACK_SIZE (64*1024)
+// Bounds of the work-group size picked by the runtime if none is given.
+// Groups of at least 16 work-items keep neighbouring elements (cache
+// lines) written by different threads apart.
+#define OCL_CPU_MIN_DEFAULT_GROUP_SIZE 16
+#define OCL_CPU_MAX_DEFAULT_GROUP_SIZE 64
+
+
+struct ocl_cpu_program {
+    void* handle;
+    const omc_ocl_cpu_kernel_info* kernels;
+    void (*set_work_item)(omc_ocl_cpu_work_item*);
+    // Work-items run as fibers if any kernel or parallel function uses barriers.
+    int uses_barriers;
+};
+
+struct ocl_cpu_kernel {
+    ocl_cpu_program* program;
+    const omc_ocl_cpu_kernel_info* info;
+    // Values of the arguments. Aligned for any scalar or pointer argument.
+    union {
+        modelica_real r;
+        modelica_integer i;
+        void* p;
+        unsigned char bytes[OCL_CPU_ARG_SIZE];
+    } values[OCL_CPU_MAX_ARGS];
+    // Size of __local arguments, 0 for all others.
+    size_t local_sizes[OCL_CPU_MAX_ARGS];
+};
+
+struct ocl_cpu_worker {
+    pthread_t thread;
+    // Argument pointers handed to the kernel. __local arguments point
+    // in to this workers local memory.
+    void* args[OCL_CPU_MAX_ARGS];
+    void* local_ptrs[OCL_CPU_MAX_ARGS];
+    char* local_mem;
+    size_t local_mem_size;
+
+    // Fibers for kernels with barriers. One per work-item of a group.
+    ucontext_t scheduler;
+    ucontext_t* fibers;
+    omc_ocl_cpu_work_item* items;
+    char* fiber_done;
+    char* stacks;
+    size_t nr_of_fibers;
+    // Work-items in the current group
+    size_t nr_of_items;
+    size_t current_fiber;
+    size_t fibers_left;
+};
+
+struct ocl_cpu_pool {
+    int nr_of_threads;
+    ocl_cpu_worker* workers;
+    pthread_mutex_t mutex;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned long generation;
+    int busy;
+    int stop;
+
+    // The current launch
+    ocl_cpu_kernel* kernel;
+    omc_ocl_cpu_work_item range;
+    size_t nr_of_groups;
+    size_t chunk;
+    size_t next_group;
+};
+
+static ocl_cpu_pool pool;
+static int pool_started = 0;
+static __thread ocl_cpu_worker* current_worker = NULL;
+
+
+
+static void* ocl_cpu_aligned_alloc(size_t size){
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, OCL_CPU_ALIGNMENT, size ? size : 1)){
+        printf("Error: CPU backend could not allocate %lu bytes\n", (unsigned long)size);
+        exit(1);
+    }
+    return ptr;
+}
+
+cl_mem ocl_cpu_alloc(const void* src_data, size_t size){
+    void* tmp = ocl_cpu_aligned_alloc(size);
+    if (src_data)
+        memcpy(tmp, src_data, size);
+    return (cl_mem)tmp;
+}
+
+void ocl_cpu_free(cl_mem buffer){
+    free((void*)buffer);
+}
+
+
+
+// Replaces comments and string literals with blanks so that the
+// declarations can be searched for without tripping over them.
+static std::string ocl_cpu_strip_comments(const char* src){
+    std::string out(src);
+    size_t i = 0, n = out.size();
+    while (i < n){
+        if (out[i] == '/' && i + 1 < n && out[i+1] == '/'){
+            while (i < n && out[i] != '\n') out[i++] = ' ';
+        }
+        else if (out[i] == '/' && i + 1 < n && out[i+1] == '*'){
+            out[i++] = ' '; out[i++] = ' ';
+            while (i < n && !(out[i] == '*' && i + 1 < n && out[i+1] == '/')){
+                if (out[i] != '\n') out[i] = ' ';
+                i++;
+            }
+            if (i < n){ out[i++] = ' '; out[i++] = ' '; }
+        }
+        else if (out[i] == '"' || out[i] == '\''){
+            char quote = out[i++];
+            while (i < n && out[i] != quote){
+                if (out[i] == '\\' && i + 1 < n) out[i++] = ' ';
+                if (out[i] != '\n') out[i] = ' ';
+                i++;
+            }
+            i++;
+        }
+        else
+            i++;
+    }
+    return out;
+}
+
+static int ocl_cpu_is_ident(char c){
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static std::string ocl_cpu_trim(const std::string& s){
+    size_t b = s.find_first_not_of(" \t\r\n");
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+}
+
+// Returns the position of the next whole word 'word' in src starting at pos.
+static size_t ocl_cpu_find_word(const std::string& src, const char* word, size_t pos){
+    size_t len = strlen(word);
+    while ((pos = src.find(word, pos)) != std::string::npos){
+        if ((pos == 0 || !ocl_cpu_is_ident(src[pos-1])) &&
+            (pos + len >= src.size() || !ocl_cpu_is_ident(src[pos+len])))
+            return pos;
+        pos += len;
+    }
+    return std::string::npos;
+}
+
+struct ocl_cpu_kernel_decl {
+    std::string name;
+    std::vector<std::string> arg_types;
+};
+
+// Collects the name and argument types of every __kernel function in src.
+static void ocl_cpu_parse_kernels(const std::string& src, std::vector<ocl_cpu_kernel_decl>& decls){
+    size_t pos = 0;
+    while ((pos = ocl_cpu_find_word(src, "__kernel", pos)) != std::string::npos){
+        pos += strlen("__kernel");
+        size_t open = src.find('(', pos);
+        if (open == std::string::npos)
+            break;
+
+        // The last identifier before the '(' is the kernel name.
+        std::string head = ocl_cpu_trim(src.substr(pos, open - pos));
+        size_t name_start = head.size();
+        while (name_start > 0 && ocl_cpu_is_ident(head[name_start-1]))
+            name_start--;
+
+        ocl_cpu_kernel_decl decl;
+        decl.name = head.substr(name_start);
+
+        int depth = 1;
+        size_t i = open + 1, arg_start = open + 1;
+        std::vector<std::string> args;
+        for (; i < src.size() && depth > 0; i++){
+            if (src[i] == '(') depth++;
+            else if (src[i] == ')') depth--;
+            if ((src[i] == ',' && depth == 1) || depth == 0){
+                args.push_back(ocl_cpu_trim(src.substr(arg_start, i - arg_start)));
+                arg_start = i + 1;
+            }
+        }
+        pos = i;
+
+        for (size_t a = 0; a < args.size(); a++){
+            const std::string& arg = args[a];
+            if (arg.empty() || arg == "void")
+                continue;
+            // Strip the argument name, keep the type.
+            size_t end = arg.size();
+            while (end > 0 && ocl_cpu_is_ident(arg[end-1]))
+                end--;
+            decl.arg_types.push_back(ocl_cpu_trim(arg.substr(0, end)));
+        }
+
+        if (decl.arg_types.size() > OCL_CPU_MAX_ARGS){
+            printf("Error: kernel %s has more than %d arguments\n", decl.name.c_str(), OCL_CPU_MAX_ARGS);
+            exit(1);
+        }
+        decls.push_back(decl);
+    }
+}
+
+// Writes the entry points the runtime uses to launch the kernels.
+// run_group loops over the work-items of a group. The arguments are
+// loaded once so the compiler can inline the kernel and vectorize it
+// across the work-items.
+static std::string ocl_cpu_entry_points(const std::vector<ocl_cpu_kernel_decl>& decls){
+    std::string out = "\n\n// CPU backend entry points\n";
+    char nr[32];
+
+    for (size_t k = 0; k < decls.size(); k++){
+        const ocl_cpu_kernel_decl& d = decls[k];
+        std::string loads, call_args, item_args;
+
+        for (size_t a = 0; a < d.arg_types.size(); a++){
+            sprintf(nr, "%lu", (unsigned long)a);
+            loads += "    " + d.arg_types[a] + " a" + nr + " = *(" + d.arg_types[a] + "*)args[" + nr + "];\n";
+            call_args += std::string(a ? ", " : "") + "a" + nr;
+            item_args += std::string(a ? ", " : "") + "*(" + d.arg_types[a] + "*)args[" + nr + "]";
+        }
+
+        out += "static void omc_ocl_cpu_group_" + d.name + "(void** args, omc_ocl_cpu_work_item* wi){\n";
+        out += loads;
+        out += "    size_t i0, i1, i2;\n";
+        out += "    omc_ocl_cpu_wi = wi;\n";
+        out += "    for (i2 = 0; i2 < wi->local_size[2]; i2++){\n";
+        out += "      wi->local_id[2] = i2;\n";
+        out += "      for (i1 = 0; i1 < wi->local_size[1]; i1++){\n";
+        out += "        wi->local_id[1] = i1;\n";
+        out += "        for (i0 = 0; i0 < wi->local_size[0]; i0++){\n";
+        out += "          wi->local_id[0] = i0;\n";
+        out += "          " + d.name + "(" + call_args + ");\n";
+        out += "        }\n      }\n    }\n}\n\n";
+
+        out += "static void omc_ocl_cpu_item_" + d.name + "(void** args){\n";
+        out += "    " + d.name + "(" + item_args + ");\n}\n\n";
+    }
+
+    out += "OMC_OCL_CPU_EXPORT omc_ocl_cpu_kernel_info omc_ocl_cpu_kernels[] = {\n";
+    for (size_t k = 0; k < decls.size(); k++){
+        sprintf(nr, "%lu", (unsigned long)decls[k].arg_types.size());
+        out += "    {\"" + decls[k].name + "\", " + nr + ", omc_ocl_cpu_group_" + decls[k].name
+            + ", omc_ocl_cpu_item_" + decls[k].name + "},\n";
+    }
+    out += "    {NULL, 0, NULL, NULL}\n};\n";
+    return out;
+}
+
+cl_program ocl_cpu_build_program(const char* source_file){
+
+    char* source = load_source_file(source_file);
+    std::string stripped = ocl_cpu_strip_comments(source);
+
+    std::vector<ocl_cpu_kernel_decl> decls;
+    ocl_cpu_parse_kernels(stripped, decls);
+
+    ocl_cpu_program* program = new ocl_cpu_program;
+    program->uses_barriers =
+        ocl_cpu_find_word(stripped, "barrier", 0) != std::string::npos ||
+        ocl_cpu_find_word(stripped, "oclLocalBarrier", 0) != std::string::npos ||
+        ocl_cpu_find_word(stripped, "oclGlobalBarrier", 0) != std::string::npos;
+
+    // Check for OpenModelica env variable.
+    const char* OMHOME = getenv("OPENMODELICAHOME");
+    if ( OMHOME == NULL )
+    {
+       printf("Couldn't find OPENMODELICAHOME!\n");
+       exit(1);
+    }
+
+    const char* tmp_root = getenv("TMPDIR");
+    std::string dir = std::string(tmp_root ? tmp_root : "/tmp") + "/omc_ocl_cpu_XXXXXX";
+    if (!mkdtemp(&dir[0])){
+        printf("Error: could not create a directory for building the kernels in %s\n", dir.c_str());
+        exit(1);
+    }
+    std::string c_file = dir + "/kernels.c";
+    std::string so_file = dir + "/kernels.so";
+
+    FILE* f = fopen(c_file.c_str(), "w");
+    if (!f){
+        printf("Error: could not write %s\n", c_file.c_str());
+        exit(1);
+    }
+    fprintf(f, "#include <ParModelica/explicit/openclrt/omc_ocl_cpu_kernel.h>\n");
+    fprintf(f, "#line 1 \"%s\"\n", source_file);
+    fputs(source, f);
+    fputs(ocl_cpu_entry_points(decls).c_str(), f);
+    fclose(f);
+    free(source);
+
+    const char* cc = getenv("OMC_OCL_CPU_CC");
+    const char* cflags = getenv("OMC_OCL_CPU_CFLAGS");
+    std::string command = std::string(cc ? cc : "cc") + " " + (cflags ? cflags : "-O3 -march=native")
+        + " -std=gnu99 -fgnu89-inline -w -fPIC -fvisibility=hidden -shared -DOMC_OCL_CPU_KERNEL"
+        + " -I\"" + OMHOME + "/include/omc/c/\""
+        + " -o \"" + so_file + "\" \"" + c_file + "\" -lm";
+
+#if BE_OCL_VERBOSE
+    printf("--- Building kernels for the CPU backend\n");
+    printf("\t :Using %s\n", command.c_str());
+#endif
+
+    int err = system(command.c_str());
+    if (err){
+        printf("Build failed: Errors detected in compilation of the kernels for the CPU backend.\n");
+        printf("Command: %s\n", command.c_str());
+        exit(1);
+    }
+
+    program->handle = dlopen(so_file.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!program->handle){
+        printf("Error loading the kernels for the CPU backend: %s\n", dlerror());
+        exit(1);
+    }
+    program->kernels = (const omc_ocl_cpu_kernel_info*)dlsym(program->handle, "omc_ocl_cpu_kernels");
+    program->set_work_item = (void (*)(omc_ocl_cpu_work_item*))dlsym(program->handle, "omc_ocl_cpu_set_work_item");
+    if (!program->kernels || !program->set_work_item){
+        printf("Error loading the kernels for the CPU backend: %s\n", dlerror());
+        exit(1);
+    }
+
+    // The library stays mapped after it is removed.
+    remove(so_file.c_str());
+    remove(c_file.c_str());
+    rmdir(dir.c_str());
+
+    return (cl_program)program;
+}
+
+cl_kernel ocl_cpu_create_kernel(cl_program in_program, const char* kernel_name){
+    ocl_cpu_program* program = (ocl_cpu_program*)in_program;
+
+    for (const omc_ocl_cpu_kernel_info* info = program->kernels; info->name; info++){
+        if (strcmp(info->name, kernel_name) == 0){
+            ocl_cpu_kernel* kernel = new ocl_cpu_kernel;
+            memset(kernel, 0, sizeof(ocl_cpu_kernel));
+            kernel->program = program;
+            kernel->info = info;
+            return (cl_kernel)kernel;
+        }
+    }
+
+    printf("Error creating Kernel:\n");
+    printf("CL_INVALID_KERNEL_NAME \n");
+    exit(1);
+    return NULL;
+}
+
+void ocl_cpu_release_kernel(cl_kernel kernel){
+    delete (ocl_cpu_kernel*)kernel;
+}
+
+static void ocl_cpu_check_arg_nr(ocl_cpu_kernel* kernel, int arg_nr){
+    if (arg_nr < 0 || arg_nr >= kernel->info->nr_of_args){
+        printf("Error: setting argument nr:  %d. Kernel %s takes %d arguments\n",
+            arg_nr + 1, kernel->info->name, kernel->info->nr_of_args);
+        exit(1);
+    }
+}
+
+void ocl_cpu_set_kernel_arg(cl_kernel in_kernel, int arg_nr, const void* value, size_t size){
+    ocl_cpu_kernel* kernel = (ocl_cpu_kernel*)in_kernel;
+    ocl_cpu_check_arg_nr(kernel, arg_nr);
+    if (size > OCL_CPU_ARG_SIZE){
+        printf("Error: setting argument nr:  %d. Argument too large\n", arg_nr + 1);
+        exit(1);
+    }
+    memcpy(kernel->values[arg_nr].bytes, value, size);
+    kernel->local_sizes[arg_nr] = 0;
+}
+
+void ocl_cpu_set_local_kernel_arg(cl_kernel in_kernel, int arg_nr, size_t size){
+    ocl_cpu_kernel* kernel = (ocl_cpu_kernel*)in_kernel;
+    ocl_cpu_check_arg_nr(kernel, arg_nr);
+    // Never 0 so that it can be told apart from the other arguments
+    kernel->local_sizes[arg_nr] = size ? size : 1;
+}
+
+
+
+// Points the workers argument list to the kernel arguments and
+// hands out its local memory to the __local arguments.
+static void ocl_cpu_prepare_args(ocl_cpu_worker* w, ocl_cpu_kernel* kernel){
+    size_t total = 0;
+    int nr_of_args = kernel->info->nr_of_args;
+
+    for (int i = 0; i < nr_of_args; i++)
+        if (kernel->local_sizes[i])
+            total += (kernel->local_sizes[i] + OCL_CPU_ALIGNMENT - 1) / OCL_CPU_ALIGNMENT * OCL_CPU_ALIGNMENT;
+
+    if (total > w->local_mem_size){
+        free(w->local_mem);
+        w->local_mem = (char*)ocl_cpu_aligned_alloc(total);
+        w->local_mem_size = total;
+    }
+
+    size_t offset = 0;
+    for (int i = 0; i < nr_of_args; i++){
+        if (kernel->local_sizes[i]){
+            w->local_ptrs[i] = w->local_mem + offset;
+            w->args[i] = &w->local_ptrs[i];
+            offset += (kernel->local_sizes[i] + OCL_CPU_ALIGNMENT - 1) / OCL_CPU_ALIGNMENT * OCL_CPU_ALIGNMENT;
+        }
+        else
+            w->args[i] = kernel->values[i].bytes;
+    }
+}
+
+static void ocl_cpu_no_barrier(){
+    printf("Error: barrier reached in a kernel running without barrier support on the CPU backend\n");
+    exit(1);
+}
+
+// Suspends the current work-item and switches to the next one that has
+// not reached the barrier yet. The last one returns to the group scheduler.
+static void ocl_cpu_barrier(){
+    ocl_cpu_worker* w = current_worker;
+    size_t f = w->current_fiber;
+    size_t next = f + 1;
+
+    while (next < w->nr_of_items && w->fiber_done[next])
+        next++;
+
+    if (next < w->nr_of_items){
+        w->current_fiber = next;
+        pool.kernel->program->set_work_item(&w->items[next]);
+        swapcontext(&w->fibers[f], &w->fibers[next]);
+    }
+    else
+        swapcontext(&w->fibers[f], &w->scheduler);
+}
+
+static void ocl_cpu_fiber_main(){
+    ocl_cpu_worker* w = current_worker;
+    pool.kernel->info->run_item(w->args);
+    w->fiber_done[w->current_fiber] = 1;
+    w->fibers_left--;
+    // returns to w->scheduler through uc_link
+}
+
+// Runs the work-items of a group as fibers. They run one after the other
+// up to the next barrier (see ocl_cpu_barrier) and then come back here.
+// This is repeated until all of them are done.
+static void ocl_cpu_run_group_fibers(ocl_cpu_worker* w, const omc_ocl_cpu_work_item* group){
+    size_t n = group->local_size[0] * group->local_size[1] * group->local_size[2];
+
+    if (n > w->nr_of_fibers){
+        free(w->fibers); free(w->items); free(w->fiber_done); free(w->stacks);
+        w->fibers = (ucontext_t*)malloc(n * sizeof(ucontext_t));
+        w->items = (omc_ocl_cpu_work_item*)malloc(n * sizeof(omc_ocl_cpu_work_item));
+        w->fiber_done = (char*)malloc(n);
+        w->stacks = (char*)ocl_cpu_aligned_alloc(n * OCL_CPU_FIBER_STACK_SIZE);
+        // getcontext is a system call. Only needed once, the contexts are reused.
+        for (size_t f = 0; f < n; f++)
+            getcontext(&w->fibers[f]);
+        w->nr_of_fibers = n;
+    }
+
+    for (size_t f = 0; f < n; f++){
+        w->items[f] = *group;
+        w->items[f].local_id[0] = f % group->local_size[0];
+        w->items[f].local_id[1] = (f / group->local_size[0]) % group->local_size[1];
+        w->items[f].local_id[2] = f / (group->local_size[0] * group->local_size[1]);
+        w->fiber_done[f] = 0;
+
+        w->fibers[f].uc_stack.ss_sp = w->stacks + f * OCL_CPU_FIBER_STACK_SIZE;
+        w->fibers[f].uc_stack.ss_size = OCL_CPU_FIBER_STACK_SIZE;
+        w->fibers[f].uc_link = &w->scheduler;
+        makecontext(&w->fibers[f], ocl_cpu_fiber_main, 0);
+    }
+
+    w->nr_of_items = n;
+    w->fibers_left = n;
+    size_t f = 0;
+    while (w->fibers_left){
+        while (f < n && w->fiber_done[f])
+            f++;
+        if (f == n){
+            f = 0;
+            continue;
+        }
+        w->current_fiber = f;
+        pool.kernel->program->set_work_item(&w->items[f]);
+        swapcontext(&w->scheduler, &w->fibers[f]);
+        // Back from the last work-item of this round or from one that finished.
+        f = w->current_fiber + 1;
+    }
+}
+
+// Takes chunks of work-groups of the current launch until none are left.
+static void ocl_cpu_run_groups(ocl_cpu_worker* w){
+    ocl_cpu_kernel* kernel = pool.kernel;
+    omc_ocl_cpu_work_item wi = pool.range;
+    size_t nr_of_groups = pool.nr_of_groups;
+
+    current_worker = w;
+    ocl_cpu_prepare_args(w, kernel);
+    wi.barrier = kernel->program->uses_barriers ? ocl_cpu_barrier : ocl_cpu_no_barrier;
+
+    for (;;){
+        size_t first = __sync_fetch_and_add(&pool.next_group, pool.chunk);
+        if (first >= nr_of_groups)
+            break;
+        size_t last = first + pool.chunk < nr_of_groups ? first + pool.chunk : nr_of_groups;
+
+        for (size_t g = first; g < last; g++){
+            wi.group_id[0] = g % wi.num_groups[0];
+            wi.group_id[1] = (g / wi.num_groups[0]) % wi.num_groups[1];
+            wi.group_id[2] = g / (wi.num_groups[0] * wi.num_groups[1]);
+
+            if (kernel->program->uses_barriers)
+                ocl_cpu_run_group_fibers(w, &wi);
+            else
+                kernel->info->run_group(w->args, &wi);
+        }
+    }
+}
+
+static void* ocl_cpu_worker_main(void* arg){
+    ocl_cpu_worker* w = (ocl_cpu_worker*)arg;
+    unsigned long seen = 0;
+
+    for (;;){
+        pthread_mutex_lock(&pool.mutex);
+        while (pool.generation == seen && !pool.stop)
+            pthread_cond_wait(&pool.start, &pool.mutex);
+        if (pool.stop){
+            pthread_mutex_unlock(&pool.mutex);
+            break;
+        }
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.mutex);
+
+        ocl_cpu_run_groups(w);
+
+        pthread_mutex_lock(&pool.mutex);
+        if (--pool.busy == 0)
+            pthread_cond_signal(&pool.done);
+        pthread_mutex_unlock(&pool.mutex);
+    }
+    return NULL;
+}
+
+void ocl_cpu_execute_kernel(cl_kernel in_kernel, int work_dim, const size_t* global_size, const size_t* local_size){
+    ocl_cpu_kernel* kernel = (ocl_cpu_kernel*)in_kernel;
+    omc_ocl_cpu_work_item range;
+    memset(&range, 0, sizeof(range));
+    range.work_dim = work_dim;
+
+    for (int d = 0; d < 3; d++){
+        range.global_size[d] = d < work_dim ? global_size[d] : 1;
+        if (d >= work_dim)
+            range.local_size[d] = 1;
+        else if (local_size)
+            range.local_size[d] = local_size[d];
+        else if (d == 0){
+            // Aim for two groups per thread. The group size has to divide the global size.
+            size_t l = range.global_size[0] / (2 * pool.nr_of_threads);
+            l = l < OCL_CPU_MIN_DEFAULT_GROUP_SIZE ? OCL_CPU_MIN_DEFAULT_GROUP_SIZE : l;
+            l = l > OCL_CPU_MAX_DEFAULT_GROUP_SIZE ? OCL_CPU_MAX_DEFAULT_GROUP_SIZE : l;
+            while (range.global_size[0] % l)
+                l--;
+            range.local_size[0] = l;
+        }
+        else
+            range.local_size[d] = 1;
+
+        if (range.local_size[d] == 0 || range.global_size[d] % range.local_size[d]){
+            printf("Error: Enqueueing ND range kernel:\n");
+            printf("CL_INVALID_WORK_GROUP_SIZE \n");
+            exit(1);
+        }
+        range.num_groups[d] = range.global_size[d] / range.local_size[d];
+    }
+
+    if (range.local_size[0] * range.local_size[1] * range.local_size[2] > OCL_CPU_MAX_WORK_GROUP_SIZE){
+        printf("Error: Enqueueing ND range kernel:\n");
+        printf("CL_INVALID_WORK_GROUP_SIZE \n");
+        exit(1);
+    }
+
+    size_t nr_of_groups = range.num_groups[0] * range.num_groups[1] * range.num_groups[2];
+    if (nr_of_groups == 0)
+        return;
+
+    pool.kernel = kernel;
+    pool.range = range;
+    pool.nr_of_groups = nr_of_groups;
+    pool.next_group = 0;
+    // A few chunks per thread so that uneven groups still balance.
+    pool.chunk = nr_of_groups / (4 * pool.nr_of_threads);
+    if (pool.chunk == 0)
+        pool.chunk = 1;
+
+    if (nr_of_groups == 1 || pool.nr_of_threads == 1){
+        ocl_cpu_run_groups(&pool.workers[0]);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.mutex);
+    pool.busy = pool.nr_of_threads - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.mutex);
+
+    // The calling thread is worker 0.
+    ocl_cpu_run_groups(&pool.workers[0]);
+
+    pthread_mutex_lock(&pool.mutex);
+    while (pool.busy)
+        pthread_cond_wait(&pool.done, &pool.mutex);
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+void ocl_cpu_initialize(){
+
+    if (pool_started)
+        return;
+
+    int nr_of_threads = 0;
+    const char* threads = getenv("OMC_OCL_CPU_THREADS");
+    if (threads)
+        nr_of_threads = atoi(threads);
+    if (nr_of_threads <= 0)
+        nr_of_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nr_of_threads <= 0)
+        nr_of_threads = 1;
+
+    printf("- Running ParModelica kernels on the CPU backend with %d threads.\n", nr_of_threads);
+    fflush(stdout);
+
+    pool.nr_of_threads = nr_of_threads;
+    pool.workers = (ocl_cpu_worker*)calloc(nr_of_threads, sizeof(ocl_cpu_worker));
+    pool.generation = 0;
+    pool.busy = 0;
+    pool.stop = 0;
+    pthread_mutex_init(&pool.mutex, NULL);
+    pthread_cond_init(&pool.start, NULL);
+    pthread_cond_init(&pool.done, NULL);
+
+    for (int i = 1; i < nr_of_threads; i++){
+        if (pthread_create(&pool.workers[i].thread, NULL, ocl_cpu_worker_main, &pool.workers[i])){
+            printf("Error: could not start the CPU backend threads\n");
+            exit(1);
+        }
+    }
+    pool_started = 1;
+    ocl_cpu_backend = 1;
+
+    omc_ocl_program = ocl_cpu_build_program(omc_ocl_kernels_source);
+}
+
+void ocl_cpu_clean_up(){
+
+    if (!pool_started)
+        return;
+
+    pthread_mutex_lock(&pool.mutex);
+    pool.stop = 1;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.mutex);
+
+    for (int i = 1; i < pool.nr_of_threads; i++)
+        pthread_join(pool.workers[i].thread, NULL);
+
+    for (int i = 0; i < pool.nr_of_threads; i++){
+        ocl_cpu_worker* w = &pool.workers[i];
+        free(w->local_mem);
+        free(w->fibers); free(w->items); free(w->fiber_done); free(w->stacks);
+    }
+    free(pool.workers);
+    pthread_mutex_destroy(&pool.mutex);
+    pthread_cond_destroy(&pool.start);
+    pthread_cond_destroy(&pool.done);
+    pool_started = 0;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Linköping University,
+ * Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3
+ * AND THIS OSMC PUBLIC LICENSE (OSMC-PL).
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES RECIPIENT'S
+ * ACCEPTANCE OF THE OSMC PUBLIC LICENSE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from Linköping University, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS
+ * OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+
+/*
+
+ Native CPU backend for the ParModelica OpenCL runtime.
+
+ Used instead of an OpenCL device when OMC_OCL_BACKEND=cpu is set
+ in the environment or when no OpenCL platform is available.
+   - Device buffers are plain host memory. A cl_mem handle is the
+     pointer to the memory itself.
+   - The kernels file is compiled with the host C compiler into a
+     shared library (see omc_ocl_cpu_kernel.h) and loaded at runtime.
+   - Work-groups are distributed over a pool of threads. The work-items
+     of a group run one after the other on the thread that owns the group.
+     If the program uses barriers they run as fibers and switch at each
+     barrier instead.
+   - __local kernel arguments get one buffer per thread, i.e. one per
+     work-group in flight.
+
+ Environment variables:
+   OMC_OCL_BACKEND     'cpu' or 'opencl'. Default is OpenCL if available.
+   OMC_OCL_CPU_THREADS number of threads. Default is the number of cores.
+   OMC_OCL_CPU_CC      C compiler used for the kernels. Default 'cc'.
+   OMC_OCL_CPU_CFLAGS  flags for compiling the kernels. Default '-O3 -march=native'.
+
+*/
+
+
+#ifndef _OMC_OCL_CPU_H
+#define _OMC_OCL_CPU_H
+
+#include "omc_ocl_common_header.h"
+
+
+// Largest work-group size on the CPU backend. Also the default
+// number of threads, like CL_DEVICE_MAX_WORK_GROUP_SIZE for devices.
+#define OCL_CPU_MAX_WORK_GROUP_SIZE 1024
+
+// Set when the CPU backend is in use.
+extern int ocl_cpu_backend;
+
+// Returns 1 if the CPU backend was requested with OMC_OCL_BACKEND=cpu
+int ocl_cpu_backend_requested();
+
+// Starts the thread pool and builds the kernels file
+// (omc_ocl_kernels_source) into the global program omc_ocl_program.
+void ocl_cpu_initialize();
+
+// Compiles and loads a kernels file.
+cl_program ocl_cpu_build_program(const char* source_file);
+
+cl_kernel ocl_cpu_create_kernel(cl_program program, const char* kernel_name);
+
+void ocl_cpu_release_kernel(cl_kernel kernel);
+
+// Sets argument arg_nr to a copy of the size bytes at value.
+void ocl_cpu_set_kernel_arg(cl_kernel kernel, int arg_nr, const void* value, size_t size);
+
+// Sets argument arg_nr to a __local buffer of size bytes.
+void ocl_cpu_set_local_kernel_arg(cl_kernel kernel, int arg_nr, size_t size);
+
+// Runs a kernel over the given range. local_size can be NULL in
+// which case the runtime picks the work-group size.
+void ocl_cpu_execute_kernel(cl_kernel kernel, int work_dim, const size_t* global_size, const size_t* local_size);
+
+// Allocates a buffer and initializes it from src_data IF src_data is not NULL.
+cl_mem ocl_cpu_alloc(const void* src_data, size_t size);
+
+void ocl_cpu_free(cl_mem buffer);
+
+// Stops the thread pool
+void ocl_cpu_clean_up();
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Linköping University,
+ * Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3
+ * AND THIS OSMC PUBLIC LICENSE (OSMC-PL).
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES RECIPIENT'S
+ * ACCEPTANCE OF THE OSMC PUBLIC LICENSE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from Linköping University, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS
+ * OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+
+/*
+
+ Header for running ParModelica kernels on the native CPU backend.
+
+ The generated <model>_kernels.cl file is compiled with the host C
+ compiler (with OMC_OCL_CPU_KERNEL defined) when no OpenCL device is
+ used. This header is included before the kernel source. It maps the
+ OpenCL C address space qualifiers and the work-item functions to
+ plain C so that the same kernel source, including OCLRuntimeUtil.cl,
+ compiles unchanged.
+
+ The omc_ocl_cpu_work_item struct is shared with the runtime
+ (omc_ocl_cpu.cpp) which fills it in for every work-item it runs.
+
+*/
+
+
+#ifndef _OMC_OCL_CPU_KERNEL_H
+#define _OMC_OCL_CPU_KERNEL_H
+
+#include <stddef.h>
+
+// Work-item state of the calling thread. Ids are zero based like in OpenCL.
+typedef struct omc_ocl_cpu_work_item {
+    unsigned int work_dim;
+    size_t global_size[3];
+    size_t local_size[3];
+    size_t num_groups[3];
+    size_t group_id[3];
+    size_t local_id[3];
+    // Suspends the work-item until all work-items of its group
+    // have reached the barrier.
+    void (*barrier)(void);
+} omc_ocl_cpu_work_item;
+
+// Runs a kernel for all work-items of the group in *wi.
+// args[i] points to the value of argument i.
+typedef void (*omc_ocl_cpu_group_func)(void** args, omc_ocl_cpu_work_item* wi);
+
+// Runs a kernel once, for the current work-item only.
+typedef void (*omc_ocl_cpu_item_func)(void** args);
+
+// One entry per __kernel function in the program. The table
+// (omc_ocl_cpu_kernels) is terminated by an entry with name NULL.
+typedef struct omc_ocl_cpu_kernel_info {
+    const char* name;
+    int nr_of_args;
+    omc_ocl_cpu_group_func run_group;
+    omc_ocl_cpu_item_func run_item;
+} omc_ocl_cpu_kernel_info;
+
+
+#ifdef OMC_OCL_CPU_KERNEL
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+
+// OpenCL C address space and function qualifiers.
+#define __kernel
+#define __global
+#define __local
+#define __private
+#define __constant const
+#define global
+#define local
+
+// Let OCLRuntimeUtil.cl pick double precision reals.
+#define cl_khr_fp64 1
+
+#define CLK_LOCAL_MEM_FENCE  1
+#define CLK_GLOBAL_MEM_FENCE 2
+
+#define min(a,b) ((a) < (b) ? (a) : (b))
+#define max(a,b) ((a) > (b) ? (a) : (b))
+
+// Initial-exec TLS keeps the work-item lookups in the kernels cheap.
+static __thread omc_ocl_cpu_work_item* omc_ocl_cpu_wi __attribute__((tls_model("initial-exec")));
+
+// The kernels are built with hidden visibility so that the compiler is
+// free to inline them. Only the entry points are exported.
+#define OMC_OCL_CPU_EXPORT __attribute__((visibility("default")))
+
+OMC_OCL_CPU_EXPORT void omc_ocl_cpu_set_work_item(omc_ocl_cpu_work_item* wi) {
+    omc_ocl_cpu_wi = wi;
+}
+
+static inline unsigned int get_work_dim() {
+    return omc_ocl_cpu_wi->work_dim;
+}
+
+static inline size_t get_global_size(unsigned int d) {
+    return d < 3 ? omc_ocl_cpu_wi->global_size[d] : 1;
+}
+
+static inline size_t get_local_size(unsigned int d) {
+    return d < 3 ? omc_ocl_cpu_wi->local_size[d] : 1;
+}
+
+static inline size_t get_num_groups(unsigned int d) {
+    return d < 3 ? omc_ocl_cpu_wi->num_groups[d] : 1;
+}
+
+static inline size_t get_group_id(unsigned int d) {
+    return d < 3 ? omc_ocl_cpu_wi->group_id[d] : 0;
+}
+
+static inline size_t get_local_id(unsigned int d) {
+    return d < 3 ? omc_ocl_cpu_wi->local_id[d] : 0;
+}
+
+static inline size_t get_global_id(unsigned int d) {
+    return d < 3 ? omc_ocl_cpu_wi->group_id[d]*omc_ocl_cpu_wi->local_size[d] + omc_ocl_cpu_wi->local_id[d] : 0;
+}
+
+static inline void barrier(int flags) {
+    (void)flags;
+    omc_ocl_cpu_wi->barrier();
+}
+
+#endif // OMC_OCL_CPU_KERNEL
+
+#endif
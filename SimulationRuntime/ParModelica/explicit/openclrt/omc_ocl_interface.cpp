@@ -50,6 +50,7 @@
 
 
 #include <omc_ocl_interface.h>
+#include "omc_ocl_cpu.h"
 
 
 size_t modelica_array_nr_of_elements(base_array_t *a){
@@ -202,6 +203,12 @@ void alloc_device_local_real_array(device_local_real_array *dest, int ndims, ...
 
 void free_device_array(device_array* dest){
     cl_int err;
+    if (ocl_cpu_backend){
+        ocl_cpu_free(dest->data);
+        ocl_cpu_free(dest->info_dev);
+        free(dest->info);
+        return;
+    }
     err = clReleaseMemObject(dest->data);
     ocl_error_check(OCL_REALEASE_MEM_OBJECT, err);
     err = clReleaseMemObject(dest->info_dev);
@@ -300,8 +307,14 @@ void copy_integer_array_data(device_integer_array dev_array1, device_integer_arr
 //function returns(not dynamic allocation), So the only lose in serial case is visible just until
 //the function returns.
 void swap_and_release(device_array* lhs, device_array* rhs){
-    clReleaseMemObject(lhs->data);
-    clReleaseMemObject(lhs->info_dev);
+    if (ocl_cpu_backend){
+        ocl_cpu_free(lhs->data);
+        ocl_cpu_free(lhs->info_dev);
+    }
+    else {
+        clReleaseMemObject(lhs->data);
+        clReleaseMemObject(lhs->info_dev);
+    }
     free(lhs->info);
     lhs->data = rhs->data;
     lhs->info_dev = rhs->info_dev;
@@ -45,6 +45,8 @@
 
 
 #include <omc_ocl_memory_ops.h>
+#include "omc_ocl_cpu.h"
+#include <string.h>
 
 
 
@@ -53,9 +55,12 @@ cl_mem ocl_device_alloc(size_t size){
     cl_int err;
     cl_mem tmp = NULL;
 
-    if (!device_comm_queue)
+    if (!device_comm_queue && !ocl_cpu_backend)
         ocl_initialize();
 
+    if (ocl_cpu_backend)
+        return ocl_cpu_alloc(NULL, size);
+
     tmp = clCreateBuffer(device_context, CL_MEM_READ_WRITE,
             size, NULL, &err);
 
@@ -68,9 +73,12 @@ cl_mem ocl_device_alloc_init(modelica_integer* host_array, size_t size){
     cl_int err;
     cl_mem tmp = NULL;
 
-    if (!device_comm_queue)
+    if (!device_comm_queue && !ocl_cpu_backend)
         ocl_initialize();
 
+    if (ocl_cpu_backend)
+        return host_array ? ocl_cpu_alloc(host_array, size) : NULL;
+
     if (host_array)
         tmp = clCreateBuffer(device_context, CL_MEM_READ_WRITE |
             CL_MEM_COPY_HOST_PTR, size, host_array, &err);
@@ -86,9 +94,12 @@ cl_mem ocl_device_alloc_init(modelica_real* host_array, size_t size){
     cl_int err;
     cl_mem tmp = NULL;
 
-    if (!device_comm_queue)
+    if (!device_comm_queue && !ocl_cpu_backend)
         ocl_initialize();
 
+    if (ocl_cpu_backend)
+        return host_array ? ocl_cpu_alloc(host_array, size) : NULL;
+
     if (host_array)
         tmp = clCreateBuffer(device_context, CL_MEM_READ_WRITE |
             CL_MEM_COPY_HOST_PTR, size, host_array, &err);
@@ -104,9 +115,12 @@ cl_mem ocl_alloc_init(void* src_data, size_t size){
     cl_int err;
     cl_mem tmp = NULL;
 
-    if (!device_comm_queue)
+    if (!device_comm_queue && !ocl_cpu_backend)
         ocl_initialize();
 
+    if (ocl_cpu_backend)
+        return ocl_cpu_alloc(src_data, size);
+
     if (src_data)
         tmp = clCreateBuffer(device_context, CL_MEM_READ_WRITE |
             CL_MEM_COPY_HOST_PTR, size, src_data, &err);
@@ -130,6 +144,13 @@ void ocl_create_execution_memory_buffer(device_buffer* d_buff){
     cl_mem tmp;
     cl_ulong size;
 
+    if (ocl_cpu_backend){
+        size = 30 * 1024 * 1024 * sizeof(modelica_integer);
+        d_buff->buffer = ocl_cpu_alloc(NULL, size);
+        d_buff->size = size;
+        return;
+    }
+
     clGetDeviceInfo(ocl_device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &mem, NULL);
     clGetDeviceInfo(ocl_device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(cl_ulong), &mem2, NULL);
     size = mem/OCL_BUFFER_SIZE_FRACTION;
@@ -153,9 +174,12 @@ void ocl_create_execution_memory_buffer(device_buffer* d_buff){
 cl_mem ocl_alloc_init_real_arr(modelica_real* host_array, int a_size){
     cl_int err;
     cl_mem tmp;
-    if (!device_comm_queue)
+    if (!device_comm_queue && !ocl_cpu_backend)
         ocl_initialize();
 
+    if (ocl_cpu_backend)
+        return ocl_cpu_alloc(host_array, sizeof(modelica_real) * a_size);
+
     if (host_array)
         tmp = clCreateBuffer(device_context, CL_MEM_READ_WRITE |
             CL_MEM_COPY_HOST_PTR, sizeof(modelica_real) * a_size, host_array, &err);
@@ -172,9 +196,12 @@ cl_mem ocl_alloc_init_real_arr(modelica_real* host_array, int a_size){
 
 cl_mem ocl_alloc_init_integer_arr(cl_int* host_array, int a_size){
     cl_int err;
-    if (!device_comm_queue)
+    if (!device_comm_queue && !ocl_cpu_backend)
         ocl_initialize();
 
+    if (ocl_cpu_backend)
+        return ocl_cpu_alloc(host_array, sizeof(modelica_integer) * a_size);
+
     if (host_array)
         return clCreateBuffer(device_context, CL_MEM_READ_WRITE |
             CL_MEM_COPY_HOST_PTR, sizeof(modelica_integer) * a_size, host_array, &err);
@@ -192,6 +219,10 @@ cl_mem ocl_alloc_init_integer_arr(cl_int* host_array, int a_size){
 
 void ocl_copy_to_device_real(cl_mem dev_dest_array, modelica_real* src_host_array, int a_size){
     cl_int err;
+    if (ocl_cpu_backend){
+        memcpy((void*)dev_dest_array, src_host_array, a_size * sizeof(modelica_real));
+        return;
+    }
     if (!device_comm_queue)
         printf("ERROR: ocl_copy_to_device_real(): tryig to copy to device with no command queue created: not initialized OCL env?");
 
@@ -203,6 +234,10 @@ void ocl_copy_to_device_real(cl_mem dev_dest_array, modelica_real* src_host_arra
 
 void ocl_copy_device_to_device_real(cl_mem dev_src_array, cl_mem device_dest_array, int a_size){
     cl_int err;
+    if (ocl_cpu_backend){
+        memcpy((void*)device_dest_array, (void*)dev_src_array, a_size * sizeof(modelica_real));
+        return;
+    }
     if (!device_comm_queue)
         printf("ERROR: ocl_copy_device_to_device_real(): tryig to copy device to device with no command queue created: not initialized OCL env?");
 
@@ -214,6 +249,10 @@ void ocl_copy_device_to_device_real(cl_mem dev_src_array, cl_mem device_dest_arr
 
 void ocl_copy_back_to_host_real(cl_mem dev_output_array, modelica_real* dest_host_array, int a_size){
     cl_int err;
+    if (ocl_cpu_backend){
+        memcpy(dest_host_array, (void*)dev_output_array, a_size * sizeof(modelica_real));
+        return;
+    }
     if (!device_comm_queue)
         printf("ERROR: ocl_copy_back_to_host_real(): tryig to copy back non existent data");
 
@@ -225,6 +264,10 @@ void ocl_copy_back_to_host_real(cl_mem dev_output_array, modelica_real* dest_hos
 
 void ocl_copy_to_device_integer(cl_mem dev_dest_array, modelica_integer* src_host_array, int a_size){
     cl_int err;
+    if (ocl_cpu_backend){
+        memcpy((void*)dev_dest_array, src_host_array, a_size * sizeof(modelica_integer));
+        return;
+    }
     if (!device_comm_queue)
         printf("ERROR: ocl_copy_to_device_integer(): tryig to copy to device with no command queue created: not initialized OCL env?");
 
@@ -236,6 +279,10 @@ void ocl_copy_to_device_integer(cl_mem dev_dest_array, modelica_integer* src_hos
 
 void ocl_copy_device_to_device_integer(cl_mem dev_src_array, cl_mem device_dest_array, int a_size){
     cl_int err;
+    if (ocl_cpu_backend){
+        memcpy((void*)device_dest_array, (void*)dev_src_array, a_size * sizeof(modelica_integer));
+        return;
+    }
     if (!device_comm_queue)
         printf("ERROR: ocl_copy_device_to_device_integer(): tryig to copy device to device with no command queue created: not initialized OCL env?");
 
@@ -248,6 +295,10 @@ void ocl_copy_device_to_device_integer(cl_mem dev_src_array, cl_mem device_dest_
 
 void ocl_copy_back_to_host_integer(cl_mem dev_output_array, modelica_integer* dest_host_array, int a_size){
     cl_int err;
+    if (ocl_cpu_backend){
+        memcpy(dest_host_array, (void*)dev_output_array, a_size * sizeof(modelica_integer));
+        return;
+    }
     if (!device_comm_queue)
         printf("ERROR: ocl_copy_back_to_host_int(): tryig to copy back non existent data");
 
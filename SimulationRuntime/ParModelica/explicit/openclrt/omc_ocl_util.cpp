@@ -49,6 +49,7 @@
 */
 
 #include "omc_ocl_util.h"
+#include "omc_ocl_cpu.h"
 
 
 cl_command_queue device_comm_queue = NULL;
@@ -204,12 +205,29 @@ void ocl_initialize(){
     double elapsedTime;
     gettimeofday(&t1, NULL);
 
-    if (!device_comm_queue){
-        if(!ocl_device){
-            ocl_get_device();
+    if (!device_comm_queue && !ocl_cpu_backend){
+        // Use the CPU backend if asked for or if there is no OpenCL platform.
+        cl_uint nr_platforms = 0;
+        int use_cpu = ocl_cpu_backend_requested();
+        if (!use_cpu && !ocl_device &&
+            (clGetPlatformIDs(0, NULL, &nr_platforms) != CL_SUCCESS || nr_platforms == 0)){
+            printf("- No OpenCL platforms found.\n");
+            use_cpu = 1;
+        }
+
+        if (use_cpu){
+            ocl_cpu_initialize();
+            //default number of threads is the max number of threads!
+            MAX_THREADS_WORKGROUP = OCL_CPU_MAX_WORK_GROUP_SIZE;
+            GLOBAL_SIZE[0] = MAX_THREADS_WORKGROUP;
+        }
+        else {
+            if(!ocl_device){
+                ocl_get_device();
+            }
+            ocl_create_context_and_comm_queue();
+            ocl_build_p_from_src();
         }
-        ocl_create_context_and_comm_queue();
-        ocl_build_p_from_src();
     }
 
     gettimeofday(&t2, NULL);
@@ -330,9 +348,13 @@ void ocl_build_p_from_src(){
 
 cl_kernel ocl_create_kernel(cl_program program, const char* kernel_name){
 
-    if (!device_comm_queue)
+    if (!device_comm_queue && !ocl_cpu_backend)
         ocl_initialize();
 
+    // The program might have been passed in before the first initialization.
+    if (ocl_cpu_backend)
+        return ocl_cpu_create_kernel(program ? program : omc_ocl_program, kernel_name);
+
     cl_kernel kernel;
     cl_int err;
     kernel = clCreateKernel(program, kernel_name, &err);
@@ -340,6 +362,14 @@ cl_kernel ocl_create_kernel(cl_program program, const char* kernel_name){
     return kernel;
 }
 
+void ocl_release_kernel(cl_kernel kernel){
+
+    if (ocl_cpu_backend)
+        ocl_cpu_release_kernel(kernel);
+    else
+        clReleaseKernel(kernel);
+}
+
 void ocl_set_kernel_args(cl_kernel kernel, int count, ...){
 
     cl_int err;
@@ -348,6 +378,10 @@ void ocl_set_kernel_args(cl_kernel kernel, int count, ...){
     for (int i = 0; i < count; i++)
     {
         cl_mem tmp = va_arg(arguments, cl_mem);
+        if (ocl_cpu_backend){
+            ocl_cpu_set_kernel_arg(kernel, i, &tmp, sizeof(cl_mem));
+            continue;
+        }
         err = clSetKernelArg(kernel, i, sizeof(cl_mem),(void*)&tmp);
         //#ifdef SHOW_ARG_SET_ERRORS
         ocl_error_check(OCL_SET_KER_ARGS, err);
@@ -362,6 +396,11 @@ void ocl_set_kernel_args(cl_kernel kernel, int count, ...){
 
 void ocl_set_kernel_arg(cl_kernel kernel, int arg_nr, cl_mem in_arg){
 
+    if (ocl_cpu_backend){
+        ocl_cpu_set_kernel_arg(kernel, arg_nr, &in_arg, sizeof(cl_mem));
+        return;
+    }
+
     cl_int err;
     err = clSetKernelArg(kernel, arg_nr, sizeof(cl_mem),(void*)&in_arg);
 
@@ -377,6 +416,11 @@ void ocl_set_kernel_arg(cl_kernel kernel, int arg_nr, cl_mem in_arg){
 
 void ocl_set_kernel_arg(cl_kernel kernel, int arg_nr, modelica_integer in_arg){
 
+    if (ocl_cpu_backend){
+        ocl_cpu_set_kernel_arg(kernel, arg_nr, &in_arg, sizeof(modelica_integer));
+        return;
+    }
+
     cl_int err;
     err = clSetKernelArg(kernel, arg_nr, sizeof(modelica_integer),(void*)&in_arg);
 
@@ -392,6 +436,11 @@ void ocl_set_kernel_arg(cl_kernel kernel, int arg_nr, modelica_integer in_arg){
 
 void ocl_set_kernel_arg(cl_kernel kernel, int arg_nr, modelica_real in_arg){
 
+    if (ocl_cpu_backend){
+        ocl_cpu_set_kernel_arg(kernel, arg_nr, &in_arg, sizeof(modelica_real));
+        return;
+    }
+
     cl_int err;
     err = clSetKernelArg(kernel, arg_nr, sizeof(modelica_real),(void*)&in_arg);
 
@@ -407,6 +456,11 @@ void ocl_set_kernel_arg(cl_kernel kernel, int arg_nr, modelica_real in_arg){
 
 void ocl_set_local_kernel_arg(cl_kernel kernel, int arg_nr, size_t in_size){
 
+    if (ocl_cpu_backend){
+        ocl_cpu_set_local_kernel_arg(kernel, arg_nr, in_size);
+        return;
+    }
+
     cl_int err;
 
     // Allocate the memory in local space for the data
@@ -428,7 +482,15 @@ void ocl_execute_kernel(cl_kernel kernel){
     double elapsedTime;
     gettimeofday(&t1, NULL);
 
-    if (WORK_DIM == 0){
+    if (ocl_cpu_backend){
+        if (WORK_DIM == 0)
+            //automatic division to workgroups by the CPU backend.
+            ocl_cpu_execute_kernel(kernel, 1, GLOBAL_SIZE, NULL);
+        else
+            ocl_cpu_execute_kernel(kernel, WORK_DIM, GLOBAL_SIZE, LOCAL_SIZE);
+    }
+
+    else if (WORK_DIM == 0){
         size_t GlobalSize[1] = {GLOBAL_SIZE[0]}; // one dimensional Range
         //automatic division to workgroups by OpenCL.
         err = clEnqueueNDRangeKernel(device_comm_queue, kernel, 1, NULL,
@@ -460,8 +522,10 @@ void ocl_execute_kernel(cl_kernel kernel){
         GlobalSize, LocalSize, 0, NULL, NULL);
     }
 
-    clFinish(device_comm_queue);
-    ocl_error_check(OCL_ENQUE_ND_RANGE_KERNEL, err);
+    if (!ocl_cpu_backend){
+        clFinish(device_comm_queue);
+        ocl_error_check(OCL_ENQUE_ND_RANGE_KERNEL, err);
+    }
 
 
     gettimeofday(&t2, NULL);
@@ -514,6 +578,7 @@ modelica_integer ocl_get_num_threads(){
 
 
 void ocl_clean_up(){
+    if(ocl_cpu_backend){ocl_cpu_clean_up();}
     if(device_context){clReleaseContext(device_context); device_context = NULL;}
     if(device_comm_queue){clReleaseCommandQueue(device_comm_queue); device_comm_queue=NULL;}
 }
@@ -90,6 +90,9 @@ void ocl_create_context_and_comm_queue();
 //Extracts and creates a kernel from a given program.
 cl_kernel ocl_create_kernel(cl_program program, const char* kernel_name);
 
+//Releases a kernel created with ocl_create_kernel.
+void ocl_release_kernel(cl_kernel kernel);
+
 //sets Kernel arguments. count is the number of arguments beieng passed
 void ocl_set_kernel_args(cl_kernel kernel, int count, ...);
 
@@ -0,0 +1,368 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+
+/*
+ * Micro-benchmark of index-spec slicing in the array runtime.
+ *
+ * index_<type>_array and indexed_assign_<type>_array are first checked
+ * against the element-by-element loop they replaced (next_index plus
+ * calc_base_index_spec per element) on 20000 random specs: scalars, ':',
+ * ranges with step 1, ranges with larger steps, reversed ranges and index
+ * vectors with repeats, for 8-byte and 1-byte elements. The number of
+ * specs whose last subscripted dimension takes the contiguous, strided,
+ * reversed and gather path is printed. Then the time per call of typical
+ * slices of a 200x200 matrix and a 40000-element vector is compared to
+ * the old loop. With assertions enabled, calc_base_index_spec checks the
+ * whole spec for every element, so the old loop is only representative
+ * in a runtime built with -DNDEBUG.
+ *
+ *   make benchmarks && ./benchmarks/array_slices [seconds per slice]
+ */
+
+#include "util/real_array.h"
+#include "util/boolean_array.h"
+#include "util/index_spec.h"
+#include "util/rtclock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_DIMS 4
+#define MAX_SUBSCRIPTS 8
+
+enum { PATH_WHOLE, PATH_CONTIGUOUS, PATH_STRIDED, PATH_REVERSED, PATH_GATHER, NUMBER_OF_PATHS };
+static const char *path_names[NUMBER_OF_PATHS] = {"all ':'", "contiguous", "strided", "reversed", "gather"};
+
+typedef struct {
+  index_spec_t spec;
+  _index_t dim_size[MAX_DIMS];
+  _index_t *index[MAX_DIMS];
+  char index_type[MAX_DIMS];
+  _index_t subscripts[MAX_DIMS][MAX_SUBSCRIPTS];
+} slice_t;
+
+static void init_slice(slice_t *s, int ndims)
+{
+  s->spec.ndims = ndims;
+  s->spec.dim_size = s->dim_size;
+  s->spec.index = s->index;
+  s->spec.index_type = s->index_type;
+}
+
+static void set_whole(slice_t *s, int d)
+{
+  s->dim_size[d] = 1;
+  s->index[d] = NULL;
+  s->index_type[d] = 'W';
+}
+
+static void set_scalar(slice_t *s, int d, _index_t i)
+{
+  s->dim_size[d] = 0;
+  s->index[d] = s->subscripts[d];
+  s->index[d][0] = i;
+  s->index_type[d] = 'S';
+}
+
+/* first:step:last, the index vector is written to sub */
+static void set_range(slice_t *s, int d, _index_t *sub, _index_t first, _index_t step, _index_t last)
+{
+  _index_t n = 0, i;
+  for (i = first; step > 0 ? i <= last : i >= last; i += step) {
+    sub[n++] = i;
+  }
+  s->dim_size[d] = n;
+  s->index[d] = sub;
+  s->index_type[d] = 'A';
+}
+
+/* A random subscript of a dimension of size n */
+static void random_subscript(slice_t *s, int d, _index_t n)
+{
+  _index_t first, last, k, len;
+  switch (rand() % 6) {
+  case 0:
+    set_scalar(s, d, 1 + rand() % n);
+    break;
+  case 1:
+    set_whole(s, d);
+    break;
+  case 2:
+    first = 1 + rand() % n;
+    last = first + rand() % (n - first + 1);
+    set_range(s, d, s->subscripts[d], first, 1, last);
+    break;
+  case 3:
+    set_range(s, d, s->subscripts[d], 1 + rand() % n, 2 + rand() % 2, n);
+    break;
+  case 4:
+    set_range(s, d, s->subscripts[d], 1 + rand() % n, -1 - rand() % 2, 1);
+    break;
+  default:
+    len = 1 + rand() % MAX_SUBSCRIPTS;
+    for (k = 0; k < len; k++) {
+      s->subscripts[d][k] = 1 + rand() % n;
+    }
+    s->dim_size[d] = len;
+    s->index[d] = s->subscripts[d];
+    s->index_type[d] = 'A';
+  }
+}
+
+/* The path copy_base_array_index_spec takes for the last subscripted
+ * dimension */
+static int classify_path(const index_spec_t *spec, const _index_t *dims)
+{
+  int c, k, n, blk = 1;
+  _index_t step;
+  for (c = spec->ndims - 1; c >= 0 && spec->index[c] == NULL; --c) {
+    blk *= dims[c];
+  }
+  if (c < 0) {
+    return PATH_WHOLE;
+  }
+  n = imax(spec->dim_size[c], 1);
+  step = n > 1 ? spec->index[c][1] - spec->index[c][0] : 1;
+  for (k = 2; k < n && spec->index[c][k] - spec->index[c][k-1] == step; k++);
+  if (k < n) {
+    return PATH_GATHER;
+  }
+  if (step == 1) {
+    return PATH_CONTIGUOUS;
+  }
+  /* ranges with trailing ':' are copied block by block */
+  if (blk > 1) {
+    return PATH_GATHER;
+  }
+  return step < 0 ? PATH_REVERSED : PATH_STRIDED;
+}
+
+/* The element-by-element loop index_<type>_array and
+ * indexed_assign_<type>_array used before */
+static void reference_copy(base_array_t *a, const index_spec_t *spec, char *data, size_t elemsize, int gather)
+{
+  _index_t idx_vec[MAX_DIMS], idx_size[MAX_DIMS];
+  size_t j = 0;
+  int i;
+
+  for (i = 0; i < spec->ndims; i++) {
+    idx_vec[i] = 0;
+    idx_size[i] = spec->index[i] != NULL ? imax(spec->dim_size[i], 1) : a->dim_size[i];
+  }
+  do {
+    char *p = (char*) a->data + calc_base_index_spec(a->ndims, idx_vec, a, spec) * elemsize;
+    if (gather) {
+      memcpy(data + j * elemsize, p, elemsize);
+    } else {
+      memcpy(p, data + j * elemsize, elemsize);
+    }
+    j++;
+  } while (0 == next_index(spec->ndims, idx_vec, idx_size));
+}
+
+/* The dimensions of source[spec] */
+static int slice_dims(const base_array_t *source, const index_spec_t *spec, _index_t *dims, size_t *n)
+{
+  int i, ndims = 0;
+  *n = 1;
+  for (i = 0; i < spec->ndims; i++) {
+    if (spec->index[i] == NULL) {
+      dims[ndims++] = source->dim_size[i];
+    } else if (spec->dim_size[i] != 0) {
+      dims[ndims++] = spec->dim_size[i];
+    } else {
+      continue;
+    }
+    *n *= dims[ndims-1];
+  }
+  return ndims;
+}
+
+/* index and indexed_assign of one random spec; returns the path of the
+ * last subscripted dimension or -1 if a result differs */
+static int check_random_spec(size_t elemsize)
+{
+  _index_t dims[MAX_DIMS], slice[MAX_DIMS];
+  slice_t s;
+  base_array_t a, b, r;
+  size_t i, n = 1, m;
+  int d, ndims = 1 + rand() % MAX_DIMS, ok;
+  char *expected, *actual;
+
+  init_slice(&s, ndims);
+  for (d = 0; d < ndims; d++) {
+    dims[d] = 1 + rand() % 6;
+    n *= dims[d];
+    random_subscript(&s, d, dims[d]);
+  }
+  a.ndims = b.ndims = ndims;
+  a.dim_size = b.dim_size = dims;
+  a.data = malloc(n * elemsize);
+  b.data = malloc(n * elemsize);
+  for (i = 0; i < n * elemsize; i++) {
+    ((char*) a.data)[i] = (char) rand();
+  }
+  r.ndims = slice_dims(&a, &s.spec, slice, &m);
+  r.dim_size = slice;
+  expected = (char*) malloc(m * elemsize + 1);
+  actual = (char*) malloc(m * elemsize + 1);
+
+  /* index */
+  reference_copy(&a, &s.spec, expected, elemsize, 1);
+  r.data = actual;
+  if (elemsize == sizeof(modelica_real)) {
+    index_real_array(&a, &s.spec, &r);
+  } else {
+    index_boolean_array(&a, &s.spec, &r);
+  }
+  ok = 0 == memcmp(expected, actual, m * elemsize);
+
+  /* indexed_assign of new values */
+  for (i = 0; i < m * elemsize; i++) {
+    actual[i] = (char) rand();
+  }
+  memcpy(b.data, a.data, n * elemsize);
+  reference_copy(&b, &s.spec, actual, elemsize, 0);
+  if (elemsize == sizeof(modelica_real)) {
+    indexed_assign_real_array(r, &a, &s.spec);
+  } else {
+    indexed_assign_boolean_array(r, &a, &s.spec);
+  }
+  ok = ok && 0 == memcmp(a.data, b.data, n * elemsize);
+
+  free(a.data);
+  free(b.data);
+  free(expected);
+  free(actual);
+  return ok ? classify_path(&s.spec, dims) : -1;
+}
+
+/* Time per call in ns of source[spec] with index_real_array, or with the
+ * old loop if reference is set */
+static double time_slice(base_array_t *a, const index_spec_t *spec, int reference, double seconds)
+{
+  _index_t slice[MAX_DIMS];
+  base_array_t r;
+  rtclock_t clk;
+  double elapsed = 0;
+  unsigned long reps = 0, batch;
+  size_t m;
+
+  r.ndims = slice_dims(a, spec, slice, &m);
+  r.dim_size = slice;
+  r.data = malloc(m * sizeof(modelica_real));
+  batch = 1 + 100000 / m;
+
+  rt_ext_tp_tick(&clk);
+  while (elapsed < seconds) {
+    unsigned long k;
+    for (k = 0; k < batch; k++) {
+      if (reference) {
+        reference_copy(a, spec, (char*) r.data, sizeof(modelica_real), 1);
+      } else {
+        index_real_array(a, spec, &r);
+      }
+    }
+    reps += batch;
+    elapsed = rt_ext_tp_tock(&clk);
+  }
+  free(r.data);
+  return elapsed / reps * 1e9;
+}
+
+static void print_slice(const char *name, base_array_t *a, const index_spec_t *spec, double seconds)
+{
+  double t = time_slice(a, spec, 0, seconds);
+  double tref = time_slice(a, spec, 1, seconds);
+  printf("%-12s %12.0f %12.0f %8.1fx\n", name, t, tref, tref / t);
+}
+
+int main(int argc, char **argv)
+{
+  enum { N = 200, NVEC = 40000 };
+  static _index_t sub1[N], sub2[N], sub3[NVEC];
+  double seconds = argc > 1 ? atof(argv[1]) : 0.2;
+  int i, failed = 0, paths[NUMBER_OF_PATHS] = {0};
+  _index_t dims[2] = {N, N}, vdims[1] = {NVEC};
+  base_array_t a, x;
+  slice_t s;
+
+  omc_alloc_interface.init();
+  rt_set_clock(OMC_CLOCK_REALTIME);
+  srand(42);
+
+  for (i = 0; i < 20000; i++) {
+    int path = check_random_spec(i % 2 ? sizeof(modelica_real) : sizeof(modelica_boolean));
+    if (path < 0) {
+      failed++;
+    } else {
+      paths[path]++;
+    }
+  }
+  printf("%s: index and indexed_assign identical to the element loop on 20000 random specs", failed ? "FAILED" : "ok");
+  if (failed) {
+    printf(" (%d differ)", failed);
+  }
+  printf("\n");
+  for (i = 0; i < NUMBER_OF_PATHS; i++) {
+    printf("  %-10s %6d\n", path_names[i], paths[i]);
+  }
+
+  a.ndims = 2;
+  a.dim_size = dims;
+  a.data = calloc(N * N, sizeof(modelica_real));
+  x.ndims = 1;
+  x.dim_size = vdims;
+  x.data = calloc(NVEC, sizeof(modelica_real));
+
+  printf("%-12s %12s %12s %9s\n", "slice", "ns/call", "old ns/call", "speedup");
+  init_slice(&s, 2);
+  set_whole(&s, 0);
+  set_scalar(&s, 1, N/2);
+  print_slice("A[:,k]", &a, &s.spec, seconds);
+  set_scalar(&s, 0, N/2);
+  set_whole(&s, 1);
+  print_slice("A[k,:]", &a, &s.spec, seconds);
+  set_range(&s, 0, sub1, 2, 1, N);
+  set_range(&s, 1, sub2, 2, 1, N);
+  print_slice("A[2:n,2:n]", &a, &s.spec, seconds);
+  set_range(&s, 0, sub1, 1, 2, N);
+  set_whole(&s, 1);
+  print_slice("A[1:2:n,:]", &a, &s.spec, seconds);
+  init_slice(&s, 1);
+  set_range(&s, 0, sub3, 2, 1, NVEC);
+  print_slice("x[2:n]", &x, &s.spec, seconds);
+
+  free(a.data);
+  free(x.data);
+  return failed != 0;
+}
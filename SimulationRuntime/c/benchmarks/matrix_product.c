@@ -0,0 +1,197 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+
+/*
+ * Micro-benchmark of the native matrix product kernels of the array runtime.
+ *
+ * The kernels are first checked against the textbook i-j-k loop on
+ * random non-square shapes; they sum every element in increasing k, so
+ * the results have to be bit-identical. Then the GFLOP/s of
+ * mul_real_matrix_product are printed for square sizes typical of models.
+ * omc_dgemm is not set, so the native kernel is measured for all sizes.
+ *
+ *   make benchmarks && ./benchmarks/matrix_product [seconds per size]
+ */
+
+#include "util/real_array.h"
+#include "util/integer_array.h"
+#include "util/rtclock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void alloc_matrix(base_array_t *a, _index_t *dims, size_t rows, size_t cols, size_t elementSize)
+{
+  a->ndims = 2;
+  a->dim_size = dims;
+  a->dim_size[0] = rows;
+  a->dim_size[1] = cols;
+  a->data = malloc(elementSize * (rows * cols + 1));
+}
+
+static void fill_real(real_array_t *a)
+{
+  size_t i, n = a->dim_size[0] * a->dim_size[1];
+  for (i = 0; i < n; i++) {
+    ((modelica_real*) a->data)[i] = rand() / (double) RAND_MAX - 0.5;
+  }
+}
+
+static void fill_integer(integer_array_t *a)
+{
+  size_t i, n = a->dim_size[0] * a->dim_size[1];
+  for (i = 0; i < n; i++) {
+    ((modelica_integer*) a->data)[i] = rand() % 201 - 100;
+  }
+}
+
+static int check_real(size_t n, size_t m, size_t p)
+{
+  _index_t da[2], db[2], dc[2];
+  real_array_t a, b, c;
+  const modelica_real *A, *B, *C;
+  size_t i, j, k;
+  int ok = 1;
+
+  alloc_matrix(&a, da, n, m, sizeof(modelica_real));
+  alloc_matrix(&b, db, m, p, sizeof(modelica_real));
+  alloc_matrix(&c, dc, n, p, sizeof(modelica_real));
+  fill_real(&a);
+  fill_real(&b);
+  mul_real_matrix_product(&a, &b, &c);
+
+  A = (const modelica_real*) a.data;
+  B = (const modelica_real*) b.data;
+  C = (const modelica_real*) c.data;
+  for (i = 0; i < n && ok; i++) {
+    for (j = 0; j < p && ok; j++) {
+      modelica_real tmp = 0;
+      for (k = 0; k < m; k++) {
+        tmp += A[i*m+k] * B[k*p+j];
+      }
+      ok = 0 == memcmp(&tmp, C + i*p+j, sizeof(modelica_real));
+    }
+  }
+  free(a.data);
+  free(b.data);
+  free(c.data);
+  return ok;
+}
+
+static int check_integer(size_t n, size_t m, size_t p)
+{
+  _index_t da[2], db[2], dc[2];
+  integer_array_t a, b, c;
+  const modelica_integer *A, *B, *C;
+  size_t i, j, k;
+  int ok = 1;
+
+  alloc_matrix(&a, da, n, m, sizeof(modelica_integer));
+  alloc_matrix(&b, db, m, p, sizeof(modelica_integer));
+  alloc_matrix(&c, dc, n, p, sizeof(modelica_integer));
+  fill_integer(&a);
+  fill_integer(&b);
+  mul_integer_matrix_product(&a, &b, &c);
+
+  A = (const modelica_integer*) a.data;
+  B = (const modelica_integer*) b.data;
+  C = (const modelica_integer*) c.data;
+  for (i = 0; i < n && ok; i++) {
+    for (j = 0; j < p && ok; j++) {
+      modelica_integer tmp = 0;
+      for (k = 0; k < m; k++) {
+        tmp += A[i*m+k] * B[k*p+j];
+      }
+      ok = tmp == C[i*p+j];
+    }
+  }
+  free(a.data);
+  free(b.data);
+  free(c.data);
+  return ok;
+}
+
+/* GFLOP/s of an n x n product, repeated for at least the given time */
+static double gflops(size_t n, double seconds)
+{
+  _index_t da[2], db[2], dc[2];
+  real_array_t a, b, c;
+  rtclock_t clk;
+  double elapsed = 0;
+  unsigned long reps = 0, batch = 1 + 1000000 / (n*n*n);
+
+  alloc_matrix(&a, da, n, n, sizeof(modelica_real));
+  alloc_matrix(&b, db, n, n, sizeof(modelica_real));
+  alloc_matrix(&c, dc, n, n, sizeof(modelica_real));
+  fill_real(&a);
+  fill_real(&b);
+
+  rt_ext_tp_tick(&clk);
+  while (elapsed < seconds) {
+    unsigned long r;
+    for (r = 0; r < batch; r++) {
+      mul_real_matrix_product(&a, &b, &c);
+    }
+    reps += batch;
+    elapsed = rt_ext_tp_tock(&clk);
+  }
+  free(a.data);
+  free(b.data);
+  free(c.data);
+  return 2.0 * n * n * n * reps / elapsed * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+  static const size_t sizes[] = {2, 3, 4, 6, 8, 10, 16, 20, 32, 50, 64, 100, 128, 200, 256, 400};
+  double seconds = argc > 1 ? atof(argv[1]) : 0.2;
+  int i, failed = 0;
+
+  omc_dgemm = NULL;
+  rt_set_clock(OMC_CLOCK_REALTIME);
+  srand(42);
+
+  for (i = 0; i < 200; i++) {
+    size_t n = 1 + rand() % 90, m = 1 + rand() % 300, p = 1 + rand() % 300;
+    if (!check_real(n, m, p) || !check_integer(n, m, p)) {
+      printf("product of %lux%lu and %lux%lu differs from the textbook loop\n", (unsigned long) n, (unsigned long) m, (unsigned long) m, (unsigned long) p);
+      failed = 1;
+    }
+  }
+  printf("%s: kernels bit-identical to the textbook loop on 200 random shapes\n", failed ? "FAILED" : "ok");
+
+  printf("%6s %10s\n", "n", "GFLOP/s");
+  for (i = 0; i < (int) (sizeof(sizes) / sizeof(sizes[0])); i++) {
+    printf("%6lu %10.2f\n", (unsigned long) sizes[i], gflops(sizes[i], seconds));
+  }
+  return failed;
+}
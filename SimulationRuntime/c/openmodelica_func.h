@@ -177,6 +177,16 @@ int (*function_ZeroCrossingsEquations)(DATA *data);
  */
 int (*function_ZeroCrossings)(DATA *data, double* gout);
 
+/*! \fn function_ZeroCrossingsValues
+ *
+ *  This function evaluates the continuous values of the zero crossings,
+ *  which are positive if the relation is true (used for root finding)
+ *
+ *  \param [ref] [data]
+ *  \param [ref] [gout]
+ */
+int (*function_ZeroCrossingsValues)(DATA *data, double* gout);
+
 /*! \fn function_updateRelations
  *
  *  This function evaluates current continuous relations.
@@ -40,6 +40,11 @@
 #include "../../simulation/options.h"
 #include "../../simulation/solver/model_help.h"
 
+typedef struct OPT_MODEL_DATA_ARG{
+  double *vopt;
+  int index;
+}OPT_MODEL_DATA_ARG;
+
 static inline void pickUpDim(OptDataDim * dim, DATA* data, OptDataTime * time);
 static inline void pickUpTime(OptDataTime * time, OptDataDim * dim, DATA* data, const double preSimTime);
 static inline void pickUpBounds(OptDataBounds * bounds, OptDataDim * dim, DATA* data);
@@ -56,6 +61,10 @@ static inline void updateDOSystem(OptData * optData, DATA * data, threadData_t *
 static inline void setLocalVars(OptData * optData, DATA * data, const double * const vopt,
                                 const int i, const int j, const int shift);
 
+static modelica_boolean evalModelData(OptData *optData, double *vopt, const int index, const modelica_boolean parallel);
+static void modelDataInterval(OptData *optData, const int i, void *arg);
+static size_t modelDataSize(OptData *optData);
+static void copyModelData(OptData *optData, modelica_real *buffer);
 static inline int getNsi(char*, const int, modelica_boolean*);
 static inline void overwriteTimeGridFile(OptDataTime * time, char* filename, long double c[], const int np, const int nsi);
 static inline void overwriteTimeGridModel(OptDataTime * time, long double c[], const int np, const int nsi);
@@ -90,6 +99,7 @@ int pickUpModelData(DATA* data, SOLVER_INFO* solverInfo)
       optData->v[i][j] = (modelica_real*)malloc(nReal*sizeof(modelica_real));
   }
   optData->data = data;
+  optData->threads.pool = NULL;
 
   optData->v0 = (modelica_real*)malloc(nReal*sizeof(modelica_real));
   memcpy(optData->v0, data->localData[0]->realVars, nReal*sizeof(modelica_real));
@@ -678,6 +688,45 @@ void res2file(OptData *optData, SOLVER_INFO* solverInfo, double *vopt){
  *  author: Vitalij Ruge
  **/
 void optData2ModelData(OptData *optData, double *vopt, const int index){
+  OptDataThreads * threads = &optData->threads;
+
+  if(index == 0 || !threads->pool){
+    evalModelData(optData, vopt, index, 0);
+  }else if(!threads->verifyModelData){
+    /* repeat the evaluation sequentially if it failed in a thread */
+    if(!evalModelData(optData, vopt, index, 1))
+      evalModelData(optData, vopt, index, 0);
+  }else{
+    /* the parallel result has to be bit-identical to the sequential one */
+    const size_t n = modelDataSize(optData);
+    modelica_real * check = (modelica_real*) malloc(n*sizeof(modelica_real));
+    modelica_real * ref = (modelica_real*) malloc(n*sizeof(modelica_real));
+    modelica_boolean scc;
+
+    assertStreamPrint(optData->data->threadData, 0 != check && 0 != ref, "out of memory");
+    scc = evalModelData(optData, vopt, index, 1);
+    copyModelData(optData, check);
+    evalModelData(optData, vopt, index, 0);
+    copyModelData(optData, ref);
+
+    if(scc && memcmp(check, ref, n*sizeof(modelica_real))){
+      warningStreamPrint(LOG_STDOUT, 0, "The collocation intervals evaluated by threads differ from the sequential evaluation, "
+                         "the intervals are evaluated sequentially from now on.");
+      freeOptimizerThreads(optData);
+    }else if(scc){
+      infoStreamPrint(LOG_SOLVER, 0, "the collocation intervals evaluated by threads are identical to the sequential evaluation");
+      threads->verifyModelData = 0;
+    }
+    free(check);
+    free(ref);
+  }
+}
+
+/*!
+ *  helper optData2ModelData
+ *  returns 0 if the evaluation failed in a thread
+ **/
+static modelica_boolean evalModelData(OptData *optData, double *vopt, const int index, const modelica_boolean parallel){
   const int nv = optData->dim.nv;
   const int nsi = optData->dim.nsi;
   const int np = optData->dim.np;
@@ -691,10 +740,12 @@ void optData2ModelData(OptData *optData, double *vopt, const int index){
   modelica_real * realVars[3];
   modelica_real * tmpVars[2];
 
-  int i, j, k, shift, l;
+  int i, j, shift, l;
   DATA * data = optData->data;
   const int * indexBC = optData->s.indexABCD + 3;
   threadData_t *threadData = data->threadData;
+  OPT_MODEL_DATA_ARG arg;
+  modelica_boolean scc = 1;
 
   for(l = 0; l < 3; ++l)
     realVars[l] = data->localData[l]->realVars;
@@ -713,14 +764,17 @@ void optData2ModelData(OptData *optData, double *vopt, const int index){
   memcpy(data->simulationInfo.relations, optData->re, nRelations*sizeof(modelica_boolean));
   memcpy(data->simulationInfo.storedRelations, optData->storeR, nRelations*sizeof(modelica_boolean));
 
-
-  for(i = 0, shift = 0; i < nsi-1; ++i){
-    for(j = 0; j < np; ++j, shift += nv){
-      setLocalVars(optData, data, vopt, i, j, shift);
-      updateDOSystem(optData, data, threadData, i, j, index, 2);
-    }
+  arg.vopt = vopt;
+  arg.index = index;
+  if(parallel){
+    scc = evalIntervalsParallel(optData, modelDataInterval, &arg);
+  }else{
+    for(i = 0; i < nsi-1; ++i)
+      modelDataInterval(optData, i, &arg);
   }
 
+  i = nsi-1;
+  shift = i*np*nv;
   for(j = 0; j < np-1; ++j, shift += nv){
     setLocalVars(optData, data, vopt, i, j, shift);
     updateDOSystem(optData, data, threadData, i, j, index, 2);
@@ -741,8 +795,62 @@ void optData2ModelData(OptData *optData, double *vopt, const int index){
     if(optData->s.matrix[l])
       data->simulationInfo.analyticJacobians[indexBC[l]].tmpVars = tmpVars[l];
 
+  return scc;
 }
 
+/*!
+ *  helper optData2ModelData
+ *  evaluates the collocation points of the interval i, which is not the last one
+ **/
+static void modelDataInterval(OptData *optData, const int i, void *arg){
+  const OPT_MODEL_DATA_ARG * const a = (const OPT_MODEL_DATA_ARG*) arg;
+  const int nv = optData->dim.nv;
+  const int np = optData->dim.np;
+  DATA * data = optData->data;
+  int j, shift;
+
+  for(j = 0, shift = i*np*nv; j < np; ++j, shift += nv){
+    setLocalVars(optData, data, a->vopt, i, j, shift);
+    updateDOSystem(optData, data, data->threadData, i, j, a->index, 2);
+  }
+}
+
+/*!
+ *  helper optData2ModelData
+ *  number of values written by optData2ModelData
+ **/
+static size_t modelDataSize(OptData *optData){
+  const int nsi = optData->dim.nsi;
+  const int np = optData->dim.np;
+  const int nv = optData->dim.nv;
+
+  return (size_t)nsi*np*(optData->dim.nReal + optData->dim.nJ2*nv) + (size_t)optData->dim.ncf*nv;
+}
+
+/*!
+ *  helper optData2ModelData
+ *  copies the values written by optData2ModelData into buffer
+ **/
+static void copyModelData(OptData *optData, modelica_real *buffer){
+  const int nsi = optData->dim.nsi;
+  const int np = optData->dim.np;
+  const int nv = optData->dim.nv;
+  const int nReal = optData->dim.nReal;
+  const int nJ2 = optData->dim.nJ2;
+  const int ncf = optData->dim.ncf;
+  int i, j, k;
+
+  for(i = 0; i < nsi; ++i){
+    for(j = 0; j < np; ++j){
+      memcpy(buffer, optData->v[i][j], nReal*sizeof(modelica_real));
+      buffer += nReal;
+      for(k = 0; k < nJ2; ++k, buffer += nv)
+        memcpy(buffer, optData->J[i][j][k], nv*sizeof(modelica_real));
+    }
+  }
+  for(k = 0; k < ncf; ++k, buffer += nv)
+    memcpy(buffer, optData->Jf[k], nv*sizeof(modelica_real));
+}
 
 /*!
  *  helper optData2ModelData
@@ -890,6 +998,386 @@ void diffSynColoredOptimizerSystemF(OptData *optData, modelica_real **J){
   }
 }
 
+/*
+ * Parallel evaluation of the collocation intervals.
+ *
+ * Every thread owns a private copy of the working set of DATA, i.e. the
+ * SIMULATION_DATA of the collocation points, the parts of SIMULATION_INFO that
+ * are written by functionDAE and the buffers of the jacobians B, C and D, and
+ * a private copy of OptData with its own scratch matrices for the hessian.
+ * The intervals 0 ... nsi-2 are distributed in contiguous ranges over the
+ * threads, the calling thread is worker 0. Every interval writes only its own
+ * entries of v, J and of the ipopt arrays, the last interval and the terminal
+ * constraints are evaluated by the caller afterwards.
+ */
+typedef struct OPT_THREAD_WORKER
+{
+  struct OPT_THREAD_POOL *pool;
+  int id;
+  pthread_t thread;
+  int first;                           /* intervals [first, last) */
+  int last;
+
+  OptData optData;                     /* private copy, optData.data points to data */
+  DATA data;                           /* private copy of DATA */
+  SIMULATION_DATA simData[3];          /* private collocation points */
+  SIMULATION_DATA **localData;
+  modelica_real *realVars;
+  modelica_integer *integerVars;
+  modelica_boolean *booleanVars;
+  modelica_string *stringVars;
+  modelica_real *realVarsPre;
+  modelica_integer *integerVarsPre;
+  modelica_boolean *booleanVarsPre;
+  modelica_boolean *relations;
+  modelica_boolean *relationsPre;
+  modelica_boolean *storedRelations;
+  modelica_real *mathEventsValuePre;
+  modelica_real *inputVars;
+  ANALYTIC_JACOBIAN *analyticJacobians;
+  modelica_real *resultVars[3];        /* of the jacobians B, C and D */
+  modelica_real *tmpVars[3];
+  modelica_real **tmpJ;
+  long double ***H;
+  long double **Hl;
+} OPT_THREAD_WORKER;
+
+typedef struct OPT_THREAD_POOL
+{
+  int numWorkers;
+  OPT_THREAD_WORKER *workers;
+  int numLocalData;
+
+  /* current task, read-only for the workers */
+  OPT_INTERVAL_TASK task;
+  void *arg;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t start;
+  pthread_cond_t finished;
+  unsigned long generation;            /* incremented for every evaluation */
+  int running;                         /* number of worker threads still busy */
+  int shutdown;
+  volatile int failed;
+} OPT_THREAD_POOL;
+
+static void optWorkerRun(OPT_THREAD_WORKER *w, threadData_t *threadData)
+{
+  OPT_THREAD_POOL *pool = w->pool;
+#if !defined(OMC_EMCC)
+  jmp_buf *oldSimulationJumpBuffer = threadData->simulationJumpBuffer;
+#endif
+  int i;
+
+  w->data.threadData = threadData;
+
+  /* errors which are not caught by updateDOSystem end the evaluation of the worker */
+  MMC_TRY_INTERNAL(mmc_jumper)
+#if !defined(OMC_EMCC)
+  MMC_TRY_INTERNAL(simulationJumpBuffer)
+#endif
+    for(i = w->first; i < w->last && !pool->failed; ++i){
+      w->optData.scc = 1;
+      pool->task(&w->optData, i, pool->arg);
+      if(!w->optData.scc)
+        pool->failed = 1;
+    }
+#if !defined(OMC_EMCC)
+  MMC_ELSE()
+    pool->failed = 1;
+  MMC_CATCH_INTERNAL(simulationJumpBuffer)
+#endif
+  MMC_ELSE()
+    pool->failed = 1;
+  MMC_CATCH_INTERNAL(mmc_jumper)
+
+#if !defined(OMC_EMCC)
+  threadData->simulationJumpBuffer = oldSimulationJumpBuffer;
+#endif
+}
+
+static void* optWorkerThread(void *arg)
+{
+  OPT_THREAD_WORKER *w = (OPT_THREAD_WORKER*) arg;
+  OPT_THREAD_POOL *pool = w->pool;
+  unsigned long generation = 0;
+
+  MMC_TRY_TOP()
+  for(;;){
+    pthread_mutex_lock(&pool->mutex);
+    while(!pool->shutdown && pool->generation == generation)
+      pthread_cond_wait(&pool->start, &pool->mutex);
+    generation = pool->generation;
+    pthread_mutex_unlock(&pool->mutex);
+    if(pool->shutdown)
+      break;
+
+    optWorkerRun(w, threadData);
+
+    pthread_mutex_lock(&pool->mutex);
+    if(--pool->running == 0)
+      pthread_cond_signal(&pool->finished);
+    pthread_mutex_unlock(&pool->mutex);
+  }
+  MMC_CATCH_TOP()
+
+  return NULL;
+}
+
+/* copies the current working set of optData into the private data of worker w */
+static void optWorkerSync(OPT_THREAD_WORKER *w, OptData *optData)
+{
+  DATA *data = optData->data;
+  const MODEL_DATA *mData = &(data->modelData);
+  const SIMULATION_INFO *sInfo = &(data->simulationInfo);
+  int l;
+
+  w->data = *data;
+  w->data.localData = w->localData;
+  memcpy(w->localData, data->localData, w->pool->numLocalData*sizeof(SIMULATION_DATA*));
+  for(l = 0; l < 3; ++l){
+    w->simData[l] = *data->localData[l];
+    w->localData[l] = w->simData + l;
+  }
+
+  w->simData[0].realVars = w->realVars;
+  memcpy(w->realVars, data->localData[0]->realVars, mData->nVariablesReal*sizeof(modelica_real));
+  w->simData[0].integerVars = w->integerVars;
+  memcpy(w->integerVars, data->localData[0]->integerVars, mData->nVariablesInteger*sizeof(modelica_integer));
+  w->simData[0].booleanVars = w->booleanVars;
+  memcpy(w->booleanVars, data->localData[0]->booleanVars, mData->nVariablesBoolean*sizeof(modelica_boolean));
+  w->simData[0].stringVars = w->stringVars;
+  memcpy(w->stringVars, data->localData[0]->stringVars, mData->nVariablesString*sizeof(modelica_string));
+
+  w->data.simulationInfo.realVarsPre = w->realVarsPre;
+  memcpy(w->realVarsPre, sInfo->realVarsPre, mData->nVariablesReal*sizeof(modelica_real));
+  w->data.simulationInfo.integerVarsPre = w->integerVarsPre;
+  memcpy(w->integerVarsPre, sInfo->integerVarsPre, mData->nVariablesInteger*sizeof(modelica_integer));
+  w->data.simulationInfo.booleanVarsPre = w->booleanVarsPre;
+  memcpy(w->booleanVarsPre, sInfo->booleanVarsPre, mData->nVariablesBoolean*sizeof(modelica_boolean));
+  w->data.simulationInfo.relations = w->relations;
+  memcpy(w->relations, sInfo->relations, mData->nRelations*sizeof(modelica_boolean));
+  w->data.simulationInfo.relationsPre = w->relationsPre;
+  memcpy(w->relationsPre, sInfo->relationsPre, mData->nRelations*sizeof(modelica_boolean));
+  w->data.simulationInfo.storedRelations = w->storedRelations;
+  memcpy(w->storedRelations, sInfo->storedRelations, mData->nRelations*sizeof(modelica_boolean));
+  w->data.simulationInfo.mathEventsValuePre = w->mathEventsValuePre;
+  memcpy(w->mathEventsValuePre, sInfo->mathEventsValuePre, mData->nMathEvents*sizeof(modelica_real));
+  w->data.simulationInfo.inputVars = w->inputVars;
+  memcpy(w->inputVars, sInfo->inputVars, mData->nInputVars*sizeof(modelica_real));
+
+  w->data.simulationInfo.analyticJacobians = w->analyticJacobians;
+  memcpy(w->analyticJacobians, sInfo->analyticJacobians, mData->nJacobians*sizeof(ANALYTIC_JACOBIAN));
+  for(l = 0; l < 3; ++l){
+    if(optData->s.matrix[2+l]){
+      ANALYTIC_JACOBIAN *jac = w->analyticJacobians + optData->s.indexABCD[2+l];
+      memcpy(w->tmpVars[l], jac->tmpVars, jac->sizeTmpVars*sizeof(modelica_real));
+      jac->tmpVars = w->tmpVars[l];
+      jac->resultVars = w->resultVars[l];
+    }
+  }
+
+  w->optData = *optData;
+  w->optData.data = &w->data;
+  w->optData.threads.pool = NULL;
+  w->optData.tmpJ = w->tmpJ;
+  w->optData.H = w->H;
+  w->optData.Hl = w->Hl;
+}
+
+/*!
+ *  evaluates task for the collocation intervals 0 ... nsi-2 with the threads of optData
+ *  returns 0 if the evaluation failed in a thread
+ **/
+modelica_boolean evalIntervalsParallel(OptData *optData, OPT_INTERVAL_TASK task, void *arg){
+  OPT_THREAD_POOL *pool = optData->threads.pool;
+  const int n = optData->dim.nsi - 1;
+  int w;
+
+  pool->task = task;
+  pool->arg = arg;
+  pool->failed = 0;
+
+  for(w = 0; w < pool->numWorkers; ++w){
+    OPT_THREAD_WORKER *worker = pool->workers + w;
+    optWorkerSync(worker, optData);
+    worker->first = n*w/pool->numWorkers;
+    worker->last = n*(w + 1)/pool->numWorkers;
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  pool->running = pool->numWorkers - 1;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->mutex);
+
+  optWorkerRun(pool->workers, optData->data->threadData);
+
+  pthread_mutex_lock(&pool->mutex);
+  while(pool->running > 0)
+    pthread_cond_wait(&pool->finished, &pool->mutex);
+  pthread_mutex_unlock(&pool->mutex);
+
+  return !pool->failed;
+}
+
+/*!
+ *  starts the threads for the collocation intervals if FLAG_OPTIMIZER_THREADS is set
+ **/
+void allocateOptimizerThreads(OptData *optData){
+  DATA * data = optData->data;
+  const MODEL_DATA *mData = &(data->modelData);
+  const int nv = optData->dim.nv;
+  const int nJ = optData->dim.nJ;
+  const int nJ2 = optData->dim.nJ2;
+  OPT_THREAD_POOL *pool;
+  int numThreads, w, k, l;
+
+  optData->threads.pool = NULL;
+  if(!omc_flag[FLAG_OPTIMIZER_THREADS] || (numThreads = atoi(omc_flagValue[FLAG_OPTIMIZER_THREADS])) < 2)
+    return;
+
+  /* the solvers of algebraic systems keep their iteration data in SIMULATION_INFO */
+  if(mData->nLinearSystems || mData->nNonLinearSystems || mData->nMixedSystems){
+    warningStreamPrint(LOG_STDOUT, 0, "The flag \"%s\" is ignored, the collocation intervals are evaluated sequentially since the model contains algebraic systems.", FLAG_NAME[FLAG_OPTIMIZER_THREADS]);
+    return;
+  }
+
+  /* every interval starts from the discrete state of the first one, the
+   * state carried over from the previous interval is only known sequentially */
+  if(mData->nRelations || mData->nVariablesInteger || mData->nVariablesBoolean){
+    warningStreamPrint(LOG_STDOUT, 0, "The flag \"%s\" is ignored, the collocation intervals are evaluated sequentially since the model contains relations or discrete variables.", FLAG_NAME[FLAG_OPTIMIZER_THREADS]);
+    return;
+  }
+
+  if(numThreads > optData->dim.nsi - 1)
+    numThreads = optData->dim.nsi - 1;
+  if(numThreads < 2)
+    return;
+
+  pool = (OPT_THREAD_POOL*) calloc(1, sizeof(OPT_THREAD_POOL));
+  assertStreamPrint(data->threadData, 0 != pool, "out of memory");
+  pool->numLocalData = ringBufferLength(data->simulationData);
+  pool->numWorkers = numThreads;
+  pool->workers = (OPT_THREAD_WORKER*) calloc(numThreads, sizeof(OPT_THREAD_WORKER));
+  assertStreamPrint(data->threadData, 0 != pool->workers, "out of memory");
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->finished, NULL);
+
+  for(w = 0; w < numThreads; ++w){
+    OPT_THREAD_WORKER *worker = pool->workers + w;
+    worker->pool = pool;
+    worker->id = w;
+    worker->localData = (SIMULATION_DATA**) malloc(pool->numLocalData*sizeof(SIMULATION_DATA*));
+    worker->realVars = (modelica_real*) calloc(mData->nVariablesReal, sizeof(modelica_real));
+    worker->integerVars = (modelica_integer*) calloc(mData->nVariablesInteger, sizeof(modelica_integer));
+    worker->booleanVars = (modelica_boolean*) calloc(mData->nVariablesBoolean, sizeof(modelica_boolean));
+    worker->stringVars = (modelica_string*) GC_malloc_uncollectable(mData->nVariablesString*sizeof(modelica_string));
+    worker->realVarsPre = (modelica_real*) calloc(mData->nVariablesReal, sizeof(modelica_real));
+    worker->integerVarsPre = (modelica_integer*) calloc(mData->nVariablesInteger, sizeof(modelica_integer));
+    worker->booleanVarsPre = (modelica_boolean*) calloc(mData->nVariablesBoolean, sizeof(modelica_boolean));
+    worker->relations = (modelica_boolean*) calloc(mData->nRelations, sizeof(modelica_boolean));
+    worker->relationsPre = (modelica_boolean*) calloc(mData->nRelations, sizeof(modelica_boolean));
+    worker->storedRelations = (modelica_boolean*) calloc(mData->nRelations, sizeof(modelica_boolean));
+    worker->mathEventsValuePre = (modelica_real*) calloc(mData->nMathEvents, sizeof(modelica_real));
+    worker->inputVars = (modelica_real*) calloc(mData->nInputVars, sizeof(modelica_real));
+    worker->analyticJacobians = (ANALYTIC_JACOBIAN*) malloc(mData->nJacobians*sizeof(ANALYTIC_JACOBIAN));
+    assertStreamPrint(data->threadData, 0 != worker->localData && 0 != worker->realVars && 0 != worker->analyticJacobians, "out of memory");
+
+    for(l = 0; l < 3; ++l){
+      if(optData->s.matrix[2+l]){
+        const ANALYTIC_JACOBIAN *jac = data->simulationInfo.analyticJacobians + optData->s.indexABCD[2+l];
+        worker->resultVars[l] = (modelica_real*) calloc(jac->sizeRows, sizeof(modelica_real));
+        worker->tmpVars[l] = (modelica_real*) calloc(jac->sizeTmpVars, sizeof(modelica_real));
+      }
+    }
+
+    worker->tmpJ = (modelica_real**) malloc(nJ2*sizeof(modelica_real*));
+    for(k = 0; k < nJ2; ++k)
+      worker->tmpJ[k] = (modelica_real*) calloc(nv, sizeof(modelica_real));
+    worker->H = (long double ***) malloc(nJ*sizeof(long double**));
+    for(k = 0; k < nJ; ++k){
+      worker->H[k] = (long double **) malloc(nv*sizeof(long double*));
+      for(l = 0; l < nv; ++l)
+        worker->H[k][l] = (long double *) calloc(nv, sizeof(long double));
+    }
+    worker->Hl = (long double **) malloc(nv*sizeof(long double*));
+    for(l = 0; l < nv; ++l)
+      worker->Hl[l] = (long double *) calloc(nv, sizeof(long double));
+
+    if(w > 0 && pthread_create(&worker->thread, NULL, optWorkerThread, worker))
+      throwStreamPrint(data->threadData, "Could not create the thread %d for the evaluation of the collocation intervals.", w);
+  }
+
+  optData->threads.pool = pool;
+  optData->threads.verifyModelData = 1;
+  optData->threads.verifyHessian = 1;
+  infoStreamPrint(LOG_SOLVER, 0, "the %d collocation intervals are evaluated by %d threads", optData->dim.nsi, numThreads);
+}
+
+/*!
+ *  stops the threads for the collocation intervals
+ **/
+void freeOptimizerThreads(OptData *optData){
+  OPT_THREAD_POOL *pool = optData->threads.pool;
+  const int nv = optData->dim.nv;
+  const int nJ = optData->dim.nJ;
+  const int nJ2 = optData->dim.nJ2;
+  int w, k, l;
+
+  if(!pool)
+    return;
+
+  pthread_mutex_lock(&pool->mutex);
+  pool->shutdown = 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for(w = 0; w < pool->numWorkers; ++w){
+    OPT_THREAD_WORKER *worker = pool->workers + w;
+    if(w > 0)
+      pthread_join(worker->thread, NULL);
+    free(worker->localData);
+    free(worker->realVars);
+    free(worker->integerVars);
+    free(worker->booleanVars);
+    GC_free(worker->stringVars);
+    free(worker->realVarsPre);
+    free(worker->integerVarsPre);
+    free(worker->booleanVarsPre);
+    free(worker->relations);
+    free(worker->relationsPre);
+    free(worker->storedRelations);
+    free(worker->mathEventsValuePre);
+    free(worker->inputVars);
+    free(worker->analyticJacobians);
+    for(l = 0; l < 3; ++l){
+      free(worker->resultVars[l]);
+      free(worker->tmpVars[l]);
+    }
+    for(k = 0; k < nJ2; ++k)
+      free(worker->tmpJ[k]);
+    free(worker->tmpJ);
+    for(k = 0; k < nJ; ++k){
+      for(l = 0; l < nv; ++l)
+        free(worker->H[k][l]);
+      free(worker->H[k]);
+    }
+    free(worker->H);
+    for(l = 0; l < nv; ++l)
+      free(worker->Hl[l]);
+    free(worker->Hl);
+  }
+
+  pthread_cond_destroy(&pool->finished);
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool->workers);
+  free(pool);
+  optData->threads.pool = NULL;
+}
+
 /*!
  *  pick up start values from csv for states
  *  author: Vitalij Ruge
@@ -150,6 +150,11 @@ typedef struct OptDataStructure{
   int indexABCD[5];
 }OptDataStructure;
 
+typedef struct OptDataThreads{
+  struct OPT_THREAD_POOL *pool;        /* NULL if the collocation intervals are evaluated sequentially */
+  modelica_boolean verifyModelData;    /* compare the next parallel evaluation with the sequential one */
+  modelica_boolean verifyHessian;
+}OptDataThreads;
 
 typedef struct OptData{
   OptDataDim dim;
@@ -158,6 +163,7 @@ typedef struct OptData{
   OptDataRK rk;
   OptDataStructure s;
   OptDataIpopt ipop;
+  OptDataThreads threads;
 
   modelica_real ***v;
   modelica_real *v0;
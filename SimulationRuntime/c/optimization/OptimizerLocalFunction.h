@@ -47,6 +47,12 @@ void optData2ModelData(OptData *optData, double *vopt, const int index);
 void diffSynColoredOptimizerSystem(OptData *optData, modelica_real **J, const int i, const int j, const int index);
 void diffSynColoredOptimizerSystemF(OptData *optData, modelica_real **J);
 
+/* evaluates the collocation interval i with the private copy optData of a thread */
+typedef void (*OPT_INTERVAL_TASK)(OptData *optData, const int i, void *arg);
+void allocateOptimizerThreads(OptData *optData);
+void freeOptimizerThreads(OptData *optData);
+modelica_boolean evalIntervalsParallel(OptData *optData, OPT_INTERVAL_TASK task, void *arg);
+
 /*ipopt*/
 
 #ifdef __cplusplus
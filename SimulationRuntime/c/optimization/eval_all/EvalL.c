@@ -41,6 +41,17 @@ static inline void num_hessian1(double * v, const double * const lambda, const d
 static inline void sumLagrange1(const int i, const int j, double * res,  const modelica_boolean upC, const modelica_boolean upC2, OptData *optData);
 #define DF_STEP(v) (1e-5*fabsl(v) + 1e-8)
 
+typedef struct OPT_HESSIAN_ARG{
+  double * vopt;
+  double * lambda;
+  double obj_factor;
+  double * values;
+  modelica_boolean upC;
+}OPT_HESSIAN_ARG;
+
+static modelica_boolean evalHessian(OptData *optData, OPT_HESSIAN_ARG *arg, const modelica_boolean parallel);
+static void hessianInterval(OptData *optData, const int ii, void *arg);
+
 /* eval hessian
  * author: Vitalij Ruge
  */
@@ -121,69 +132,47 @@ Bool ipopt_h(int n, double *vopt, Bool new_x, double obj_factor, int m, double *
   }else if(keepH){
     memcpy(values,optData->oldH,nele_hess*sizeof(double));
   }else{
-    int ii, p, i, j, k;
-    double * v;
-    double * la;
-    const int nJ = optData->dim.nJ;
-    modelica_boolean upC;
-    modelica_boolean upC2;
-    const int nBoolean = optData->data->modelData.nVariablesBoolean;
-    const int nInteger = optData->data->modelData.nVariablesInteger;
-    const int nReal = optData->dim.nReal;
-    const int nRelations =  optData->data->modelData.nRelations;
-    DATA * data = optData->data;
-
-    upC = obj_factor != 0;
+    OptDataThreads * threads = &optData->threads;
+    OPT_HESSIAN_ARG arg;
+
     /*
     if(new_x){
       optData2ModelData(optData, vopt, 1);
     }
     */
     optData->dim.iter_updateHessian = 0;
-    upC2 = upC && optData->s.mayer;
-    upC = upC && optData->s.lagrange;
-
-    memcpy(data->localData[0]->integerVars, optData->i0, nInteger*sizeof(modelica_integer));
-    memcpy(data->localData[0]->booleanVars, optData->b0, nBoolean*sizeof(modelica_boolean));
-    memcpy(data->simulationInfo.integerVarsPre, optData->i0Pre, nInteger*sizeof(modelica_integer));
-    memcpy(data->simulationInfo.booleanVarsPre, optData->b0Pre, nBoolean*sizeof(modelica_boolean));
-    memcpy(data->simulationInfo.realVarsPre, optData->v0Pre, nReal*sizeof(modelica_real));
-    memcpy(data->simulationInfo.relationsPre, optData->rePre, nRelations*sizeof(modelica_boolean));
-    memcpy(data->simulationInfo.relations, optData->re, nRelations*sizeof(modelica_boolean));
-
-    for(ii = 0, k = 0, v = vopt, la = lambda; ii + 1 < nsi; ++ii){
-      for(p = 1; p < np1; ++p, v += nv, la += nJ){
-        num_hessian0(v, la, obj_factor, optData, ii, p-1);
-        /*******************/
-        for(i = 0; i < nv; ++i){
-          for(j = 0; j < i + 1; ++j){
-            if(optData->s.H0[i][j]){
-              sumLagrange0(i, j, values + (k++),upC,optData);
-            }
-          }
-        }
-        /*******************/
+    arg.vopt = vopt;
+    arg.lambda = lambda;
+    arg.obj_factor = obj_factor;
+    arg.values = values;
+
+    if(!threads->pool){
+      evalHessian(optData, &arg, 0);
+    }else if(!threads->verifyHessian){
+      /* repeat the evaluation sequentially if it failed in a thread */
+      if(!evalHessian(optData, &arg, 1))
+        evalHessian(optData, &arg, 0);
+    }else{
+      /* the parallel result has to be bit-identical to the sequential one */
+      double * check = (double*) malloc(nele_hess*sizeof(double));
+      modelica_boolean scc;
+
+      assertStreamPrint(optData->data->threadData, 0 != check, "out of memory");
+      scc = evalHessian(optData, &arg, 1);
+      memcpy(check, values, nele_hess*sizeof(double));
+      evalHessian(optData, &arg, 0);
+
+      if(scc && memcmp(check, values, nele_hess*sizeof(double))){
+        warningStreamPrint(LOG_STDOUT, 0, "The hessian evaluated by threads differs from the sequential evaluation, "
+                           "the collocation intervals are evaluated sequentially from now on.");
+        freeOptimizerThreads(optData);
+      }else if(scc){
+        infoStreamPrint(LOG_SOLVER, 0, "the hessian evaluated by threads is identical to the sequential evaluation");
+        threads->verifyHessian = 0;
       }
+      free(check);
     }
-    /*******************/
-    for(p = 1; p < np1; ++p, v += nv, la += nJ){
-      num_hessian1(v, la, obj_factor, optData, ii, p-1);
-      /*******************/
-      for(i = 0; i < nv; ++i){
-        for(j = 0; j < i + 1; ++j){
-          if(optData->s.H1[i][j] && np == p){
-            sumLagrange1(i, j, values + (k++),upC, upC2,optData);
-          }else if(optData->s.H0[i][j]){
-            sumLagrange0(i, j, values + (k++),upC,optData);
-          }
-        }
-      }
-      /*******************/
 
-      /*for(i=0; i< nele_hess; ++i){
-        printf("values[%i] = %g\n",i,values[i]);
-      }*/
-    }
     if(optData->dim.updateHessian > 0)
       memcpy(optData->oldH, values, nele_hess*sizeof(double));
   }
@@ -192,6 +181,100 @@ Bool ipopt_h(int n, double *vopt, Bool new_x, double obj_factor, int m, double *
   return TRUE;
 }
 
+/* eval hessian
+ * returns 0 if the evaluation failed in a thread
+ */
+static modelica_boolean evalHessian(OptData *optData, OPT_HESSIAN_ARG *arg, const modelica_boolean parallel){
+  const int np = optData->dim.np;
+  const int np1 = np + 1;
+  const int nv = optData->dim.nv;
+  const int nsi = optData->dim.nsi;
+  const int nJ = optData->dim.nJ;
+  const int nBoolean = optData->data->modelData.nVariablesBoolean;
+  const int nInteger = optData->data->modelData.nVariablesInteger;
+  const int nReal = optData->dim.nReal;
+  const int nRelations =  optData->data->modelData.nRelations;
+  DATA * data = optData->data;
+
+  int ii, p, i, j, k;
+  double * v;
+  double * la;
+  modelica_boolean upC;
+  modelica_boolean upC2;
+  modelica_boolean scc = 1;
+
+  upC = arg->obj_factor != 0;
+  upC2 = upC && optData->s.mayer;
+  upC = upC && optData->s.lagrange;
+  arg->upC = upC;
+
+  memcpy(data->localData[0]->integerVars, optData->i0, nInteger*sizeof(modelica_integer));
+  memcpy(data->localData[0]->booleanVars, optData->b0, nBoolean*sizeof(modelica_boolean));
+  memcpy(data->simulationInfo.integerVarsPre, optData->i0Pre, nInteger*sizeof(modelica_integer));
+  memcpy(data->simulationInfo.booleanVarsPre, optData->b0Pre, nBoolean*sizeof(modelica_boolean));
+  memcpy(data->simulationInfo.realVarsPre, optData->v0Pre, nReal*sizeof(modelica_real));
+  memcpy(data->simulationInfo.relationsPre, optData->rePre, nRelations*sizeof(modelica_boolean));
+  memcpy(data->simulationInfo.relations, optData->re, nRelations*sizeof(modelica_boolean));
+
+  if(parallel){
+    scc = evalIntervalsParallel(optData, hessianInterval, arg);
+  }else{
+    for(ii = 0; ii + 1 < nsi; ++ii)
+      hessianInterval(optData, ii, arg);
+  }
+
+  /*******************/
+  ii = nsi - 1;
+  k = ii*np*optData->dim.nH0_;
+  v = arg->vopt + ii*np*nv;
+  la = arg->lambda + ii*np*nJ;
+  for(p = 1; p < np1; ++p, v += nv, la += nJ){
+    num_hessian1(v, la, arg->obj_factor, optData, ii, p-1);
+    /*******************/
+    for(i = 0; i < nv; ++i){
+      for(j = 0; j < i + 1; ++j){
+        if(optData->s.H1[i][j] && np == p){
+          sumLagrange1(i, j, arg->values + (k++),upC, upC2,optData);
+        }else if(optData->s.H0[i][j]){
+          sumLagrange0(i, j, arg->values + (k++),upC,optData);
+        }
+      }
+    }
+    /*******************/
+  }
+
+  return scc;
+}
+
+/* eval hessian for the collocation points of the interval ii, which is not the last one
+ */
+static void hessianInterval(OptData *optData, const int ii, void *arg){
+  const OPT_HESSIAN_ARG * const a = (const OPT_HESSIAN_ARG*) arg;
+  const int np = optData->dim.np;
+  const int np1 = np + 1;
+  const int nv = optData->dim.nv;
+  const int nJ = optData->dim.nJ;
+  int p, i, j, k;
+  double * v;
+  double * la;
+
+  k = ii*np*optData->dim.nH0_;
+  v = a->vopt + ii*np*nv;
+  la = a->lambda + ii*np*nJ;
+  for(p = 1; p < np1; ++p, v += nv, la += nJ){
+    num_hessian0(v, la, a->obj_factor, optData, ii, p-1);
+    /*******************/
+    for(i = 0; i < nv; ++i){
+      for(j = 0; j < i + 1; ++j){
+        if(optData->s.H0[i][j]){
+          sumLagrange0(i, j, a->values + (k++),a->upC,optData);
+        }
+      }
+    }
+    /*******************/
+  }
+}
+
 /* numerical approximation
  *  hessian
  * author: Vitalij Ruge
@@ -246,8 +329,8 @@ static inline void num_hessian0(double * v, const double * const lambda,
     for(jj = 0; jj <ii+1; ++jj){
       if(optData->s.H0[ii][jj]){
         for(l = 0; l < nJ; ++l){
-          if(optData->s.Hg[l][ii][jj] && lambda[l] != 0)
-              optData->H[l][ii][jj] = (long double)(optData->tmpJ[l][jj] - optData->J[i][j][l][jj])*lambda[l]/h;
+          if(optData->s.Hg[l][ii][jj])
+            optData->H[l][ii][jj] = (lambda[l] != 0) ? (long double)(optData->tmpJ[l][jj] - optData->J[i][j][l][jj])*lambda[l]/h : 0.0;
         }
       }
     }
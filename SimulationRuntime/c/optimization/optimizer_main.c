@@ -50,6 +50,7 @@ int runOptimizer(DATA* data, SOLVER_INFO* solverInfo){
 
   initial_guess_optimizer(optData, solverInfo);
   allocate_der_struct(&optData->s, &optData->dim ,data, optData);
+  allocateOptimizerThreads(optData);
 
   optimizationWithIpopt(optData);
   res2file(optData, solverInfo, optData->ipop.vopt);
@@ -228,6 +229,7 @@ static inline void freeOptimizerData(OptData*optData){
 
   int i,j,k;
 
+  freeOptimizerThreads(optData);
   /*************************/
   for(i=0; i < nsi; ++i)
     free(optData->time.t[i]);
@@ -29,6 +29,7 @@
  */
 
 #include "simulation_result.h"
+#include "util/rtclock.h"
 
 extern "C" {
 
@@ -46,6 +47,17 @@ simulation_result sim_result = {
   sim_result_doNothing, /* emit */
   sim_result_doNothing, /* writeParam */
   sim_result_doNothing, /* free */
+  sim_result_doNothing, /* flush */
+  NULL, /* writeRow */
 };
 
+double sim_result_cpuTime(void)
+{
+  double cpuTimeValue;
+  rt_accumulate(SIM_TIMER_TOTAL);
+  cpuTimeValue = rt_accumulated(SIM_TIMER_TOTAL);
+  rt_tick(SIM_TIMER_TOTAL);
+  return cpuTimeValue;
+}
+
 }
@@ -47,10 +47,16 @@ typedef struct simulation_result {
   void (*emit)(struct simulation_result*,DATA*);
   void (*writeParameterData)(struct simulation_result*,DATA*);
   void (*free)(struct simulation_result*,DATA*);
+  void (*flush)(struct simulation_result*,DATA*); /* blocks until all emitted points are written */
+  void (*writeRow)(struct simulation_result*,DATA*,double); /* emit() without timer accounting, gets the $cpuTime value; NULL if not supported */
 } simulation_result;
 
 extern simulation_result sim_result;
 
+/* $cpuTime of the current output point; restarts SIM_TIMER_TOTAL, so it
+ * has to be called once per point on the solver thread. */
+double sim_result_cpuTime(void);
+
 #ifdef __cplusplus
 }
 #endif /* cplusplus */
@@ -0,0 +1,318 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+
+#include "util/omc_error.h"
+#include "simulation_result_async.h"
+#include "meta/meta_modelica.h"
+#include "util/rtclock.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <pthread.h>
+
+/* One buffered time point. The arrays point into the per-type blocks owned
+ * by async_data. */
+typedef struct async_slot {
+  modelica_real timeValue;
+  double cpuTimeValue;            /* $cpuTime, read by the solver thread when the point was queued */
+  modelica_real *realVars;
+  modelica_integer *integerVars;
+  modelica_boolean *booleanVars;
+  modelica_string *stringVars;
+} async_slot;
+
+typedef struct async_data {
+  simulation_result inner;        /* the wrapped backend */
+  DATA writerData;                /* shallow copy of DATA used by the writer thread */
+  SIMULATION_DATA writerSimData;  /* localData[0] of writerData, pointed at the slot being written */
+  SIMULATION_DATA *writerLocalData[1];
+
+  async_slot *slots;
+  unsigned long numSlots;
+  modelica_real *realBlock;
+  modelica_integer *integerBlock;
+  modelica_boolean *booleanBlock;
+  modelica_string *stringBlock;   /* GC-visible, the strings are still referenced */
+
+  /* Ring indices only ever grow; slot = index % numSlots.
+   * head is stored by the solver thread only (release, after filling the
+   * slot), tail by the writer thread only (release, after writing the slot);
+   * the other side loads them with acquire. */
+  unsigned long head;
+  unsigned long tail;
+  int producerWaiting;
+  int consumerWaiting;
+  int stop;                       /* only accessed with the mutex held */
+  int failed;
+
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t notFull;
+  pthread_cond_t notEmpty;
+
+  unsigned long stalls;           /* number of times the solver waited for a free slot */
+} async_data;
+
+static unsigned long async_pending(async_data *ad)
+{
+  return __atomic_load_n(&ad->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ad->tail, __ATOMIC_ACQUIRE);
+}
+
+static int async_failed(async_data *ad)
+{
+  return __atomic_load_n(&ad->failed, __ATOMIC_ACQUIRE);
+}
+
+/* Publishes a new ring index and wakes the other side if it announced that
+ * it sleeps. The fence orders the index store before the flag load and pairs
+ * with the one in the waiting functions below, so that either the sleeper
+ * sees the new index or we see its flag. */
+static void async_publish(async_data *ad, unsigned long *index, unsigned long value, int *waiting, pthread_cond_t *cond)
+{
+  __atomic_store_n(index, value, __ATOMIC_RELEASE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(waiting, __ATOMIC_RELAXED)) {
+    pthread_mutex_lock(&ad->mutex);
+    pthread_cond_signal(cond);
+    pthread_mutex_unlock(&ad->mutex);
+  }
+}
+
+/* Solver side: block until at most maxPending points are queued. */
+static void async_wait_pending(async_data *ad, unsigned long maxPending)
+{
+  if (async_pending(ad) <= maxPending || async_failed(ad)) {
+    return;
+  }
+  pthread_mutex_lock(&ad->mutex);
+  __atomic_store_n(&ad->producerWaiting, 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  while (async_pending(ad) > maxPending && !async_failed(ad)) {
+    pthread_cond_wait(&ad->notFull, &ad->mutex);
+  }
+  __atomic_store_n(&ad->producerWaiting, 0, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&ad->mutex);
+}
+
+/* Writer side: block until a point is queued. Returns 0 once stopped and drained. */
+static int async_wait_queued(async_data *ad)
+{
+  int queued;
+  if (async_pending(ad)) {
+    return 1;
+  }
+  pthread_mutex_lock(&ad->mutex);
+  __atomic_store_n(&ad->consumerWaiting, 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  while (!async_pending(ad) && !ad->stop) {
+    pthread_cond_wait(&ad->notEmpty, &ad->mutex);
+  }
+  __atomic_store_n(&ad->consumerWaiting, 0, __ATOMIC_RELAXED);
+  queued = async_pending(ad) != 0;
+  pthread_mutex_unlock(&ad->mutex);
+  return queued;
+}
+
+static void async_writer_failed(async_data *ad)
+{
+  pthread_mutex_lock(&ad->mutex);
+  __atomic_store_n(&ad->failed, 1, __ATOMIC_RELEASE);
+  pthread_cond_signal(&ad->notFull);
+  pthread_mutex_unlock(&ad->mutex);
+}
+
+/* The writer only calls the backend's writeRow(), which does not touch the
+ * rt-clocks; all timing is done by the solver thread in async_emit(). */
+static void* async_writer(void *arg)
+{
+  async_data *ad = (async_data*) arg;
+
+  MMC_TRY_TOP()
+  ad->writerData.threadData = threadData;
+  while (async_wait_queued(ad)) {
+    unsigned long tail = __atomic_load_n(&ad->tail, __ATOMIC_RELAXED);
+    async_slot *slot = ad->slots + tail % ad->numSlots;
+    ad->writerSimData.timeValue = slot->timeValue;
+    ad->writerSimData.realVars = slot->realVars;
+    ad->writerSimData.integerVars = slot->integerVars;
+    ad->writerSimData.booleanVars = slot->booleanVars;
+    ad->writerSimData.stringVars = slot->stringVars;
+    ad->inner.writeRow(&ad->inner, &ad->writerData, slot->cpuTimeValue);
+    async_publish(ad, &ad->tail, tail + 1, &ad->producerWaiting, &ad->notFull);
+  }
+  MMC_CATCH_TOP(async_writer_failed(ad))
+
+  return NULL;
+}
+
+static void async_check(async_data *ad, DATA *data)
+{
+  if (async_failed(ad)) {
+    throwStreamPrint(data->threadData, "Writing the result file failed in the output thread.");
+  }
+}
+
+static void async_emit(simulation_result *self, DATA *data)
+{
+  async_data *ad = (async_data*) self->storage;
+  const MODEL_DATA *mData = &(data->modelData);
+  const SIMULATION_DATA *sData = data->localData[0];
+  unsigned long head = __atomic_load_n(&ad->head, __ATOMIC_RELAXED);
+  async_slot *slot;
+
+  rt_tick(SIM_TIMER_OUTPUT);
+  if (async_pending(ad) >= ad->numSlots) {
+    ad->stalls++;
+    async_wait_pending(ad, ad->numSlots - 1);
+  }
+  async_check(ad, data);
+
+  slot = ad->slots + head % ad->numSlots;
+  slot->timeValue = sData->timeValue;
+  slot->cpuTimeValue = sim_result_cpuTime();
+  memcpy(slot->realVars, sData->realVars, sizeof(modelica_real) * mData->nVariablesReal);
+  memcpy(slot->integerVars, sData->integerVars, sizeof(modelica_integer) * mData->nVariablesInteger);
+  memcpy(slot->booleanVars, sData->booleanVars, sizeof(modelica_boolean) * mData->nVariablesBoolean);
+  memcpy(slot->stringVars, sData->stringVars, sizeof(modelica_string) * mData->nVariablesString);
+
+  async_publish(ad, &ad->head, head + 1, &ad->consumerWaiting, &ad->notEmpty);
+  rt_accumulate(SIM_TIMER_OUTPUT);
+}
+
+static void async_flush(simulation_result *self, DATA *data)
+{
+  async_data *ad = (async_data*) self->storage;
+  async_wait_pending(ad, 0);
+  async_check(ad, data);
+  ad->inner.flush(&ad->inner, data);
+}
+
+/* Parameters are written by the solver thread once the writer is idle,
+ * which keeps the backend's file accesses ordered. */
+static void async_writeParameterData(simulation_result *self, DATA *data)
+{
+  async_data *ad = (async_data*) self->storage;
+  async_wait_pending(ad, 0);
+  async_check(ad, data);
+  ad->inner.writeParameterData(&ad->inner, data);
+}
+
+static void async_release(async_data *ad)
+{
+  pthread_cond_destroy(&ad->notEmpty);
+  pthread_cond_destroy(&ad->notFull);
+  pthread_mutex_destroy(&ad->mutex);
+  free(ad->slots);
+  free(ad->realBlock);
+  free(ad->integerBlock);
+  free(ad->booleanBlock);
+  GC_free(ad->stringBlock);
+  free(ad);
+}
+
+static void async_free(simulation_result *self, DATA *data)
+{
+  async_data *ad = (async_data*) self->storage;
+
+  pthread_mutex_lock(&ad->mutex);
+  ad->stop = 1;
+  pthread_cond_signal(&ad->notEmpty);
+  pthread_mutex_unlock(&ad->mutex);
+  pthread_join(ad->thread, NULL);
+
+  infoStreamPrint(LOG_STATS, 0, "output thread wrote %lu points, the solver waited %lu times for a free buffer slot", ad->tail, ad->stalls);
+  if (async_failed(ad)) {
+    warningStreamPrint(LOG_STDOUT, 0, "The result file may be incomplete, the output thread failed.");
+  }
+
+  *self = ad->inner;
+  async_release(ad);
+  self->free(self, data);
+}
+
+int omc_async_result_start(simulation_result *self, DATA *data, int numSlots)
+{
+  const MODEL_DATA *mData = &(data->modelData);
+  async_data *ad;
+  unsigned long i;
+
+  if (!self->writeRow) {
+    return 1;
+  }
+  if (numSlots < 2) {
+    numSlots = 2;
+  }
+
+  ad = (async_data*) calloc(1, sizeof(async_data));
+  if (!ad) {
+    return 1;
+  }
+  ad->inner = *self;
+  ad->writerData = *data;
+  ad->writerLocalData[0] = &ad->writerSimData;
+  ad->writerData.localData = ad->writerLocalData;
+  ad->numSlots = numSlots;
+
+  /* +1 keeps the blocks non-empty for models without variables of a type */
+  ad->slots = (async_slot*) calloc(numSlots, sizeof(async_slot));
+  ad->realBlock = (modelica_real*) malloc(sizeof(modelica_real) * (numSlots * mData->nVariablesReal + 1));
+  ad->integerBlock = (modelica_integer*) malloc(sizeof(modelica_integer) * (numSlots * mData->nVariablesInteger + 1));
+  ad->booleanBlock = (modelica_boolean*) malloc(sizeof(modelica_boolean) * (numSlots * mData->nVariablesBoolean + 1));
+  ad->stringBlock = (modelica_string*) GC_malloc_uncollectable(sizeof(modelica_string) * (numSlots * mData->nVariablesString + 1));
+
+  pthread_mutex_init(&ad->mutex, NULL);
+  pthread_cond_init(&ad->notFull, NULL);
+  pthread_cond_init(&ad->notEmpty, NULL);
+
+  if (!ad->slots || !ad->realBlock || !ad->integerBlock || !ad->booleanBlock || !ad->stringBlock) {
+    async_release(ad);
+    return 1;
+  }
+
+  for (i = 0; i < ad->numSlots; i++) {
+    ad->slots[i].realVars = ad->realBlock + i * mData->nVariablesReal;
+    ad->slots[i].integerVars = ad->integerBlock + i * mData->nVariablesInteger;
+    ad->slots[i].booleanVars = ad->booleanBlock + i * mData->nVariablesBoolean;
+    ad->slots[i].stringVars = ad->stringBlock + i * mData->nVariablesString;
+  }
+
+  if (pthread_create(&ad->thread, NULL, async_writer, ad)) {
+    async_release(ad);
+    return 1;
+  }
+
+  self->storage = ad;
+  self->emit = async_emit;
+  self->writeParameterData = async_writeParameterData;
+  self->flush = async_flush;
+  self->free = async_free;
+  return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+
+/*
+  Asynchronous result emission.
+
+  Wraps an already initialized result backend so that emit() only copies the
+  current time point into a single-producer/single-consumer ring buffer. A
+  writer thread drains the ring and calls the wrapped backend's writeRow(),
+  which does not touch the rt-clocks: $cpuTime and the output timer are read
+  by the solver thread when the point is queued. The solver blocks when the
+  ring is full (back-pressure); flush() and free() wait until every queued
+  point has been written.
+ */
+
+#ifndef _SIMULATION_RESULT_ASYNC_H
+#define _SIMULATION_RESULT_ASYNC_H
+
+#include "simulation_data.h"
+#include "simulation_result.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* cplusplus */
+
+/* Moves the backend currently installed in self behind a writer thread
+ * buffering up to numSlots time points. Returns 0 on success; on failure
+ * (or if the backend has no writeRow()) self is left untouched and results
+ * are written synchronously. */
+int omc_async_result_start(simulation_result *self, DATA *data, int numSlots);
+
+#ifdef __cplusplus
+}
+#endif /* cplusplus */
+
+#endif
@@ -49,7 +49,7 @@
 
 extern "C" {
 
-void omc_csv_emit(simulation_result *self, DATA *data)
+void omc_csv_writeRow(simulation_result *self, DATA *data, double cpuTimeValue)
 {
   FILE *fout = (FILE*) self->storage;
   const char* format = "%.16g,";
@@ -58,12 +58,6 @@ void omc_csv_emit(simulation_result *self, DATA *data)
   const char* formatstring = "\"%s\",";
   int i;
   modelica_real value = 0;
-  double cpuTimeValue = 0;
-  rt_tick(SIM_TIMER_OUTPUT);
-
-  rt_accumulate(SIM_TIMER_TOTAL);
-  cpuTimeValue = rt_accumulated(SIM_TIMER_TOTAL);
-  rt_tick(SIM_TIMER_TOTAL);
 
   fprintf(fout, format, data->localData[0]->timeValue);
   if(self->cpuTime)
@@ -109,6 +103,12 @@ void omc_csv_emit(simulation_result *self, DATA *data)
   }
   fseek(fout, -1, SEEK_CUR); // removes the eol comma separator
   fprintf(fout, "\n");
+}
+
+void omc_csv_emit(simulation_result *self, DATA *data)
+{
+  rt_tick(SIM_TIMER_OUTPUT);
+  omc_csv_writeRow(self, data, sim_result_cpuTime());
   rt_accumulate(SIM_TIMER_OUTPUT);
 }
 
@@ -40,6 +40,7 @@ extern "C" {
 
 void omc_csv_init(simulation_result *self,DATA *data);
 void omc_csv_emit(simulation_result *self,DATA *data);
+void omc_csv_writeRow(simulation_result *self,DATA *data,double cpuTimeValue);
 void omc_csv_free(simulation_result *self,DATA *data);
 
 #ifdef __cplusplus
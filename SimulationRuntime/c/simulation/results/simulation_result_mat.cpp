@@ -37,6 +37,7 @@
 #include <map>
 #include <string>
 #include <utility>
+#include <vector>
 #include <cstring>
 #include <cstdlib>
 #include <stdint.h>
@@ -62,8 +63,24 @@ typedef struct mat_data {
 
   unsigned int negatedboolaliases;
   int numVars;
+
+  std::vector<double> row; /* values of the current time point, in data_2 column order */
+
+  /* chunked output (mat4c_*): time points are buffered and written as column-major chunks */
+  std::vector<double> chunk; /* buffered time points, row-major */
+  std::vector<double> chunkTransposed;
+  unsigned long chunkSize; /* number of time points per chunk */
+  unsigned long chunkFill; /* number of time points in the buffer */
+  std::vector<double> chunkIndex; /* per chunk: file offset of its data, number of time points, first and last time */
 } mat_data;
 
+/* Size of the buffer for one chunk; it is bounded to [MAT4C_MIN_CHUNK_ROWS,MAT4C_MAX_CHUNK_ROWS] time points */
+#define MAT4C_CHUNK_BYTES (8*1024*1024)
+#define MAT4C_MIN_CHUNK_ROWS 64
+#define MAT4C_MAX_CHUNK_ROWS 65536
+/* Tile size for the transposition of a chunk */
+#define MAT4C_TILE 32
+
 long flattenStrBuf(int dims, const struct VAR_INFO** src, char* &dest, int& longest, int& nstrings, bool fixNames, bool useComment);
 void writeMatVer4MatrixHeader(simulation_result *self,DATA *data,const char *name, int rows, int cols, unsigned int size);
 void writeMatVer4Matrix(simulation_result *self,DATA *data,const char *name, int rows, int cols, const void *, unsigned int size);
@@ -190,13 +207,25 @@ void mat4_writeParameterData(simulation_result *self,DATA *data)
   }
 }
 
-void mat4_init(simulation_result *self,DATA *data)
+static int mat4_numColumns(simulation_result *self)
+{
+  mat_data *matData = (mat_data*) self->storage;
+  return matData->r_indx_map.size() + matData->i_indx_map.size() + matData->b_indx_map.size() + matData->negatedboolaliases + 1 /* add one more for timeValue*/ + self->cpuTime;
+}
+
+/* Writes everything up to and including data_1.
+ * The binTrans format continues with the data_2 header; the binChunked
+ * format writes its data_2 chunks as they fill up (see mat4c_emit).
+ */
+static void mat4_init_common(simulation_result *self,DATA *data,bool chunked)
 {
   mat_data *matData = new mat_data();
   self->storage = matData;
   const MODEL_DATA *mData = &(data->modelData);
 
-  const char Aclass[] = "A1 bt. ir1 na  Tj  re  ac  nt  so   r   y   ";
+  const char AclassTrans[] = "A1 bt. ir1 na  Tj  re  ac  nt  so   r   y   ";
+  const char AclassChunked[] = "A1 bt. ir1 na  Cj  he  uc  nt  ko  er  dy   ";
+  const char *Aclass = chunked ? AclassChunked : AclassTrans;
 
   const struct VAR_INFO** names = NULL;
   const int nParams = mData->nParametersReal + mData->nParametersInteger + mData->nParametersBoolean;
@@ -250,10 +279,19 @@ void mat4_init(simulation_result *self,DATA *data)
     /*  write `data_1' matrix */
     writeMatVer4Matrix(self,data,"data_1", cols, rows, doubleMatrix, sizeof(double));
 
-    /* remember data2HdrPos */
-    matData->data2HdrPos = matData->fp.tellp();
-    /* write `data_2' header */
-    writeMatVer4MatrixHeader(self,data,"data_2", matData->r_indx_map.size() + matData->i_indx_map.size() + matData->b_indx_map.size() + matData->negatedboolaliases + 1 /* add one more for timeValue*/ + self->cpuTime, 0, sizeof(double));
+    matData->row.resize(mat4_numColumns(self));
+    if(chunked) {
+      unsigned long rows = MAT4C_CHUNK_BYTES / (sizeof(double)*matData->row.size());
+      matData->chunkSize = rows < MAT4C_MIN_CHUNK_ROWS ? MAT4C_MIN_CHUNK_ROWS : (rows > MAT4C_MAX_CHUNK_ROWS ? MAT4C_MAX_CHUNK_ROWS : rows);
+      matData->chunkFill = 0;
+      matData->chunk.resize(matData->chunkSize*matData->row.size());
+      matData->chunkTransposed.resize(matData->chunkSize*matData->row.size());
+    } else {
+      /* remember data2HdrPos */
+      matData->data2HdrPos = matData->fp.tellp();
+      /* write `data_2' header */
+      writeMatVer4MatrixHeader(self,data,"data_2", mat4_numColumns(self), 0, sizeof(double));
+    }
 
     free(doubleMatrix);
     free(intMatrix);
@@ -276,6 +314,11 @@ void mat4_init(simulation_result *self,DATA *data)
   rt_accumulate(SIM_TIMER_OUTPUT);
 }
 
+void mat4_init(simulation_result *self,DATA *data)
+{
+  mat4_init_common(self, data, false);
+}
+
 void mat4_free(simulation_result *self,DATA *data)
 {
   mat_data *matData = (mat_data*) self->storage;
@@ -289,7 +332,7 @@ void mat4_free(simulation_result *self,DATA *data)
     try
     {
       matData->fp.seekp(matData->data2HdrPos);
-      writeMatVer4MatrixHeader(self,data,"data_2", matData->r_indx_map.size() + matData->i_indx_map.size() + matData->b_indx_map.size() + matData->negatedboolaliases + 1 /* add one more for timeValue*/ + self->cpuTime, matData->ntimepoints, sizeof(double));
+      writeMatVer4MatrixHeader(self,data,"data_2", mat4_numColumns(self), matData->ntimepoints, sizeof(double));
       matData->fp.close();
     }
     catch (...)
@@ -302,46 +345,127 @@ void mat4_free(simulation_result *self,DATA *data)
   rt_accumulate(SIM_TIMER_OUTPUT);
 }
 
-void mat4_emit(simulation_result *self,DATA *data)
+/* stores the values of the current time point in row, in data_2 column order */
+static void mat4_collectRow(simulation_result *self,DATA *data,double cpuTimeValue,double *row)
 {
-  mat_data *matData = (mat_data*) self->storage;
-  double datPoint=0;
-  rt_tick(SIM_TIMER_OUTPUT);
+  int k = 0;
 
-  rt_accumulate(SIM_TIMER_TOTAL);
-  double cpuTimeValue = rt_accumulated(SIM_TIMER_TOTAL);
-  rt_tick(SIM_TIMER_TOTAL);
-
-  /* this is done wrong -- a buffering should be used
-     although ofstream does have some buffering, but it is not enough and
-     not for this purpose */
-  matData->fp.write((char*)&(data->localData[0]->timeValue), sizeof(double));
+  row[k++] = data->localData[0]->timeValue;
   if(self->cpuTime)
-    matData->fp.write((char*)&cpuTimeValue, sizeof(double));
+    row[k++] = cpuTimeValue;
   for(int i = 0; i < data->modelData.nVariablesReal; i++) if(!data->modelData.realVarsData[i].filterOutput)
-    matData->fp.write((char*)&(data->localData[0]->realVars[i]),sizeof(double));
+    row[k++] = data->localData[0]->realVars[i];
   for(int i = 0; i < data->modelData.nVariablesInteger; i++) if(!data->modelData.integerVarsData[i].filterOutput)
-    {
-      datPoint = (double) data->localData[0]->integerVars[i];
-      matData->fp.write((char*)&datPoint,sizeof(double));
-    }
+    row[k++] = (double) data->localData[0]->integerVars[i];
   for(int i = 0; i < data->modelData.nVariablesBoolean; i++) if(!data->modelData.booleanVarsData[i].filterOutput)
-    {
-      datPoint = (double) data->localData[0]->booleanVars[i];
-      matData->fp.write((char*)&datPoint,sizeof(double));
-    }
+    row[k++] = (double) data->localData[0]->booleanVars[i];
   for(int i = 0; i < data->modelData.nAliasBoolean; i++) if(!data->modelData.booleanAlias[i].filterOutput)
     {
       if(data->modelData.booleanAlias[i].negate)
-      {
-        datPoint = (double) (data->localData[0]->booleanVars[data->modelData.booleanAlias[i].nameID]==1?0:1);
-        matData->fp.write((char*)&datPoint,sizeof(double));
-      }
+        row[k++] = (double) (data->localData[0]->booleanVars[data->modelData.booleanAlias[i].nameID]==1?0:1);
     }
+}
+
+void mat4_writeRow(simulation_result *self,DATA *data,double cpuTimeValue)
+{
+  mat_data *matData = (mat_data*) self->storage;
+
+  mat4_collectRow(self, data, cpuTimeValue, &matData->row[0]);
+  matData->fp.write((char*)&matData->row[0], sizeof(double)*matData->row.size());
   if (!matData->fp) {
     throwStreamPrint(data->threadData, "Error while writing file %s",self->filename);
   }
   ++matData->ntimepoints;
+}
+
+void mat4_emit(simulation_result *self,DATA *data)
+{
+  rt_tick(SIM_TIMER_OUTPUT);
+  mat4_writeRow(self, data, sim_result_cpuTime());
+  rt_accumulate(SIM_TIMER_OUTPUT);
+}
+
+/* Writes the buffered time points as one column-major data_2 chunk
+ * (mrows = time points, ncols = variables), so each variable of the
+ * chunk is stored contiguously. */
+static void mat4c_flushChunk(simulation_result *self,DATA *data)
+{
+  mat_data *matData = (mat_data*) self->storage;
+  const unsigned long nrows = matData->chunkFill;
+  const unsigned long ncols = matData->row.size();
+  const double *src = &matData->chunk[0];
+  double *dst = &matData->chunkTransposed[0];
+
+  if(nrows == 0)
+    return;
+
+  for(unsigned long r0 = 0; r0 < nrows; r0 += MAT4C_TILE)
+    for(unsigned long c0 = 0; c0 < ncols; c0 += MAT4C_TILE)
+      for(unsigned long r = r0; r < r0+MAT4C_TILE && r < nrows; r++)
+        for(unsigned long c = c0; c < c0+MAT4C_TILE && c < ncols; c++)
+          dst[c*nrows+r] = src[r*ncols+c];
+
+  /* the data follows the header and the name "data_2" */
+  std::ofstream::pos_type pos = matData->fp.tellp();
+  matData->chunkIndex.push_back((double)pos + 5*sizeof(uint32_t) + sizeof("data_2"));
+  matData->chunkIndex.push_back(nrows);
+  matData->chunkIndex.push_back(src[0]);
+  matData->chunkIndex.push_back(src[(nrows-1)*ncols]);
+  writeMatVer4Matrix(self,data,"data_2", nrows, ncols, dst, sizeof(double));
+  matData->chunkFill = 0;
+}
+
+void mat4c_init(simulation_result *self,DATA *data)
+{
+  mat4_init_common(self, data, true);
+}
+
+void mat4c_writeRow(simulation_result *self,DATA *data,double cpuTimeValue)
+{
+  mat_data *matData = (mat_data*) self->storage;
+
+  mat4_collectRow(self, data, cpuTimeValue, &matData->chunk[matData->chunkFill*matData->row.size()]);
+  ++matData->chunkFill;
+  ++matData->ntimepoints;
+  if(matData->chunkFill == matData->chunkSize) {
+    mat4c_flushChunk(self, data);
+  }
+}
+
+void mat4c_emit(simulation_result *self,DATA *data)
+{
+  rt_tick(SIM_TIMER_OUTPUT);
+  mat4c_writeRow(self, data, sim_result_cpuTime());
+  rt_accumulate(SIM_TIMER_OUTPUT);
+}
+
+void mat4c_free(simulation_result *self,DATA *data)
+{
+  mat_data *matData = (mat_data*) self->storage;
+  rt_tick(SIM_TIMER_OUTPUT);
+  if(matData->fp)
+  {
+    try
+    {
+      double indexPos;
+      mat4c_flushChunk(self, data);
+      if(matData->ntimepoints == 0) {
+        /* readers expect at least one data_2 matrix */
+        writeMatVer4MatrixHeader(self,data,"data_2", 0, matData->row.size(), sizeof(double));
+      }
+      /* the index footer: chunkIndex followed by the position of its header */
+      indexPos = (double) matData->fp.tellp();
+      writeMatVer4Matrix(self,data,"chunkIndex", 4, matData->chunkIndex.size()/4, matData->chunkIndex.empty() ? NULL : &matData->chunkIndex[0], sizeof(double));
+      writeMatVer4Matrix(self,data,"chunkIndexPos", 1, 1, &indexPos, sizeof(double));
+      matData->fp.close();
+    }
+    catch (...)
+    {
+      /* just ignore, we are in destructor */
+    }
+  }
+  delete matData;
+  self->storage = NULL;
   rt_accumulate(SIM_TIMER_OUTPUT);
 }
 
@@ -50,9 +50,20 @@ extern "C" {
 
 void mat4_init(simulation_result *self,DATA *data);
 void mat4_emit(simulation_result *self,DATA *data);
+void mat4_writeRow(simulation_result *self,DATA *data,double cpuTimeValue);
 void mat4_writeParameterData(simulation_result *self,DATA *data);
 void mat4_free(simulation_result *self,DATA *data);
 
+/* Chunked variant (Aclass binChunked): time points are buffered and
+ * written as column-major data_2 chunks, followed by a chunkIndex matrix
+ * (file offset, number of time points, first and last time of each chunk)
+ * and a 1x1 chunkIndexPos matrix holding the offset of chunkIndex.
+ */
+void mat4c_init(simulation_result *self,DATA *data);
+void mat4c_emit(simulation_result *self,DATA *data);
+void mat4c_writeRow(simulation_result *self,DATA *data,double cpuTimeValue);
+void mat4c_free(simulation_result *self,DATA *data);
+
 #ifdef __cplusplus
 }
 #endif /* cplusplus */
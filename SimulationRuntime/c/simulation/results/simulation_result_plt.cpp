@@ -58,7 +58,7 @@ typedef struct plt_data {
   int num_vars;
 } plt_data;
 
-static void add_result(simulation_result *self,DATA *data,double *data_, long *actualPoints);
+static void add_result(simulation_result *self,DATA *data,double cpuTimeValue,double *data_, long *actualPoints);
 static void deallocResult(plt_data *pltData);
 static void printPltLine(FILE* f, double time, double val);
 
@@ -80,12 +80,11 @@ static int calcDataSize(simulation_result *self,const MODEL_DATA *modelData)
   return sz;
 }
 
-void plt_emit(simulation_result *self,DATA *data)
+void plt_writeRow(simulation_result *self,DATA *data,double cpuTimeValue)
 {
   plt_data *pltData = (plt_data*) self->storage;
-  rt_tick(SIM_TIMER_OUTPUT);
   if(pltData->actualPoints < pltData->maxPoints) {
-      add_result(self,data,pltData->simulationResultData,&pltData->actualPoints); /*used for non-interactive simulation */
+      add_result(self,data,cpuTimeValue,pltData->simulationResultData,&pltData->actualPoints); /*used for non-interactive simulation */
   } else {
     pltData->maxPoints = (long)(1.4*pltData->maxPoints + (pltData->maxPoints-pltData->actualPoints) + 2000);
     /* cerr << "realloc simulationResultData to a size of " << maxPoints * dataSize * sizeof(double) << endl; */
@@ -93,8 +92,14 @@ void plt_emit(simulation_result *self,DATA *data)
     if(!pltData->simulationResultData) {
       throwStreamPrint(data->threadData, "Error allocating simulation result data of size %ld",pltData->maxPoints * pltData->dataSize);
     }
-    add_result(self,data,pltData->simulationResultData,&pltData->actualPoints);
+    add_result(self,data,cpuTimeValue,pltData->simulationResultData,&pltData->actualPoints);
   }
+}
+
+void plt_emit(simulation_result *self,DATA *data)
+{
+  rt_tick(SIM_TIMER_OUTPUT);
+  plt_writeRow(self, data, sim_result_cpuTime());
   rt_accumulate(SIM_TIMER_OUTPUT);
 }
 
@@ -102,16 +107,11 @@ void plt_emit(simulation_result *self,DATA *data)
  * add the values of one step for all variables to the data
  * array to be able to later store this on file.
  */
-static void add_result(simulation_result *self,DATA *data,double *data_, long *actualPoints)
+static void add_result(simulation_result *self,DATA *data,double cpuTimeValue,double *data_, long *actualPoints)
 {
   plt_data *pltData = (plt_data*) self->storage;
   const DATA *simData = data;
   int i;
-  double cpuTimeValue = 0;
-
-  rt_accumulate(SIM_TIMER_TOTAL);
-  cpuTimeValue = rt_accumulated(SIM_TIMER_TOTAL);
-  rt_tick(SIM_TIMER_TOTAL);
 
   {
     data_[pltData->currentPos++] = simData->localData[0]->timeValue;
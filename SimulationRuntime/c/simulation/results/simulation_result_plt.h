@@ -40,6 +40,7 @@ extern "C" {
 #if !defined(OMC_MINIMAL_RUNTIME)
 void plt_init(simulation_result *self,DATA *data);
 void plt_emit(simulation_result *self,DATA *data);
+void plt_writeRow(simulation_result *self,DATA *data,double cpuTimeValue);
 void plt_free(simulation_result *self,DATA *data);
 #endif
 
@@ -405,6 +405,12 @@ void recon_wall_emit(simulation_result *self,DATA *data)
   fp.seekp(end_pos);
 }
 
+/* the wall format has no $cpuTime column and emits without timers */
+void recon_wall_writeRow(simulation_result *self,DATA *data,double cpuTimeValue)
+{
+  recon_wall_emit(self, data);
+}
+
 void recon_wall_free(simulation_result *self,DATA *data)
 {
   wall_storage *storage = (wall_storage *)self->storage;
@@ -47,6 +47,7 @@ extern "C" {
 #if !defined(OMC_MINIMAL_RUNTIME)
 void recon_wall_init(simulation_result *self,DATA *data);
 void recon_wall_emit(simulation_result *self,DATA *data);
+void recon_wall_writeRow(simulation_result *self,DATA *data,double cpuTimeValue);
 void recon_wall_writeParameterData(simulation_result *self,DATA *data);
 void recon_wall_free(simulation_result *self,DATA *data);
 #endif
@@ -73,6 +73,7 @@
 #include "simulation/results/simulation_result_mat.h"
 #include "simulation/results/simulation_result_wall.h"
 #include "simulation/results/simulation_result_ia.h"
+#include "simulation/results/simulation_result_async.h"
 #include "simulation/solver/solver_main.h"
 #include "simulation_info_xml.h"
 #include "modelinfo.h"
@@ -304,6 +305,50 @@ int getNewtonStrategy(int argc, char**argv)
   return NEWTON_NONE;
 }
 
+int getEventLocator(int argc, char**argv)
+{
+  int i;
+  const char *cflags = omc_flagValue[FLAG_EVENT_LOCATOR];
+  const string *method = cflags ? new string(cflags) : NULL;
+
+  if(!method)
+    return EVENT_LOCATOR_BISECTION; /* default method */
+
+  for(i=1; i<EVENT_LOCATOR_MAX; ++i)
+    if(*method == EVENT_LOCATOR_NAME[i])
+      return i;
+
+  warningStreamPrint(LOG_STDOUT, 1, "unrecognized option -eventLocator=%s, current options are:", method->c_str());
+  for(i=1; i<EVENT_LOCATOR_MAX; ++i)
+    warningStreamPrint(LOG_STDOUT, 0, "%-18s [%s]", EVENT_LOCATOR_NAME[i], EVENT_LOCATOR_DESC[i]);
+  messageClose(LOG_STDOUT);
+  throwStreamPrint(NULL,"see last warning");
+
+  return EVENT_LOCATOR_UNKNOWN;
+}
+
+int getParmodautoScheduler(int argc, char**argv)
+{
+  int i;
+  const char *cflags = omc_flagValue[FLAG_PARMODAUTO_SCHEDULER];
+  const string *method = cflags ? new string(cflags) : NULL;
+
+  if(!method)
+    return PARMODAUTO_SCHEDULER_LEVEL; /* default method */
+
+  for(i=1; i<PARMODAUTO_SCHEDULER_MAX; ++i)
+    if(*method == PARMODAUTO_SCHEDULER_NAME[i])
+      return i;
+
+  warningStreamPrint(LOG_STDOUT, 1, "unrecognized option -parmodautoScheduler=%s, current options are:", method->c_str());
+  for(i=1; i<PARMODAUTO_SCHEDULER_MAX; ++i)
+    warningStreamPrint(LOG_STDOUT, 0, "%-18s [%s]", PARMODAUTO_SCHEDULER_NAME[i], PARMODAUTO_SCHEDULER_DESC[i]);
+  messageClose(LOG_STDOUT);
+  throwStreamPrint(NULL,"see last warning");
+
+  return PARMODAUTO_SCHEDULER_UNKNOWN;
+}
+
 /**
  * Read the variable filter and mark variables that should not be part of the result file.
  * This phase is skipped for interactive simulations
@@ -575,24 +620,35 @@ int initializeResultData(DATA* simData, int cpuTime)
   } else if(0 == strcmp("csv", MMC_STRINGDATA(simData->simulationInfo.outputFormat))) {
     sim_result.init = omc_csv_init;
     sim_result.emit = omc_csv_emit;
+    sim_result.writeRow = omc_csv_writeRow;
     /* sim_result.writeParameterData = omc_csv_writeParameterData; */
     sim_result.free = omc_csv_free;
   } else if(0 == strcmp("mat", MMC_STRINGDATA(simData->simulationInfo.outputFormat))) {
     sim_result.init = mat4_init;
     sim_result.emit = mat4_emit;
+    sim_result.writeRow = mat4_writeRow;
     sim_result.writeParameterData = mat4_writeParameterData;
     sim_result.free = mat4_free;
     resultFormatHasCheapAliasesAndParameters = 1;
+  } else if(0 == strcmp("matc", MMC_STRINGDATA(simData->simulationInfo.outputFormat))) {
+    sim_result.init = mat4c_init;
+    sim_result.emit = mat4c_emit;
+    sim_result.writeRow = mat4c_writeRow;
+    sim_result.writeParameterData = mat4_writeParameterData;
+    sim_result.free = mat4c_free;
+    resultFormatHasCheapAliasesAndParameters = 1;
 #if !defined(OMC_MINIMAL_RUNTIME)
   } else if(0 == strcmp("wall", MMC_STRINGDATA(simData->simulationInfo.outputFormat))) {
     sim_result.init = recon_wall_init;
     sim_result.emit = recon_wall_emit;
+    sim_result.writeRow = recon_wall_writeRow;
     sim_result.writeParameterData = recon_wall_writeParameterData;
     sim_result.free = recon_wall_free;
     resultFormatHasCheapAliasesAndParameters = 1;
   } else if(0 == strcmp("plt", MMC_STRINGDATA(simData->simulationInfo.outputFormat))) {
     sim_result.init = plt_init;
     sim_result.emit = plt_emit;
+    sim_result.writeRow = plt_writeRow;
     /* sim_result.writeParameterData = plt_writeParameterData; */
     sim_result.free = plt_free;
   }
@@ -610,6 +666,18 @@ int initializeResultData(DATA* simData, int cpuTime)
   initializeOutputFilter(&(simData->modelData), simData->simulationInfo.variableFilter, resultFormatHasCheapAliasesAndParameters);
   sim_result.init(&sim_result, simData);
   infoStreamPrint(LOG_SOLVER, 0, "Allocated simulation result data storage for method '%s' and file='%s'", (char*) MMC_STRINGDATA(simData->simulationInfo.outputFormat), sim_result.filename);
+
+  /* the output thread needs a backend that writes without touching the rt-clocks */
+  if (omc_flag[FLAG_EMIT_THREAD] && !sim_noemit && sim_result.writeRow) {
+    int numSlots = atoi(omc_flagValue[FLAG_EMIT_THREAD]);
+    if (numSlots > 0) {
+      if (omc_async_result_start(&sim_result, simData, numSlots)) {
+        warningStreamPrint(LOG_STDOUT, 0, "Could not start the output thread, writing results on the solver thread.");
+      } else {
+        infoStreamPrint(LOG_SOLVER, 0, "Writing results in a separate thread buffering %d output points", numSlots);
+      }
+    }
+  }
   return 0;
 }
 
@@ -771,8 +839,12 @@ int initRuntimeAndSimulation(int argc, char**argv, DATA *data)
   }
 
   data->simulationInfo.nlsMethod = getNonlinearSolverMethod(argc, argv);
+  data->simulationInfo.nlsJacobianReuse = omc_flag[FLAG_NLS_JAC_REUSE] ? atoi(omc_flagValue[FLAG_NLS_JAC_REUSE]) : 0;
   data->simulationInfo.lsMethod = getlinearSolverMethod(argc, argv);
+  data->simulationInfo.lsRefactor = omc_flag[FLAG_LS_REFACTOR] ? atoi(omc_flagValue[FLAG_LS_REFACTOR]) : 0;
   data->simulationInfo.newtonStrategy = getNewtonStrategy(argc, argv);
+  data->simulationInfo.eventLocator = getEventLocator(argc, argv);
+  data->simulationInfo.parmodautoScheduler = getParmodautoScheduler(argc, argv);
   data->simulationInfo.nlsCsvInfomation = omc_flag[FLAG_NLS_INFO];
 
   rt_tick(SIM_TIMER_INIT_XML);
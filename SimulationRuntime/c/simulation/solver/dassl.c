@@ -36,6 +36,7 @@
 #include "simulation_data.h"
 
 #include "util/omc_error.h"
+#include "util/omc_spinlock.h"
 #include "util/memory_pool.h"
 
 #include "simulation/options.h"
@@ -128,6 +129,9 @@ dummy_precondition(int *neq, double *t, double *y, double *yprime, double *savr,
 
 static int continue_DASSL(int* idid, double* tolarence);
 
+static struct DASSL_JAC_POOL* allocJacobianPool(DATA* data, DASSL_DATA* dasslData, int numThreads);
+static void freeJacobianPool(struct DASSL_JAC_POOL* pool);
+
 enum EVAL_CONTEXT
 {
   CONTEXT_UNKNOWN = 0,
@@ -199,6 +203,7 @@ int dassl_initial(DATA* data, SOLVER_INFO* solverInfo, DASSL_DATA *dasslData)
   dasslData->delta_hh = (double*) malloc(data->modelData.nStates*sizeof(double));
   dasslData->newdelta = (double*) malloc(data->modelData.nStates*sizeof(double));
   dasslData->stateDer = (double*) malloc(data->modelData.nStates*sizeof(double));
+  dasslData->jacobianPool = NULL;
 
   dasslData->currentContext = CONTEXT_UNKNOWN;
 
@@ -409,6 +414,32 @@ int dassl_initial(DATA* data, SOLVER_INFO* solverInfo, DASSL_DATA *dasslData)
   }
   infoStreamPrint(LOG_SOLVER, 0, "jacobian is calculated by %s", dasslJacobianMethodDescStr[dasslData->dasslJacobian]);
 
+  /* if FLAG_DASSL_JACOBIAN_THREADS is set, evaluate the colors of the numerical jacobian in parallel */
+  if (omc_flag[FLAG_DASSL_JACOBIAN_THREADS] && atoi(omc_flagValue[FLAG_DASSL_JACOBIAN_THREADS]) > 1)
+  {
+    int numThreads = atoi(omc_flagValue[FLAG_DASSL_JACOBIAN_THREADS]);
+
+    if (dasslData->dasslJacobian != DASSL_COLOREDNUMJAC)
+    {
+      warningStreamPrint(LOG_STDOUT, 0, "The flag \"%s\" is only used with the coloredNumerical jacobian.", FLAG_NAME[FLAG_DASSL_JACOBIAN_THREADS]);
+    }
+    /* the solvers of algebraic systems keep their iteration data in SIMULATION_INFO */
+    else if (data->modelData.nLinearSystems || data->modelData.nNonLinearSystems || data->modelData.nMixedSystems)
+    {
+      warningStreamPrint(LOG_STDOUT, 0, "The flag \"%s\" is ignored, the colors are evaluated sequentially since the model contains algebraic systems.", FLAG_NAME[FLAG_DASSL_JACOBIAN_THREADS]);
+    }
+    /* external objects and functions share state between the threads, e.g. the
+     * cached rows of the table functions or static variables of user C code */
+    else if (data->modelData.nExtObjs || data->modelData.nExtFunctions)
+    {
+      warningStreamPrint(LOG_STDOUT, 0, "The flag \"%s\" is ignored, the colors are evaluated sequentially since the model contains external objects or functions.", FLAG_NAME[FLAG_DASSL_JACOBIAN_THREADS]);
+    }
+    else
+    {
+      dasslData->jacobianPool = allocJacobianPool(data, dasslData, numThreads);
+    }
+  }
+
 
   /* if FLAG_DASSL_NO_ROOTFINDING is set, choose dassl with out internal root finding */
   if(omc_flag[FLAG_DASSL_NO_ROOTFINDING])
@@ -464,6 +495,10 @@ int dassl_deinitial(DASSL_DATA *dasslData)
   free(dasslData->delta_hh);
   free(dasslData->newdelta);
   free(dasslData->stateDer);
+  if (dasslData->jacobianPool)
+  {
+    freeJacobianPool(dasslData->jacobianPool);
+  }
   free(dasslData->dasslStatistics);
   free(dasslData->dasslStatisticsTmp);
 
@@ -1280,6 +1315,438 @@ int jacA_numColored(DATA* data, double *t, double *y, double *yprime, double *de
   return 0;
 }
 
+/*
+ * Parallel evaluation of the colored numerical jacobian.
+ *
+ * Every worker owns a private copy of the working set of DATA, i.e. the
+ * current SIMULATION_DATA and the parts of SIMULATION_INFO that are written
+ * by functionODE. The colors are distributed in contiguous ranges over the
+ * workers; a worker that runs out of colors steals the upper half of the
+ * remaining range of another worker. The calling thread is worker 0.
+ * Each color is evaluated exactly like in jacA_numColored and scattered into
+ * its own entries of matrixA, hence the result does not depend on the
+ * number of threads.
+ */
+typedef struct DASSL_JAC_WORKER
+{
+  struct DASSL_JAC_POOL *pool;
+  int id;
+  pthread_t thread;
+
+  pthread_spinlock_t lock;             /* protects first and last */
+  int first;                           /* remaining colors [first, last) */
+  int last;
+
+  DATA data;                           /* private copy of DATA */
+  DASSL_DATA dasslData;                /* private copy used by functionODE_residual */
+  double* rpar[2];
+  SIMULATION_DATA simData;             /* private current time step */
+  SIMULATION_DATA **localData;
+  modelica_boolean *relations;
+  modelica_real *inputVars;
+  double *delta_hh;
+  double *newdelta;
+} DASSL_JAC_WORKER;
+
+typedef struct DASSL_JAC_POOL
+{
+  int numWorkers;
+  DASSL_JAC_WORKER *workers;
+  int numLocalData;
+
+  /* columns of color c are colorCols[colorPtr[c]] ... colorCols[colorPtr[c+1]-1] */
+  unsigned int maxColors;
+  unsigned int *colorPtr;
+  unsigned int *colorCols;
+  SPARSE_PATTERN *sparsePattern;
+  unsigned int sizeRows;
+
+  /* arguments of the current jacobian evaluation, read-only for the workers */
+  double sqrteps;
+  double *t;
+  double *y;
+  double *yprime;
+  double *delta;
+  double *matrixA;
+  double *cj;
+  double *h;
+  double *wt;
+  int *ipar;
+
+  int verify;                          /* compare the next result with the sequential evaluation */
+  double *matrixCheck;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t start;
+  pthread_cond_t finished;
+  unsigned long generation;            /* incremented for every jacobian evaluation */
+  int running;                         /* number of worker threads still busy */
+  int shutdown;
+  volatile int failed;
+} DASSL_JAC_POOL;
+
+/* next color of worker w, stolen from another worker if necessary; -1 if all colors are taken */
+static int jacPoolNextColor(DASSL_JAC_WORKER *w)
+{
+  DASSL_JAC_POOL *pool = w->pool;
+  int color = -1, i;
+
+  pthread_spin_lock(&w->lock);
+  if (w->first < w->last)
+  {
+    color = w->first++;
+  }
+  pthread_spin_unlock(&w->lock);
+
+  for (i = 1; color < 0 && i < pool->numWorkers; ++i)
+  {
+    DASSL_JAC_WORKER *victim = pool->workers + (w->id + i) % pool->numWorkers;
+    int first = 0, last = 0;
+
+    pthread_spin_lock(&victim->lock);
+    if (victim->first < victim->last)
+    {
+      first = victim->first + (victim->last - victim->first) / 2;
+      last = victim->last;
+      victim->last = first;
+    }
+    pthread_spin_unlock(&victim->lock);
+
+    if (first < last)
+    {
+      color = first;
+      pthread_spin_lock(&w->lock);
+      w->first = first + 1;
+      w->last = last;
+      pthread_spin_unlock(&w->lock);
+    }
+  }
+
+  return color;
+}
+
+/* evaluates one color; same arithmetic as jacA_numColored */
+static void jacWorkerColor(DASSL_JAC_WORKER *w, unsigned int color)
+{
+  DASSL_JAC_POOL *pool = w->pool;
+  const SPARSE_PATTERN *sparsePattern = pool->sparsePattern;
+  double *y = w->simData.realVars;
+  double delta_hhh;
+  int ires;
+  unsigned int ii, j, k, l, m;
+
+  for (m = pool->colorPtr[color]; m < pool->colorPtr[color+1]; m++)
+  {
+    ii = pool->colorCols[m];
+    delta_hhh = *pool->h * pool->yprime[ii];
+    w->delta_hh[ii] = pool->sqrteps * fmax(fmax(fabs(pool->y[ii]),fabs(delta_hhh)),fabs(1./pool->wt[ii]));
+    w->delta_hh[ii] = (delta_hhh >= 0 ? w->delta_hh[ii] : -w->delta_hh[ii]);
+    w->delta_hh[ii] = pool->y[ii] + w->delta_hh[ii] - pool->y[ii];
+
+    y[ii] += w->delta_hh[ii];
+
+    w->delta_hh[ii] = 1. / w->delta_hh[ii];
+  }
+
+  functionODE_residual(pool->t, y, pool->yprime, pool->cj, w->newdelta, &ires, (double*) w->rpar, pool->ipar);
+
+  for (m = pool->colorPtr[color]; m < pool->colorPtr[color+1]; m++)
+  {
+    ii = pool->colorCols[m];
+    j = (ii == 0) ? 0 : sparsePattern->leadindex[ii-1];
+    while (j < sparsePattern->leadindex[ii])
+    {
+      l = sparsePattern->index[j];
+      k = l + ii*pool->sizeRows;
+      pool->matrixA[k] = (w->newdelta[l] - pool->delta[l]) * w->delta_hh[ii];
+      j++;
+    }
+    y[ii] = pool->y[ii];
+  }
+}
+
+static void jacWorkerRun(DASSL_JAC_WORKER *w, threadData_t *threadData)
+{
+  int color;
+
+  w->data.threadData = threadData;
+
+  MMC_TRY_INTERNAL(mmc_jumper)
+    while (!w->pool->failed && (color = jacPoolNextColor(w)) >= 0)
+    {
+      jacWorkerColor(w, (unsigned int) color);
+    }
+  MMC_ELSE()
+    w->pool->failed = 1;
+  MMC_CATCH_INTERNAL(mmc_jumper)
+}
+
+static void* jacWorkerThread(void *arg)
+{
+  DASSL_JAC_WORKER *w = (DASSL_JAC_WORKER*) arg;
+  DASSL_JAC_POOL *pool = w->pool;
+  unsigned long generation = 0;
+
+  MMC_TRY_TOP()
+  for (;;)
+  {
+    pthread_mutex_lock(&pool->mutex);
+    while (!pool->shutdown && pool->generation == generation)
+    {
+      pthread_cond_wait(&pool->start, &pool->mutex);
+    }
+    generation = pool->generation;
+    pthread_mutex_unlock(&pool->mutex);
+    if (pool->shutdown)
+    {
+      break;
+    }
+
+    jacWorkerRun(w, threadData);
+
+    pthread_mutex_lock(&pool->mutex);
+    if (--pool->running == 0)
+    {
+      pthread_cond_signal(&pool->finished);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+  }
+  MMC_CATCH_TOP()
+
+  return NULL;
+}
+
+/* copies the current working set of data into the private data of worker w */
+static void jacWorkerSync(DASSL_JAC_WORKER *w, DATA *data, DASSL_DATA *dasslData)
+{
+  const MODEL_DATA *mData = &(data->modelData);
+  const SIMULATION_DATA *sData = data->localData[0];
+
+  w->data = *data;
+  w->data.localData = w->localData;
+  memcpy(w->localData, data->localData, w->pool->numLocalData * sizeof(SIMULATION_DATA*));
+  w->localData[0] = &w->simData;
+
+  w->simData.timeValue = sData->timeValue;
+  memcpy(w->simData.realVars, sData->realVars, mData->nVariablesReal * sizeof(modelica_real));
+  memcpy(w->simData.integerVars, sData->integerVars, mData->nVariablesInteger * sizeof(modelica_integer));
+  memcpy(w->simData.booleanVars, sData->booleanVars, mData->nVariablesBoolean * sizeof(modelica_boolean));
+  memcpy(w->simData.stringVars, sData->stringVars, mData->nVariablesString * sizeof(modelica_string));
+
+  w->data.simulationInfo.relations = w->relations;
+  memcpy(w->relations, data->simulationInfo.relations, mData->nRelations * sizeof(modelica_boolean));
+  w->data.simulationInfo.inputVars = w->inputVars;
+  memcpy(w->inputVars, data->simulationInfo.inputVars, mData->nInputVars * sizeof(modelica_real));
+
+  w->dasslData = *dasslData;
+}
+
+static DASSL_JAC_POOL* allocJacobianPool(DATA* data, DASSL_DATA* dasslData, int numThreads)
+{
+  const MODEL_DATA *mData = &(data->modelData);
+  const int index = data->callback->INDEX_JAC_A;
+  SPARSE_PATTERN *sparsePattern = &(data->simulationInfo.analyticJacobians[index].sparsePattern);
+  unsigned int sizeCols = data->simulationInfo.analyticJacobians[index].sizeCols;
+  DASSL_JAC_POOL *pool;
+  unsigned int i, c;
+  int w;
+
+  if ((unsigned int) numThreads > sparsePattern->maxColors)
+  {
+    numThreads = sparsePattern->maxColors;
+  }
+  if (numThreads < 2)
+  {
+    return NULL;
+  }
+
+  pool = (DASSL_JAC_POOL*) calloc(1, sizeof(DASSL_JAC_POOL));
+  assertStreamPrint(data->threadData, 0 != pool, "out of memory");
+  pool->sparsePattern = sparsePattern;
+  pool->sizeRows = data->simulationInfo.analyticJacobians[index].sizeRows;
+  pool->sqrteps = dasslData->sqrteps;
+  pool->numLocalData = ringBufferLength(data->simulationData);
+  pool->verify = 1;
+  pool->matrixCheck = (double*) malloc(mData->nStates * mData->nStates * sizeof(double));
+
+  /* sort the columns by color once instead of searching them for every color */
+  pool->maxColors = sparsePattern->maxColors;
+  pool->colorPtr = (unsigned int*) calloc(pool->maxColors + 1, sizeof(unsigned int));
+  pool->colorCols = (unsigned int*) malloc(sizeCols * sizeof(unsigned int));
+  assertStreamPrint(data->threadData, 0 != pool->colorPtr && 0 != pool->colorCols && 0 != pool->matrixCheck, "out of memory");
+  for (i = 0; i < sizeCols; i++)
+  {
+    /* sparsePattern->colorCols counts the colors from 1 */
+    pool->colorPtr[sparsePattern->colorCols[i]]++;
+  }
+  for (c = 0; c < pool->maxColors; c++)
+  {
+    pool->colorPtr[c+1] += pool->colorPtr[c];
+  }
+  for (i = 0; i < sizeCols; i++)
+  {
+    pool->colorCols[pool->colorPtr[sparsePattern->colorCols[i]-1]++] = i;
+  }
+  for (c = pool->maxColors; c > 0; c--)
+  {
+    pool->colorPtr[c] = pool->colorPtr[c-1];
+  }
+  pool->colorPtr[0] = 0;
+
+  pool->numWorkers = numThreads;
+  pool->workers = (DASSL_JAC_WORKER*) calloc(numThreads, sizeof(DASSL_JAC_WORKER));
+  assertStreamPrint(data->threadData, 0 != pool->workers, "out of memory");
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->finished, NULL);
+
+  for (w = 0; w < numThreads; w++)
+  {
+    DASSL_JAC_WORKER *worker = pool->workers + w;
+    worker->pool = pool;
+    worker->id = w;
+    pthread_spin_init(&worker->lock, 0);
+    worker->rpar[0] = (double*)(void*) &worker->data;
+    worker->rpar[1] = (double*)(void*) &worker->dasslData;
+    worker->localData = (SIMULATION_DATA**) malloc(pool->numLocalData * sizeof(SIMULATION_DATA*));
+    worker->simData.realVars = (modelica_real*) calloc(mData->nVariablesReal, sizeof(modelica_real));
+    worker->simData.integerVars = (modelica_integer*) calloc(mData->nVariablesInteger, sizeof(modelica_integer));
+    worker->simData.booleanVars = (modelica_boolean*) calloc(mData->nVariablesBoolean, sizeof(modelica_boolean));
+    worker->simData.stringVars = (modelica_string*) GC_malloc_uncollectable(mData->nVariablesString * sizeof(modelica_string));
+    worker->relations = (modelica_boolean*) calloc(mData->nRelations, sizeof(modelica_boolean));
+    worker->inputVars = (modelica_real*) calloc(mData->nInputVars, sizeof(modelica_real));
+    worker->delta_hh = (double*) malloc(mData->nStates * sizeof(double));
+    worker->newdelta = (double*) malloc(mData->nStates * sizeof(double));
+    assertStreamPrint(data->threadData, 0 != worker->localData && 0 != worker->simData.realVars &&
+                      0 != worker->delta_hh && 0 != worker->newdelta, "out of memory");
+
+    if (w > 0 && pthread_create(&worker->thread, NULL, jacWorkerThread, worker))
+    {
+      throwStreamPrint(data->threadData, "Could not create the thread %d for the evaluation of the jacobian.", w);
+    }
+  }
+
+  infoStreamPrint(LOG_SOLVER, 0, "the %d colors of the numerical jacobian are evaluated by %d threads", pool->maxColors, numThreads);
+  return pool;
+}
+
+static void freeJacobianPool(DASSL_JAC_POOL* pool)
+{
+  int w;
+
+  pthread_mutex_lock(&pool->mutex);
+  pool->shutdown = 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for (w = 0; w < pool->numWorkers; w++)
+  {
+    DASSL_JAC_WORKER *worker = pool->workers + w;
+    if (w > 0)
+    {
+      pthread_join(worker->thread, NULL);
+    }
+    free(worker->localData);
+    free(worker->simData.realVars);
+    free(worker->simData.integerVars);
+    free(worker->simData.booleanVars);
+    GC_free(worker->simData.stringVars);
+    free(worker->relations);
+    free(worker->inputVars);
+    free(worker->delta_hh);
+    free(worker->newdelta);
+  }
+
+  pthread_cond_destroy(&pool->finished);
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool->workers);
+  free(pool->colorPtr);
+  free(pool->colorCols);
+  free(pool->matrixCheck);
+  free(pool);
+}
+
+/*
+ *  function calculates the colored numerical jacobian
+ *  with the worker threads of dasslData->jacobianPool
+ */
+static int jacA_numColoredParallel(DATA* data, double *t, double *y, double *yprime, double *delta, double *matrixA, double *cj, double *h, double *wt, double *rpar, int *ipar)
+{
+  TRACE_PUSH
+  DASSL_DATA* dasslData = (DASSL_DATA*)(void*)((double**)rpar)[1];
+  DASSL_JAC_POOL* pool = dasslData->jacobianPool;
+  const unsigned int n = data->modelData.nStates;
+  int verify = pool->verify || ACTIVE_STREAM(LOG_JAC);
+  int w;
+
+  if (verify)
+  {
+    memcpy(pool->matrixCheck, matrixA, n * n * sizeof(double));
+  }
+
+  pool->t = t;
+  pool->y = y;
+  pool->yprime = yprime;
+  pool->delta = delta;
+  pool->matrixA = matrixA;
+  pool->cj = cj;
+  pool->h = h;
+  pool->wt = wt;
+  pool->ipar = ipar;
+  pool->failed = 0;
+
+  for (w = 0; w < pool->numWorkers; w++)
+  {
+    DASSL_JAC_WORKER *worker = pool->workers + w;
+    jacWorkerSync(worker, data, dasslData);
+    worker->first = (int) (pool->maxColors * w / pool->numWorkers);
+    worker->last = (int) (pool->maxColors * (w + 1) / pool->numWorkers);
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  pool->running = pool->numWorkers - 1;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->mutex);
+
+  jacWorkerRun(pool->workers, data->threadData);
+
+  pthread_mutex_lock(&pool->mutex);
+  while (pool->running > 0)
+  {
+    pthread_cond_wait(&pool->finished, &pool->mutex);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  if (pool->failed)
+  {
+    throwStreamPrint(data->threadData, "Error, can not get Matrix A: the evaluation of the jacobian failed in a worker thread.");
+  }
+
+  /* the parallel result has to be bit-identical to the sequential one */
+  if (verify)
+  {
+    jacA_numColored(data, t, y, yprime, delta, pool->matrixCheck, cj, h, wt, rpar, ipar);
+    if (memcmp(pool->matrixCheck, matrixA, n * n * sizeof(double)))
+    {
+      warningStreamPrint(LOG_STDOUT, 0, "The jacobian evaluated by %d threads differs from the sequential evaluation, "
+                         "the colors are evaluated sequentially from now on.", pool->numWorkers);
+      memcpy(matrixA, pool->matrixCheck, n * n * sizeof(double));
+      freeJacobianPool(pool);
+      dasslData->jacobianPool = NULL;
+    }
+    else
+    {
+      infoStreamPrint(LOG_JAC, 0, "the jacobian evaluated by %d threads is identical to the sequential evaluation", pool->numWorkers);
+      pool->verify = 0;
+    }
+  }
+
+  TRACE_POP
+  return 0;
+}
+
 /*
  * provides a numerical Jacobian to be used with DASSL
  */
@@ -1293,7 +1760,9 @@ static int JacobianOwnNumColored(double *t, double *y, double *yprime, double *d
 
   setDasslContext(dasslData, t, CONTEXT_JACOBIAN);
 
-  if(jacA_numColored(data, t, y, yprime, deltaD, pd, cj, h, wt, rpar, ipar))
+  if(dasslData->jacobianPool ?
+     jacA_numColoredParallel(data, t, y, yprime, deltaD, pd, cj, h, wt, rpar, ipar) :
+     jacA_numColored(data, t, y, yprime, deltaD, pd, cj, h, wt, rpar, ipar))
   {
     throwStreamPrint(data->threadData, "Error, can not get Matrix A ");
     TRACE_POP
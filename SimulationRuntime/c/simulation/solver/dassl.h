@@ -91,6 +91,9 @@ typedef struct DASSL_DATA{
   double *newdelta;
   double *stateDer;
 
+  /* parallel evaluation of the colored numerical jacobian, NULL if the colors are evaluated sequentially */
+  struct DASSL_JAC_POOL* jacobianPool;
+
   /* function pointer of provied functions */
   void* jacobianFunction;
   void* zeroCrossingFunction;
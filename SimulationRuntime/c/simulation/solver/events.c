@@ -50,7 +50,8 @@
 extern "C" {
 #endif
 
-double bisection(DATA* data, double*, double*, double*, double*, LIST*, LIST*);
+double bisection(DATA* data, double*, double*, double*, double*, LIST*, LIST*, int*);
+double illinois(DATA* data, double*, double*, double*, double*, LIST*, LIST*, int*);
 int checkZeroCrossings(DATA *data, LIST *list, LIST*);
 void saveZeroCrossingsAfterEvent(DATA *data);
 
@@ -191,7 +192,7 @@ int checkEvents(DATA* data, LIST* eventLst, double *eventTime, SOLVER_INFO* solv
   {
     if (!solverInfo->solverRootFinding)
     {
-      findRoot(data, solverInfo->eventLst, &(solverInfo->currentTime));
+      solverInfo->eventLocatorIterations += findRoot(data, solverInfo->eventLst, &(solverInfo->currentTime));
     }
   }
 
@@ -328,9 +329,11 @@ void handleEvents(DATA* data, LIST* eventLst, double *eventTime, SOLVER_INFO* so
  *  \param [ref] [eventLst]
  *  \param [in]  [eventTime]
  *
+ *  \return number of iterations
+ *
  *  This function perform a root finding for Intervall = [oldTime, timeValue]
  */
-void findRoot(DATA* data, LIST *eventList, double *eventTime)
+int findRoot(DATA* data, LIST *eventList, double *eventTime)
 {
   TRACE_PUSH
 
@@ -338,6 +341,7 @@ void findRoot(DATA* data, LIST *eventList, double *eventTime)
   LIST_NODE* it;
   fortran_integer i=0;
   static LIST *tmpEventList = NULL;
+  int iterations = 0;
 
   double *states_right = (double*) malloc(data->modelData.nStates * sizeof(double));
   double *states_left = (double*) malloc(data->modelData.nStates * sizeof(double));
@@ -359,8 +363,16 @@ void findRoot(DATA* data, LIST *eventList, double *eventTime)
   memcpy(states_left,  data->simulationInfo.realVarsOld, data->modelData.nStates * sizeof(double));
   memcpy(states_right, data->localData[0]->realVars    , data->modelData.nStates * sizeof(double));
 
-  /* Search for event time and event_id with bisection method */
-  *eventTime = bisection(data, &time_left, &time_right, states_left, states_right, tmpEventList, eventList);
+  /* Search for event time and event_id */
+  if(data->simulationInfo.eventLocator == EVENT_LOCATOR_ILLINOIS)
+  {
+    *eventTime = illinois(data, &time_left, &time_right, states_left, states_right, tmpEventList, eventList, &iterations);
+  }
+  else
+  {
+    *eventTime = bisection(data, &time_left, &time_right, states_left, states_right, tmpEventList, eventList, &iterations);
+  }
+  infoStreamPrint(LOG_EVENTS, 0, "event located by %s after %d iterations", EVENT_LOCATOR_NAME[data->simulationInfo.eventLocator], iterations);
 
   if(listLen(tmpEventList) == 0)
   {
@@ -430,6 +442,7 @@ void findRoot(DATA* data, LIST *eventList, double *eventTime)
   free(states_right);
 
   TRACE_POP
+  return iterations;
 }
 
 /*! \fn bisection
@@ -441,11 +454,12 @@ void findRoot(DATA* data, LIST *eventList, double *eventTime)
  *  \param [ref] [states_b]
  *  \param [ref] [eventListTmp]
  *  \param [in]  [eventList]
+ *  \param [out] [iterations]
  *  \return Founded event time
  *
  *  Method to find root in Intervall [oldTime, timeValue]
  */
-double bisection(DATA* data, double* a, double* b, double* states_a, double* states_b, LIST *tmpEventList, LIST *eventList)
+double bisection(DATA* data, double* a, double* b, double* states_a, double* states_b, LIST *tmpEventList, LIST *eventList, int *iterations)
 {
   TRACE_PUSH
 
@@ -462,6 +476,7 @@ double bisection(DATA* data, double* a, double* b, double* states_a, double* sta
 
   while(fabs(*b - *a) > MINIMAL_STEP_SIZE && n-- > 0)
   {
+    (*iterations)++;
     c = 0.5 * (*a + *b);
     data->localData[0]->timeValue = c;
 
@@ -500,6 +515,147 @@ double bisection(DATA* data, double* a, double* b, double* states_a, double* sta
   return c;
 }
 
+/*! \fn illinois
+ *
+ *  \param [ref] [data]
+ *  \param [ref] [a]
+ *  \param [ref] [b]
+ *  \param [ref] [states_a]
+ *  \param [ref] [states_b]
+ *  \param [ref] [eventListTmp]
+ *  \param [in]  [eventList]
+ *  \param [out] [iterations]
+ *  \return Founded event time
+ *
+ *  Method to find root in Intervall [oldTime, timeValue] by regula falsi
+ *  with the Illinois modification on the values of the zero-crossing
+ *  functions. The new point is the earliest secant root of all crossings in
+ *  the event list. The states are interpolated with the cubic Hermite
+ *  polynomial of the states and their derivatives at both ends of the step.
+ *  The bookkeeping of the sign changes is the same as for bisection.
+ */
+double illinois(DATA* data, double* a, double* b, double* states_a, double* states_b, LIST *tmpEventList, LIST *eventList, int *iterations)
+{
+  TRACE_PUSH
+
+  const long nStates = data->modelData.nStates;
+  const long nZeroCrossings = data->modelData.nZeroCrossings;
+  const double t0 = *a, t1 = *b, h = t1 - t0;
+  double *x0 = (double*) malloc(4 * nStates * sizeof(double));
+  double *x1 = x0 + nStates, *dx0 = x1 + nStates, *dx1 = dx0 + nStates;
+  double *g = (double*) malloc(3 * nZeroCrossings * sizeof(double));
+  double *g_a = g + nZeroCrossings, *g_b = g_a + nZeroCrossings;
+  double c, theta, alpha = 1.0;
+  int side = 0, sidePrev = -1;
+  long i;
+  LIST_NODE *it;
+  /* n >= log(2)/log(2) + log(|b-a|/TOL)/log(2) as for bisection, the secant steps need fewer */
+  unsigned int n = 2 + 2*ceil(log(fabs(*b - *a)/(MINIMAL_STEP_SIZE + MINIMAL_STEP_SIZE*fabs(*b-*a)))/log(2));
+
+  assertStreamPrint(data->threadData, 0 != x0 && 0 != g, "out of memory");
+
+  /* ends of the step, the derivatives follow the states in realVars */
+  memcpy(x0,  data->simulationInfo.realVarsOld, nStates * sizeof(double));
+  memcpy(dx0, data->simulationInfo.realVarsOld + nStates, nStates * sizeof(double));
+  memcpy(x1,  data->localData[0]->realVars, nStates * sizeof(double));
+  memcpy(dx1, data->localData[0]->realVars + nStates, nStates * sizeof(double));
+
+  memcpy(data->simulationInfo.zeroCrossingsBackup, data->simulationInfo.zeroCrossings, nZeroCrossings * sizeof(modelica_real));
+
+  /* values of the zero-crossing functions at the right end, the system is up to date there */
+  data->callback->function_ZeroCrossingsValues(data, g_b);
+
+  /* values at the left end */
+  data->localData[0]->timeValue = t0;
+  memcpy(data->localData[0]->realVars, x0, nStates * sizeof(double));
+  externalInputUpdate(data);
+  data->callback->input_function(data);
+  data->callback->function_ZeroCrossingsEquations(data);
+  data->callback->function_ZeroCrossingsValues(data, g_a);
+
+  infoStreamPrint(LOG_ZEROCROSSINGS, 0, "illinois method starts in interval [%e, %e]", *a, *b);
+
+  while(fabs(*b - *a) > MINIMAL_STEP_SIZE && n-- > 0)
+  {
+    double fraction = -1.0, ttol = 0.5 * MINIMAL_STEP_SIZE;
+    (*iterations)++;
+
+    /* Illinois modification: scale the value of the end that was kept twice */
+    if(side == sidePrev)
+      alpha = (side == 2) ? 2.0*alpha : 0.5*alpha;
+    else
+      alpha = 1.0;
+    sidePrev = side;
+
+    /* earliest secant root of all crossings; the sign of the value is taken
+     * from the relation, the value only serves the interpolation */
+    for(it=listFirstNode(eventList); it; it=listNextNode(it))
+    {
+      long ix = *((long*) listNodeData(it));
+      double ga = fmax(fabs(g_a[ix]), DBL_MIN) * data->simulationInfo.zeroCrossingsPre[ix];
+      double gb = fmax(fabs(g_b[ix]), DBL_MIN) * data->simulationInfo.zeroCrossingsBackup[ix];
+      if((ga > 0) != (gb > 0) && fabs(gb / (gb - alpha*ga)) > fraction)
+      {
+        fraction = fabs(gb / (gb - alpha*ga));
+      }
+    }
+    c = (fraction < 0) ? 0.5 * (*a + *b) : *b - fraction * (*b - *a);
+
+    /* keep the new point inside the interval */
+    if(c - *a < ttol || *b - c < ttol)
+    {
+      double fracint = fabs(*b - *a) / ttol;
+      double fracsub = (fracint > 5.0) ? 0.1 : 0.5/fracint;
+      c = (c - *a < ttol) ? *a + fracsub * (*b - *a) : *b - fracsub * (*b - *a);
+    }
+    data->localData[0]->timeValue = c;
+
+    /* dense output of the step at time c */
+    theta = (c - t0) / h;
+    for(i=0; i < nStates; i++)
+    {
+      data->localData[0]->realVars[i] = (1.0 + 2.0*theta) * (1.0 - theta) * (1.0 - theta) * x0[i]
+                                      + theta * (1.0 - theta) * (1.0 - theta) * h * dx0[i]
+                                      + theta * theta * (3.0 - 2.0*theta) * x1[i]
+                                      + theta * theta * (theta - 1.0) * h * dx1[i];
+    }
+
+    /* read input vars */
+    externalInputUpdate(data);
+    data->callback->input_function(data);
+    /* eval needed equations */
+    data->callback->function_ZeroCrossingsEquations(data);
+
+    data->callback->function_ZeroCrossings(data, data->simulationInfo.zeroCrossings);
+    data->callback->function_ZeroCrossingsValues(data, g);
+
+    if(checkZeroCrossings(data, tmpEventList, eventList))  /* If Zerocrossing in left Section */
+    {
+      memcpy(states_b, data->localData[0]->realVars, nStates * sizeof(modelica_real));
+      *b = c;
+      memcpy(g_b, g, nZeroCrossings * sizeof(double));
+      memcpy(data->simulationInfo.zeroCrossingsBackup, data->simulationInfo.zeroCrossings, nZeroCrossings * sizeof(modelica_real));
+      side = 1;
+    }
+    else  /*else Zerocrossing in right Section */
+    {
+      memcpy(states_a, data->localData[0]->realVars, nStates * sizeof(modelica_real));
+      *a = c;
+      memcpy(g_a, g, nZeroCrossings * sizeof(double));
+      memcpy(data->simulationInfo.zeroCrossingsPre, data->simulationInfo.zeroCrossings, nZeroCrossings * sizeof(modelica_real));
+      memcpy(data->simulationInfo.zeroCrossings, data->simulationInfo.zeroCrossingsBackup, nZeroCrossings * sizeof(modelica_real));
+      side = 2;
+    }
+  }
+  c = 0.5*(*a + *b);
+
+  free(x0);
+  free(g);
+
+  TRACE_POP
+  return c;
+}
+
 /*! \fn checkZeroCrossings
  *
  *  Function checks for an event list on events
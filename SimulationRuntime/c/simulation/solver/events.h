@@ -49,7 +49,7 @@ int checkEvents(DATA* data, LIST* eventLst, double *eventTime, SOLVER_INFO* solv
 
 void handleEvents(DATA* data, LIST* eventLst, double *eventTime, SOLVER_INFO* solverInfo);
 
-void findRoot(DATA *data, LIST *eventList, double*);
+int findRoot(DATA *data, LIST *eventList, double*);
 
 #ifdef __cplusplus
 }
@@ -46,8 +46,10 @@
 #include "linearSolverLapack.h"
 
 
-extern int dgesv_(int *n, int *nrhs, double *a, int *lda,
-                  int *ipiv, double *b, int *ldb, int *info);
+extern int dgetrf_(int *m, int *n, double *a, int *lda,
+                   int *ipiv, int *info);
+extern int dgetrs_(char *trans, int *n, int *nrhs, double *a, int *lda,
+                   int *ipiv, double *b, int *ldb, int *info);
 
 /*! \fn allocate memory for linear system solver lapack
  *
@@ -66,6 +68,12 @@ int allocateLapackData(int size, void** voiddata)
   data->b = _omc_createVector(size, NULL);
   data->A = _omc_createMatrix(size, size, NULL);
 
+  data->Aold = (double*) malloc(size*size*sizeof(double));
+  data->LU = (double*) malloc(size*size*sizeof(double));
+  assertStreamPrint(NULL, 0 != data->Aold && 0 != data->LU, "Could not allocate data for linear solver lapack.");
+  data->factorized = 0;
+  data->nSolutions = 0;
+
   *voiddata = (void*)data;
   return 0;
 }
@@ -84,6 +92,9 @@ int freeLapackData(void **voiddata)
   _omc_destroyVector(data->b);
   _omc_destroyMatrix(data->A);
 
+  free(data->Aold);
+  free(data->LU);
+
   return 0;
 }
 
@@ -218,15 +229,42 @@ int solveLapack(DATA *data, int sysNumber)
 
   rt_ext_tp_tick(&(solverData->timeClock));
 
-  /* Solve system */
-  dgesv_((int*) &systemData->size,
-         (int*) &solverData->nrhs,
-         solverData->A->data,
-         (int*) &systemData->size,
-         solverData->ipiv,
-         solverData->b->data,
-         (int*) &systemData->size,
-         &solverData->info);
+  /* Solve system, the LU factorization is reused as long as matrix A does not change */
+  if (solverData->factorized &&
+      (0 >= data->simulationInfo.lsRefactor || solverData->nSolutions < data->simulationInfo.lsRefactor) &&
+      0 == memcmp(solverData->Aold, systemData->A, (systemData->size)*(systemData->size)*sizeof(double)))
+  {
+    infoStreamPrint(LOG_LS, 0, "Reuse the LU factorization of matrix A (%d solutions).", solverData->nSolutions);
+    solverData->info = 0;
+  }
+  else
+  {
+    memcpy(solverData->Aold, systemData->A, (systemData->size)*(systemData->size)*sizeof(double));
+    memcpy(solverData->LU, systemData->A, (systemData->size)*(systemData->size)*sizeof(double));
+    dgetrf_((int*) &systemData->size,
+            (int*) &systemData->size,
+            solverData->LU,
+            (int*) &systemData->size,
+            solverData->ipiv,
+            &solverData->info);
+    solverData->factorized = (0 == solverData->info);
+    solverData->nSolutions = 0;
+  }
+
+  if (0 == solverData->info)
+  {
+    char trans = 'N';
+    dgetrs_(&trans,
+            (int*) &systemData->size,
+            (int*) &solverData->nrhs,
+            solverData->LU,
+            (int*) &systemData->size,
+            solverData->ipiv,
+            solverData->b->data,
+            (int*) &systemData->size,
+            &solverData->info);
+    solverData->nSolutions++;
+  }
 
   infoStreamPrint(LOG_LS, 0, "Solve System: %f", rt_ext_tp_tock(&(solverData->timeClock)));
 
@@ -245,6 +283,7 @@ int solveLapack(DATA *data, int sysNumber)
 
     /* debug output */
     if (ACTIVE_STREAM(LOG_LS)){
+      _omc_setMatrixData(solverData->A, solverData->LU);
       _omc_printMatrix(solverData->A, "Matrix U", LOG_LS);
 
       _omc_printVector(solverData->b, "Output vector x", LOG_LS);
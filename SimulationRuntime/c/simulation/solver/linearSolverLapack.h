@@ -48,6 +48,11 @@ typedef struct DATA_LAPACK
   _omc_vector* b;
   _omc_matrix* A;
 
+  double *Aold;     /* matrix A of the current LU factorization */
+  double *LU;       /* LU factors of Aold */
+  int factorized;   /* = 1 if LU and ipiv are valid */
+  int nSolutions;   /* number of solutions with the current LU factorization */
+
   rtclock_t timeClock;             /* time clock */
 
 } DATA_LAPACK;
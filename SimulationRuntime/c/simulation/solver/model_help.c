@@ -47,6 +47,12 @@
 #include "delay.h"
 #include "epsilon.h"
 #include "meta/meta_modelica.h"
+#include "util/real_array.h"
+
+extern int dgemm_(char *transa, char *transb, int *m, int *n, int *k, double *alpha,
+                  double *a, int *lda, double *b, int *ldb, double *beta, double *c, int *ldc);
+extern int dgemv_(char *trans, int *m, int *n, double *alpha, double *a, int *lda,
+                  double *x, int *incx, double *beta, double *y, int *incy);
 
 static const int IterationMax = 200;
 const size_t SIZERINGBUFFER = 3;
@@ -901,9 +907,17 @@ void initializeDataStruc(DATA *data)
 #else
   data->simulationInfo.nlsMethod = NLS_HOMOTOPY;
 #endif
+  data->simulationInfo.nlsJacobianReuse = 0;
+
+  /* the simulation runtime is linked against BLAS, use it for large matrix products */
+  omc_dgemm = dgemm_;
+  omc_dgemv = dgemv_;
   data->simulationInfo.lsMethod = LS_LAPACK;
+  data->simulationInfo.lsRefactor = 0;
   data->simulationInfo.mixedMethod = MIXED_SEARCH;
   data->simulationInfo.newtonStrategy = NEWTON_PURE;
+  data->simulationInfo.eventLocator = EVENT_LOCATOR_BISECTION;
+  data->simulationInfo.parmodautoScheduler = PARMODAUTO_SCHEDULER_LEVEL;
   data->simulationInfo.nlsCsvInfomation = 0;
 
   data->simulationInfo.zeroCrossings = (modelica_real*) calloc(data->modelData.nZeroCrossings, sizeof(modelica_real));
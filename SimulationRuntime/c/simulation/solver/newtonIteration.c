@@ -63,6 +63,7 @@ void LineSearch(double* x, int(*f)(int*, double*, double*, void*, int),
     double current_fvec_enorm, int* n, double* fvec, int* k, DATA_NEWTON* solverData, void* userdata);
 void Backtracking(double* x, int(*f)(int*, double*, double*, void*, int),
     double current_fvec_enorm, int* n, double* fvec, DATA_NEWTON* solverData, void* userdata);
+void broydenUpdate(int* n, double* x, double* fvec, DATA_NEWTON* solverData);
 void printErrors(double delta_x, double delta_x_scaled, double delta_f, double error_f, double scaledError_f, double* eps);
 
 
@@ -112,6 +113,15 @@ int allocateNewtonData(int size, void** voiddata)
   data->delta_f = (double*) calloc(size,sizeof(double));
   data->delta_x_vec = (double*) calloc(size,sizeof(double));
 
+  /* jacobian reuse */
+  data->jacobianReuse = 0;
+  data->jacobianValid = 0;
+  data->jacobianCalls = 0;
+  data->jac = (double*) malloc((size*size)*sizeof(double));
+  data->jac_f = (double*) malloc(size*sizeof(double));
+  data->numberOfJacobianEvaluations = 0;
+  data->numberOfJacobianSaved = 0;
+
   data->factorization = 0;
   data->calculate_jacobian = 1;
   data->numberOfIterations = 0;
@@ -145,6 +155,10 @@ int freeNewtonData(void **voiddata)
   free(data->delta_f);
   free(data->delta_x_vec);
 
+  /* jacobian reuse */
+  free(data->jac);
+  free(data->jac_f);
+
   return 0;
 }
 
@@ -179,6 +193,9 @@ int _omc_newton(int(*f)(int*, double*, double*, void*, int), DATA_NEWTON* solver
   int *iwork = solverData->iwork;
   int *info = &(solverData->info);
   int calc_jac = 1;
+  int reuse = solverData->jacobianReuse > 0 && solverData->calculate_jacobian == 0;
+  int jac_fresh = 0;
+  int jac_kept = 0;
 
   double error_f  = 1.0 + *eps, scaledError_f = 1.0 + *eps, delta_x = 1.0 + *eps, delta_f = 1.0 + *eps, delta_x_scaled = 1.0 + *eps, lambda = 1.0;
   double current_fvec_enorm, enorm_new;
@@ -224,16 +241,44 @@ int _omc_newton(int(*f)(int*, double*, double*, void*, int), DATA_NEWTON* solver
     /* calculate jacobian if no matrix is given */
     if (calc_jac == 1 && solverData->calculate_jacobian >= 0)
     {
-      (*f)(n, x, fvec, userdata, 0);
+      if (reuse && solverData->jacobianValid)
+      {
+        /* take the kept jacobian from the previous call */
+        memcpy(fjac, solverData->jac, (*n)*(*n)*sizeof(double));
+        jac_fresh = 0;
+        jac_kept = 1;
+      }
+      else
+      {
+        (*f)(n, x, fvec, userdata, 0);
+        solverData->numberOfJacobianEvaluations++;
+        if (reuse)
+        {
+          memcpy(solverData->jac, fjac, (*n)*(*n)*sizeof(double));
+          solverData->jacobianValid = 1;
+          solverData->jacobianCalls = 0;
+          jac_fresh = 1;
+        }
+      }
       solverData->factorization = 0;
       calc_jac = solverData->calculate_jacobian;
     }
+    else if (reuse)
+    {
+      /* the kept jacobian has been updated, factorize it again */
+      memcpy(fjac, solverData->jac, (*n)*(*n)*sizeof(double));
+      solverData->factorization = 0;
+    }
     else
     {
       solverData->factorization = 1;
       calc_jac--;
     }
 
+    /* save function values for the Broyden update */
+    if (reuse)
+      memcpy(solverData->jac_f, fvec, *n*sizeof(double));
+
 
     /* debug output */
     if(ACTIVE_STREAM(LOG_NLS_JAC))
@@ -253,6 +298,7 @@ int _omc_newton(int(*f)(int*, double*, double*, void*, int), DATA_NEWTON* solver
 
     if (solveLinearSystem(n, iwork, fvec, fjac, solverData) != 0)
     {
+      solverData->jacobianValid = 0;
       *info=-1;
       break;
     }
@@ -291,6 +337,25 @@ int _omc_newton(int(*f)(int*, double*, double*, void*, int), DATA_NEWTON* solver
 
       calculatingErrors(solverData, &delta_x, &delta_x_scaled, &delta_f, &error_f, &scaledError_f, n, x, fvec);
 
+      if (reuse)
+      {
+        /* evaluate a new jacobian if an updated one does not reduce the residual sufficiently */
+        if (!jac_fresh && error_f > 0.5*current_fvec_enorm)
+        {
+          solverData->jacobianValid = 0;
+          calc_jac = 1;
+        }
+        else
+        {
+          /* the kept jacobian only counts as saved evaluation once it is accepted */
+          if (jac_kept)
+            solverData->numberOfJacobianSaved++;
+          broydenUpdate(n, x, fvec, solverData);
+          jac_fresh = 0;
+        }
+        jac_kept = 0;
+      }
+
       /* updating x */
       memcpy(x, solverData->x_new, *n*sizeof(double));
 
@@ -325,6 +390,43 @@ int _omc_newton(int(*f)(int*, double*, double*, void*, int), DATA_NEWTON* solver
 }
 
 
+/*! \fn broydenUpdate
+ *
+ *  rank-one update of the kept jacobian with the last step
+ *  jac = jac + (df - jac*dx)*dx^T / (dx^T*dx)
+ */
+void broydenUpdate(int* n, double* x, double* fvec, DATA_NEWTON* solverData)
+{
+  int i, j;
+  double *jac = solverData->jac;
+  double *dx = solverData->delta_x_vec;
+  double *r = solverData->rwork;
+  double dxdx = 0.0;
+
+  for (i=0; i<*n; i++)
+  {
+    dx[i] = solverData->x_new[i]-x[i];
+    dxdx += dx[i]*dx[i];
+  }
+
+  if (dxdx == 0.0)
+    return;
+
+  /* r = df - jac*dx */
+  for (j=0; j<*n; j++)
+    r[j] = fvec[j]-solverData->jac_f[j];
+  for (i=0; i<*n; i++)
+    for (j=0; j<*n; j++)
+      r[j] -= jac[i*(*n)+j]*dx[i];
+
+  for (i=0; i<*n; i++)
+  {
+    double scale = dx[i]/dxdx;
+    for (j=0; j<*n; j++)
+      jac[i*(*n)+j] += r[j]*scale;
+  }
+}
+
 /*! \fn printErrors
  *
  *  function prints errors, that reached tolerance
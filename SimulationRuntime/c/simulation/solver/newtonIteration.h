@@ -73,6 +73,15 @@ typedef struct DATA_NEWTON
   double* delta_f;
   double* delta_x_vec;
 
+  /* jacobian reuse with Broyden updates */
+  int jacobianReuse;      /* calls a kept jacobian may be reused, 0 off */
+  int jacobianValid;      /* 1 if jac holds a usable jacobian */
+  int jacobianCalls;      /* calls solved with jac since its last evaluation */
+  double* jac;            /* kept jacobian, not factorized */
+  double* jac_f;          /* function values belonging to the last use of jac */
+  int numberOfJacobianEvaluations; /* over the whole simulation time */
+  int numberOfJacobianSaved;       /* over the whole simulation time */
+
    rtclock_t timeClock;
 
 } DATA_NEWTON;
@@ -828,7 +828,8 @@ static int wrapper_fvec(DATA_HOMOTOPY* solverData, double* x, double* f)
 static int wrapper_fvec_der(DATA_HOMOTOPY* solverData, double* x, double* fJac)
 {
   int i;
-  int jacobianIndex = (&(solverData->data->simulationInfo.nonlinearSystemData[solverData->sysNumber]))->jacobianIndex;
+  NONLINEAR_SYSTEM_DATA* systemData = &(solverData->data->simulationInfo.nonlinearSystemData[solverData->sysNumber]);
+  int jacobianIndex = systemData->jacobianIndex;
 
   /* calculate jacobian */
   if(jacobianIndex != -1)
@@ -840,6 +841,7 @@ static int wrapper_fvec_der(DATA_HOMOTOPY* solverData, double* x, double* fJac)
   {
     getNumericalJacobianHomotopy(solverData, x, fJac);
   }
+  systemData->numberOfJEval++;
 
   if(ACTIVE_STREAM(LOG_NLS_JAC_TEST))
   {
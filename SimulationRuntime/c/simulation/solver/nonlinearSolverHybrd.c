@@ -362,6 +362,7 @@ static int wrapper_fvec_hybrj(const integer* n, const double* x, double* f, doub
     else{
       getNumericalJacobian(dataSys, fjac, x, f);
     }
+    systemData->numberOfJEval++;
 
     /* debug output */
     if (ACTIVE_STREAM(LOG_NLS_RES)) {
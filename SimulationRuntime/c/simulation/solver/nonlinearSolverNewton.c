@@ -235,6 +235,13 @@ int solveNewton(DATA *data, int sysNumber)
   /* try to calculate jacobian only once at the beginning of the iteration */
   solverData->calculate_jacobian = 0;
 
+  /* reuse the jacobian of the previous call, but not across events */
+  solverData->jacobianReuse = data->simulationInfo.nlsJacobianReuse;
+  if(data->simulationInfo.discreteCall || data->simulationInfo.initial ||
+     solverData->jacobianCalls >= solverData->jacobianReuse)
+    solverData->jacobianValid = 0;
+  solverData->jacobianCalls++;
+
   /* debug output */
   if(ACTIVE_STREAM(LOG_NLS_V))
   {
@@ -311,6 +318,7 @@ int solveNewton(DATA *data, int sysNumber)
 
       /* evaluate jacobian in every step now */
       solverData->calculate_jacobian = 1;
+      solverData->jacobianValid = 0;
     }
     else if(retries < 2)
     {
@@ -384,6 +392,8 @@ int solveNewton(DATA *data, int sysNumber)
   /* write statistics */
   systemData->numberOfFEval = solverData->numberOfFunctionEvaluations;
   systemData->numberOfIterations = solverData->numberOfIterations;
+  systemData->numberOfJEval = solverData->numberOfJacobianEvaluations;
+  systemData->numberOfJEvalSaved = solverData->numberOfJacobianSaved;
 
   return success;
 }
@@ -334,6 +334,8 @@ int initializeNonlinearSystems(DATA *data)
     size = nonlinsys[i].size;
     nonlinsys[i].numberOfFEval = 0;
     nonlinsys[i].numberOfIterations = 0;
+    nonlinsys[i].numberOfJEval = 0;
+    nonlinsys[i].numberOfJEvalSaved = 0;
 
     /* check if residual function pointer are valid */
     assertStreamPrint(data->threadData, 0 != nonlinsys[i].residualFunc, "residual function pointer is invalid" );
@@ -519,6 +521,9 @@ void printNonLinearSystemSolvingStatistics(DATA *data, int sysNumber, int logLev
   infoStreamPrint(logLevel, 0, " number of calls                : %ld", nonlinsys[sysNumber].numberOfCall);
   infoStreamPrint(logLevel, 0, " number of iterations           : %ld", nonlinsys[sysNumber].numberOfIterations);
   infoStreamPrint(logLevel, 0, " number of function evaluations : %ld", nonlinsys[sysNumber].numberOfFEval);
+  infoStreamPrint(logLevel, 0, " number of jacobian evaluations : %ld", nonlinsys[sysNumber].numberOfJEval);
+  if(data->simulationInfo.nlsJacobianReuse > 0)
+    infoStreamPrint(logLevel, 0, " jacobian evaluations saved     : %ld", nonlinsys[sysNumber].numberOfJEvalSaved);
   infoStreamPrint(logLevel, 0, " average time per call          : %f", nonlinsys[sysNumber].totalTime/nonlinsys[sysNumber].numberOfCall);
   infoStreamPrint(logLevel, 0, " total time                     : %f", nonlinsys[sysNumber].totalTime);
   messageClose(logLevel);
@@ -177,6 +177,7 @@ int initializeSolverData(DATA* data, SOLVER_INFO* solverInfo)
   solverInfo->didEventStep = 0;
   solverInfo->stateEvents = 0;
   solverInfo->sampleEvents = 0;
+  solverInfo->eventLocatorIterations = 0;
 
   /* if FLAG_NOEQUIDISTANT_GRID is set, choose dassl step method */
   if (omc_flag[FLAG_NOEQUIDISTANT_GRID])
@@ -479,6 +480,9 @@ int finishSimulation(DATA* data, SOLVER_INFO* solverInfo, const char* outputVari
     data->simulationInfo.terminal = 0;
   }
 
+  /* wait for a result writer running in the background */
+  sim_result.flush(&sim_result, data);
+
   if(0 != strcmp("ia", MMC_STRINGDATA(data->simulationInfo.outputFormat)))
   {
     communicateStatus("Finished", 1);
@@ -517,6 +521,8 @@ int finishSimulation(DATA* data, SOLVER_INFO* solverInfo, const char* outputVari
     infoStreamPrint(LOG_STATS, 1, "events");
     infoStreamPrint(LOG_STATS, 0, "%5ld state events", solverInfo->stateEvents);
     infoStreamPrint(LOG_STATS, 0, "%5ld time events", solverInfo->sampleEvents);
+    if(solverInfo->eventLocatorIterations)
+      infoStreamPrint(LOG_STATS, 0, "%5ld iterations to locate state events (%s)", solverInfo->eventLocatorIterations, EVENT_LOCATOR_NAME[data->simulationInfo.eventLocator]);
     messageClose(LOG_STATS);
 
 #if defined(WITH_DASSL)
@@ -554,6 +560,8 @@ int finishSimulation(DATA* data, SOLVER_INFO* solverInfo, const char* outputVari
     infoStreamPrint(LOG_STATS_V, 0, "%5ld calls of functionZeroCrossings", data->simulationInfo.callStatistics.functionZeroCrossings);
     messageClose(LOG_STATS_V);
 
+    memory_pool_statistics();
+
     infoStreamPrint(LOG_STATS_V, 1, "linear systems");
     for(ui=0; ui<data->modelData.nLinearSystems; ui++)
       printLinearSystemSolvingStatistics(data, ui, LOG_STATS_V);
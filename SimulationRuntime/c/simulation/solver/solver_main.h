@@ -63,6 +63,7 @@ typedef struct SOLVER_INFO
   /* stats */
   unsigned long stateEvents;
   unsigned long sampleEvents;
+  unsigned long eventLocatorIterations; /* iterations of findRoot for all state events */
 
   /* further options */
   int integratorSteps;
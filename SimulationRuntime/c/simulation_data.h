@@ -312,6 +312,8 @@ typedef struct NONLINEAR_SYSTEM_DATA
   unsigned long numberOfCall;           /* number of solving calls of this system */
   unsigned long numberOfFEval;          /* number of function evaluations of this system */
   unsigned long numberOfIterations;     /* number of iteration of non-linear solvers of this system */
+  unsigned long numberOfJEval;          /* number of jacobian evaluations of this system */
+  unsigned long numberOfJEvalSaved;     /* number of jacobian evaluations replaced by Broyden updates */
   double totalTime;                     /* save the totalTime */
   rtclock_t totalTimeClock;             /* time clock for the totalTime  */
 
@@ -481,6 +483,7 @@ typedef struct MODEL_DATA
   long nMathEvents;                    /* number of math triggering functions e.g. cail, floor, integer */
   long nDelayExpressions;
   long nExtObjs;
+  long nExtFunctions;                  /* number of external functions */
   long nMixedSystems;
   long nLinearSystems;
   long nNonLinearSystems;
@@ -514,9 +517,13 @@ typedef struct SIMULATION_INFO
   modelica_string outputFormat;
   modelica_string variableFilter;
   int lsMethod;                        /* linear solver */
+  int lsRefactor;                      /* solutions after which lapack refactorizes an unchanged matrix, 0 never */
   int mixedMethod;                     /* mixed solver */
   int nlsMethod;                       /* nonlinear solver */
+  int nlsJacobianReuse;                /* calls a Broyden updated jacobian is reused by newton, 0 off */
   int newtonStrategy;                  /* newton damping strategy solver */
+  int eventLocator;                    /* root finding method for state events */
+  int parmodautoScheduler;             /* task scheduler of -d=parmodauto models */
   int nlsCsvInfomation;                /* = 1 csv files with detailed nonlinear solver process are generated */
 
   double lambda;                       /* homotopy parameter E [0, 1.0] */
@@ -35,7 +35,11 @@
 #include <ctype.h>
 
 #include "omc_inline.h"
+#include "omc_mmap.h"
 #include "ModelicaUtilities.h"
+#if HAVE_MMAP
+#include <pthread.h>
+#endif
 #ifdef _MSC_VER
 #include "omc_msvc.h"
 #endif
@@ -46,18 +50,22 @@
 /* Definition to make a copy of the arrays */
 #define COPY_ARRAYS
 
+typedef struct TABLE_FILE_DATA TABLE_FILE_DATA;
+
 typedef struct InterpolationTable
 {
   char *filename;
   char *tablename;
   char own_data;
   double* data;
+  TABLE_FILE_DATA *file;  /* set if the data is read from a file */
   size_t rows;
   size_t cols;
   char colWise;
   int ipoType;
   int expoType;
   double startTime;
+  size_t lastRow;   /* row found by the last lookup, tried first by the next */
 } InterpolationTable;
 
 typedef struct InterpolationTable2D
@@ -66,12 +74,15 @@ typedef struct InterpolationTable2D
   char *tablename;
   char own_data;
   double *data;
+  TABLE_FILE_DATA *file;
   size_t rows;
   size_t cols;
 
   char colWise;
   int ipoType;
   int expoType;
+  size_t lastRow;   /* intervals found by the last lookup */
+  size_t lastCol;
 } InterpolationTable2D;
 
 static InterpolationTable** interpolationTables=NULL;
@@ -79,6 +90,11 @@ static int ninterpolationTables=0;
 static InterpolationTable2D** interpolationTables2D=NULL;
 static int ninterpolationTables2D=0;
 
+static TABLE_FILE_DATA *openSharedFile(const char *filename, const char* tableName);
+static void releaseSharedFile(TABLE_FILE_DATA *file);
+static inline double TableFile_getElt(TABLE_FILE_DATA *f, size_t row, size_t col);
+static inline char TableFile_isLazy(TABLE_FILE_DATA *f);
+
 static InterpolationTable *InterpolationTable_init(double time,double startTime, int ipoType, int expoType,
          const char* tableName, const char* fileName,
          const double *table,
@@ -88,9 +104,11 @@ static void InterpolationTable_deinit(InterpolationTable *tpl);
 static double InterpolationTable_interpolate(InterpolationTable *tpl, double time, size_t col);
 static double InterpolationTable_maxTime(InterpolationTable *tpl);
 static double InterpolationTable_minTime(InterpolationTable *tpl);
-static char InterpolationTable_compare(InterpolationTable *tpl, const char* fname, const char* tname, const double* table);
+static char InterpolationTable_compare(InterpolationTable *tpl, const char* fname, const char* tname, const double* table,
+         double startTime, int ipoType, int expoType, int colWise);
 
 static double InterpolationTable_extrapolate(InterpolationTable *tpl, double time, size_t col, char beforeData);
+static size_t InterpolationTable_findRow(InterpolationTable *tpl, double time, size_t lastIdx);
 static inline double InterpolationTable_interpolateLin(InterpolationTable *tpl, double time, size_t i, size_t j);
 static inline const double InterpolationTable_getElt(InterpolationTable *tpl, size_t row, size_t col);
 static void InterpolationTable_checkValidityOfData(InterpolationTable *tpl);
@@ -101,9 +119,11 @@ static InterpolationTable2D *InterpolationTable2D_init(int ipoType, const char*
            int tableDim1, int tableDim2, int colWise);
 static void InterpolationTable2D_deinit(InterpolationTable2D *table);
 static double InterpolationTable2D_interpolate(InterpolationTable2D *tpl, double x1, double x2);
-static char InterpolationTable2D_compare(InterpolationTable2D *tpl, const char* fname, const char* tname, const double* table);
+static char InterpolationTable2D_compare(InterpolationTable2D *tpl, const char* fname, const char* tname, const double* table,
+         int ipoType, int colWise);
 static double InterpolationTable2D_linInterpolate(double x, double x_1, double x_2, double f_1, double f_2);
 static const double InterpolationTable2D_getElt(InterpolationTable2D *tpl, size_t row, size_t col);
+static size_t InterpolationTable2D_findIndex(InterpolationTable2D *tpl, char alongRows, double x, size_t lo, size_t hi, size_t *last);
 static void InterpolationTable2D_checkValidityOfData(InterpolationTable2D *tpl);
 
 
@@ -138,7 +158,7 @@ int omcTableTimeIni(double timeIn, double startTime,int ipoType,int expoType,
 #endif
   /* if table is already initialized, find it */
   for(i = 0; i < ninterpolationTables; ++i)
-    if(InterpolationTable_compare(interpolationTables[i],fileName,tableName,table))
+    if(InterpolationTable_compare(interpolationTables[i],fileName,tableName,table,startTime,ipoType,expoType,colWise))
     {
 #ifdef INFOS
       infoStreamPrint("Table id = %d",i);
@@ -234,7 +254,7 @@ int omcTable2DIni(int ipoType, const char *tableName, const char* fileName,
 #endif
   /* if table is already initialized, find it */
   for(i = 0; i < ninterpolationTables2D; ++i)
-    if(InterpolationTable2D_compare(interpolationTables2D[i],fileName,tableName,table))
+    if(InterpolationTable2D_compare(interpolationTables2D[i],fileName,tableName,table,ipoType,colWise))
     {
 #ifdef INFOS
       infoStreamPrint("Table id = %d",i);
@@ -399,26 +419,26 @@ static char parseHead(TEXT_FILE *f, const char* hdr, size_t hdrLen, const char *
     }
   if(!readChr(&hdr, &hLen, '('))
   {
-    fclose(f->fp);
+    if(f->fp) fclose(f->fp);
     ModelicaFormatError("In file `%s': parsing error at line %lu and col %lu.", f->filename, (unsigned long)f->line, (unsigned long)(hdrLen-hLen));
   }
   *rows = (size_t)strtol(hdr, &endptr, 10);
   if(hdr == endptr)
   {
-    fclose(f->fp);
+    if(f->fp) fclose(f->fp);
     ModelicaFormatError("In file `%s': parsing error at line %lu and col %lu.", f->filename, (unsigned long)f->line, (unsigned long)(hdrLen-hLen));
   }
   hLen -= endptr-hdr;
   hdr = endptr;
   if(!readChr(&hdr, &hLen, ','))
   {
-    fclose(f->fp);
+    if(f->fp) fclose(f->fp);
     ModelicaFormatError("In file `%s': parsing error at line %lu and col %lu.", f->filename, (unsigned long)f->line, (unsigned long)(hdrLen-hLen));
   }
   *cols = (size_t)strtol(hdr, &endptr, 10);
   if(hdr == endptr)
   {
-    fclose(f->fp);
+    if(f->fp) fclose(f->fp);
     ModelicaFormatError("In file `%s': parsing error at line %lu and col %lu.", f->filename, (unsigned long)f->line, (unsigned long)(hdrLen-hLen));
   }
   hLen -= endptr-hdr;
@@ -427,7 +447,7 @@ static char parseHead(TEXT_FILE *f, const char* hdr, size_t hdrLen, const char *
 
   if((hLen > 0) && ((*hdr) != '#'))
   {
-    fclose(f->fp);
+    if(f->fp) fclose(f->fp);
     ModelicaFormatError("In file `%s': parsing error at line %lu and col %lu.", f->filename, (unsigned long)f->line, (unsigned long)(hdrLen-hLen));
   }
 
@@ -1022,6 +1042,506 @@ static char *copyTableNameFile(const char *name)
   return dst;
 }
 
+/*
+  Tables read from a file are kept once per file and table name and are
+  shared read-only by all instances using them.
+
+  Large text and csv files are memory mapped instead of read completely at
+  initialization. The rows are located once, the offsets are cached in a file
+  next to the table file, and the rows are parsed in blocks on first use.
+  Tables in MAT-files are used directly from the mapped file if they are
+  stored as doubles in the byte order of the machine.
+*/
+
+/* Text and csv files of at least this size are parsed on demand */
+#define LAZY_TABLE_FILE_SIZE (64*1024*1024)
+/* Number of rows parsed at once from a lazily read table */
+#define LAZY_TABLE_BLOCK_ROWS 256
+
+#if defined(__GNUC__)
+#define TABLE_LOAD_ACQUIRE(X) __atomic_load_n(&(X), __ATOMIC_ACQUIRE)
+#define TABLE_STORE_RELEASE(X,V) __atomic_store_n(&(X), (V), __ATOMIC_RELEASE)
+#else
+/* volatile accesses have acquire/release semantics with MSVC */
+#define TABLE_LOAD_ACQUIRE(X) (X)
+#define TABLE_STORE_RELEASE(X,V) ((X) = (V))
+#endif
+
+struct TABLE_FILE_DATA
+{
+  char *filename;
+  char *tablename;
+  double *data;
+  size_t rows;
+  size_t cols;
+  char colMajor;               /* data is stored column by column (MAT-files) */
+  char ownData;                /* data is allocated, not a pointer into the mapped file */
+  int refCount;
+#if HAVE_MMAP
+  omc_mmap_read_unix map;      /* size 0 if the file is not mapped */
+  char csv;
+  size_t *rowOffset;           /* lazily parsed tables: rows+1 offsets into map */
+  volatile char *blockParsed;
+  pthread_mutex_t blockMutex;
+#endif
+  struct TABLE_FILE_DATA *next;
+};
+
+static TABLE_FILE_DATA *tableFileData = NULL;
+
+#if HAVE_MMAP
+
+typedef struct TABLE_INDEX_HEADER
+{
+  char magic[8];
+  size_t fileSize;
+  time_t mtime;
+  size_t rows;
+  size_t cols;
+} TABLE_INDEX_HEADER;
+
+static const char TABLE_INDEX_MAGIC[8] = {'O','M','C','T','I','D','X','1'};
+
+static void TableFile_parseBlock(TABLE_FILE_DATA *f, size_t block)
+{
+  size_t first = block*LAZY_TABLE_BLOCK_ROWS;
+  size_t last = first+LAZY_TABLE_BLOCK_ROWS;
+  size_t row, col, len, buflen = 0;
+  char *buf = NULL, *number, *entp;
+
+  if(last > f->rows)
+    last = f->rows;
+
+  pthread_mutex_lock(&f->blockMutex);
+  if(!f->blockParsed[block])
+  {
+    for(row = first; row < last; ++row)
+    {
+      /* copy the line, strtod must not run past its end */
+      len = f->rowOffset[row+1] - f->rowOffset[row];
+      if(len+1 > buflen)
+      {
+        free(buf);
+        buflen = 2*len+1;
+        buf = (char*)malloc(buflen);
+        if (!buf) {
+          pthread_mutex_unlock(&f->blockMutex);
+          ModelicaFormatError("Not enough memory for loading file %s",f->filename);
+        }
+      }
+      memcpy(buf, f->map.data+f->rowOffset[row], len);
+      buf[len] = '\0';
+
+      number = buf;
+      for(col = 0; col < f->cols; ++col)
+      {
+        f->data[row*f->cols+col] = strtod(number,&entp);
+        if(f->csv)
+        {
+          while(*entp && *entp != ',')
+            ++entp;
+          if(*entp)
+            ++entp;
+        }
+        number = entp;
+      }
+    }
+    free(buf);
+    TABLE_STORE_RELEASE(f->blockParsed[block], 1);
+  }
+  pthread_mutex_unlock(&f->blockMutex);
+}
+
+static size_t TableFile_nextLine(TABLE_FILE_DATA *f, size_t pos)
+{
+  const char *nl = (const char*)memchr(f->map.data+pos, '\n', f->map.size-pos);
+  return nl ? (size_t)(nl-f->map.data)+1 : f->map.size;
+}
+
+/* length of the line starting at pos without the line end */
+static size_t TableFile_lineLength(TABLE_FILE_DATA *f, size_t pos, size_t next)
+{
+  size_t len = next-pos;
+  while(len > 0 && (f->map.data[pos+len-1] == '\n' || f->map.data[pos+len-1] == '\r'))
+    --len;
+  return len;
+}
+
+static void TableFile_indexRows(TABLE_FILE_DATA *f, size_t pos)
+{
+  size_t i;
+  f->rowOffset = (size_t*)malloc((f->rows+1)*sizeof(size_t));
+  if (!f->rowOffset) {
+    ModelicaFormatError("Not enough memory for Table: %s",f->tablename);
+  }
+  for(i = 0; i < f->rows; ++i)
+  {
+    if(pos >= f->map.size) {
+      ModelicaFormatError("In file `%s': table `%s' ends after %lu of %lu rows.", f->filename, f->tablename, (unsigned long)i, (unsigned long)f->rows);
+    }
+    f->rowOffset[i] = pos;
+    pos = TableFile_nextLine(f,pos);
+  }
+  f->rowOffset[f->rows] = pos;
+}
+
+static char TableFile_indexText(TABLE_FILE_DATA *f)
+{
+  TEXT_FILE tf;
+  const char *name = NULL;
+  const char *ln;
+  size_t pos = 0, next, len;
+
+  memset(&tf, 0, sizeof(TEXT_FILE));
+  tf.filename = f->filename;
+
+  while(pos < f->map.size)
+  {
+    ++tf.line;
+    next = TableFile_nextLine(f,pos);
+    len = TableFile_lineLength(f,pos,next);
+    ln = f->map.data+pos;
+    trim(&ln,&len);
+    if(len > 6 && parseHead(&tf,ln,len,&name,&f->rows,&f->cols) &&
+       strncmp(name,f->tablename,strlen(f->tablename)) == 0)
+    {
+      TableFile_indexRows(f,next);
+      return 1;
+    }
+    pos = next;
+  }
+  return 0;
+}
+
+static char TableFile_indexCsv(TABLE_FILE_DATA *f)
+{
+  size_t pos = 0, next, len, nameLen = strlen(f->tablename);
+
+  while(pos < f->map.size)
+  {
+    next = TableFile_nextLine(f,pos);
+    len = TableFile_lineLength(f,pos,next);
+    if(len == nameLen && strncmp(f->map.data+pos,f->tablename,len) == 0)
+    {
+      /* the table lasts as long as the lines start with a number */
+      size_t start = next, i;
+      f->rows = 0;
+      f->cols = 1;
+      for(pos = start; pos < f->map.size; pos = next)
+      {
+        const char *ln = f->map.data+pos;
+        next = TableFile_nextLine(f,pos);
+        len = TableFile_lineLength(f,pos,next);
+        trim(&ln,&len);
+        if(len == 0 || !(isdigit(*ln) || *ln == '-' || *ln == '+' || *ln == '.'))
+          break;
+        if(f->rows == 0)
+          for(i = 0; i < len; ++i)
+            if(ln[i] == ',')
+              f->cols++;
+        f->rows++;
+      }
+      if(f->rows == 0)
+        return 0;
+      TableFile_indexRows(f,start);
+      return 1;
+    }
+    pos = next;
+  }
+  return 0;
+}
+
+static char *TableFile_indexName(TABLE_FILE_DATA *f)
+{
+  size_t l = strlen(f->filename)+strlen(f->tablename)+6;
+  char *name = (char*)malloc(l);
+  if (!name) {
+    ModelicaFormatError("Not enough memory for Table: %s",f->tablename);
+  }
+  snprintf(name,l,"%s.%s.idx",f->filename,f->tablename);
+  return name;
+}
+
+static char TableFile_readIndex(TABLE_FILE_DATA *f, const struct stat *s)
+{
+  TABLE_INDEX_HEADER hdr;
+  char *name = TableFile_indexName(f);
+  FILE *fp = fopen(name,"rb");
+  free(name);
+  if(!fp)
+    return 0;
+
+  if(fread(&hdr,sizeof(TABLE_INDEX_HEADER),1,fp) != 1 ||
+     memcmp(hdr.magic,TABLE_INDEX_MAGIC,8) != 0 ||
+     hdr.fileSize != f->map.size || hdr.mtime != s->st_mtime || hdr.rows == 0)
+  {
+    fclose(fp);
+    return 0;
+  }
+
+  f->rowOffset = (size_t*)malloc((hdr.rows+1)*sizeof(size_t));
+  if(!f->rowOffset || fread(f->rowOffset,sizeof(size_t),hdr.rows+1,fp) != hdr.rows+1 ||
+     f->rowOffset[hdr.rows] > f->map.size)
+  {
+    free(f->rowOffset);
+    f->rowOffset = NULL;
+    fclose(fp);
+    return 0;
+  }
+  fclose(fp);
+
+  f->rows = hdr.rows;
+  f->cols = hdr.cols;
+  return 1;
+}
+
+/* the index is only a cache, it does not matter if it can not be written */
+static void TableFile_writeIndex(TABLE_FILE_DATA *f, const struct stat *s)
+{
+  TABLE_INDEX_HEADER hdr;
+  char *name = TableFile_indexName(f);
+  FILE *fp = fopen(name,"wb");
+
+  if(fp)
+  {
+    memset(&hdr,0,sizeof(TABLE_INDEX_HEADER));
+    memcpy(hdr.magic,TABLE_INDEX_MAGIC,8);
+    hdr.fileSize = f->map.size;
+    hdr.mtime = s->st_mtime;
+    hdr.rows = f->rows;
+    hdr.cols = f->cols;
+    if(fwrite(&hdr,sizeof(TABLE_INDEX_HEADER),1,fp) != 1 ||
+       fwrite(f->rowOffset,sizeof(size_t),f->rows+1,fp) != f->rows+1)
+    {
+      fclose(fp);
+      remove(name);
+    }
+    else
+    {
+      fclose(fp);
+    }
+  }
+  free(name);
+}
+
+static void Mat_swapInt(int *num)
+{
+  unsigned char *b = (unsigned char*)num, tmp;
+  tmp = b[0]; b[0] = b[3]; b[3] = tmp;
+  tmp = b[1]; b[1] = b[2]; b[2] = tmp;
+}
+
+/* MAT v4: 5 integer header, the name and the matrix stored column by column */
+static char TableFile_findMat(TABLE_FILE_DATA *f)
+{
+  size_t pos = 0, nameLen = strlen(f->tablename);
+  static const size_t elemSizes[6] = {sizeof(double), sizeof(float), 4, 2, 2, 1};
+
+  while(pos + 5*sizeof(int) <= f->map.size)
+  {
+    int hdr[5], i;
+    size_t elemSize, dataSize;
+    const char *name;
+    char isBigEndian;
+    long P;
+
+    memcpy(hdr, f->map.data+pos, 5*sizeof(int));
+    if(hdr[0] < 0 || hdr[0] > 9999)
+      for(i = 0; i < 5; ++i)
+        Mat_swapInt(&hdr[i]);
+    P = (hdr[0]%1000)/100;
+    isBigEndian = (hdr[0]/1000) == 1;
+    if(P > 5 || hdr[1] < 0 || hdr[2] < 0 || hdr[4] < 0) {
+      ModelicaFormatError("Corrupted MAT-file: `%s'",f->filename);
+    }
+    elemSize = elemSizes[P];
+    pos += 5*sizeof(int);
+    name = f->map.data+pos;
+    pos += hdr[4];
+    dataSize = (size_t)hdr[1]*hdr[2]*elemSize*(hdr[3]?2:1);
+    if(pos + dataSize > f->map.size) {
+      ModelicaFormatError("Corrupted MAT-file: `%s'",f->filename);
+    }
+
+    if((size_t)hdr[4] == nameLen+1 && strncmp(name,f->tablename,nameLen) == 0)
+    {
+      const char *values = f->map.data+pos;
+      if(hdr[0]%10 != 0 || hdr[0]/1000 > 1) {
+        ModelicaFormatError("Table `%s' not in supported format.",f->tablename);
+      }
+      if(hdr[1] <= 0 || hdr[2] <= 0) {
+        ModelicaFormatError("Table `%s' has zero dimensions [%lu,%lu].", f->tablename, (unsigned long)hdr[1], (unsigned long)hdr[2]);
+      }
+      f->rows = hdr[1];
+      f->cols = hdr[2];
+      f->colMajor = 1;
+      if(P == 0 && isBigEndian == getEndianness() && ((size_t)values) % sizeof(double) == 0)
+      {
+        f->data = (double*)values;
+        f->ownData = 0;
+      }
+      else
+      {
+        size_t k;
+        elem_t num;
+        f->data = (double*)malloc(f->rows*f->cols*sizeof(double));
+        if (!f->data) {
+          ModelicaFormatError("Not enough memory for Table: %s",f->tablename);
+        }
+        f->ownData = 1;
+        for(k = 0; k < f->rows*f->cols; ++k)
+        {
+          memcpy(num.p, values+k*elemSize, elemSize);
+          f->data[k] = Mat_getElem(&num,(char)P,isBigEndian);
+        }
+      }
+      return 1;
+    }
+    pos += dataSize;
+  }
+  return 0;
+}
+
+/* Returns 0 if the file should be read completely by openFile. */
+static char TableFile_openMapped(TABLE_FILE_DATA *f)
+{
+  struct stat s;
+  size_t sl = strlen(f->filename);
+  char isMat = sl >= 4 && strcmp(f->filename+sl-4,".mat") == 0;
+  char isCsv = sl >= 4 && strcmp(f->filename+sl-4,".csv") == 0;
+  char isTxt = sl >= 4 && strcmp(f->filename+sl-4,".txt") == 0;
+  size_t nBlocks;
+
+  if(!(isMat || isCsv || isTxt) || stat(f->filename,&s) != 0)
+    return 0;
+  if(!isMat && (size_t)s.st_size < LAZY_TABLE_FILE_SIZE)
+    return 0;
+  if(omc_mmap_try_open_read_unix(f->filename,&f->map) != NULL)
+    return 0;
+
+  if(isMat)
+  {
+    if(!TableFile_findMat(f)) {
+      ModelicaFormatError("No table named `%s' in file `%s'.",f->tablename,f->filename);
+    }
+    /* converted tables do not need the file any more */
+    if(f->ownData)
+    {
+      omc_mmap_close_read_unix(f->map);
+      f->map.size = 0;
+    }
+    return 1;
+  }
+
+  f->csv = isCsv;
+  if(!TableFile_readIndex(f,&s))
+  {
+    if(!(isCsv ? TableFile_indexCsv(f) : TableFile_indexText(f))) {
+      ModelicaFormatError("No table named `%s' in file `%s'.",f->tablename,f->filename);
+    }
+    TableFile_writeIndex(f,&s);
+  }
+
+  /* only the pages of the parsed blocks are ever touched */
+  nBlocks = (f->rows+LAZY_TABLE_BLOCK_ROWS-1)/LAZY_TABLE_BLOCK_ROWS;
+  f->data = (double*)calloc(f->rows*f->cols,sizeof(double));
+  f->blockParsed = (volatile char*)calloc(nBlocks,sizeof(char));
+  if (!f->data || !f->blockParsed) {
+    ModelicaFormatError("Not enough memory for Table: %s",f->tablename);
+  }
+  f->ownData = 1;
+  pthread_mutex_init(&f->blockMutex,NULL);
+  return 1;
+}
+
+#endif /* HAVE_MMAP */
+
+static inline char TableFile_isLazy(TABLE_FILE_DATA *f)
+{
+#if HAVE_MMAP
+  return f && f->blockParsed;
+#else
+  return 0;
+#endif
+}
+
+static inline double TableFile_getElt(TABLE_FILE_DATA *f, size_t row, size_t col)
+{
+#if HAVE_MMAP
+  if(f->blockParsed && !TABLE_LOAD_ACQUIRE(f->blockParsed[row/LAZY_TABLE_BLOCK_ROWS]))
+    TableFile_parseBlock(f,row/LAZY_TABLE_BLOCK_ROWS);
+#endif
+  return f->colMajor ? f->data[col*f->rows+row] : f->data[row*f->cols+col];
+}
+
+static TABLE_FILE_DATA *openSharedFile(const char *filename, const char* tableName)
+{
+  TABLE_FILE_DATA *f = NULL;
+
+  for(f = tableFileData; f; f = f->next)
+  {
+    if(!strcmp(f->filename,filename) && !strcmp(f->tablename,tableName))
+    {
+      f->refCount++;
+      return f;
+    }
+  }
+
+  f = (TABLE_FILE_DATA*)calloc(1,sizeof(TABLE_FILE_DATA));
+  if (!f) {
+    ModelicaFormatError("Not enough memory for Table: %s",tableName);
+  }
+  f->filename = copyTableNameFile(filename);
+  f->tablename = copyTableNameFile(tableName);
+
+#if HAVE_MMAP
+  if(!TableFile_openMapped(f))
+#endif
+  {
+    openFile(filename,tableName,&f->rows,&f->cols,&f->data);
+    f->ownData = 1;
+  }
+
+  f->refCount = 1;
+  f->next = tableFileData;
+  tableFileData = f;
+
+  return f;
+}
+
+static void releaseSharedFile(TABLE_FILE_DATA *file)
+{
+  TABLE_FILE_DATA **prev = &tableFileData;
+  TABLE_FILE_DATA *f = NULL;
+
+  for(f = tableFileData; f; prev = &f->next, f = f->next)
+  {
+    if(f == file)
+    {
+      if(--f->refCount == 0)
+      {
+        *prev = f->next;
+#if HAVE_MMAP
+        if(f->blockParsed)
+        {
+          pthread_mutex_destroy(&f->blockMutex);
+          free((char*)f->blockParsed);
+        }
+        free(f->rowOffset);
+        if(f->map.size)
+          omc_mmap_close_read_unix(f->map);
+#endif
+        if(f->ownData)
+          free(f->data);
+        free(f->filename);
+        free(f->tablename);
+        free(f);
+      }
+      return;
+    }
+  }
+}
+
 static InterpolationTable* InterpolationTable_init(double time, double startTime,
                int ipoType, int expoType,
                const char* tableName, const char* fileName,
@@ -1048,8 +1568,11 @@ static InterpolationTable* InterpolationTable_init(double time, double startTime
 
     if(fileName && strncmp("NoName",fileName,6) != 0)
     {
-      openFile(fileName,tableName,&(tpl->rows),&(tpl->cols),&(tpl->data));
-      tpl->own_data = 1;
+      tpl->file = openSharedFile(fileName,tableName);
+      tpl->data = tpl->file->data;
+      tpl->rows = tpl->file->rows;
+      tpl->cols = tpl->file->cols;
+      tpl->own_data = 0;
     } else
     {
 #ifndef COPY_ARRAYS
@@ -1072,8 +1595,10 @@ static InterpolationTable* InterpolationTable_init(double time, double startTime
       }
 #endif
     }
-    /* check that time column is strictly monotonous */
-    InterpolationTable_checkValidityOfData(tpl);
+    /* check that time column is strictly monotonous, lazily read
+       files are not parsed completely just for the check */
+    if(!TableFile_isLazy(tpl->file))
+      InterpolationTable_checkValidityOfData(tpl);
   }
   return tpl;
 }
@@ -1084,6 +1609,10 @@ static void InterpolationTable_deinit(InterpolationTable *tpl)
   {
     if(tpl->own_data)
       free(tpl->data);
+    else if(tpl->file)
+      releaseSharedFile(tpl->file);
+    free(tpl->tablename);
+    free(tpl->filename);
     free(tpl);
   }
 }
@@ -1105,25 +1634,64 @@ static double InterpolationTable_interpolate(InterpolationTable *tpl, double tim
   if(time < InterpolationTable_minTime(tpl))
     return InterpolationTable_extrapolate(tpl,time,col,time <= InterpolationTable_minTime(tpl));
 
-  for(i = 0; i < lastIdx; ++i) {
-    if(InterpolationTable_getElt(tpl,i,0) > time) {
-      return InterpolationTable_interpolateLin(tpl,time, i-1,col);
-    }
+  i = InterpolationTable_findRow(tpl,time,lastIdx);
+  if(i < lastIdx) {
+    return InterpolationTable_interpolateLin(tpl,time, i-1,col);
   }
   return InterpolationTable_extrapolate(tpl,time,col,time <= InterpolationTable_minTime(tpl));
 }
 
+/* Returns the first row with a time greater than time, lastIdx if there is
+ * none. The solvers mostly ask for the same or the next interval, so these
+ * are checked before falling back to a binary search.
+ */
+static size_t InterpolationTable_findRow(InterpolationTable *tpl, double time, size_t lastIdx)
+{
+  size_t lo = 0, hi = lastIdx, mid;
+  size_t i = tpl->lastRow;
+
+  if(i > 0 && i < lastIdx)
+  {
+    if(InterpolationTable_getElt(tpl,i-1,0) <= time)
+    {
+      if(InterpolationTable_getElt(tpl,i,0) > time)
+        return i;
+      lo = i+1;
+      if(lo < lastIdx && InterpolationTable_getElt(tpl,lo,0) > time)
+      {
+        tpl->lastRow = lo;
+        return lo;
+      }
+    }
+    else
+    {
+      hi = i-1;
+    }
+  }
+
+  while(lo < hi)
+  {
+    mid = lo + (hi-lo)/2;
+    if(InterpolationTable_getElt(tpl,mid,0) > time)
+      hi = mid;
+    else
+      lo = mid+1;
+  }
+  tpl->lastRow = lo;
+  return lo;
+}
+
 static double InterpolationTable_maxTime(InterpolationTable *tpl)
 {
   return (tpl->data?InterpolationTable_getElt(tpl,tpl->rows-1,0):0.0);
 }
 static double InterpolationTable_minTime(InterpolationTable *tpl)
 {
-  return (tpl->data?tpl->data[0]:0.0);
+  return (tpl->data?InterpolationTable_getElt(tpl,0,0):0.0);
 }
 
 static char InterpolationTable_compare(InterpolationTable *tpl, const char* fname, const char* tname,
-         const double* table)
+         const double* table, double startTime, int ipoType, int expoType, int colWise)
 {
   if( (fname == NULL || tname == NULL) || ((strncmp("NoName",fname,6) == 0 && strncmp("NoName",tname,6) == 0)) )
   {
@@ -1132,8 +1700,10 @@ static char InterpolationTable_compare(InterpolationTable *tpl, const char* fnam
   }
   else
   {
-    /* table loaded from file */
-    return ((!strncmp(tpl->filename,fname,6)) && (!strncmp(tpl->tablename,tname,6)));
+    /* table loaded from file, the data is shared anyway if the settings differ */
+    return ((!strcmp(tpl->filename,fname)) && (!strcmp(tpl->tablename,tname)) &&
+            tpl->startTime == startTime && tpl->ipoType == ipoType &&
+            tpl->expoType == expoType && tpl->colWise == colWise);
   }
 }
 
@@ -1182,6 +1752,16 @@ static const double InterpolationTable_getElt(InterpolationTable *tpl, size_t ro
       (unsigned long)row, (unsigned long)col);
   }
 
+  if(tpl->file)
+  {
+    /* the file holds the rows as written, colWise refers to the flat data */
+    if(tpl->colWise)
+    {
+      size_t k = col*tpl->rows+row;
+      return TableFile_getElt(tpl->file,k/tpl->cols,k%tpl->cols);
+    }
+    return TableFile_getElt(tpl->file,row,col);
+  }
   return tpl->data[tpl->colWise ? col*tpl->rows+row : row*tpl->cols+col];
 }
 
@@ -1226,8 +1806,11 @@ static InterpolationTable2D* InterpolationTable2D_init(int ipoType, const char*
 
     if(fileName && strncmp("NoName",fileName,6) != 0)
     {
-      openFile(fileName,tableName,&(tpl->rows),&(tpl->cols),&(tpl->data));
-      tpl->own_data = 1;
+      tpl->file = openSharedFile(fileName,tableName);
+      tpl->data = tpl->file->data;
+      tpl->rows = tpl->file->rows;
+      tpl->cols = tpl->file->cols;
+      tpl->own_data = 0;
     } else {
 #ifndef COPY_ARRAYS
       if (!table) {
@@ -1250,7 +1833,8 @@ static InterpolationTable2D* InterpolationTable2D_init(int ipoType, const char*
 }
   }
   /* check if table is valid */
-  InterpolationTable2D_checkValidityOfData(tpl);
+  if(!TableFile_isLazy(tpl->file))
+    InterpolationTable2D_checkValidityOfData(tpl);
   return tpl;
 }
 
@@ -1260,6 +1844,10 @@ static void InterpolationTable2D_deinit(InterpolationTable2D *table)
   {
     if(table->own_data)
       free(table->data);
+    else if(table->file)
+      releaseSharedFile(table->file);
+    free(table->tablename);
+    free(table->filename);
     free(table);
   }
 }
@@ -1441,8 +2029,7 @@ static double InterpolationTable2D_interpolate(InterpolationTable2D *table, doub
       return InterpolationTable2D_getElt(table,1,1);
     }
     /* find interval corresponding x1 */
-    for(i = 2; i < table->rows; ++i)
-      if(InterpolationTable2D_getElt(table,i,0) >= x1) break;
+    i = InterpolationTable2D_findIndex(table,1,x1,2,table->rows,&table->lastRow);
     if((table->ipoType == 2) && (table->rows > 3))
     {
       /* smooth interpolation with Akima Splines such that der(y) is continuous */
@@ -1466,8 +2053,7 @@ static double InterpolationTable2D_interpolate(InterpolationTable2D *table, doub
   if(table->rows == 2)
   {
     /* find interval corresponding x2 */
-    for(j = 2; j < table->cols; ++j)
-      if(InterpolationTable2D_getElt(table,0,j) >= x2) break;
+    j = InterpolationTable2D_findIndex(table,0,x2,2,table->cols,&table->lastCol);
 
     if((table->ipoType == 2) && (table->cols > 3))
     {
@@ -1490,10 +2076,8 @@ static double InterpolationTable2D_interpolate(InterpolationTable2D *table, doub
   }
 
   /* find intervals corresponding x1 and x2 */
-  for(i = 2; i < table->rows-1; ++i)
-    if(InterpolationTable2D_getElt(table,i,0) >= x1) break;
-  for(j = 2; j < table->cols-1; ++j)
-    if(InterpolationTable2D_getElt(table,0,j) >= x2) break;
+  i = InterpolationTable2D_findIndex(table,1,x1,2,table->rows-1,&table->lastRow);
+  j = InterpolationTable2D_findIndex(table,0,x2,2,table->cols-1,&table->lastCol);
 
   if((table->ipoType == 2) && (table->rows != 3) && (table->cols != 3)  )
   {
@@ -1543,7 +2127,8 @@ static double InterpolationTable2D_interpolate(InterpolationTable2D *table, doub
   return InterpolationTable2D_linInterpolate(x2,InterpolationTable2D_getElt(table,0,j-1),InterpolationTable2D_getElt(table,0,j),f_1,f_2);
 }
 
-static char InterpolationTable2D_compare(InterpolationTable2D *tpl, const char* fname, const char* tname, const double* table)
+static char InterpolationTable2D_compare(InterpolationTable2D *tpl, const char* fname, const char* tname, const double* table,
+         int ipoType, int colWise)
 {
   if( (fname == NULL || tname == NULL) || ((strncmp("NoName",fname,6) == 0 && strncmp("NoName",tname,6) == 0)) )
   {
@@ -1552,8 +2137,9 @@ static char InterpolationTable2D_compare(InterpolationTable2D *tpl, const char*
   }
   else
   {
-    /* table loaded from file */
-    return ((!strncmp(tpl->filename,fname,6)) && (!strncmp(tpl->tablename,tname,6)));
+    /* table loaded from file, the data is shared anyway if the settings differ */
+    return ((!strcmp(tpl->filename,fname)) && (!strcmp(tpl->tablename,tname)) &&
+            tpl->ipoType == ipoType && tpl->colWise == colWise);
   }
   return 0;
 }
@@ -1568,9 +2154,56 @@ static const double InterpolationTable2D_getElt(InterpolationTable2D *tpl, size_
   if (!(row < tpl->rows && col < tpl->cols)) {
     ModelicaFormatError("In Table: %s from File: %s with Size[%lu,%lu] try to get Element[%lu,%lu] out of range!", tpl->tablename, tpl->filename, (unsigned long)tpl->rows, (unsigned long)tpl->cols, (unsigned long)row, (unsigned long)col);
   }
+  if(tpl->file)
+    return TableFile_getElt(tpl->file,row,col);
   return tpl->data[row*tpl->cols+col];
 }
 
+static inline double InterpolationTable2D_axis(InterpolationTable2D *tpl, char alongRows, size_t k)
+{
+  return alongRows ? InterpolationTable2D_getElt(tpl,k,0) : InterpolationTable2D_getElt(tpl,0,k);
+}
+
+/* Returns the first index in [lo,hi) of the first column (alongRows) or the
+ * first row with a value not less than x, hi if there is none. As for the
+ * time tables the last result and the one after it are tried first.
+ */
+static size_t InterpolationTable2D_findIndex(InterpolationTable2D *tpl, char alongRows, double x, size_t lo, size_t hi, size_t *last)
+{
+  size_t mid;
+  size_t k = *last;
+
+  if(k > lo && k < hi)
+  {
+    if(InterpolationTable2D_axis(tpl,alongRows,k-1) < x)
+    {
+      if(InterpolationTable2D_axis(tpl,alongRows,k) >= x)
+        return k;
+      lo = k+1;
+      if(lo < hi && InterpolationTable2D_axis(tpl,alongRows,lo) >= x)
+      {
+        *last = lo;
+        return lo;
+      }
+    }
+    else
+    {
+      hi = k-1;
+    }
+  }
+
+  while(lo < hi)
+  {
+    mid = lo + (hi-lo)/2;
+    if(InterpolationTable2D_axis(tpl,alongRows,mid) >= x)
+      hi = mid;
+    else
+      lo = mid+1;
+  }
+  *last = lo;
+  return lo;
+}
+
 static void InterpolationTable2D_checkValidityOfData(InterpolationTable2D *tpl)
 {
   size_t i = 0;
@@ -38,6 +38,8 @@
 #include <stdio.h>
 #include <assert.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
 
 /** function: base_array_create
  **
@@ -290,6 +292,187 @@ size_t calc_base_index_spec(int ndims, const _index_t *idx_vec,
     return index;
 }
 
+/* Copies n elements between two buffers with byte steps dst_step and
+ * src_step; the element sizes of the runtime types get a constant memcpy */
+static inline void copy_strided_data(char *dst, ptrdiff_t dst_step,
+                                     const char *src, ptrdiff_t src_step,
+                                     size_t n, size_t elemsize)
+{
+    size_t k;
+    switch(elemsize) {
+    case 8:
+        for(k = 0; k < n; ++k, dst += dst_step, src += src_step) memcpy(dst, src, 8);
+        break;
+    case 4:
+        for(k = 0; k < n; ++k, dst += dst_step, src += src_step) memcpy(dst, src, 4);
+        break;
+    case 1:
+        for(k = 0; k < n; ++k, dst += dst_step, src += src_step) *dst = *src;
+        break;
+    default:
+        for(k = 0; k < n; ++k, dst += dst_step, src += src_step) memcpy(dst, src, elemsize);
+    }
+}
+
+/*
+ * Copies the elements of arr selected by spec, in row-major order, from
+ * (gather != 0) or to the dense buffer data.
+ *
+ * Trailing whole dimensions (':') are collapsed into one contiguous block.
+ * The last subscripted dimension is classified as a contiguous range
+ * (one memmove per block), a range with constant step (strided loop) or
+ * an arbitrary index vector (gather per block). Single elements out of a
+ * range of rows, like A[:,k], are copied with one strided loop. Remaining
+ * outer dimensions are traversed with next_index.
+ */
+static void copy_base_array_index_spec(base_array_t *arr, const index_spec_t *spec,
+                                       char *data, size_t elemsize, int gather)
+{
+    int i, c;
+    size_t k, l, n, m = 1, blk = 1, run;
+    ptrdiff_t step, row_step = 1;
+    int contiguous, strided, rows_strided = 1;
+    const _index_t *idx;
+    const _index_t *row_idx = NULL;
+    _index_t *idx_vec = NULL;
+    _index_t *idx_size = NULL;
+    char *arr_data = (char*) arr->data;
+
+    for(c = spec->ndims - 1; c >= 0 && spec->index[c] == NULL; --c) {
+        blk *= arr->dim_size[c];
+    }
+    if(blk == 0) {
+        return;
+    }
+    if(c < 0) { /* all dimensions are ':' */
+        if(gather) {
+            memmove(data, arr_data, blk * elemsize);
+        } else {
+            memmove(arr_data, data, blk * elemsize);
+        }
+        return;
+    }
+
+    /* classify the last subscripted dimension */
+    idx = spec->index[c];
+    n = imax(spec->dim_size[c], 1);
+    step = (n > 1) ? (idx[1] - idx[0]) : 1;
+    for(k = 2; k < n && (idx[k] - idx[k-1]) == step; ++k);
+    contiguous = (k >= n) && (step == 1);
+    strided = (k >= n) && (blk == 1);
+    run = n * blk * elemsize;
+
+    /* the dimension before it is looped over directly */
+    if(c > 0) {
+        row_idx = spec->index[c-1];
+        if(row_idx != NULL) {
+            m = imax(spec->dim_size[c-1], 1);
+            row_step = (m > 1) ? (row_idx[1] - row_idx[0]) : 1;
+            for(l = 2; l < m && (row_idx[l] - row_idx[l-1]) == row_step; ++l);
+            rows_strided = (l >= m);
+        } else {
+            m = arr->dim_size[c-1];
+        }
+        if(m == 0) {
+            return;
+        }
+    }
+
+    if(c > 1) {
+        idx_vec = size_alloc(c - 1);
+        idx_size = size_alloc(c - 1);
+        for(i = 0; i < c - 1; ++i) {
+            idx_vec[i] = 0;
+            if(spec->index[i] != NULL) {
+                idx_size[i] = imax(spec->dim_size[i], 1);
+            } else {
+                idx_size[i] = arr->dim_size[i];
+            }
+            if(idx_size[i] == 0) {
+                return;
+            }
+        }
+    }
+
+    do {
+        size_t offset = 0;
+        for(i = 0; i < c - 1; ++i) {
+            size_t d = (spec->index[i] != NULL) ? (size_t)(spec->index[i][idx_vec[i]] - 1) : (size_t)idx_vec[i];
+            offset = (offset * arr->dim_size[i]) + d;
+        }
+        if(c > 0) {
+            offset *= arr->dim_size[c-1];
+        }
+
+        if(c > 0 && n * blk == 1 && rows_strided) {
+            size_t row0 = (row_idx != NULL) ? (size_t)(row_idx[0] - 1) : 0;
+            char *p = arr_data + ((offset + row0) * arr->dim_size[c] + (idx[0] - 1)) * elemsize;
+            ptrdiff_t p_step = row_step * (ptrdiff_t)(arr->dim_size[c] * elemsize);
+            if(gather) {
+                copy_strided_data(data, elemsize, p, p_step, m, elemsize);
+            } else {
+                copy_strided_data(p, p_step, data, elemsize, m, elemsize);
+            }
+            data += m * elemsize;
+            continue;
+        }
+
+        for(l = 0; l < m; ++l) {
+            size_t row = (c == 0) ? 0 : ((row_idx != NULL) ? (size_t)(row_idx[l] - 1) : l);
+            char *slab = arr_data + (offset + row) * arr->dim_size[c] * blk * elemsize;
+
+            if(contiguous) {
+                char *p = slab + (idx[0] - 1) * blk * elemsize;
+                if(gather) {
+                    memmove(data, p, run);
+                } else {
+                    memmove(p, data, run);
+                }
+            } else if(strided) {
+                char *p = slab + (idx[0] - 1) * elemsize;
+                if(gather) {
+                    copy_strided_data(data, elemsize, p, step * (ptrdiff_t)elemsize, n, elemsize);
+                } else {
+                    copy_strided_data(p, step * (ptrdiff_t)elemsize, data, elemsize, n, elemsize);
+                }
+            } else {
+                for(k = 0; k < n; ++k) {
+                    char *p = slab + (idx[k] - 1) * blk * elemsize;
+                    if(gather) {
+                        memmove(data + k * blk * elemsize, p, blk * elemsize);
+                    } else {
+                        memmove(p, data + k * blk * elemsize, blk * elemsize);
+                    }
+                }
+            }
+            data += run;
+        }
+    } while(c > 1 && 0 == next_index(c - 1, idx_vec, idx_size));
+}
+
+/* dest_data := source[source_spec], dest_data is dense and row-major */
+void index_base_array_data(const base_array_t *source, const index_spec_t *source_spec,
+                           void *dest_data, size_t elemsize)
+{
+    assert(base_array_ok(source));
+    assert(index_spec_ok(source_spec));
+    assert(index_spec_fit_base_array(source_spec, source));
+
+    copy_base_array_index_spec((base_array_t*) source, source_spec,
+                               (char*) dest_data, elemsize, 1);
+}
+
+/* dest[dest_spec] := source_data, source_data is dense and row-major */
+void indexed_assign_base_array_data(const void *source_data, base_array_t *dest,
+                                    const index_spec_t *dest_spec, size_t elemsize)
+{
+    assert(base_array_ok(dest));
+    assert(index_spec_ok(dest_spec));
+    assert(index_spec_fit_base_array(dest_spec, dest));
+
+    copy_base_array_index_spec(dest, dest_spec, (char*) source_data, elemsize, 0);
+}
+
 /* Uses zero based indexing */
 size_t calc_base_index(int ndims, const _index_t *idx_vec, const base_array_t *arr)
 {
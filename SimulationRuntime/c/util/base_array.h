@@ -98,6 +98,10 @@ int base_array_one_element_ok(const base_array_t *a);
 size_t calc_base_index_spec(int ndims, const _index_t* idx_vec,
                             const base_array_t *arr, const index_spec_t *spec);
 size_t calc_base_index(int ndims, const _index_t *idx_vec, const base_array_t *arr);
+void index_base_array_data(const base_array_t *source, const index_spec_t *source_spec,
+                           void *dest_data, size_t elemsize);
+void indexed_assign_base_array_data(const void *source_data, base_array_t *dest,
+                                    const index_spec_t *dest_spec, size_t elemsize);
 size_t calc_base_index_va(const base_array_t *source, int ndims, va_list ap);
 
 size_t calc_base_index_dims_subs(int ndims,...);
@@ -306,8 +306,6 @@ void simple_indexed_assign_boolean_array2(const boolean_array_t* source,
 void indexed_assign_boolean_array(const boolean_array_t source, boolean_array_t* dest,
                                   const index_spec_t* dest_spec)
 {
-    _index_t* idx_vec1;
-    _index_t* idx_size;
     int i,j;
 
     assert(base_array_ok(&source));
@@ -321,29 +319,7 @@ void indexed_assign_boolean_array(const boolean_array_t source, boolean_array_t*
     }
     assert(j == source.ndims);
 
-    idx_vec1 = size_alloc(dest->ndims);
-    idx_size = size_alloc(dest_spec->ndims);
-
-    for(i = 0; i < dest_spec->ndims; ++i) {
-        idx_vec1[i] = 0;
-
-        if(dest_spec->index[i] != NULL) { /* is 'S' or 'A' */
-            idx_size[i] = imax(dest_spec->dim_size[i],1);
-        } else { /* is 'W' */
-            idx_size[i] = dest->dim_size[i];
-        }
-    }
-
-    j = 0;
-    do {
-        boolean_set(dest,
-                    calc_base_index_spec(dest->ndims, idx_vec1, dest, dest_spec),
-                    boolean_get(source, j));
-        j++;
-
-    } while(0 == next_index(dest_spec->ndims, idx_vec1, idx_size));
-
-    assert(j == base_array_nr_of_elements(source));
+    indexed_assign_base_array_data(source.data, dest, dest_spec, sizeof(modelica_boolean));
 }
 
 /*
@@ -361,9 +337,6 @@ void index_boolean_array(const boolean_array_t* source,
                          const index_spec_t* source_spec,
                          boolean_array_t* dest)
 {
-    _index_t* idx_vec1;
-    _index_t* idx_vec2;
-    _index_t* idx_size;
     int j;
     int i;
 
@@ -380,37 +353,7 @@ void index_boolean_array(const boolean_array_t* source,
     }
     assert(j == dest->ndims);
 
-    idx_vec1 = size_alloc(source->ndims);  /*indices in the source array*/
-    idx_vec2 = size_alloc(dest->ndims); /* indices in the destination array*/
-    idx_size = size_alloc(source_spec->ndims);
-
-    for(i = 0; i < source->ndims; ++i) {
-        idx_vec1[i] = 0;
-    }
-    for(i = 0; i < source_spec->ndims; ++i) {
-        if(source_spec->index[i]) {
-            idx_size[i] = imax(source_spec->dim_size[i],1);
-        } else {
-            idx_size[i] = source->dim_size[i];
-        }
-    }
-
-    do {
-        for(i = 0, j = 0; i < source->ndims; ++i) {
-            if((source_spec->index_type[i] == 'W')
-                ||
-                (source_spec->index_type[i] == 'A')) {
-                idx_vec2[j] = idx_vec1[i];
-                j++;
-            }
-        }
-
-        boolean_set(dest, calc_base_index(dest->ndims, idx_vec2, dest),
-                    boolean_get(*source,
-                                calc_base_index_spec(source->ndims, idx_vec1,
-                                                     source, source_spec)));
-
-    } while(0 == next_index(source->ndims, idx_vec1, idx_size));
+    index_base_array_data(source, source_spec, dest->data, sizeof(modelica_boolean));
 }
 
 /*
@@ -38,6 +38,7 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <math.h>
+#include <string.h>
 
 #include "omc_error.h"
 #include "meta/meta_modelica.h"
@@ -302,8 +303,6 @@ void simple_indexed_assign_integer_array2(const integer_array_t * source,
 void indexed_assign_integer_array(const integer_array_t source, integer_array_t* dest,
                                   const index_spec_t* dest_spec)
 {
-    _index_t* idx_vec1;
-    _index_t* idx_size;
     int i,j;
 
     omc_assert_macro(base_array_ok(&source));
@@ -317,29 +316,7 @@ void indexed_assign_integer_array(const integer_array_t source, integer_array_t*
     }
     omc_assert_macro(j == source.ndims);
 
-    idx_vec1 = size_alloc(dest->ndims);
-    idx_size = size_alloc(dest_spec->ndims);
-
-    for(i = 0; i < dest_spec->ndims; ++i) {
-        idx_vec1[i] = 0;
-
-        if(dest_spec->index[i] != NULL) { /* is 'S' or 'A' */
-            idx_size[i] = imax(dest_spec->dim_size[i],1);
-        } else { /* is 'W' */
-            idx_size[i] = dest->dim_size[i];
-        }
-    }
-
-    j = 0;
-    do {
-        integer_set(dest,
-                 calc_base_index_spec(dest->ndims, idx_vec1, dest, dest_spec),
-                 integer_get(source, j));
-        j++;
-
-    } while(0 == next_index(dest_spec->ndims, idx_vec1, idx_size));
-
-    omc_assert_macro(j == base_array_nr_of_elements(source));
+    indexed_assign_base_array_data(source.data, dest, dest_spec, sizeof(modelica_integer));
 }
 
 /*
@@ -357,9 +334,6 @@ void index_integer_array(const integer_array_t * source,
                          const index_spec_t* source_spec,
                          integer_array_t* dest)
 {
-    _index_t* idx_vec1;
-    _index_t* idx_vec2;
-    _index_t* idx_size;
     int j;
     int i;
 
@@ -376,37 +350,7 @@ void index_integer_array(const integer_array_t * source,
     }
     omc_assert_macro(j == dest->ndims);
 
-    idx_vec1 = size_alloc(source->ndims); /*indices in the source array*/
-    idx_vec2 = size_alloc(dest->ndims); /* indices in the destination array*/
-    idx_size = size_alloc(source_spec->ndims);
-
-    for(i = 0; i < source->ndims; ++i) {
-        idx_vec1[i] = 0;
-    }
-    for(i = 0; i < source_spec->ndims; ++i) {
-        if(source_spec->index[i] != NULL) {
-            idx_size[i] = imax(source_spec->dim_size[i],1);
-        } else {
-            idx_size[i] = source->dim_size[i];
-        }
-    }
-
-    do {
-        for(i = 0, j = 0; i < source->ndims; ++i) {
-            if((source_spec->index_type[i] == 'W')
-                ||
-                (source_spec->index_type[i] == 'A')) {
-                idx_vec2[j] = idx_vec1[i];
-                ++j;
-            }
-        }
-
-        integer_set(dest, calc_base_index(dest->ndims, idx_vec2, dest),
-                    integer_get(*source,
-                                calc_base_index_spec(source->ndims, idx_vec1,
-                                                     source, source_spec)));
-
-    } while(0 == next_index(source->ndims, idx_vec1, idx_size));
+    index_base_array_data(source, source_spec, dest->data, sizeof(modelica_integer));
 }
 
 /*
@@ -960,34 +904,64 @@ modelica_integer mul_integer_scalar_product(const integer_array_t a, const integ
     return res;
 }
 
+/* see mul_real_matrix_product */
+#define MATRIX_PRODUCT_BLOCK_K 64
+#define MATRIX_PRODUCT_BLOCK_J 256
+
 void mul_integer_matrix_product(const integer_array_t * a,const integer_array_t * b,integer_array_t* dest)
 {
-    modelica_integer tmp;
+    const modelica_integer *A = (const modelica_integer *) a->data;
+    const modelica_integer *B = (const modelica_integer *) b->data;
+    modelica_integer *C = (modelica_integer *) dest->data;
     size_t i_size;
     size_t j_size;
     size_t k_size;
-    size_t i;
-    size_t j;
-    size_t k;
+    size_t i, j, k, j0, k0;
 
     /* Assert that dest har correct size */
     i_size = dest->dim_size[0];
     j_size = dest->dim_size[1];
     k_size = a->dim_size[1];
 
-    for(i = 0; i < i_size; ++i) {
-        for(j = 0; j < j_size; ++j) {
-            tmp = 0;
-            for(k = 0; k < k_size; ++k) {
-                tmp += integer_get(*a, (i * k_size) + k)*integer_get(*b, (k * j_size) + j);
+    /* i-k-j order: a[i][k] is broadcast over the contiguous row b[k][*] into
+     * c[i][*], four k at a time, blocked over k and j so that the b block
+     * and the c row segment stay in cache. Each element is still summed in
+     * increasing k like the textbook loop. */
+    memset(C, 0, sizeof(modelica_integer) * i_size * j_size);
+    for(j0 = 0; j0 < j_size; j0 += MATRIX_PRODUCT_BLOCK_J) {
+        const size_t j1 = j0 + MATRIX_PRODUCT_BLOCK_J < j_size ? j0 + MATRIX_PRODUCT_BLOCK_J : j_size;
+        for(k0 = 0; k0 < k_size; k0 += MATRIX_PRODUCT_BLOCK_K) {
+            const size_t k1 = k0 + MATRIX_PRODUCT_BLOCK_K < k_size ? k0 + MATRIX_PRODUCT_BLOCK_K : k_size;
+            for(i = 0; i < i_size; ++i) {
+                const modelica_integer *a_row = A + i * k_size;
+                modelica_integer *c_row = C + i * j_size;
+                for(k = k0; k + 4 <= k1; k += 4) {
+                    const modelica_integer a0 = a_row[k], a1 = a_row[k + 1], a2 = a_row[k + 2], a3 = a_row[k + 3];
+                    const modelica_integer *b0 = B + k * j_size;
+                    const modelica_integer *b1 = b0 + j_size;
+                    const modelica_integer *b2 = b1 + j_size;
+                    const modelica_integer *b3 = b2 + j_size;
+                    for(j = j0; j < j1; ++j) {
+                        c_row[j] = c_row[j] + a0 * b0[j] + a1 * b1[j] + a2 * b2[j] + a3 * b3[j];
+                    }
+                }
+                for(; k < k1; ++k) {
+                    const modelica_integer a_ik = a_row[k];
+                    const modelica_integer *b_row = B + k * j_size;
+                    for(j = j0; j < j1; ++j) {
+                        c_row[j] += a_ik * b_row[j];
+                    }
+                }
             }
-            integer_set(dest, (i * j_size) + j, tmp);
         }
     }
 }
 
 void mul_integer_matrix_vector(const integer_array_t * a, const integer_array_t * b,integer_array_t* dest)
 {
+    const modelica_integer *A = (const modelica_integer *) a->data;
+    const modelica_integer *x = (const modelica_integer *) b->data;
+    modelica_integer *y = (modelica_integer *) dest->data;
     size_t i;
     size_t j;
     size_t i_size;
@@ -1005,22 +979,25 @@ void mul_integer_matrix_vector(const integer_array_t * a, const integer_array_t
     j_size = a->dim_size[1];
 
     for(i = 0; i < i_size; ++i) {
+        const modelica_integer *a_row = A + i * j_size;
         tmp = 0;
         for(j = 0; j < j_size; ++j) {
-            tmp += integer_get(*a, (i * j_size) + j)*integer_get(*b, j);
+            tmp += a_row[j] * x[j];
         }
-        integer_set(dest, i, tmp);
+        y[i] = tmp;
     }
 }
 
 
 void mul_integer_vector_matrix(const integer_array_t * a, const integer_array_t * b,integer_array_t* dest)
 {
+    const modelica_integer *x = (const modelica_integer *) a->data;
+    const modelica_integer *B = (const modelica_integer *) b->data;
+    modelica_integer *y = (modelica_integer *) dest->data;
     size_t i;
     size_t j;
     size_t i_size;
     size_t j_size;
-    modelica_integer tmp;
 
     /* Assert a vector */
     omc_assert_macro(a->ndims == 1);
@@ -1028,15 +1005,18 @@ void mul_integer_vector_matrix(const integer_array_t * a, const integer_array_t
     omc_assert_macro(b->ndims == 2);
     /* Assert dest vector of correct size */
 
-    i_size = a->dim_size[0];
+    i_size = b->dim_size[0];
     j_size = b->dim_size[1];
 
+    for(j = 0; j < j_size; ++j) {
+        y[j] = 0;
+    }
     for(i = 0; i < i_size; ++i) {
-        tmp = 0;
+        const modelica_integer x_i = x[i];
+        const modelica_integer *b_row = B + i * j_size;
         for(j = 0; j < j_size; ++j) {
-            tmp += integer_get(*a, j) * integer_get(*b, (j * j_size) + i);
+            y[j] += x_i * b_row[j];
         }
-        integer_set(dest, i, tmp);
     }
 }
 
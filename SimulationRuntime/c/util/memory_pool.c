@@ -30,6 +30,7 @@
 
 
 #include "memory_pool.h"
+#include "omc_error.h"
 #include <string.h>
 #include <pthread.h>
 #include <gc.h>
@@ -52,6 +53,10 @@ omc_alloc_interface_t omc_alloc_interface = {
   GC_collect_a_little_or_not
 };
 
+/* The pooled interface keeps one arena per thread, so allocations need no
+ * lock. Memory is handed out by bumping a pointer in the current block of
+ * the arena and is reclaimed for all arenas by pool_free between steps, or
+ * per thread by memory_pool_release. */
 typedef struct list_s {
   void *memory;
   size_t used;
@@ -59,16 +64,77 @@ typedef struct list_s {
   struct list_s *next;
 } list;
 
-static pthread_mutex_t memory_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
-static list *memory_pools = NULL;
+typedef struct arena_s {
+  list *blocks;          /* current block first */
+  list *spare;           /* block dropped by memory_pool_release, reused by the next expansion */
+  size_t inUse;          /* bytes allocated in all blocks */
+  size_t highWater;      /* maximum of inUse */
+  int owned;             /* 0 if the thread of the arena finished */
+  struct arena_s *next;  /* all arenas */
+} arena;
+
+#define MEMORY_POOL_BLOCK_SIZE (2*1024*1024) /* 2MB pool by default */
+
+static pthread_mutex_t memory_pool_mutex = PTHREAD_MUTEX_INITIALIZER; /* protects memory_arenas */
+static arena *memory_arenas = NULL;
+static pthread_key_t memory_pool_key;
+static int memory_pool_initialized = 0;
+
+static list* pool_new_block(size_t size)
+{
+  list *block = (list*) malloc(sizeof(list));
+  block->used = 0;
+  block->size = size;
+  block->memory = malloc(size);
+  block->next = NULL;
+  return block;
+}
+
+static void pool_free_block(list *block)
+{
+  free(block->memory);
+  free(block);
+}
+
+/* the arena is kept for the next thread that allocates */
+static void pool_orphan_arena(void *data)
+{
+  pthread_mutex_lock(&memory_pool_mutex);
+  ((arena*) data)->owned = 0;
+  pthread_mutex_unlock(&memory_pool_mutex);
+}
 
 static void pool_init(void)
 {
-  memory_pools = (list*) malloc(sizeof(list));
-  memory_pools->used = 0;
-  memory_pools->size = 2*1024*1024; /* 2MB pool by default */
-  memory_pools->memory = malloc(memory_pools->size);
-  memory_pools->next = NULL;
+  if (!memory_pool_initialized) {
+    pthread_key_create(&memory_pool_key, pool_orphan_arena);
+    memory_pool_initialized = 1;
+  }
+}
+
+static arena* pool_new_arena(void)
+{
+  arena *a;
+
+  pthread_mutex_lock(&memory_pool_mutex);
+  for (a = memory_arenas; a && a->owned; a = a->next);
+  if (!a) {
+    a = (arena*) calloc(1, sizeof(arena));
+    a->blocks = pool_new_block(MEMORY_POOL_BLOCK_SIZE);
+    a->next = memory_arenas;
+    memory_arenas = a;
+  }
+  a->owned = 1;
+  pthread_mutex_unlock(&memory_pool_mutex);
+
+  pthread_setspecific(memory_pool_key, a);
+  return a;
+}
+
+static inline arena* pool_arena(void)
+{
+  arena *a = (arena*) pthread_getspecific(memory_pool_key);
+  return a ? a : pool_new_arena();
 }
 
 static unsigned long upper_power_of_two(unsigned long v)
@@ -88,52 +154,133 @@ static inline size_t round_up(size_t num, size_t factor)
   return num + factor - 1 - (num - 1) % factor;
 }
 
-static inline void pool_expand(size_t len)
+static inline void pool_expand(arena *a, size_t len)
 {
   list *newlist = NULL;
   /* Check if we have enough memory already */
-  if (memory_pools->size - memory_pools->used >= len) {
+  if (a->blocks->size - a->blocks->used >= len) {
     return;
   }
-  newlist = (list*) malloc(sizeof(list));
-  newlist->next = memory_pools;
-  memory_pools = newlist;
-  memory_pools->used = 0;
-  memory_pools->size = upper_power_of_two(3*memory_pools->next->size/2 + len); /* expand by 1.5x the old memory pool. More if we request a very large array. */
-  memory_pools->memory = malloc(memory_pools->size);
+  if (a->spare && a->spare->size >= len) {
+    newlist = a->spare;
+    newlist->used = 0;
+    a->spare = NULL;
+  } else {
+    newlist = pool_new_block(upper_power_of_two(3*a->blocks->size/2 + len)); /* expand by 1.5x the old memory pool. More if we request a very large array. */
+  }
+  newlist->next = a->blocks;
+  a->blocks = newlist;
 }
 
-static void* pool_malloc(size_t sz)
+static inline void* pool_bump(size_t sz)
 {
+  arena *a = pool_arena();
   void *res;
   sz = round_up(sz,8);
-  pthread_mutex_lock(&memory_pool_mutex);
-  pool_expand(sz);
-  res = (void*)((char*)memory_pools->memory + memory_pools->used);
-  memory_pools->used += sz;
-  pthread_mutex_unlock(&memory_pool_mutex);
+  pool_expand(a, sz);
+  res = (void*)((char*)a->blocks->memory + a->blocks->used);
+  a->blocks->used += sz;
+  a->inUse += sz;
+  if (a->inUse > a->highWater) {
+    a->highWater = a->inUse;
+  }
+  return res;
+}
+
+/* like GC_malloc the memory is cleared, it may hold pointers */
+static void* pool_malloc(size_t sz)
+{
+  void *res = pool_bump(sz);
   memset(res,0,sz);
   return res;
 }
 
+/* like GC_malloc_atomic the memory is not cleared */
+static void* pool_malloc_atomic(size_t sz)
+{
+  return pool_bump(sz);
+}
+
+/* Called between steps, when no other thread allocates */
 static int pool_free(void)
 {
-  list *freelist = memory_pools->next;
-  while (freelist) {
-    list *next = freelist->next;
-    free(freelist->memory);
-    free(freelist);
-    freelist = next;
+  arena *a;
+  pthread_mutex_lock(&memory_pool_mutex);
+  for (a = memory_arenas; a; a = a->next) {
+    list *freelist = a->blocks->next;
+    while (freelist) {
+      list *next = freelist->next;
+      pool_free_block(freelist);
+      freelist = next;
+    }
+    if (a->spare) {
+      pool_free_block(a->spare);
+      a->spare = NULL;
+    }
+    a->blocks->used = 0;
+    a->blocks->next = 0;
+    a->inUse = 0;
   }
-  memory_pools->used = 0;
-  memory_pools->next = 0;
+  pthread_mutex_unlock(&memory_pool_mutex);
   return 0;
 }
 
+memory_pool_mark_t memory_pool_mark(void)
+{
+  memory_pool_mark_t mark = {NULL, NULL, 0, 0};
+  if (omc_alloc_interface.malloc == pool_malloc) {
+    arena *a = pool_arena();
+    mark.arena = a;
+    mark.block = a->blocks;
+    mark.used = a->blocks->used;
+    mark.inUse = a->inUse;
+  }
+  return mark;
+}
+
+void memory_pool_release(memory_pool_mark_t mark)
+{
+  arena *a = (arena*) mark.arena;
+  if (!a) {
+    return;
+  }
+  /* blocks added since the mark are dropped, the largest one is kept as spare */
+  while (a->blocks != mark.block) {
+    list *block = a->blocks;
+    a->blocks = block->next;
+    if (!a->spare || a->spare->size < block->size) {
+      if (a->spare) {
+        pool_free_block(a->spare);
+      }
+      a->spare = block;
+    } else {
+      pool_free_block(block);
+    }
+  }
+  a->blocks->used = mark.used;
+  a->inUse = mark.inUse;
+}
+
+void memory_pool_statistics(void)
+{
+  arena *a;
+  int i = 0;
+  if (!memory_arenas) {
+    return;
+  }
+  infoStreamPrint(LOG_STATS, 1, "memory pool");
+  pthread_mutex_lock(&memory_pool_mutex);
+  for (a = memory_arenas; a; a = a->next) {
+    infoStreamPrint(LOG_STATS, 0, "arena %d: high-water mark %lu bytes", ++i, (unsigned long) a->highWater);
+  }
+  pthread_mutex_unlock(&memory_pool_mutex);
+  messageClose(LOG_STATS);
+}
+
 omc_alloc_interface_t omc_alloc_interface_pooled = {
   pool_init,
   pool_malloc,
-  pool_malloc,
+  pool_malloc_atomic,
   (char*(*)(size_t)) malloc,
   strdup,
   pool_free
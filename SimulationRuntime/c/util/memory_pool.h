@@ -48,6 +48,22 @@ extern _index_t** index_alloc(int n);
 
 void* generic_alloc(int n, size_t sze);
 
+/* Position in the memory pool of the calling thread. Memory allocated after
+ * memory_pool_mark is reclaimed by memory_pool_release, e.g. after each
+ * equation evaluation. Both do nothing if the pooled allocator is not used. */
+typedef struct {
+  void *arena;
+  void *block;
+  size_t used;
+  size_t inUse;
+} memory_pool_mark_t;
+
+extern memory_pool_mark_t memory_pool_mark(void);
+extern void memory_pool_release(memory_pool_mark_t mark);
+
+/* high-water marks of the pooled allocator (LOG_STATS) */
+extern void memory_pool_statistics(void);
+
 #if defined(__cplusplus)
 } /* end extern "C" */
 #endif
@@ -60,6 +60,37 @@ omc_mmap_read_unix omc_mmap_open_read_unix(const char *fileName)
   return res;
 }
 
+/* Like omc_mmap_open_read_unix, but returns an error message instead of throwing.
+ * Used by readers that report errors through return values (e.g. read_matlab4.c).
+ */
+const char* omc_mmap_try_open_read_unix(const char *fileName, omc_mmap_read_unix *res)
+{
+  struct stat s;
+  int fd = open(fileName, O_RDONLY);
+  res->size = 0;
+  res->data = NULL;
+  if (fd < 0) {
+    return strerror(errno);
+  }
+  if (fstat(fd, &s) < 0) {
+    close(fd);
+    return strerror(errno);
+  }
+  if (s.st_size == 0) {
+    close(fd);
+    return "Cannot mmap an empty file";
+  }
+  res->size = s.st_size;
+  res->data = (const char*) mmap(0, res->size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (res->data == MAP_FAILED) {
+    res->size = 0;
+    res->data = NULL;
+    return strerror(errno);
+  }
+  return NULL;
+}
+
 omc_mmap_write_unix omc_mmap_open_write_unix(const char *fileName, size_t size)
 {
   omc_mmap_write_unix res = {0};
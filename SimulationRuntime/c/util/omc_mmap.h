@@ -85,6 +85,7 @@ void omc_mmap_close_write_inmemory(omc_mmap_write_inmemory map);
 #if HAVE_MMAP
 
 omc_mmap_read_unix omc_mmap_open_read_unix(const char *filename);
+const char* omc_mmap_try_open_read_unix(const char *filename, omc_mmap_read_unix *map);
 omc_mmap_write_unix omc_mmap_open_write_unix(const char *filename, size_t size);
 void omc_mmap_close_read_unix(omc_mmap_read_unix map);
 void omc_mmap_close_write_unix(omc_mmap_write_unix map);
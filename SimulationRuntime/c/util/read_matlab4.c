@@ -28,6 +28,11 @@
  *
  */
 
+/* 64-bit off_t for fseeko/ftello on 32-bit systems */
+#if !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include <stdlib.h>
 #include <stdint.h>
 #include <errno.h>
@@ -35,9 +40,19 @@
 #include <assert.h>
 #include <ctype.h>
 #include "read_matlab4.h"
+#include "omc_mmap.h"
 
 extern const char *omc_mat_Aclass;
 
+/* data_2 is gathered in tiles of MAT_TILE_ROWS rows and MAT_TILE_COLS
+ * columns, so that the written parts of the column arrays stay in cache.
+ * If the file is not memory-mapped, MAT_READ_BLOCK_SIZE bytes of rows are
+ * read with a single fread.
+ */
+#define MAT_TILE_ROWS 256
+#define MAT_TILE_COLS 32
+#define MAT_READ_BLOCK_SIZE (4*1024*1024)
+
 typedef struct {
   uint32_t type;
   uint32_t mrows;
@@ -51,8 +66,29 @@ typedef struct {
 #define strdup _strdup
 #endif
 
+/* fseek/ftell take a long, which is 32 bits on Windows; result files may
+ * be larger than 2 GB */
+int omc_matlab4_fseek(FILE *file, int64_t offset, int whence)
+{
+#if defined(_MSC_VER) || defined(__MINGW32__)
+  return _fseeki64(file, offset, whence);
+#else
+  return fseeko(file, (off_t) offset, whence);
+#endif
+}
+
+int64_t omc_matlab4_ftell(FILE *file)
+{
+#if defined(_MSC_VER) || defined(__MINGW32__)
+  return _ftelli64(file);
+#else
+  return (int64_t) ftello(file);
+#endif
+}
+
 static const char *binTrans_char = "binTrans";
 static const char *binNormal_char = "binNormal";
+static const char *binChunked_char = "binChunked";
 
 /* strcmp ignore whitespace */
 static OMC_INLINE int strcmp_iws(const char *a, const char *b)
@@ -137,6 +173,34 @@ void omc_free_matlab4_reader(ModelicaMatReader *reader)
     free(reader->vars);
     reader->vars=NULL;
   }
+  if (reader->cacheStamp) {
+    free(reader->cacheStamp);
+    reader->cacheStamp=NULL;
+  }
+  reader->cacheSize = 0;
+  if (reader->chunkOffset) {
+    free(reader->chunkOffset);
+    reader->chunkOffset=NULL;
+  }
+  if (reader->chunkFirstRow) {
+    free(reader->chunkFirstRow);
+    reader->chunkFirstRow=NULL;
+  }
+  if (reader->chunkLastTime) {
+    free(reader->chunkLastTime);
+    reader->chunkLastTime=NULL;
+  }
+  reader->nchunks = 0;
+#if HAVE_MMAP
+  if (reader->mappedData) {
+    omc_mmap_read_unix map;
+    map.data = reader->mappedData;
+    map.size = reader->mappedSize;
+    omc_mmap_close_read_unix(map);
+  }
+#endif
+  reader->mappedData = NULL;
+  reader->mappedSize = 0;
 }
 
 void remSpaces(char *ch){
@@ -152,6 +216,129 @@ void remSpaces(char *ch){
     }
 }
 
+/* Maps the file if it contains at least size bytes; the reader falls back to fread otherwise */
+static void matlab4_try_mmap(ModelicaMatReader *reader, const char *filename, size_t size)
+{
+#if HAVE_MMAP
+  omc_mmap_read_unix map;
+  if(size > 0 && 0 == omc_mmap_try_open_read_unix(filename, &map)) {
+    if(map.size >= size) {
+      reader->mappedData = map.data;
+      reader->mappedSize = map.size;
+    } else {
+      omc_mmap_close_read_unix(map);
+    }
+  }
+#endif
+}
+
+static int matlab4_read_named_header(FILE *file, MHeader_t *hdr, const char *name)
+{
+  char buf[32];
+  if(1 != fread(hdr,sizeof(MHeader_t),1,file)) return 1;
+  if(hdr->namelen != strlen(name)+1 || hdr->namelen > sizeof(buf)) return 1;
+  if(1 != fread(buf,hdr->namelen,1,file)) return 1;
+  return 0 != strcmp(buf,name);
+}
+
+/* Reads the chunkIndex footer of a binChunked file */
+static int matlab4_read_chunk_footer(ModelicaMatReader *reader)
+{
+  MHeader_t hdr;
+  double indexPos, *index;
+  uint32_t k;
+  long footerSize = sizeof(MHeader_t) + sizeof("chunkIndexPos") + sizeof(double);
+  if(omc_matlab4_fseek(reader->file, -footerSize, SEEK_END)) return 1;
+  if(matlab4_read_named_header(reader->file, &hdr, "chunkIndexPos") || hdr.type != 0 || hdr.mrows != 1 || hdr.ncols != 1) return 1;
+  if(1 != fread(&indexPos, sizeof(double), 1, reader->file)) return 1;
+  if(omc_matlab4_fseek(reader->file, (int64_t) indexPos, SEEK_SET)) return 1;
+  if(matlab4_read_named_header(reader->file, &hdr, "chunkIndex") || hdr.type != 0 || hdr.mrows != 4) return 1;
+  index = (double*) malloc(4*hdr.ncols*sizeof(double)+1);
+  if(hdr.ncols && 1 != fread(index, 4*hdr.ncols*sizeof(double), 1, reader->file)) {
+    free(index);
+    return 1;
+  }
+  reader->nchunks = hdr.ncols;
+  reader->chunkOffset = (size_t*) malloc(reader->nchunks*sizeof(size_t)+1);
+  reader->chunkFirstRow = (uint32_t*) malloc((reader->nchunks+1)*sizeof(uint32_t));
+  reader->chunkLastTime = (double*) malloc(reader->nchunks*sizeof(double)+1);
+  reader->chunkFirstRow[0] = 0;
+  for(k=0; k<reader->nchunks; k++) {
+    reader->chunkOffset[k] = (size_t) index[4*k];
+    reader->chunkFirstRow[k+1] = reader->chunkFirstRow[k] + (uint32_t) index[4*k+1];
+    reader->chunkLastTime[k] = index[4*k+3];
+  }
+  free(index);
+  return 0;
+}
+
+/* Walks the data_2 chunks of a binChunked file without footer (e.g. if
+ * the simulation did not terminate), starting with the first chunk whose
+ * header was just read. Incomplete chunks at the end are ignored. */
+static void matlab4_scan_chunks(ModelicaMatReader *reader, MHeader_t hdr, size_t offset)
+{
+  size_t fileSize, capacity = 16;
+  omc_matlab4_fseek(reader->file, 0, SEEK_END);
+  fileSize = omc_matlab4_ftell(reader->file);
+  reader->nchunks = 0;
+  reader->chunkOffset = (size_t*) malloc(capacity*sizeof(size_t));
+  reader->chunkFirstRow = (uint32_t*) malloc((capacity+1)*sizeof(uint32_t));
+  reader->chunkLastTime = (double*) malloc(capacity*sizeof(double));
+  reader->chunkFirstRow[0] = 0;
+  do {
+    size_t chunkLength = (size_t)hdr.mrows*hdr.ncols*sizeof(double);
+    if(hdr.type != 0 || hdr.ncols != reader->nvar || offset+chunkLength > fileSize) break;
+    if(hdr.mrows > 0) {
+      double lastTime;
+      /* The time is the first variable of the column-major chunk */
+      if(omc_matlab4_fseek(reader->file, offset+(hdr.mrows-1)*sizeof(double), SEEK_SET) || 1 != fread(&lastTime, sizeof(double), 1, reader->file)) break;
+      if(reader->nchunks == capacity) {
+        capacity *= 2;
+        reader->chunkOffset = (size_t*) realloc(reader->chunkOffset, capacity*sizeof(size_t));
+        reader->chunkFirstRow = (uint32_t*) realloc(reader->chunkFirstRow, (capacity+1)*sizeof(uint32_t));
+        reader->chunkLastTime = (double*) realloc(reader->chunkLastTime, capacity*sizeof(double));
+      }
+      reader->chunkOffset[reader->nchunks] = offset;
+      reader->chunkFirstRow[reader->nchunks+1] = reader->chunkFirstRow[reader->nchunks] + hdr.mrows;
+      reader->chunkLastTime[reader->nchunks] = lastTime;
+      reader->nchunks++;
+    }
+    if(omc_matlab4_fseek(reader->file, offset+chunkLength, SEEK_SET)) break;
+    if(matlab4_read_named_header(reader->file, &hdr, "data_2")) break;
+    offset = omc_matlab4_ftell(reader->file);
+  } while(1);
+}
+
+/* Returns the chunk containing the given time point */
+static uint32_t matlab4_find_chunk(ModelicaMatReader *reader, uint32_t row)
+{
+  uint32_t lo = 0, hi = reader->nchunks-1;
+  while(lo < hi) {
+    uint32_t mid = lo + (hi-lo+1)/2;
+    if(reader->chunkFirstRow[mid] <= row) {
+      lo = mid;
+    } else {
+      hi = mid-1;
+    }
+  }
+  return lo;
+}
+
+/* Returns the first chunk ending after the given time, or the last chunk */
+static uint32_t matlab4_find_time_chunk(ModelicaMatReader *reader, double time)
+{
+  uint32_t lo = 0, hi = reader->nchunks-1;
+  while(lo < hi) {
+    uint32_t mid = lo + (hi-lo)/2;
+    if(reader->chunkLastTime[mid] > time) {
+      hi = mid;
+    } else {
+      lo = mid+1;
+    }
+  }
+  return lo;
+}
+
 /* Returns 0 on success; the error message on error */
 const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *reader)
 {
@@ -195,7 +382,7 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
       return "Corrupt header (3)";
     }
     /* fprintf(stderr, "  Name of matrix: %s\n", name); */
-    matrix_length = hdr.mrows*hdr.ncols*(1+hdr.imagf)*element_length;
+    matrix_length = (size_t)hdr.mrows*hdr.ncols*(1+hdr.imagf)*element_length;
     if(0 != strcmp(name,matrixNames[i])) {
       free(name);
       return matrixNamesMismatch[i];
@@ -229,6 +416,9 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
             /* binNormal */
             /* fprintf(stderr, "use binNormal format\n"); */
             binTrans = 0;
+          } else if(0 == strncmp(row,binChunked_char,10))  {
+            /* binChunked: names etc. as binTrans, data_2 as column-major chunks */
+            binTrans = 2;
           } else {
             fprintf(stderr, "row 3: %s\n", row);
             return "Aclass matrix does not match binTrans or binNormal format";
@@ -244,7 +434,7 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
       else
         reader->nall = hdr.ncols;
       reader->allInfo = (ModelicaMatVariable_t*) malloc(sizeof(ModelicaMatVariable_t)*reader->nall);
-      if(binTrans==1) {
+      if(binTrans!=0) {
         for(k=0; k<hdr.ncols; k++) {
           reader->allInfo[k].name = (char*) malloc(hdr.mrows+1);
           if(fread(reader->allInfo[k].name,hdr.mrows,1,reader->file) != 1) return "Corrupt header: names matrix";
@@ -279,7 +469,7 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
     }
     case 2: { /* description */
       unsigned int k;
-      if(binTrans==1) {
+      if(binTrans!=0) {
         for(k=0; k<hdr.ncols; k++) {
           reader->allInfo[k].descr = (char*) malloc(hdr.mrows+1);
           if(fread(reader->allInfo[k].descr,hdr.mrows,1,reader->file) != 1) return "Corrupt header: names matrix";
@@ -311,7 +501,7 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
         free(tmp); tmp=NULL;
         return "Corrupt header: dataInfo matrix";
       }
-      if(binTrans==1) {
+      if(binTrans!=0) {
         for(k=0; k<hdr.ncols; k++) {
           reader->allInfo[k].isParam = tmp[k*hdr.mrows] == 1;
           reader->allInfo[k].index = tmp[k*hdr.mrows+1];
@@ -331,7 +521,7 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
       break;
     }
     case 4: { /* "data_1" */
-      if(binTrans==1) {
+      if(binTrans!=0) {
         unsigned int k;
         if(hdr.mrows == 0) return "data_1 matrix does not contain at least 1 variable";
         if(hdr.ncols != 2 && hdr.ncols != 1) return "data_1 matrix does not have 1 or 2 cols";
@@ -402,9 +592,35 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
         /* Allow empty matrix; it's not a complete file, but ok... */
         /* if(reader->nrows < 2) return "Too few rows in data_2 matrix"; */
         reader->nvar = hdr.mrows;
-        reader->var_offset = ftell(reader->file);
+        reader->var_offset = omc_matlab4_ftell(reader->file);
+        reader->vars = (double**) calloc(reader->nvar*2,sizeof(double*));
+        reader->cacheStamp = (uint32_t*) calloc(reader->nvar*2,sizeof(uint32_t));
+        if(omc_matlab4_fseek(reader->file,matrix_length,SEEK_CUR)) return "Corrupt header: data_2 matrix";
+        /* Variables are gathered directly from the mapped file */
+        if(matrix_length > 0) {
+          matlab4_try_mmap(reader, filename, reader->var_offset + matrix_length);
+        }
+      }
+      if(binTrans==2) {
+        if(hdr.type != 0) return "Chunked data_2 matrix is not stored in double precision";
+        reader->nvar = hdr.ncols;
+        reader->var_offset = omc_matlab4_ftell(reader->file);
+        if(matlab4_read_chunk_footer(reader)) {
+          if(reader->chunkOffset) free(reader->chunkOffset);
+          if(reader->chunkFirstRow) free(reader->chunkFirstRow);
+          if(reader->chunkLastTime) free(reader->chunkLastTime);
+          reader->chunkOffset = NULL;
+          reader->chunkFirstRow = NULL;
+          reader->chunkLastTime = NULL;
+          matlab4_scan_chunks(reader, hdr, reader->var_offset);
+        }
+        reader->nrows = reader->chunkFirstRow[reader->nchunks];
         reader->vars = (double**) calloc(reader->nvar*2,sizeof(double*));
-        if(-1==fseek(reader->file,matrix_length,SEEK_CUR)) return "Corrupt header: data_2 matrix";
+        reader->cacheStamp = (uint32_t*) calloc(reader->nvar*2,sizeof(uint32_t));
+        if(reader->nchunks > 0) {
+          uint32_t last = reader->nchunks-1;
+          matlab4_try_mmap(reader, filename, reader->chunkOffset[last] + sizeof(double)*reader->nvar*(reader->chunkFirstRow[last+1]-reader->chunkFirstRow[last]));
+        }
       }
       if(binTrans==0) {
         unsigned int k,j;
@@ -412,7 +628,7 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
         /* Allow empty matrix; it's not a complete file, but ok... */
         /* if(reader->nrows < 2) return "Too few rows in data_2 matrix"; */
         reader->nvar = hdr.ncols;
-        reader->var_offset = ftell(reader->file);
+        reader->var_offset = omc_matlab4_ftell(reader->file);
         reader->vars = (double**) calloc(reader->nvar*2,sizeof(double*));
         if(reader->doublePrecision==1)
         {
@@ -450,7 +666,7 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
           }
           free(tmp);
         }
-        if(-1==fseek(reader->file,matrix_length,SEEK_CUR)) return "Corrupt header: data_2 matrix";
+        if(omc_matlab4_fseek(reader->file,matrix_length,SEEK_CUR)) return "Corrupt header: data_2 matrix";
       }
       break;
     }
@@ -540,58 +756,317 @@ ModelicaMatVariable_t *omc_matlab4_find_var(ModelicaMatReader *reader, const cha
   return res;
 }
 
-/* Writes the number of values in the returned array if nvals is non-NULL */
-double* omc_matlab4_read_vals(ModelicaMatReader *reader, int varIndex)
+typedef struct {
+  uint32_t col;
+  double sign;
+  double *dst;
+} MatGatherColumn_t;
+
+static int matlab4_comp_gather_column(const void *a, const void *b)
 {
-  size_t absVarIndex = abs(varIndex);
-  size_t ix = (varIndex < 0 ? absVarIndex + reader->nvar : absVarIndex) -1;
-  assert(absVarIndex > 0 && absVarIndex <= reader->nvar);
-  if(!reader->vars[ix]) {
-    unsigned int i;
-    double *tmp = (double*) malloc(reader->nrows*sizeof(double));
-    if(reader->doublePrecision==1)
-    {
-      for(i=0; i<reader->nrows; i++) {
-        fseek(reader->file,reader->var_offset + sizeof(double)*(i*reader->nvar + absVarIndex-1), SEEK_SET);
-        if(1 != fread(&tmp[i], sizeof(double), 1, reader->file)) {
-          /* fprintf(stderr, "Corrupt file at %d of %d? nvar %d\n", i, reader->nrows, reader->nvar); */
-          free(tmp);
-          tmp=NULL;
-          return NULL;
+  uint32_t ca = ((const MatGatherColumn_t*)a)->col;
+  uint32_t cb = ((const MatGatherColumn_t*)b)->col;
+  return ca < cb ? -1 : ca > cb;
+}
+
+/* Copies nrows rows starting at src (row-major with nvar elements per row)
+ * into the column arrays of cols, starting at position row0.
+ * The data in a MAT-file is not aligned, so the elements are read using memcpy */
+static void matlab4_gather_rows(const char *src, char doublePrecision, uint32_t nvar, uint32_t row0, uint32_t nrows, int ncols, const MatGatherColumn_t *cols)
+{
+  uint32_t r0, r, rEnd;
+  int c0, c, cEnd;
+  for(r0=0; r0<nrows; r0+=MAT_TILE_ROWS) {
+    rEnd = r0+MAT_TILE_ROWS < nrows ? r0+MAT_TILE_ROWS : nrows;
+    for(c0=0; c0<ncols; c0+=MAT_TILE_COLS) {
+      cEnd = c0+MAT_TILE_COLS < ncols ? c0+MAT_TILE_COLS : ncols;
+      if(doublePrecision==1) {
+        for(r=r0; r<rEnd; r++) {
+          const char *row = src + sizeof(double)*(size_t)r*nvar;
+          for(c=c0; c<cEnd; c++) {
+            double val;
+            memcpy(&val, row + sizeof(double)*cols[c].col, sizeof(double));
+            cols[c].dst[row0+r] = cols[c].sign * val;
+          }
+        }
+      } else {
+        for(r=r0; r<rEnd; r++) {
+          const char *row = src + sizeof(float)*(size_t)r*nvar;
+          for(c=c0; c<cEnd; c++) {
+            float val;
+            memcpy(&val, row + sizeof(float)*cols[c].col, sizeof(float));
+            cols[c].dst[row0+r] = cols[c].sign * val;
+          }
         }
-        if(varIndex < 0) tmp[i] = -tmp[i];
-        /* fprintf(stderr, "tmp[%d]=%g\n", i, tmp[i]); */
       }
     }
-    else
-    {
-      float *buffer = (float*) malloc(reader->nrows*sizeof(float));
-      for(i=0; i<reader->nrows; i++) {
-        fseek(reader->file,reader->var_offset + sizeof(float)*(i*reader->nvar + absVarIndex-1), SEEK_SET);
-        if(1 != fread(&buffer[i], sizeof(float), 1, reader->file)) {
-          /* fprintf(stderr, "Corrupt file at %d of %d? nvar %d\n", i, reader->nrows, reader->nvar); */
-          free(buffer);
-          free(tmp);
-          tmp=NULL;
-          return NULL;
-        }
+  }
+}
+
+/* In the binChunked format, each variable is contiguous within a chunk */
+static int matlab4_gather_chunked_columns(ModelicaMatReader *reader, int ncols, const MatGatherColumn_t *cols)
+{
+  uint32_t k, j;
+  int c;
+  for(k=0; k<reader->nchunks; k++) {
+    uint32_t first = reader->chunkFirstRow[k];
+    uint32_t n = reader->chunkFirstRow[k+1] - first;
+    for(c=0; c<ncols; c++) {
+      size_t offset = reader->chunkOffset[k] + sizeof(double)*cols[c].col*n;
+      double *dst = cols[c].dst + first;
+      if(reader->mappedData) {
+        memcpy(dst, reader->mappedData + offset, n*sizeof(double));
+      } else if(omc_matlab4_fseek(reader->file, offset, SEEK_SET) || n != fread(dst, sizeof(double), n, reader->file)) {
+        return 1;
       }
-      if(varIndex < 0)
-      {
-        for(i=0; i<reader->nrows; i++) {
-          tmp[i] = -buffer[i];
+      if(cols[c].sign < 0) {
+        for(j=0; j<n; j++) {
+          dst[j] = -dst[j];
         }
       }
-      else
-      {
-          for(i=0; i<reader->nrows; i++) {
-            tmp[i] = buffer[i];
+    }
+  }
+  return 0;
+}
+
+/* Gathers the given (sorted) columns of data_2 in a single pass over the rows */
+static int matlab4_gather_columns(ModelicaMatReader *reader, int ncols, const MatGatherColumn_t *cols)
+{
+  size_t elementSize = reader->doublePrecision==1 ? sizeof(double) : sizeof(float);
+  size_t rowSize = elementSize*reader->nvar;
+  uint32_t row0, blockRows;
+  char *buffer = NULL;
+
+  if(reader->chunkOffset) {
+    return matlab4_gather_chunked_columns(reader, ncols, cols);
+  }
+  if(reader->mappedData) {
+    matlab4_gather_rows(reader->mappedData + reader->var_offset, reader->doublePrecision, reader->nvar, 0, reader->nrows, ncols, cols);
+    return 0;
+  }
+
+  blockRows = MAT_READ_BLOCK_SIZE / rowSize;
+  if(blockRows == 0) blockRows = 1;
+  if(blockRows > reader->nrows) blockRows = reader->nrows;
+  buffer = (char*) malloc(blockRows*rowSize);
+  if(!buffer) return 1;
+  if(omc_matlab4_fseek(reader->file, reader->var_offset, SEEK_SET)) {
+    free(buffer);
+    return 1;
+  }
+  for(row0=0; row0<reader->nrows; row0+=blockRows) {
+    uint32_t n = row0+blockRows < reader->nrows ? blockRows : reader->nrows-row0;
+    if(n != fread(buffer, rowSize, n, reader->file)) {
+      /* fprintf(stderr, "Corrupt file at %d of %d? nvar %d\n", row0, reader->nrows, reader->nvar); */
+      free(buffer);
+      return 1;
+    }
+    matlab4_gather_rows(buffer, reader->doublePrecision, reader->nvar, row0, n, ncols, cols);
+  }
+  free(buffer);
+  return 0;
+}
+
+/* Gathers rows [row0,row0+nrows) of the given columns of data_2; the
+ * destination of each column is indexed from row0 */
+static int matlab4_gather_column_rows(ModelicaMatReader *reader, uint32_t row0, uint32_t nrows, int ncols, const MatGatherColumn_t *cols)
+{
+  size_t elementSize = reader->doublePrecision==1 ? sizeof(double) : sizeof(float);
+  size_t rowSize = elementSize*reader->nvar;
+  uint32_t rowEnd = row0+nrows, r, blockRows;
+  char *buffer = NULL;
+
+  if(reader->chunkOffset) {
+    uint32_t k, j;
+    int c;
+    for(k=matlab4_find_chunk(reader, row0); k<reader->nchunks && reader->chunkFirstRow[k]<rowEnd; k++) {
+      uint32_t first = reader->chunkFirstRow[k];
+      uint32_t n = reader->chunkFirstRow[k+1] - first;
+      uint32_t start = first > row0 ? first : row0;
+      uint32_t end = first+n < rowEnd ? first+n : rowEnd;
+      for(c=0; c<ncols; c++) {
+        size_t offset = reader->chunkOffset[k] + sizeof(double)*((size_t)cols[c].col*n + (start-first));
+        double *dst = cols[c].dst + (start-row0);
+        if(reader->mappedData) {
+          memcpy(dst, reader->mappedData + offset, (end-start)*sizeof(double));
+        } else if(omc_matlab4_fseek(reader->file, offset, SEEK_SET) || end-start != fread(dst, sizeof(double), end-start, reader->file)) {
+          return 1;
+        }
+        if(cols[c].sign < 0) {
+          for(j=0; j<end-start; j++) {
+            dst[j] = -dst[j];
           }
+        }
       }
+    }
+    return 0;
+  }
+  if(reader->mappedData) {
+    matlab4_gather_rows(reader->mappedData + reader->var_offset + row0*rowSize, reader->doublePrecision, reader->nvar, 0, nrows, ncols, cols);
+    return 0;
+  }
+
+  blockRows = MAT_READ_BLOCK_SIZE / rowSize;
+  if(blockRows == 0) blockRows = 1;
+  if(blockRows > nrows) blockRows = nrows;
+  buffer = (char*) malloc(blockRows*rowSize);
+  if(!buffer) return 1;
+  if(omc_matlab4_fseek(reader->file, reader->var_offset + (int64_t)row0*rowSize, SEEK_SET)) {
+    free(buffer);
+    return 1;
+  }
+  for(r=0; r<nrows; r+=blockRows) {
+    uint32_t n = r+blockRows < nrows ? blockRows : nrows-r;
+    if(n != fread(buffer, rowSize, n, reader->file)) {
       free(buffer);
-      /* fprintf(stderr, "tmp[%d]=%g\n", i, tmp[i]); */
+      return 1;
+    }
+    matlab4_gather_rows(buffer, reader->doublePrecision, reader->nvar, r, n, ncols, cols);
+  }
+  free(buffer);
+  return 0;
+}
+
+int omc_matlab4_read_vars_rows(ModelicaMatReader *reader, int nvars, const int *varIndexes, uint32_t row0, uint32_t nrows, double *dst)
+{
+  MatGatherColumn_t *cols;
+  int i, res;
+
+  if(nvars <= 0 || nrows == 0) return 0;
+  if(row0 > reader->nrows || nrows > reader->nrows-row0) return 1;
+  cols = (MatGatherColumn_t*) malloc(nvars*sizeof(MatGatherColumn_t));
+  if(!cols) return 1;
+  for(i=0; i<nvars; i++) {
+    int varIndex = varIndexes[i];
+    uint32_t absVarIndex = abs(varIndex);
+    assert(absVarIndex > 0 && absVarIndex <= reader->nvar);
+    cols[i].col = absVarIndex-1;
+    cols[i].sign = varIndex < 0 ? -1.0 : 1.0;
+    cols[i].dst = dst + (size_t)i*nrows;
+  }
+  /* Visit the columns of each row in ascending order */
+  qsort(cols, nvars, sizeof(MatGatherColumn_t), matlab4_comp_gather_column);
+  res = matlab4_gather_column_rows(reader, row0, nrows, nvars, cols);
+  free(cols);
+  return res;
+}
+
+/* Releases the least recently used columns until the cache fits in the limit.
+ * Columns used by the current read (stamped with cacheClock) are kept. */
+static void matlab4_enforce_cache_limit(ModelicaMatReader *reader)
+{
+  size_t colSize = reader->nrows*sizeof(double);
+  uint32_t i;
+  if(reader->cacheLimit == 0 || reader->cacheStamp == NULL) return;
+  while(reader->cacheSize > reader->cacheLimit) {
+    uint32_t oldest = 0, oldestStamp = reader->cacheClock;
+    for(i=0; i<reader->nvar*2; i++) {
+      if(reader->vars[i] && reader->cacheStamp[i] < oldestStamp) {
+        oldest = i;
+        oldestStamp = reader->cacheStamp[i];
+      }
+    }
+    if(oldestStamp == reader->cacheClock) break;
+    free(reader->vars[oldest]);
+    reader->vars[oldest] = NULL;
+    reader->cacheSize -= colSize;
+    reader->readAll = 0;
+  }
+}
+
+void omc_matlab4_set_cache_limit(ModelicaMatReader *reader, size_t limit)
+{
+  reader->cacheLimit = limit;
+  matlab4_enforce_cache_limit(reader);
+}
+
+/* Releases the columns allocated by a failed omc_matlab4_read_vars_vals */
+static void matlab4_drop_columns(ModelicaMatReader *reader, int ncols, const MatGatherColumn_t *cols)
+{
+  int i;
+  for(i=0; i<ncols; i++) {
+    reader->vars[cols[i].col + (cols[i].sign < 0 ? reader->nvar : 0)] = NULL;
+    free(cols[i].dst);
+    reader->cacheSize -= reader->nrows*sizeof(double);
+  }
+}
+
+int omc_matlab4_read_vars_vals(ModelicaMatReader *reader, int nvars, const int *varIndexes)
+{
+  size_t colSize = reader->nrows*sizeof(double);
+  /* cols[0..ncols) are gathered from the file; the ncopies entries at the
+   * end of the array are negated copies of their alias, which is either
+   * cached already or gathered by this call */
+  MatGatherColumn_t *cols = NULL, *copies;
+  int i, ncols = 0, ncopies = 0;
+  uint32_t j;
+
+  if(nvars <= 0) return 0;
+  cols = (MatGatherColumn_t*) malloc(nvars*sizeof(MatGatherColumn_t));
+  if(!cols) return 1;
+  copies = cols + nvars;
+  if(reader->cacheStamp) {
+    reader->cacheClock++;
+  }
+  for(i=0; i<nvars; i++) {
+    int varIndex = varIndexes[i];
+    size_t absVarIndex = abs(varIndex);
+    size_t ix = (varIndex < 0 ? absVarIndex + reader->nvar : absVarIndex) -1;
+    size_t ixAlias = (varIndex < 0 ? absVarIndex : absVarIndex + reader->nvar) -1;
+    MatGatherColumn_t *col;
+    assert(absVarIndex > 0 && absVarIndex <= reader->nvar);
+    if(reader->cacheStamp) {
+      reader->cacheStamp[ix] = reader->cacheClock;
+    }
+    if(reader->vars[ix]) continue;
+    reader->vars[ix] = (double*) malloc(colSize);
+    if(!reader->vars[ix]) {
+      matlab4_drop_columns(reader, ncols, cols);
+      matlab4_drop_columns(reader, ncopies, copies);
+      free(cols);
+      return 1;
+    }
+    reader->cacheSize += colSize;
+    /* The negated alias (or the variable itself) is already cached or
+     * will be gathered below; copy it when it is complete */
+    col = reader->vars[ixAlias] ? --copies : cols + ncols;
+    col->col = absVarIndex-1;
+    col->sign = varIndex < 0 ? -1.0 : 1.0;
+    col->dst = reader->vars[ix];
+    if(reader->vars[ixAlias]) {
+      ncopies++;
+    } else {
+      ncols++;
+    }
+  }
+  if(ncols > 0) {
+    /* Visit the columns of each row in ascending order */
+    qsort(cols, ncols, sizeof(MatGatherColumn_t), matlab4_comp_gather_column);
+    if(matlab4_gather_columns(reader, ncols, cols)) {
+      matlab4_drop_columns(reader, ncols, cols);
+      matlab4_drop_columns(reader, ncopies, copies);
+      free(cols);
+      return 1;
     }
-    reader->vars[ix] = tmp;
+  }
+  for(i=0; i<ncopies; i++) {
+    const double *alias = reader->vars[copies[i].col + (copies[i].sign < 0 ? 0 : reader->nvar)];
+    for(j=0; j<reader->nrows; j++) {
+      copies[i].dst[j] = -alias[j];
+    }
+  }
+  free(cols);
+  matlab4_enforce_cache_limit(reader);
+  return 0;
+}
+
+double* omc_matlab4_read_vals(ModelicaMatReader *reader, int varIndex)
+{
+  size_t absVarIndex = abs(varIndex);
+  size_t ix = (varIndex < 0 ? absVarIndex + reader->nvar : absVarIndex) -1;
+  assert(absVarIndex > 0 && absVarIndex <= reader->nvar);
+  if(omc_matlab4_read_vars_vals(reader, 1, &varIndex)) {
+    return NULL;
   }
   return reader->vars[ix];
 }
@@ -643,8 +1118,8 @@ void matrix_transpose_uint32(uint32_t *m, int w, int h)
 int omc_matlab4_read_all_vals(ModelicaMatReader *reader)
 {
   int done = reader->readAll;
-  int i,j;
-  double *tmp;
+  int i;
+  int *indexes;
   int nrows = reader->nrows, nvar = reader->nvar;
   if (nvar == 0 || nrows == 0) {
     return 1;
@@ -656,34 +1131,27 @@ int omc_matlab4_read_all_vals(ModelicaMatReader *reader)
     reader->readAll = 1;
     return 0;
   }
-  tmp = (double*) malloc(2*nvar*nrows*sizeof(double));
-  if (!tmp) {
+  /* Gather the variables in one tiled pass, then derive the negated aliases from them */
+  indexes = (int*) calloc(nvar, sizeof(int));
+  if (!indexes) {
     return 1;
   }
-  fseek(reader->file, reader->var_offset, SEEK_SET);
-  if (nvar*reader->nrows != fread(tmp, reader->doublePrecision==1 ? sizeof(double) : sizeof(float), nvar*nrows, reader->file)) {
-    free(tmp);
-    return 1;
+  for (i=0; i<nvar; i++) {
+    indexes[i] = i+1;
   }
-  if(reader->doublePrecision != 1) {
-    for (i=nvar*nrows-1; i>=0; i--) {
-      tmp[i] = ((float*)tmp)[i];
-    }
+  if (omc_matlab4_read_vars_vals(reader, nvar, indexes)) {
+    free(indexes);
+    return 1;
   }
-  matrix_transpose(tmp,nvar,nrows);
-  /* Negative aliases */
-  for (i=0; i<nrows*nvar; i++) {
-    tmp[nrows*nvar + i] = -tmp[i];
+  for (i=0; i<nvar; i++) {
+    indexes[i] = -(i+1);
   }
-  /* Setup all the pointers */
-  for (i=0; i<2*nvar; i++) {
-    if (!reader->vars[i]) {
-      reader->vars[i] = (double*) malloc(nrows*sizeof(double));
-      memcpy(reader->vars[i], tmp + i*nrows, nrows*sizeof(double));
-    }
+  if (omc_matlab4_read_vars_vals(reader, nvar, indexes)) {
+    free(indexes);
+    return 1;
   }
-  free(tmp);
-  reader->readAll = 1;
+  free(indexes);
+  reader->readAll = reader->cacheLimit == 0;
   return 0;
 }
 
@@ -696,15 +1164,34 @@ double omc_matlab4_read_single_val(double *res, ModelicaMatReader *reader, int v
     *res = reader->vars[ix][timeIndex];
     return 0;
   }
-  if(reader->doublePrecision==1) {
-    fseek(reader->file,reader->var_offset + sizeof(double)*(timeIndex*reader->nvar + absVarIndex-1), SEEK_SET);
+  if(reader->chunkOffset) {
+    uint32_t k = matlab4_find_chunk(reader, timeIndex);
+    uint32_t n = reader->chunkFirstRow[k+1] - reader->chunkFirstRow[k];
+    size_t offset = reader->chunkOffset[k] + sizeof(double)*((absVarIndex-1)*n + timeIndex - reader->chunkFirstRow[k]);
+    if(reader->mappedData) {
+      memcpy(res, reader->mappedData + offset, sizeof(double));
+    } else if(omc_matlab4_fseek(reader->file, offset, SEEK_SET) || 1 != fread(res, sizeof(double), 1, reader->file)) {
+      *res = 0;
+      return 1;
+    }
+  } else if(reader->mappedData) {
+    size_t offset = (size_t)timeIndex*reader->nvar + absVarIndex-1;
+    if(reader->doublePrecision==1) {
+      memcpy(res, reader->mappedData + reader->var_offset + sizeof(double)*offset, sizeof(double));
+    } else {
+      float tmpres;
+      memcpy(&tmpres, reader->mappedData + reader->var_offset + sizeof(float)*offset, sizeof(float));
+      *res = tmpres;
+    }
+  } else if(reader->doublePrecision==1) {
+    omc_matlab4_fseek(reader->file,reader->var_offset + sizeof(double)*((int64_t)timeIndex*reader->nvar + absVarIndex-1), SEEK_SET);
     if(1 != fread(res, sizeof(double), 1, reader->file)) {
       *res = 0;
       return 1;
     }
   } else {
     float tmpres;
-    fseek(reader->file,reader->var_offset + sizeof(float)*(timeIndex*reader->nvar + absVarIndex-1), SEEK_SET);
+    omc_matlab4_fseek(reader->file,reader->var_offset + sizeof(float)*((int64_t)timeIndex*reader->nvar + absVarIndex-1), SEEK_SET);
     if(1 != fread(&tmpres, sizeof(float), 1, reader->file)) {
       *res = 0;
       return 1;
@@ -739,7 +1226,14 @@ void find_closest_points(double key, double *vec, int nelem, int *index1, double
     }
   } while(max > min);
   if(max == min) {
-    if(key > vec[max])
+    if(key == vec[max]) {
+      while(max < nelem-1 && vec[max] == vec[max+1]) max++;
+      *index1 = max;
+      *weight1 = 1.0;
+      *index2 = -1;
+      *weight2 = 0.0;
+      return;
+    } else if(key > vec[max])
       max++;
     else
       min--;
@@ -761,6 +1255,31 @@ double omc_matlab4_stopTime(ModelicaMatReader *reader)
   return reader->params[reader->nparam];
 }
 
+/* find_closest_points for a binChunked file whose time is not cached:
+ * only reads the time points of the chunk containing the given time and
+ * the last time point of the chunk before it */
+static int matlab4_find_closest_chunked_points(ModelicaMatReader *reader, double time, int *index1, double *weight1, int *index2, double *weight2)
+{
+  int timeIndex = 1;
+  uint32_t k, row0, nrows;
+  double *times;
+  if(reader->nchunks == 0) return 1;
+  k = matlab4_find_time_chunk(reader, time);
+  row0 = reader->chunkFirstRow[k] > 0 ? reader->chunkFirstRow[k]-1 : 0;
+  nrows = reader->chunkFirstRow[k+1] - row0;
+  times = (double*) malloc(nrows*sizeof(double));
+  if(!times) return 1;
+  if(omc_matlab4_read_vars_rows(reader, 1, &timeIndex, row0, nrows, times)) {
+    free(times);
+    return 1;
+  }
+  find_closest_points(time, times, nrows, index1, weight1, index2, weight2);
+  free(times);
+  if(*index1 != -1) *index1 += row0;
+  if(*index2 != -1) *index2 += row0;
+  return 0;
+}
+
 /* Returns 0 on success */
 int omc_matlab4_val(double *res, ModelicaMatReader *reader, ModelicaMatVariable_t *var, double time)
 {
@@ -774,8 +1293,12 @@ int omc_matlab4_val(double *res, ModelicaMatReader *reader, ModelicaMatVariable_
     int i1,i2;
     if(time > omc_matlab4_stopTime(reader)) return 1;
     if(time < omc_matlab4_startTime(reader)) return 1;
-    if(!omc_matlab4_read_vals(reader,1)) return 1;
-    find_closest_points(time, reader->vars[0], reader->nrows, &i1, &w1, &i2, &w2);
+    if(reader->chunkOffset && !reader->vars[0]) {
+      if(matlab4_find_closest_chunked_points(reader, time, &i1, &w1, &i2, &w2)) return 1;
+    } else {
+      if(!omc_matlab4_read_vals(reader,1)) return 1;
+      find_closest_points(time, reader->vars[0], reader->nrows, &i1, &w1, &i2, &w2);
+    }
     if(i2 == -1) {
       return (int)omc_matlab4_read_single_val(res,reader,var->index,i1);
     } else if(i1 == -1) {
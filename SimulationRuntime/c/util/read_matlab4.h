@@ -54,6 +54,16 @@ typedef struct {
   int readAll; /* Read all variables already */
   double **vars;
   char doublePrecision; /* data_1 and data_2 in double ore single precision */
+  const char *mappedData; /* The file mapped into memory (binTrans only); NULL if it is read using fread */
+  size_t mappedSize;
+  size_t cacheLimit; /* Maximum number of bytes cached in vars; 0 means no limit */
+  size_t cacheSize; /* Number of bytes currently cached in vars */
+  uint32_t *cacheStamp; /* Last use of each entry in vars, for evicting the least recently used column; NULL if columns may not be evicted */
+  uint32_t cacheClock;
+  uint32_t nchunks; /* binChunked: number of column-major data_2 chunks */
+  size_t *chunkOffset; /* binChunked: file offset of the data of each chunk */
+  uint32_t *chunkFirstRow; /* binChunked: first time point of each chunk; nchunks+1 entries */
+  double *chunkLastTime; /* binChunked: time of the last time point of each chunk */
 } ModelicaMatReader;
 
 /* Returns 0 on success; the error message on error.
@@ -67,6 +77,10 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
 
 void omc_free_matlab4_reader(ModelicaMatReader *reader);
 
+/* fseek/ftell with 64-bit offsets */
+int omc_matlab4_fseek(FILE *file, int64_t offset, int whence);
+int64_t omc_matlab4_ftell(FILE *file);
+
 /* Returns a variable or NULL */
 ModelicaMatVariable_t *omc_matlab4_find_var(ModelicaMatReader *reader, const char *varName);
 
@@ -77,6 +91,32 @@ ModelicaMatVariable_t *omc_matlab4_find_var(ModelicaMatReader *reader, const cha
  */
 double* omc_matlab4_read_vals(ModelicaMatReader *reader, int varIndex);
 
+/* Reads the values of several variables in a single pass over data_2.
+ * Only the requested columns are gathered; the rows are processed in
+ * cache-sized tiles. The values are afterwards available through
+ * omc_matlab4_read_vals without touching the file again.
+ * Note: Like omc_matlab4_read_vals, this is _not_ defined for parameters.
+ * Returns 0 on success.
+ */
+int omc_matlab4_read_vars_vals(ModelicaMatReader *reader, int nvars, const int *varIndexes);
+
+/* Reads the rows [row0,row0+nrows) of several variables into dst without
+ * caching them; dst[i*nrows+j] is row row0+j of varIndexes[i]. This allows
+ * streaming over data_2 in row blocks with memory proportional to the
+ * number of selected variables.
+ * Note: Like omc_matlab4_read_vals, this is _not_ defined for parameters.
+ * Returns 0 on success.
+ */
+int omc_matlab4_read_vars_rows(ModelicaMatReader *reader, int nvars, const int *varIndexes, uint32_t row0, uint32_t nrows, double *dst);
+
+/* Limits the memory used for cached variable values to approximately
+ * the given number of bytes (0 means no limit, which is the default).
+ * When a limit is set, the least recently used columns are released
+ * on the following reads, so pointers returned by omc_matlab4_read_vals
+ * are only valid until the next call that reads values.
+ */
+void omc_matlab4_set_cache_limit(ModelicaMatReader *reader, size_t limit);
+
 /* Returns 0 on success */
 int omc_matlab4_val(double *res, ModelicaMatReader *reader, ModelicaMatVariable_t *var, double time);
 
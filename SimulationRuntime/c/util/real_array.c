@@ -41,6 +41,7 @@
 #include <stdarg.h>
 #include <math.h>
 #include <float.h>
+#include <string.h>
 
 static inline modelica_real *real_ptrget(const real_array_t *a, size_t i)
 {
@@ -279,8 +280,6 @@ void simple_indexed_assign_real_array2(const real_array_t * source,
 void indexed_assign_real_array(const real_array_t source, real_array_t* dest,
                                const index_spec_t* dest_spec)
 {
-    _index_t* idx_vec1;
-    _index_t* idx_size;
     int i,j;
 
     omc_assert_macro(base_array_ok(&source));
@@ -294,29 +293,7 @@ void indexed_assign_real_array(const real_array_t source, real_array_t* dest,
     }
     omc_assert_macro(j == source.ndims);
 
-    idx_vec1 = size_alloc(dest->ndims);
-    idx_size = size_alloc(dest_spec->ndims);
-
-    for(i = 0; i < dest_spec->ndims; ++i) {
-        idx_vec1[i] = 0;
-
-        if(dest_spec->index[i] != NULL) { /* is 'S' or 'A' */
-            idx_size[i] = imax(dest_spec->dim_size[i],1);
-        } else { /* is 'W' */
-            idx_size[i] = dest->dim_size[i];
-        }
-    }
-
-    j = 0;
-    do {
-        real_set(dest,
-                 calc_base_index_spec(dest->ndims, idx_vec1, dest, dest_spec),
-                 real_get(source, j));
-        j++;
-
-    } while(0 == next_index(dest_spec->ndims, idx_vec1, idx_size));
-
-    omc_assert_macro(j == base_array_nr_of_elements(source));
+    indexed_assign_base_array_data(source.data, dest, dest_spec, sizeof(modelica_real));
 }
 
 /*
@@ -334,8 +311,6 @@ void index_real_array(const real_array_t * source,
                       const index_spec_t* source_spec,
                       real_array_t* dest)
 {
-    _index_t* idx_vec1;
-    _index_t* idx_size;
     int j;
     int i;
 
@@ -360,42 +335,7 @@ void index_real_array(const real_array_t * source,
     }
     omc_assert_macro(j == dest->ndims);
 
-    idx_vec1 = size_alloc(source->ndims);  /*indices in the source array*/
-    /* idx_vec2 = size_alloc(dest->ndims); / * indices in the destination array* / */
-    idx_size = size_alloc(source_spec->ndims);
-
-    for(i = 0; i < source->ndims; ++i) {
-        idx_vec1[i] = 0;
-    }
-    for(i = 0; i < source_spec->ndims; ++i) {
-        if(source_spec->index[i] != NULL) { /* is 'S' or 'A' */
-            idx_size[i] = imax(source_spec->dim_size[i],1); /* the imax() is not needed, because there is (idx[d] >= size[d]) in the next_index(), but ... */
-        } else { /* is 'W' */
-            idx_size[i] = source->dim_size[i];
-        }
-    }
-
-    j = 0;
-    do {
-        /*
-        for(i = 0, j = 0; i < source->ndims; ++i) {
-            if((source_spec->index_type[i] == 'W')
-                ||
-                (source_spec->index_type[i] == 'A')) {
-                idx_vec2[j] = idx_vec1[i];
-                j++;
-            }
-        }
-        */
-        real_set(dest, j,  /* calc_base_index(dest->ndims, idx_vec2, dest), */
-                 real_get(*source,
-                          calc_base_index_spec(source->ndims, idx_vec1,
-                                               source, source_spec)));
-        j++;
-
-    } while(0 == next_index(source->ndims, idx_vec1, idx_size));
-
-    omc_assert_macro(j == base_array_nr_of_elements(*dest));
+    index_base_array_data(source, source_spec, dest->data, sizeof(modelica_real));
 }
 
 /*
@@ -921,34 +861,82 @@ modelica_real mul_real_scalar_product(const real_array_t a, const real_array_t b
     return res;
 }
 
+/* BLAS kernels for large matrix products. real_array.c is also part of the
+ * runtime for compiled functions which is not linked against BLAS, so the
+ * simulation runtime sets these when it initializes a model. */
+omc_dgemm_t omc_dgemm = NULL;
+omc_dgemv_t omc_dgemv = NULL;
+
+/* use BLAS for products with at least this many multiplications */
+#define MATRIX_PRODUCT_BLAS_THRESHOLD (64*64*64)
+#define MATRIX_VECTOR_BLAS_THRESHOLD (256*256)
+/* the b block of the native product, 64x256 doubles = 128 kB */
+#define MATRIX_PRODUCT_BLOCK_K 64
+#define MATRIX_PRODUCT_BLOCK_J 256
+
 void mul_real_matrix_product(const real_array_t * a,const real_array_t * b,real_array_t* dest)
 {
-    modelica_real tmp;
+    const modelica_real *A = (const modelica_real *) a->data;
+    const modelica_real *B = (const modelica_real *) b->data;
+    modelica_real *C = (modelica_real *) dest->data;
     size_t i_size;
     size_t j_size;
     size_t k_size;
-    size_t i;
-    size_t j;
-    size_t k;
+    size_t i, j, k, j0, k0;
 
     /* Assert that dest has correct size */
     i_size = dest->dim_size[0];
     j_size = dest->dim_size[1];
     k_size = a->dim_size[1];
 
-    for(i = 0; i < i_size; ++i) {
-        for(j = 0; j < j_size; ++j) {
-            tmp = 0;
-            for(k = 0; k < k_size; ++k) {
-                tmp += real_get(*a, (i * k_size) + k)*real_get(*b, (k * j_size) + j);
+    if(omc_dgemm && i_size*j_size*k_size >= MATRIX_PRODUCT_BLAS_THRESHOLD) {
+        /* row-major C = A*B is column-major C^T = B^T*A^T */
+        char trans = 'N';
+        int m = j_size, n = i_size, k = k_size;
+        double one = 1.0, zero = 0.0;
+        omc_dgemm(&trans, &trans, &m, &n, &k, &one, (double*) B, &m, (double*) A, &k, &zero, C, &m);
+        return;
+    }
+
+    /* i-k-j order: a[i][k] is broadcast over the contiguous row b[k][*] into
+     * c[i][*], four k at a time, blocked over k and j so that the b block
+     * and the c row segment stay in cache. Each element is still summed in
+     * increasing k like the textbook loop. */
+    memset(C, 0, sizeof(modelica_real) * i_size * j_size);
+    for(j0 = 0; j0 < j_size; j0 += MATRIX_PRODUCT_BLOCK_J) {
+        const size_t j1 = j0 + MATRIX_PRODUCT_BLOCK_J < j_size ? j0 + MATRIX_PRODUCT_BLOCK_J : j_size;
+        for(k0 = 0; k0 < k_size; k0 += MATRIX_PRODUCT_BLOCK_K) {
+            const size_t k1 = k0 + MATRIX_PRODUCT_BLOCK_K < k_size ? k0 + MATRIX_PRODUCT_BLOCK_K : k_size;
+            for(i = 0; i < i_size; ++i) {
+                const modelica_real *a_row = A + i * k_size;
+                modelica_real *c_row = C + i * j_size;
+                for(k = k0; k + 4 <= k1; k += 4) {
+                    const modelica_real a0 = a_row[k], a1 = a_row[k + 1], a2 = a_row[k + 2], a3 = a_row[k + 3];
+                    const modelica_real *b0 = B + k * j_size;
+                    const modelica_real *b1 = b0 + j_size;
+                    const modelica_real *b2 = b1 + j_size;
+                    const modelica_real *b3 = b2 + j_size;
+                    for(j = j0; j < j1; ++j) {
+                        c_row[j] = c_row[j] + a0 * b0[j] + a1 * b1[j] + a2 * b2[j] + a3 * b3[j];
+                    }
+                }
+                for(; k < k1; ++k) {
+                    const modelica_real a_ik = a_row[k];
+                    const modelica_real *b_row = B + k * j_size;
+                    for(j = j0; j < j1; ++j) {
+                        c_row[j] += a_ik * b_row[j];
+                    }
+                }
             }
-            real_set(dest, (i * j_size) + j, tmp);
         }
     }
 }
 
 void mul_real_matrix_vector(const real_array_t * a, const real_array_t * b,real_array_t* dest)
 {
+    const modelica_real *A = (const modelica_real *) a->data;
+    const modelica_real *x = (const modelica_real *) b->data;
+    modelica_real *y = (modelica_real *) dest->data;
     size_t i;
     size_t j;
     size_t i_size;
@@ -962,37 +950,61 @@ void mul_real_matrix_vector(const real_array_t * a, const real_array_t * b,real_
     i_size = a->dim_size[0];
     j_size = a->dim_size[1];
 
+    if(omc_dgemv && i_size*j_size >= MATRIX_VECTOR_BLAS_THRESHOLD) {
+        /* row-major A is column-major A^T */
+        char trans = 'T';
+        int m = j_size, n = i_size, inc = 1;
+        double one = 1.0, zero = 0.0;
+        omc_dgemv(&trans, &m, &n, &one, (double*) A, &m, (double*) x, &inc, &zero, y, &inc);
+        return;
+    }
+
     for(i = 0; i < i_size; ++i) {
+        const modelica_real *a_row = A + i * j_size;
         tmp = 0;
         for(j = 0; j < j_size; ++j) {
-            tmp += real_get(*a, (i * j_size) + j) * real_get(*b, j);
+            tmp += a_row[j] * x[j];
         }
-        real_set(dest, i, tmp);
+        y[i] = tmp;
     }
 }
 
 
 void mul_real_vector_matrix(const real_array_t * a, const real_array_t * b,real_array_t* dest)
 {
+    const modelica_real *x = (const modelica_real *) a->data;
+    const modelica_real *B = (const modelica_real *) b->data;
+    modelica_real *y = (modelica_real *) dest->data;
     size_t i;
     size_t j;
     size_t i_size;
     size_t j_size;
-    modelica_real tmp;
 
     /* Assert a vector */
     /* Assert b matrix */
     /* Assert dest vector of correct size */
 
-    i_size = a->dim_size[0];
+    i_size = b->dim_size[0];
     j_size = b->dim_size[1];
 
+    if(omc_dgemv && i_size*j_size >= MATRIX_VECTOR_BLAS_THRESHOLD) {
+        /* row-major B is column-major B^T, y = B^T*x */
+        char trans = 'N';
+        int m = j_size, n = i_size, inc = 1;
+        double one = 1.0, zero = 0.0;
+        omc_dgemv(&trans, &m, &n, &one, (double*) B, &m, (double*) x, &inc, &zero, y, &inc);
+        return;
+    }
+
+    for(j = 0; j < j_size; ++j) {
+        y[j] = 0;
+    }
     for(i = 0; i < i_size; ++i) {
-        tmp = 0;
+        const modelica_real x_i = x[i];
+        const modelica_real *b_row = B + i * j_size;
         for(j = 0; j < j_size; ++j) {
-            tmp += real_get(*a, j) * real_get(*b, (j * j_size) + i);
+            y[j] += x_i * b_row[j];
         }
-        real_set(dest, i, tmp);
     }
 }
 
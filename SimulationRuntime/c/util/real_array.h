@@ -181,6 +181,14 @@ extern real_array_t mul_alloc_real_array(const real_array_t a,const real_array_t
 
 extern modelica_real mul_real_scalar_product(const real_array_t a, const real_array_t b);
 
+typedef int (*omc_dgemm_t)(char *transa, char *transb, int *m, int *n, int *k, double *alpha,
+                           double *a, int *lda, double *b, int *ldb, double *beta, double *c, int *ldc);
+typedef int (*omc_dgemv_t)(char *trans, int *m, int *n, double *alpha, double *a, int *lda,
+                           double *x, int *incx, double *beta, double *y, int *incy);
+/* BLAS routines used for large matrix products, NULL if BLAS is not linked */
+extern omc_dgemm_t omc_dgemm;
+extern omc_dgemv_t omc_dgemv;
+
 extern void mul_real_matrix_product(const real_array_t *a,const real_array_t *b,real_array_t*dest);
 extern void mul_real_matrix_vector(const real_array_t * a, const real_array_t * b,
                             real_array_t* dest);
@@ -38,9 +38,12 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_CLOCK */                 "clock",
   /* FLAG_CPU */                   "cpu",
   /* FLAG_DASSL_JACOBIAN */        "dasslJacobian",
+  /* FLAG_DASSL_JACOBIAN_THREADS */ "dasslJacobianThreads",
   /* FLAG_DASSL_NO_ROOTFINDING */  "dasslnoRootFinding",
   /* FLAG_DASSL_NO_RESTART */      "dasslnoRestart",
   /* FLAG_EMIT_PROTECTED */        "emit_protected",
+  /* FLAG_EMIT_THREAD */           "emitThread",
+  /* FLAG_EVENT_LOCATOR */         "eventLocator",
   /* FLAG_F */                     "f",
   /* FLAG_HELP */                  "help",
   /* FLAG_IIF */                   "iif",
@@ -59,6 +62,7 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_LOG_FORMAT */            "logFormat",
   /* FLAG_LS */                    "ls",
   /* FLAG_LS_IPOPT */              "ls_ipopt",
+  /* FLAG_LS_REFACTOR */           "lsRefactor",
   /* FLAG_LV */                    "lv",
   /* FLAG_MAX_STEP_SIZE */         "maxStepSize",
   /* FLAG_MAX_ORDER */             "maxIntegrationOrder",
@@ -66,6 +70,7 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_NEWTON_STRATEGY */       "newton",
   /* FLAG_NLS */                   "nls",
   /* FLAG_NLS_INFO */              "nlsInfo",
+  /* FLAG_NLS_JAC_REUSE */         "nlsJacobianReuse",
   /* FLAG_NOEMIT */                "noemit",
   /* FLAG_NOEQUIDISTANT_GRID */    "noEquidistantTimeGrid",
   /* FLAG_NOEQUIDISTANT_OUT_FREQ*/ "noEquidistantOutputFrequency",
@@ -77,7 +82,9 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_OVERRIDE_FILE */         "overrideFile",
   /* FLAG_OPTIMIZER_NP */          "optimizerNP",
   /* FLAG_OPTIMIZER_TGRID */       "optimizerTimeGrid",
+  /* FLAG_OPTIMIZER_THREADS */     "optimizerThreads",
   /* FLAG_UP_HESSIAN */            "keepHessian",
+  /* FLAG_PARMODAUTO_SCHEDULER */  "parmodautoScheduler",
   /* FLAG_PORT */                  "port",
   /* FLAG_R */                     "r",
   /* FLAG_S */                     "s",
@@ -94,9 +101,12 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_CLOCK */                 "selects the type of clock to use -clock=RT, -clock=CYC or -clock=CPU",
   /* FLAG_CPU */                   "dumps the cpu-time into the results-file",
   /* FLAG_DASSL_JACOBIAN */        "selects the type of the jacobians that is used for the dassl solver.\n  dasslJacobian=[coloredNumerical (default) |numerical|internalNumerical|coloredSymbolical|symbolical].",
+  /* FLAG_DASSL_JACOBIAN_THREADS */ "value specifies the number of threads evaluating the colored numerical jacobian of dassl (1 disables)",
   /* FLAG_DASSL_NO_ROOTFINDING */  "flag deactivates the internal root finding procedure of dassl.",
   /* FLAG_DASSL_NO_RESTART */      "flag deactivates the restart of dassl after an event is performed.",
   /* FLAG_EMIT_PROTECTED */        "emits protected variables to the result-file",
+  /* FLAG_EMIT_THREAD */           "value specifies the number of output points buffered for a separate output thread (0 disables)",
+  /* FLAG_EVENT_LOCATOR */         "value specifies the method to locate state events [bisection (default)|illinois]",
   /* FLAG_F */                     "value specifies a new setup XML file to the generated simulation code",
   /* FLAG_HELP */                  "get detailed information that specifies the command-line flag",
   /* FLAG_IIF */                   "value specifies an external file for the initialization of the model",
@@ -115,6 +125,7 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_LOG_FORMAT */            "value specifies the log format of the executable. -logFormat=text (default) or -logFormat=xml",
   /* FLAG_LS */                    "value specifies the linear solver method",
   /* FLAG_LS_IPOPT */              "value specifies the linear solver method for ipopt",
+  /* FLAG_LS_REFACTOR */           "value specifies the number of solutions after which the lapack solver refactorizes an unchanged matrix (default 0 never)",
   /* FLAG_LV */                    "[string list] value specifies the logging level",
   /* FLAG_MAX_STEP_SIZE */         "value specifies maximum absolute step size, used by dassl solver",
   /* FLAG_MAX_ORDER */             "value specifies maximum integration order, used by dassl solver",
@@ -122,6 +133,7 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_NEWTON_STRATEGY */       "value specifies the damping strategy for the newton solver",
   /* FLAG_NLS */                   "value specifies the nonlinear solver",
   /* FLAG_NLS_INFO */              "outputs detailed information about solving process of non-linear systems into csv files.",
+  /* FLAG_NLS_JAC_REUSE */         "value specifies the number of calls a Broyden updated jacobian is reused by the newton solver (default 0 off)",
   /* FLAG_NOEMIT */                "do not emit any results to the result file",
   /* FLAG_NOEQUIDISTANT_GRID */    "stores results not in equidistant time grid as given by stepSize or numberOfIntervals, instead the variable step size of dassl is used.",
   /* FLAG_NOEQUIDISTANT_OUT_FREQ*/ "value controls the output frequency in noEquidistantTimeGrid mode",
@@ -133,7 +145,9 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_OVERRIDE_FILE */         "will override the variables or the simulation settings in the XML setup file with the values from the file",
   /* FLAG_OPTIMIZER_NP */          "value specifies the number of points in a subinterval",
   /* FLAG_OPTIMIZER_TGRID */       "value specifies external file with time points.",
+  /* FLAG_OPTIMIZER_THREADS */     "value specifies the number of threads evaluating the collocation intervals of the optimizer (1 disables)",
   /* FLAG_UP_HESSIAN */            "value specifies the number of steps, which keep hessian matrix constant",
+  /* FLAG_PARMODAUTO_SCHEDULER */  "value specifies the task scheduler for models compiled with -d=parmodauto [level (default)|dynamic|serial|auto]",
   /* FLAG_PORT */                  "value specifies the port for simulation status (default disabled)",
   /* FLAG_R */                     "value specifies a new result file than the default Model_res.mat",
   /* FLAG_S */                     "value specifies the solver",
@@ -162,12 +176,31 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  * coloredSymbolical (colored symbolical Jacobian. Only usable if the simulation is compiled with --generateSymbolicJacobian or --generateSymbolicLinearization.\n"
   "  * numerical - numerical Jacobian.\n\n"
   "  * symbolical - symbolical Jacobian. Only usable if the simulation is compiled with --generateSymbolicJacobian or --generateSymbolicLinearization.",
+  /* FLAG_DASSL_JACOBIAN_THREADS */
+  "  Value specifies the number of threads that evaluate the colors of the\n"
+  "  coloredNumerical Jacobian of dassl. Every thread works on a private copy of\n"
+  "  the model variables and idle threads steal colors from busy ones. The first\n"
+  "  Jacobian (and every Jacobian with -lv=LOG_JAC) is compared bit by bit with the\n"
+  "  sequential evaluation. Only used for models without algebraic loops, external\n"
+  "  objects and external functions. Default 1 evaluates the colors sequentially.",
   /* FLAG_DASSL_NO_ROOTFINDING */
   "  Deactivates the internal root finding procedure of dassl.",
   /* FLAG_DASSL_NO_RESTART */
   "  Deactivates the restart of dassl after an event is performed.",
   /* FLAG_EMIT_PROTECTED */
   "  Emits protected variables to the result-file.",
+  /* FLAG_EMIT_THREAD */
+  "  Value specifies the number of output points that are buffered for a separate\n"
+  "  thread writing the result file. The solver only copies the variables into the\n"
+  "  buffer and waits if it is full. Default 0 writes the results on the solver\n"
+  "  thread. Not used with the ia output format.",
+  /* FLAG_EVENT_LOCATOR */
+  "  Value specifies the method to locate state events for solvers without internal\n"
+  "  root finding:\n\n"
+  "  * bisection (bisection with linearly interpolated states - default)\n"
+  "  * illinois (regula falsi with the Illinois modification on the values of the\n"
+  "    zero-crossing functions, the states are interpolated with the cubic Hermite\n"
+  "    polynomial of the step)",
   /* FLAG_F */
   "  Value specifies a new setup XML file to the generated simulation code.\n",
   /* FLAG_HELP */
@@ -209,6 +242,13 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   /* FLAG_LS_IPOPT */
   "  Value specifies the linear solver method for Ipopt, default mumps.\n"
   "  Note: Use if you build ipopt with other linear solver like ma27",
+  /* FLAG_LS_REFACTOR */
+  "  The lapack linear solver (-ls=lapack and the default solver) keeps the LU\n"
+  "  factorization of a linear system and reuses it as long as the assembled\n"
+  "  matrix does not change, e.g. for systems which depend only on parameters or\n"
+  "  change only at events. Value specifies the number of solutions after which\n"
+  "  an unchanged matrix is refactorized anyway. Default 0 refactorizes only\n"
+  "  changed matrices, 1 refactorizes the matrix for every solution.",
   /* FLAG_LV */
   "  Value (a comma-separated String list) specifies which logging levels to\n"
   "  enable. Multiple options can be enabled at the same time.",
@@ -233,6 +273,13 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  * mixed",
   /* FLAG_NLS_INFO */
   "  Outputs detailed information about solving process of non-linear systems into csv files.",
+  /* FLAG_NLS_JAC_REUSE */
+  "  The newton solver (-nls=newton) keeps the jacobian of a non-linear system\n"
+  "  from one call to the next and improves it with rank-one Broyden updates\n"
+  "  instead of evaluating a new one. A fresh jacobian is evaluated after events,\n"
+  "  if the residual is not reduced sufficiently, and if the solver has to retry.\n"
+  "  Value specifies the number of consecutive calls the kept jacobian is reused\n"
+  "  before a fresh one is evaluated anyway. Default 0 disables the reuse.",
   /* FLAG_NOEMIT */
   "  Do not emit any results to the result file.",
   /* FLAG_NOEQUIDISTANT_GRID */
@@ -266,8 +313,26 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  Currently supports numbers 1 and 3.",
   /* FLAG_OPTIMIZER_TGRID */
   "  Value specifies external file with time points.",
+  /* FLAG_OPTIMIZER_THREADS */
+  "  Value specifies the number of threads that evaluate the collocation intervals\n"
+  "  of the optimizer, i.e. the model equations, the Jacobians and the numerical\n"
+  "  Hessian at the collocation points. Every thread works on a private copy of the\n"
+  "  model variables. The first evaluations are compared bit by bit with the\n"
+  "  sequential ones. Only used for models without algebraic loops, relations and\n"
+  "  discrete variables; external objects and functions have to be thread-safe.\n"
+  "  Default 1 evaluates the intervals sequentially.",
   /* FLAG_UP_HESSIAN */
   "  Value specifies the number of steps, which keep hessian matrix constant.",
+  /* FLAG_PARMODAUTO_SCHEDULER */
+  "  Value specifies how the ODE equations of a model compiled with -d=parmodauto\n"
+  "  are scheduled on the worker threads:\n\n"
+  "  * level (the equations are clustered level by level with costs measured\n"
+  "    during the first steps - default)\n"
+  "  * dynamic (a TBB flow graph runs each equation as soon as its inputs are\n"
+  "    ready)\n"
+  "  * serial (no parallelism, the equations run in their sorted order)\n"
+  "  * auto (each of the above is timed for a few steps on the model and the\n"
+  "    fastest one is used for the rest of the simulation)",
   /* FLAG_PORT */
   "  Value specifies the port for simulation status (default disabled).",
   /* FLAG_R */
@@ -290,9 +355,12 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_CLOCK */                 FLAG_TYPE_OPTION,
   /* FLAG_CPU */                   FLAG_TYPE_FLAG,
   /* FLAG_DASSL_JACOBIAN */        FLAG_TYPE_OPTION,
+  /* FLAG_DASSL_JACOBIAN_THREADS */ FLAG_TYPE_OPTION,
   /* FLAG_DASSL_NO_ROOTFINDING */  FLAG_TYPE_FLAG,
   /* FLAG_DASSL_NO_RESTART */      FLAG_TYPE_FLAG,
   /* FLAG_EMIT_PROTECTED */        FLAG_TYPE_FLAG,
+  /* FLAG_EMIT_THREAD */           FLAG_TYPE_OPTION,
+  /* FLAG_EVENT_LOCATOR */         FLAG_TYPE_OPTION,
   /* FLAG_F */                     FLAG_TYPE_OPTION,
   /* FLAG_HELP */                  FLAG_TYPE_OPTION,
   /* FLAG_IIF */                   FLAG_TYPE_OPTION,
@@ -311,6 +379,7 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_LOG_FORMAT */            FLAG_TYPE_OPTION,
   /* FLAG_LS */                    FLAG_TYPE_OPTION,
   /* FLAG_LS_IPOPT */              FLAG_TYPE_OPTION,
+  /* FLAG_LS_REFACTOR */           FLAG_TYPE_OPTION,
   /* FLAG_LV */                    FLAG_TYPE_OPTION,
   /* FLAG_MAX_STEP_SIZE */         FLAG_TYPE_OPTION,
   /* FLAG_MAX_ORDER */             FLAG_TYPE_OPTION,
@@ -318,6 +387,7 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_NEWTON_STRATEGY */       FLAG_TYPE_OPTION,
   /* FLAG_NLS */                   FLAG_TYPE_OPTION,
   /* FLAG_NLS_INFO */              FLAG_TYPE_FLAG,
+  /* FLAG_NLS_JAC_REUSE */         FLAG_TYPE_OPTION,
   /* FLAG_NOEMIT */                FLAG_TYPE_FLAG,
   /* FLAG_NOEQUIDISTANT_GRID*/     FLAG_TYPE_FLAG,
   /* FLAG_NOEQUIDISTANT_OUT_FREQ*/ FLAG_TYPE_OPTION,
@@ -329,7 +399,9 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_OVERRIDE_FILE */         FLAG_TYPE_OPTION,
   /* FLAG_OPTIZER_NP */            FLAG_TYPE_OPTION,
   /* FLAG_OPTIZER_TGRID */         FLAG_TYPE_OPTION,
+  /* FLAG_OPTIMIZER_THREADS */     FLAG_TYPE_OPTION,
   /* FLAG_UP_HESSIAN */            FLAG_TYPE_OPTION,
+  /* FLAG_PARMODAUTO_SCHEDULER */  FLAG_TYPE_OPTION,
   /* FLAG_PORT */                  FLAG_TYPE_OPTION,
   /* FLAG_R */                     FLAG_TYPE_OPTION,
   /* FLAG_S */                     FLAG_TYPE_OPTION,
@@ -464,3 +536,43 @@ const char *NEWTONSTRATEGY_DESC[NEWTON_MAX+1] = {
 
   "NEWTON_MAX"
 };
+
+const char *EVENT_LOCATOR_NAME[EVENT_LOCATOR_MAX+1] = {
+  "EVENT_LOCATOR_UNKNOWN",
+
+  /* EVENT_LOCATOR_BISECTION */ "bisection",
+  /* EVENT_LOCATOR_ILLINOIS */  "illinois",
+
+  "EVENT_LOCATOR_MAX"
+};
+
+const char *EVENT_LOCATOR_DESC[EVENT_LOCATOR_MAX+1] = {
+  "unknown",
+
+  /* EVENT_LOCATOR_BISECTION */ "bisection with linearly interpolated states",
+  /* EVENT_LOCATOR_ILLINOIS */  "Illinois regula falsi on the zero-crossing values with Hermite interpolated states",
+
+  "EVENT_LOCATOR_MAX"
+};
+
+const char *PARMODAUTO_SCHEDULER_NAME[PARMODAUTO_SCHEDULER_MAX+1] = {
+  "PARMODAUTO_SCHEDULER_UNKNOWN",
+
+  /* PARMODAUTO_SCHEDULER_SERIAL */  "serial",
+  /* PARMODAUTO_SCHEDULER_LEVEL */   "level",
+  /* PARMODAUTO_SCHEDULER_DYNAMIC */ "dynamic",
+  /* PARMODAUTO_SCHEDULER_AUTO */    "auto",
+
+  "PARMODAUTO_SCHEDULER_MAX"
+};
+
+const char *PARMODAUTO_SCHEDULER_DESC[PARMODAUTO_SCHEDULER_MAX+1] = {
+  "unknown",
+
+  /* PARMODAUTO_SCHEDULER_SERIAL */  "equations in sorted order on one thread",
+  /* PARMODAUTO_SCHEDULER_LEVEL */   "profiled, clustered level scheduler",
+  /* PARMODAUTO_SCHEDULER_DYNAMIC */ "TBB flow graph over the equation dependencies",
+  /* PARMODAUTO_SCHEDULER_AUTO */    "time all schedulers on the model and keep the fastest",
+
+  "PARMODAUTO_SCHEDULER_MAX"
+};
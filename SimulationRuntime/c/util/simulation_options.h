@@ -46,9 +46,12 @@ enum _FLAG
   FLAG_CLOCK,
   FLAG_CPU,
   FLAG_DASSL_JACOBIAN,
+  FLAG_DASSL_JACOBIAN_THREADS,
   FLAG_DASSL_NO_ROOTFINDING,
   FLAG_DASSL_NO_RESTART,
   FLAG_EMIT_PROTECTED,
+  FLAG_EMIT_THREAD,
+  FLAG_EVENT_LOCATOR,
   FLAG_F,
   FLAG_HELP,
   FLAG_IIF,
@@ -67,6 +70,7 @@ enum _FLAG
   FLAG_LOG_FORMAT,
   FLAG_LS,
   FLAG_LS_IPOPT,
+  FLAG_LS_REFACTOR,
   FLAG_LV,
   FLAG_MAX_STEP_SIZE,
   FLAG_MAX_ORDER,
@@ -74,6 +78,7 @@ enum _FLAG
   FLAG_NEWTON_STRATEGY,
   FLAG_NLS,
   FLAG_NLS_INFO,
+  FLAG_NLS_JAC_REUSE,
   FLAG_NOEMIT,
   FLAG_NOEQUIDISTANT_GRID,
   FLAG_NOEQUIDISTANT_OUT_FREQ,
@@ -85,7 +90,9 @@ enum _FLAG
   FLAG_OVERRIDE_FILE,
   FLAG_OPTIMIZER_NP,
   FLAG_OPTIMIZER_TGRID,
+  FLAG_OPTIMIZER_THREADS,
   FLAG_UP_HESSIAN,
+  FLAG_PARMODAUTO_SCHEDULER,
   FLAG_PORT,
   FLAG_R,
   FLAG_S,
@@ -197,6 +204,34 @@ extern const char *NLS_DESC[NLS_MAX+1];
 extern const char *NEWTONSTRATEGY_NAME[NEWTON_MAX+1];
 extern const char *NEWTONSTRATEGY_DESC[NEWTON_MAX+1];
 
+enum EVENT_LOCATOR
+{
+  EVENT_LOCATOR_UNKNOWN = 0,
+
+  EVENT_LOCATOR_BISECTION,
+  EVENT_LOCATOR_ILLINOIS,
+
+  EVENT_LOCATOR_MAX
+};
+
+extern const char *EVENT_LOCATOR_NAME[EVENT_LOCATOR_MAX+1];
+extern const char *EVENT_LOCATOR_DESC[EVENT_LOCATOR_MAX+1];
+
+enum PARMODAUTO_SCHEDULER
+{
+  PARMODAUTO_SCHEDULER_UNKNOWN = 0,
+
+  PARMODAUTO_SCHEDULER_SERIAL,
+  PARMODAUTO_SCHEDULER_LEVEL,
+  PARMODAUTO_SCHEDULER_DYNAMIC,
+  PARMODAUTO_SCHEDULER_AUTO,
+
+  PARMODAUTO_SCHEDULER_MAX
+};
+
+extern const char *PARMODAUTO_SCHEDULER_NAME[PARMODAUTO_SCHEDULER_MAX+1];
+extern const char *PARMODAUTO_SCHEDULER_DESC[PARMODAUTO_SCHEDULER_MAX+1];
+
 #if defined(__cplusplus)
   }
 #endif
@@ -247,9 +247,6 @@ void indexed_assign_string_array(const string_array_t * source,
                                  string_array_t* dest,
                                  const index_spec_t* dest_spec)
 {
-    _index_t* idx_vec1;
-    _index_t* idx_vec2;
-    _index_t* idx_size;
     int i,j;
 
     assert(base_array_ok(source));
@@ -263,33 +260,7 @@ void indexed_assign_string_array(const string_array_t * source,
     }
     assert(j == source->ndims);
 
-    idx_vec1 = size_alloc(dest->ndims);
-    idx_vec2 = size_alloc(source->ndims);
-    idx_size = size_alloc(dest_spec->ndims);
-
-    for(i = 0; i < dest_spec->ndims; ++i) {
-        idx_vec1[i] = 0;
-
-        if(dest_spec->index[i] != NULL) {
-            idx_size[i] = imax(dest_spec->dim_size[i],1);
-        } else {
-            idx_size[i] = dest->dim_size[i];
-        }
-    }
-
-    do {
-        for(i = 0, j = 0; i < dest_spec->ndims; ++i) {
-            if(dest_spec->dim_size[i] != 0) {
-                idx_vec2[j] = idx_vec1[i];
-                ++j;
-            }
-        }
-        string_set(dest, calc_base_index_spec(dest->ndims, idx_vec1,
-                                              dest, dest_spec),
-                   string_get(*source, calc_base_index(source->ndims,
-                                                      idx_vec2, source)));
-
-    } while(0 == next_index(dest_spec->ndims, idx_vec1, idx_size));
+    indexed_assign_base_array_data(source->data, dest, dest_spec, sizeof(modelica_string));
 }
 
 /*
@@ -307,9 +278,6 @@ void index_string_array(const string_array_t * source,
                         const index_spec_t* source_spec,
                         string_array_t* dest)
 {
-    _index_t* idx_vec1;
-    _index_t* idx_vec2;
-    _index_t* idx_size;
     int j;
     int i;
 
@@ -326,37 +294,7 @@ void index_string_array(const string_array_t * source,
     }
     assert(j == dest->ndims);
 
-    idx_vec1 = size_alloc(source->ndims);  /*indices in the source array*/
-    idx_vec2 = size_alloc(dest->ndims); /* indices in the destination array*/
-    idx_size = size_alloc(source_spec->ndims);
-
-    for(i = 0; i < source->ndims; ++i) {
-        idx_vec1[i] = 0;
-    }
-    for(i = 0; i < source_spec->ndims; ++i) {
-        if(source_spec->index[i] != NULL) {
-            idx_size[i] = imax(source_spec->dim_size[i],1);
-        } else {
-            idx_size[i] = source->dim_size[i];
-        }
-    }
-
-    do {
-        for(i = 0, j = 0; i < source->ndims; ++i) {
-            if((source_spec->index_type[i] == 'W')
-                ||
-                (source_spec->index_type[i] == 'A')) {
-                idx_vec2[j] = idx_vec1[i];
-                j++;
-            }
-        }
-
-        string_set(dest, calc_base_index(dest->ndims, idx_vec2, dest),
-                   string_get(*source,
-                              calc_base_index_spec(source->ndims, idx_vec1,
-                                                   source, source_spec)));
-
-    } while(0 == next_index(source->ndims, idx_vec1, idx_size));
+    index_base_array_data(source, source_spec, dest->data, sizeof(modelica_string));
 }
 
 /*
@@ -6,6 +6,7 @@
 #include <Core/Modelica.h>
 #include <Core/Math/ArrayOperations.h>
 #include <Core/Math/ArraySlice.h>
+#include <Core/Math/ILapack.h>
 #include <sstream>
 #include <stdio.h>
 
@@ -199,16 +200,107 @@ void multiply_array(const BaseArray<T>& inputArray, const T &b, BaseArray<T>& ou
                   aim, std::bind2nd(std::multiplies<T>(), b));
 };
 
+/**
+ * helpers for multiply_array
+ * kernels on contiguous column-major data, accumulating in the same
+ * order as the element wise definition; double products above
+ * MULTIPLY_ARRAY_BLAS_THRESHOLD are passed to BLAS
+ */
 template <typename T>
-void multiply_array(const BaseArray<T> &leftArray, const BaseArray<T> &rightArray, BaseArray<T> &resultArray)
+static void multiply_matrix_matrix(const T* A, const T* B, T* C,
+                                   size_t m, size_t n, size_t p)
+{
+  for (size_t j = 0; j < p; j++) {
+    T* c = C + m*j;
+    std::fill(c, c + m, T());
+    for (size_t k = 0; k < n; k++) {
+      const T b = B[k + n*j];
+      const T* a = A + m*k;
+      for (size_t i = 0; i < m; i++)
+        c[i] += a[i] * b;
+    }
+  }
+}
+
+static void multiply_matrix_matrix(const double* A, const double* B, double* C,
+                                   size_t m, size_t n, size_t p)
+{
+  if (m*n*p < MULTIPLY_ARRAY_BLAS_THRESHOLD) {
+    multiply_matrix_matrix<double>(A, B, C, m, n, p);
+    return;
+  }
+  char trans = 'N';
+  long int M = m, N = p, K = n;
+  double alpha = 1.0, beta = 0.0;
+  dgemm_(&trans, &trans, &M, &N, &K, &alpha, const_cast<double*>(A), &M,
+         const_cast<double*>(B), &K, &beta, C, &M);
+}
+
+template <typename T>
+static void multiply_matrix_vector(const T* A, const T* x, T* y,
+                                   size_t m, size_t n)
+{
+  std::fill(y, y + m, T());
+  for (size_t k = 0; k < n; k++) {
+    const T b = x[k];
+    const T* a = A + m*k;
+    for (size_t i = 0; i < m; i++)
+      y[i] += a[i] * b;
+  }
+}
+
+static void multiply_matrix_vector(const double* A, const double* x, double* y,
+                                   size_t m, size_t n)
+{
+  if (m*n < MULTIPLY_ARRAY_BLAS_THRESHOLD2) {
+    multiply_matrix_vector<double>(A, x, y, m, n);
+    return;
+  }
+  char trans = 'N';
+  long int M = m, N = n, inc = 1;
+  double alpha = 1.0, beta = 0.0;
+  dgemv_(&trans, &M, &N, &alpha, const_cast<double*>(A), &M,
+         const_cast<double*>(x), &inc, &beta, y, &inc);
+}
+
+template <typename T>
+static void multiply_vector_matrix(const T* x, const T* B, T* y,
+                                   size_t n, size_t p)
+{
+  for (size_t j = 0; j < p; j++) {
+    const T* b = B + n*j;
+    T val = T();
+    for (size_t k = 0; k < n; k++)
+      val += x[k] * b[k];
+    y[j] = val;
+  }
+}
+
+static void multiply_vector_matrix(const double* x, const double* B, double* y,
+                                   size_t n, size_t p)
+{
+  if (n*p < MULTIPLY_ARRAY_BLAS_THRESHOLD2) {
+    multiply_vector_matrix<double>(x, B, y, n, p);
+    return;
+  }
+  char trans = 'T';
+  long int N = n, P = p, inc = 1;
+  double alpha = 1.0, beta = 0.0;
+  dgemv_(&trans, &N, &P, &alpha, const_cast<double*>(B), &N,
+         const_cast<double*>(x), &inc, &beta, y, &inc);
+}
+
+/**
+ * element wise product for two-dimensional reference arrays, whose data
+ * is not stored in column-major order
+ */
+template <typename T>
+static void multiply_ref_array(const BaseArray<T> &leftArray, const BaseArray<T> &rightArray, BaseArray<T> &resultArray)
 {
   size_t leftNumDims = leftArray.getNumDims();
   size_t rightNumDims = rightArray.getNumDims();
   size_t matchDim = rightArray.getDim(1);
-  if (leftArray.getDim(leftNumDims) != matchDim)
-    throw ModelicaSimulationError(MODEL_ARRAY_FUNCTION,
-                                  "Wrong sizes in multiply_array");
-  if (leftNumDims == 1 && rightNumDims == 2) {
+  if (leftNumDims == 1) {
     size_t rightDim = rightArray.getDim(2);
     for (size_t j = 1; j <= rightDim; j++) {
       T val = T();
@@ -217,7 +309,7 @@ void multiply_array(const BaseArray<T> &leftArray, const BaseArray<T> &rightArra
       resultArray(j) = val;
     }
   }
-  else if (leftNumDims == 2 && rightNumDims == 1) {
+  else if (rightNumDims == 1) {
     size_t leftDim = leftArray.getDim(1);
     for (size_t i = 1; i <= leftDim; i++) {
       T val = T();
@@ -226,7 +318,7 @@ void multiply_array(const BaseArray<T> &leftArray, const BaseArray<T> &rightArra
       resultArray(i) = val;
     }
   }
-  else if (leftNumDims == 2 && rightNumDims == 2) {
+  else {
     size_t leftDim = leftArray.getDim(1);
     size_t rightDim = rightArray.getDim(2);
     for (size_t i = 1; i <= leftDim; i++) {
@@ -238,9 +330,64 @@ void multiply_array(const BaseArray<T> &leftArray, const BaseArray<T> &rightArra
       }
     }
   }
+}
+
+template <typename T>
+void multiply_array(const BaseArray<T> &leftArray, const BaseArray<T> &rightArray, BaseArray<T> &resultArray)
+{
+  size_t leftNumDims = leftArray.getNumDims();
+  size_t rightNumDims = rightArray.getNumDims();
+  size_t matchDim = rightArray.getDim(1);
+  if (leftArray.getDim(leftNumDims) != matchDim)
+    throw ModelicaSimulationError(MODEL_ARRAY_FUNCTION,
+                                  "Wrong sizes in multiply_array");
+  vector<size_t> dims;
+  if (leftNumDims == 1 && rightNumDims == 2)
+    dims.push_back(rightArray.getDim(2));
+  else if (leftNumDims == 2 && rightNumDims == 1)
+    dims.push_back(leftArray.getDim(1));
+  else if (leftNumDims == 2 && rightNumDims == 2) {
+    dims.push_back(leftArray.getDim(1));
+    dims.push_back(rightArray.getDim(2));
+  }
   else
     throw ModelicaSimulationError(MODEL_ARRAY_FUNCTION,
                                   "Unsupported dimensions in multiply_array");
+  resultArray.setDims(dims);
+
+  if ((leftNumDims == 2 && leftArray.isRefArray()) ||
+      (rightNumDims == 2 && rightArray.isRefArray()) ||
+      (dims.size() == 2 && resultArray.isRefArray())) {
+    multiply_ref_array(leftArray, rightArray, resultArray);
+    return;
+  }
+
+  // one-dimensional reference arrays return a copy of their data,
+  // all others their column-major storage
+  const T* left = leftArray.getData();
+  const T* right = rightArray.getData();
+  size_t nelems = resultArray.getNumElems();
+  T* result = NULL;
+  T* tmp = NULL;
+  if (resultArray.isRefArray())
+    result = tmp = new T[nelems];
+  else {
+    result = resultArray.getData();
+    if (result == left || result == right)
+      result = tmp = new T[nelems];
+  }
+
+  if (leftNumDims == 1)
+    multiply_vector_matrix(left, right, result, matchDim, dims[0]);
+  else if (rightNumDims == 1)
+    multiply_matrix_vector(left, right, result, dims[0], matchDim);
+  else
+    multiply_matrix_matrix(left, right, result, dims[0], matchDim, dims[1]);
+
+  if (tmp != NULL) {
+    resultArray.assign(tmp);
+    delete [] tmp;
+  }
 }
 
 template <typename T>
@@ -303,11 +450,9 @@ template <typename T>
 void usub_array(const BaseArray<T>& a, BaseArray<T>& b)
 {
   b.setDims(a.getDims());
-  size_t numEle =  a.getNumElems();
-  for (size_t i = 1; i <= numEle; i++)
-  {
-    b(i) = -a(i);
-  }
+  const T* data = a.getData();
+  T* aim = b.getData();
+  std::transform(data, data + a.getNumElems(), aim, std::negate<T>());
 }
 
 template <typename T>
@@ -361,7 +506,7 @@ void convertBoolToInt(const BaseArray<bool>& a, BaseArray<int>& b)
   int numEle = a.getNumElems();
   const bool* source_data = a.getData();
   int* dest_data = b.getData();
-  for (int i = 0; (numEle > 0) && (i <= numEle); i++)
+  for (int i = 0; i < numEle; i++)
   {
     if(source_data[i])
       dest_data[i]=1;
@@ -374,16 +519,14 @@ void convertIntToBool(const BaseArray<int>& a, BaseArray<bool>& b)
 {
   b.setDims(a.getDims());
   int numEle = a.getNumElems();
-  for (int i = 0; i <= numEle; i++)
+  const int* source_data = a.getData();
+  bool* dest_data = b.getData();
+  for (int i = 0; i < numEle; i++)
   {
-    if (a(i))
-    {
-      b(i) = true;
-    }
+    if (source_data[i])
+      dest_data[i] = true;
     else
-    {
-      b(i) = false;
-    }
+      dest_data[i] = false;
   }
 }
 
@@ -1,54 +1,112 @@
 #include <Core/ModelicaDefine.h>
  #include <Core/Modelica.h>
-#include <Core/Math/matrix_t.h>
+#include <Core/Math/SparseMatrix.h>
 #ifdef USE_UMFPACK
 #include "umfpack.h"
 #endif
 
-#ifdef USE_UMFPACK
+static bool sparse_entry_less(const sparse_inserter::entry& a, const sparse_inserter::entry& b)
+{
+    return a.j < b.j || (a.j == b.j && a.i < b.i);
+}
+
+sparse_matrix::sparse_matrix(int n)
+    : n(n)
+    , _symbolic(NULL)
+    , _numeric(NULL)
+{
+}
+
+sparse_matrix::~sparse_matrix()
+{
+    freeFactorization(true);
+}
+
 void sparse_matrix::build(sparse_inserter& ins) {
-        if(n==-1) {
-            n=ins.content.rbegin()->first.first+1;
-        } else {
-            if(n-1!=ins.content.rbegin()->first.first) {
-                throw ModelicaSimulationError(MATH_FUNCTION,"size doesn't match");
-            }
-        }
-        size_t n=ins.content.size();
-        Ap.assign(this->n+1,0);
-        Ai.resize(n);
-        Ax.resize(n);
-        unsigned int j=0;
-        int rowold=1;
-        for(map< pair<int,int>, double>::iterator it=ins.content.begin(); it!=ins.content.end(); it++) {
-            if(it->first.first+1==rowold) {
-                ++Ap[rowold];
-            } else {
-                Ap[it->first.first+1]=Ap[rowold]+1;
-                rowold=it->first.first+1;
-            }
-            Ai[j]=it->first.second;
-            Ax[j]=it->second;
-            ++j;
+    int maxIndex = -1;
+    for(std::vector<sparse_inserter::entry>::const_iterator it=ins.content.begin(); it!=ins.content.end(); ++it) {
+        maxIndex = std::max(maxIndex, std::max(it->i, it->j));
+    }
+    if(n==-1) {
+        n=maxIndex+1;
+    } else if(maxIndex>=n) {
+        throw ModelicaSimulationError(MATH_FUNCTION,"size doesn't match");
+    }
+
+    // a stable sort keeps repeated assignments of one entry in order, the last one is used
+    std::stable_sort(ins.content.begin(), ins.content.end(), sparse_entry_less);
+
+    std::vector<int> oldAp, oldAi;
+    oldAp.swap(Ap);
+    oldAi.swap(Ai);
+    Ap.assign(n+1,0);
+    Ai.clear();
+    Ax.clear();
+    for(size_t k=0; k<ins.content.size(); ++k) {
+        const sparse_inserter::entry& e = ins.content[k];
+        if(k+1<ins.content.size() && ins.content[k+1].i==e.i && ins.content[k+1].j==e.j)
+            continue;
+        ++Ap[e.j+1];
+        Ai.push_back(e.i);
+        Ax.push_back(e.value);
+    }
+    for(int j=0; j<n; ++j)
+        Ap[j+1] += Ap[j];
+
+    freeFactorization(Ap!=oldAp || Ai!=oldAi);
+}
+
+void sparse_matrix::setPattern(int n, const int* colPtr, const int* rowIndex) {
+    this->n = n;
+    Ap.assign(colPtr, colPtr+n+1);
+    Ai.assign(rowIndex, rowIndex+Ap[n]);
+    Ax.assign(Ap[n], 0.0);
+    freeFactorization(true);
+}
+
+#ifdef USE_UMFPACK
+void sparse_matrix::freeFactorization(bool structureChanged) {
+    if(_numeric)
+        umfpack_di_free_numeric(&_numeric);
+    _numeric = NULL;
+    if(structureChanged && _symbolic) {
+        umfpack_di_free_symbolic(&_symbolic);
+        _symbolic = NULL;
+    }
+}
+
+int sparse_matrix::factorize() {
+    int status;
+    if(n<=0 || Ax.empty())
+        return UMFPACK_ERROR_n_nonpositive;
+
+    freeFactorization(false);
+    if(!_symbolic) {
+        status = umfpack_di_symbolic (n, n, &Ap[0], &Ai[0], &Ax[0], &_symbolic, NULL, NULL);
+        if(status!=UMFPACK_OK) {
+            freeFactorization(true);
+            return status;
         }
     }
+    status = umfpack_di_numeric (&Ap[0], &Ai[0], &Ax[0], _symbolic, &_numeric, NULL, NULL);
+    if(status!=UMFPACK_OK)
+        freeFactorization(false);
+    return status;
+}
 
 int sparse_matrix::solve(const double* b, double * x) {
-    int status, sys=0;
-    double Control [UMFPACK_CONTROL], Info [UMFPACK_INFO] ;
-    void *Symbolic, *Numeric ;
-    umfpack_di_defaults (Control) ;
-    status = umfpack_di_symbolic (sparse_matrix::n, sparse_matrix::n, &sparse_matrix::Ap[0], &sparse_matrix::Ai[0], &sparse_matrix::Ax[0], &Symbolic, Control, Info) ;
-    status = umfpack_di_numeric (&sparse_matrix::Ap[0], &sparse_matrix::Ai[0], &sparse_matrix::Ax[0], Symbolic, &Numeric, Control, Info);
-    status = umfpack_di_solve (sys, &sparse_matrix::Ap[0], &sparse_matrix::Ai[0], &sparse_matrix::Ax[0], x, b, Numeric, Control, Info);
-    umfpack_di_free_symbolic (&Symbolic);
-    umfpack_di_free_numeric (&Numeric);
-    return status;
+    int status;
+    if(!_numeric && (status = factorize())!=UMFPACK_OK)
+        return status;
+    return umfpack_di_solve (UMFPACK_A, &Ap[0], &Ai[0], &Ax[0], x, b, _numeric, NULL, NULL);
 }
 #else
-void sparse_matrix::build(sparse_inserter& ins) {
+void sparse_matrix::freeFactorization(bool structureChanged) {
+}
+
+int sparse_matrix::factorize() {
         throw ModelicaSimulationError(MATH_FUNCTION,"no umfpack");
-    }
+}
 
 int sparse_matrix::solve(const double* b, double * x) {
         throw ModelicaSimulationError(MATH_FUNCTION,"no umfpack");
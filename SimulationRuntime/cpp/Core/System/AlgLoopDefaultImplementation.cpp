@@ -56,6 +56,76 @@ void AlgLoopDefaultImplementation::writeOutput(const OUTPUT command )
 {
 };
 
+bool AlgLoopDefaultImplementation::getSparsityPattern(const int*& colPtr, const int*& rowIndex, const int*& colorPtr, const int*& colorCols, int& numColors)
+{
+  if(_dimAEq == 0 || (int)_sparseColPtr.size() != _dimAEq + 1 || (int)_colorCols.size() != _dimAEq)
+    return false;
+  colPtr = &_sparseColPtr[0];
+  rowIndex = _sparseRowIndex.empty() ? NULL : &_sparseRowIndex[0];
+  colorPtr = &_colorPtr[0];
+  colorCols = &_colorCols[0];
+  numColors = _colorPtr.size() - 1;
+  return true;
+}
+
+void AlgLoopDefaultImplementation::setSparsityPattern(const int* columnNonZeros, const int* rowIndex)
+{
+  int n = _dimAEq;
+
+  _sparseColPtr.assign(n + 1, 0);
+  for(int j = 0; j < n; ++j)
+    _sparseColPtr[j+1] = _sparseColPtr[j] + columnNonZeros[j];
+  _sparseRowIndex.assign(rowIndex, rowIndex + _sparseColPtr[n]);
+
+  // transposed pattern: columns that have a nonzero in a row
+  std::vector<int> rowPtr(n + 1, 0), rowCols(_sparseRowIndex.size());
+  for(size_t k = 0; k < _sparseRowIndex.size(); ++k)
+  {
+    if(_sparseRowIndex[k] < 0 || _sparseRowIndex[k] >= n)
+    {
+      _sparseColPtr.clear();
+      _sparseRowIndex.clear();
+      throw ModelicaSimulationError(ALGLOOP_EQ_SYSTEM,"AlgLoop::setSparsityPattern(): Row index out of range.");
+    }
+    rowPtr[_sparseRowIndex[k] + 1]++;
+  }
+  for(int i = 0; i < n; ++i)
+    rowPtr[i+1] += rowPtr[i];
+  std::vector<int> fill(rowPtr.begin(), rowPtr.end() - 1);
+  for(int j = 0; j < n; ++j)
+    for(int k = _sparseColPtr[j]; k < _sparseColPtr[j+1]; ++k)
+      rowCols[fill[_sparseRowIndex[k]]++] = j;
+
+  // greedy coloring: a column gets the smallest color not used by a column sharing a row with it
+  std::vector<int> color(n, -1), forbidden(n + 1, -1);
+  int numColors = 0;
+  for(int j = 0; j < n; ++j)
+  {
+    for(int k = _sparseColPtr[j]; k < _sparseColPtr[j+1]; ++k)
+    {
+      int row = _sparseRowIndex[k];
+      for(int l = rowPtr[row]; l < rowPtr[row+1]; ++l)
+        if(color[rowCols[l]] >= 0)
+          forbidden[color[rowCols[l]]] = j;
+    }
+    int c = 0;
+    while(forbidden[c] == j)
+      ++c;
+    color[j] = c;
+    numColors = std::max(numColors, c + 1);
+  }
+
+  _colorPtr.assign(numColors + 1, 0);
+  for(int j = 0; j < n; ++j)
+    _colorPtr[color[j] + 1]++;
+  for(int c = 0; c < numColors; ++c)
+    _colorPtr[c+1] += _colorPtr[c];
+  _colorCols.resize(n);
+  fill.assign(_colorPtr.begin(), _colorPtr.end() - 1);
+  for(int j = 0; j < n; ++j)
+    _colorCols[fill[color[j]]++] = j;
+}
+
 //in algloop default verschieben
 void AlgLoopDefaultImplementation::setReal(const double* lambda)
 {
@@ -95,6 +95,8 @@ public:
   virtual size_t getNumDims() const = 0;
   virtual void setDims(const std::vector<size_t>& v) = 0;
   virtual void resize(const std::vector<size_t>& dims) = 0;
+  // contiguous data in column-major order; reference arrays return a copy
+  // in the order of their references, which is row-major for RefArrayDim2
   virtual const T* getData() const = 0;
   virtual T* getData() = 0;
   virtual void getDataCopy(T data[], size_t n) const = 0;
@@ -369,6 +371,15 @@ public:
     return *(RefArray<T, size>::_ref_array[index-1]);
   }
 
+  /**
+   * Index operator to read array element
+   * @param index  index
+   */
+  inline virtual const T& operator()(size_t index) const
+  {
+    return *(RefArray<T, size>::_ref_array[index-1]);
+  }
+
   /**
    * Return sizes of dimensions
    */
@@ -456,6 +467,17 @@ public:
              _ref_array[(i-1)*size2 + (j-1)]);
   }
 
+  /**
+   * Index operator to read array element
+   * @param i  index 1
+   * @param j  index 2
+   */
+  inline virtual const T& operator()(size_t i, size_t j) const
+  {
+    return *(RefArray<T, size1*size2>::
+             _ref_array[(i-1)*size2 + (j-1)]);
+  }
+
   /**
    * Return sizes of dimensions
    */
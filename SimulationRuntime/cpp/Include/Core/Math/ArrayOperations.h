@@ -52,9 +52,94 @@ void promote_array(size_t n, const BaseArray<T>& s, BaseArray<T>& d);
 template <typename T>
 void multiply_array(const BaseArray<T>& inputArray, const T &b, BaseArray<T>& outputArray);
 
+/**
+ * Matrix and vector products; real products with at least
+ * MULTIPLY_ARRAY_BLAS_THRESHOLD (matrix-matrix) or
+ * MULTIPLY_ARRAY_BLAS_THRESHOLD2 (matrix-vector) multiplications use BLAS
+ */
+#define MULTIPLY_ARRAY_BLAS_THRESHOLD (64*64*64)
+#define MULTIPLY_ARRAY_BLAS_THRESHOLD2 (256*256)
+
 template <typename T>
 void multiply_array(const BaseArray<T> &leftArray, const BaseArray<T> &rightArray, BaseArray<T> &resultArray);
 
+/**
+ * Matrix product of static arrays.
+ * The sizes are template parameters, so small products are unrolled by the
+ * compiler; large or aliased products take the BaseArray version.
+ */
+template <typename T, size_t m, size_t n, size_t p, bool e1, bool e2, bool e3>
+void multiply_array(const StatArrayDim2<T, m, n, e1> &leftArray,
+                    const StatArrayDim2<T, n, p, e2> &rightArray,
+                    StatArrayDim2<T, m, p, e3> &resultArray)
+{
+  const T* A = leftArray.getData();
+  const T* B = rightArray.getData();
+  T* C = resultArray.getData();
+  if (m*n*p >= MULTIPLY_ARRAY_BLAS_THRESHOLD || C == A || C == B) {
+    multiply_array<T>(static_cast<const BaseArray<T>&>(leftArray),
+                      static_cast<const BaseArray<T>&>(rightArray),
+                      static_cast<BaseArray<T>&>(resultArray));
+    return;
+  }
+  for (size_t j = 0; j < p; j++) {
+    for (size_t i = 0; i < m; i++)
+      C[i + m*j] = T();
+    for (size_t k = 0; k < n; k++)
+      for (size_t i = 0; i < m; i++)
+        C[i + m*j] += A[i + m*k] * B[k + n*j];
+  }
+}
+
+/**
+ * Static matrix times static vector, see above
+ */
+template <typename T, size_t m, size_t n, bool e1, bool e2, bool e3>
+void multiply_array(const StatArrayDim2<T, m, n, e1> &leftArray,
+                    const StatArrayDim1<T, n, e2> &rightArray,
+                    StatArrayDim1<T, m, e3> &resultArray)
+{
+  const T* A = leftArray.getData();
+  const T* x = rightArray.getData();
+  T* y = resultArray.getData();
+  if (m*n >= MULTIPLY_ARRAY_BLAS_THRESHOLD2 || y == x) {
+    multiply_array<T>(static_cast<const BaseArray<T>&>(leftArray),
+                      static_cast<const BaseArray<T>&>(rightArray),
+                      static_cast<BaseArray<T>&>(resultArray));
+    return;
+  }
+  for (size_t i = 0; i < m; i++)
+    y[i] = T();
+  for (size_t k = 0; k < n; k++)
+    for (size_t i = 0; i < m; i++)
+      y[i] += A[i + m*k] * x[k];
+}
+
+/**
+ * Static vector times static matrix, see above
+ */
+template <typename T, size_t n, size_t p, bool e1, bool e2, bool e3>
+void multiply_array(const StatArrayDim1<T, n, e1> &leftArray,
+                    const StatArrayDim2<T, n, p, e2> &rightArray,
+                    StatArrayDim1<T, p, e3> &resultArray)
+{
+  const T* x = leftArray.getData();
+  const T* B = rightArray.getData();
+  T* y = resultArray.getData();
+  if (n*p >= MULTIPLY_ARRAY_BLAS_THRESHOLD2 || y == x) {
+    multiply_array<T>(static_cast<const BaseArray<T>&>(leftArray),
+                      static_cast<const BaseArray<T>&>(rightArray),
+                      static_cast<BaseArray<T>&>(resultArray));
+    return;
+  }
+  for (size_t j = 0; j < p; j++) {
+    T val = T();
+    for (size_t k = 0; k < n; k++)
+      val += x[k] * B[k + n*j];
+    y[j] = val;
+  }
+}
+
 template <typename T>
 void divide_array(const BaseArray<T>& inputArray, const T &b, BaseArray<T>& outputArray);
 
@@ -190,4 +190,20 @@ extern "C" void SGESVD(char *JOBU, char *JOBVT, long int *M,  long int *N, doubl
 ********************************/
 
 extern "C" void DGGEV(char *JOBVL, char *JOBVR,  long int *N, double* A, long int* LDA, double *B, long int *LDB, double *ALPHAR, double *ALPHAI, double *BETA, double* VL, long int* LDVL, double *VR, long int* LDVR, double* WORK, long int* LWORK, long int *INFO);
+
+
+
+/********************************
+*  DGEMM performs one of the matrix-matrix operations
+*     C := alpha*op( A )*op( B ) + beta*C,
+*  where op( X ) is one of op( X ) = X or op( X ) = X**T.
+*
+*  DGEMV performs one of the matrix-vector operations
+*     y := alpha*A*x + beta*y  or  y := alpha*A**T*x + beta*y.
+*
+*  Both are BLAS routines, all matrices are stored column-major.
+********************************/
+
+extern "C" void dgemm_(char *TRANSA, char *TRANSB, long int *M, long int *N, long int *K, double *ALPHA, double *A, long int *LDA, double *B, long int *LDB, double *BETA, double *C, long int *LDC);
+extern "C" void dgemv_(char *TRANS, long int *M, long int *N, double *ALPHA, double *A, long int *LDA, double *X, long int *INCX, double *BETA, double *Y, long int *INCY);
 /** @} */ // end of math
\ No newline at end of file
@@ -1,25 +1,33 @@
 #pragma once
 
-
-using std::map;
-using std::pair;
-using std::make_pair;
+/// Minimal dimension of an algebraic loop for which the nonlinear solvers switch to the sparse LU factorization
+#define SPARSE_MATRIX_MIN_DIM 100
+/// Maximal density (nonzeros / dim^2) of the Jacobian for which the sparse LU factorization is used
+#define SPARSE_MATRIX_MAX_DENSITY 0.2
 
 struct BOOST_EXTENSION_EXPORT_DECL sparse_inserter  {
+    /// Entry A(i,j) = value, i is the row and j the column (zero based)
+    struct entry {
+        int i;
+        int j;
+        double value;
+    };
+
     struct t2 {
         int i;
         int j;
-        map< pair<int,int>, double> & content;
-        t2(int i, int j, map< pair<int,int>, double> & c): i(i), j(j), content(c) {}
+        std::vector<entry> & content;
+        t2(int i, int j, std::vector<entry> & c): i(i), j(j), content(c) {}
         inline void operator=(double t) {
-            content[make_pair(j,i)]=t;
+            entry e = {i, j, t};
+            content.push_back(e);
         }
     };
 
     struct t1 {
         int i;
-        map< pair<int,int>, double> & content;
-        t1(int i,map< pair<int,int>, double> & c): i(i), content(c) {}
+        std::vector<entry> & content;
+        t1(int i,std::vector<entry> & c): i(i), content(c) {}
         inline t2 operator[](size_t j) {
             t2 res(i,j,content);
             return res;
@@ -27,7 +35,8 @@ struct BOOST_EXTENSION_EXPORT_DECL sparse_inserter  {
     };
 
 
-    map< pair<int,int>, double> content;
+    /// Entries in the order of assignment, sorted only once by sparse_matrix::build
+    std::vector<entry> content;
     inline t1 operator[](size_t i) {
         t1 res(i,content);
         return res;
@@ -41,14 +50,37 @@ struct BOOST_EXTENSION_EXPORT_DECL sparse_inserter  {
 
 };
 
+/**
+ * Square matrix in compressed column format with a LU factorization by UmfPack.
+ *
+ * The structure (Ap, Ai) is fixed either by build() or by setPattern(). Afterwards
+ * the values in Ax can be assembled directly; factorize() then only repeats the
+ * numeric factorization, the symbolic analysis of the structure is done once.
+ */
 struct BOOST_EXTENSION_EXPORT_DECL sparse_matrix {
     std::vector<int> Ap;
     std::vector<int> Ai;
     std::vector<double> Ax;
     int n;
-    sparse_matrix(int n=-1): n(n) {}
+    sparse_matrix(int n=-1);
+    ~sparse_matrix();
 
+    /// Build structure and values from the collected entries, a later assignment to an entry wins
     void build(sparse_inserter& ins);
+    /// Fix the structure: column j has nonzeros in the rows rowIndex[colPtr[j]] ... rowIndex[colPtr[j+1]-1]
+    void setPattern(int n, const int* colPtr, const int* rowIndex);
+    /// LU factorization of the current values in Ax, returns 0 on success
+    int factorize();
+    /// Solve A*x = b with the last factorization (factorizes first if there is none), returns 0 on success
     int solve(const double* b,double* x);
-};
 
+private:
+    sparse_matrix(const sparse_matrix&);
+    sparse_matrix& operator=(const sparse_matrix&);
+
+    /// Drop the numeric factorization and, if the structure changed, the symbolic analysis
+    void freeFactorization(bool structureChanged);
+
+    void* _symbolic;
+    void* _numeric;
+};
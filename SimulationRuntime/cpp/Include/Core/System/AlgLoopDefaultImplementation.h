@@ -67,6 +67,13 @@ public:
   /// Output routine (to be called by the solver after every successful integration step)
   void writeOutput(const OUTPUT command = UNDEF_OUTPUT);
 
+  /// Provide the sparsity pattern of the Jacobian and the coloring of its columns (see IAlgLoop)
+  bool getSparsityPattern(const int*& colPtr, const int*& rowIndex, const int*& colorPtr, const int*& colorCols, int& numColors);
+
+  /// Set the sparsity pattern of the Jacobian in compressed column format (number of nonzeros per column and
+  /// their zero based row indices) and compute a coloring of the columns
+  void setSparsityPattern(const int* columnNonZeros, const int* rowIndex);
+
   //void setDim(const int dim);
 
   /// Set stream for output
@@ -83,5 +90,11 @@ protected:
   IAlgLoop::CONSTRTYPE
     _constraintType;                ///< Typ der Bindungsgleichungen (analog, digital, binär)
 
+  std::vector<int>
+    _sparseColPtr,                  ///< Start of every column in _sparseRowIndex (_dimAEq+1 entries), empty if no pattern is known
+    _sparseRowIndex,                ///< Row indices of the nonzeros of the Jacobian
+    _colorPtr,                      ///< Start of every color in _colorCols
+    _colorCols;                     ///< Columns of the Jacobian sorted by color
+
 };
 /** @} */ // end of coreSystem
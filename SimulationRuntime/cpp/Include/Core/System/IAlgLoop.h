@@ -64,6 +64,12 @@ public:
   virtual void setUseSparseFormat(bool value) = 0;
   virtual float queryDensity() = 0;
 
+  /// Provide the sparsity pattern of the Jacobian d(residuals)/d(variables) together with a coloring of its columns.
+  /// Column j has nonzeros in the rows rowIndex[colPtr[j]] ... rowIndex[colPtr[j+1]-1]; the columns of color c
+  /// are colorCols[colorPtr[c]] ... colorCols[colorPtr[c+1]-1]. Columns of one color share no row, so they can be
+  /// perturbed together. Returns false if no pattern is known, then the Jacobian has to be treated as dense.
+  virtual bool getSparsityPattern(const int*& colPtr, const int*& rowIndex, const int*& colorPtr, const int*& colorCols, int& numColors) = 0;
+
   /*/// Fügt das übergebene Objekt als Across-Kante hinzu
   void addAcrossEdge(IObject& new_obj);
 
@@ -42,6 +42,8 @@ private:
     void extrapolateVars();
     /// Encapsulation of determination of Jacobian
     void calcJacobian(double* jac);
+    /// Finite difference step for the j-th unknown
+    double calcStepSize(int j);
     static void fcn(const int *n, const double *x, double *fvec, double *fjac, const int *ldfjac, int *iflag,void* userdata);
 
     // Member variables
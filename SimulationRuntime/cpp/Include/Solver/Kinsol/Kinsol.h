@@ -22,6 +22,10 @@
 
 //#include<kinsol_lapack.h>
  int kin_fCallback(N_Vector y, N_Vector fval, void *user_data);
+ int kin_DlsDenseJacCallback(long int N, N_Vector u, N_Vector fu, DlsMat J, void *user_data, N_Vector tmp1, N_Vector tmp2);
+ int kin_PrecSetupCallback(N_Vector u, N_Vector uscale, N_Vector fu, N_Vector fscale, void *user_data, N_Vector tmp1, N_Vector tmp2);
+ int kin_PrecSolveCallback(N_Vector u, N_Vector uscale, N_Vector fu, N_Vector fscale, N_Vector v, void *user_data, N_Vector tmp);
+ struct sparse_matrix;
 class Kinsol : public IAlgLoopSolver
 {
 public:
@@ -38,7 +42,17 @@ public:
   virtual ITERATIONSTATUS getIterationStatus();
   virtual void stepCompleted(double time);
   int kin_f(N_Vector y, N_Vector fval, void *user_data);
+  /// Dense Jacobian by colored finite differences, used if the algebraic loop provides a sparsity pattern
+  int kin_DlsDenseJac(long int N, N_Vector u, N_Vector fu, DlsMat J);
+  /// Sparse LU factorization of the colored finite difference Jacobian, used as preconditioner for large sparse systems
+  int kin_PrecSetup(N_Vector u, N_Vector fu);
+  /// Solve with the sparse LU factorization, v is overwritten by the solution
+  int kin_PrecSolve(N_Vector v);
 private:
+  /// Colored finite differences into the dense matrix J or, if values is given, into the compressed column values
+  int calcJacobianColored(const double* y, const double* f, DlsMat J, double* values);
+  /// Attach the Krylov solver with the sparse LU preconditioner
+  void setSparseLinSolver();
   /// Encapsulation of determination of residuals to given unknowns
   void calcFunction(const double* y, double* residual);
 
@@ -104,5 +118,11 @@ private:
     _currentIterateNorm;
 
    int _counter;
+
+  sparse_matrix
+    *_sparseJac;         ///< Temp   - Jacobian of large sparse systems, NULL for the dense solvers
+
+  bool
+    _sparseLinSolverSet; ///< Temp   - Preconditioned sparse linear solver currently attached to _kinMem
 };
 /** @} */ // end of solverKinsol
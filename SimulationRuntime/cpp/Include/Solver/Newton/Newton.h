@@ -45,6 +45,8 @@ where A is an n-by-n matrix and y and B are n-by-n(right hand side) matrices.
 /*****************************************************************************
 OSMS(c) 2008
 *****************************************************************************/
+struct sparse_matrix;
+
 class Newton : public IAlgLoopSolver
 {
 public:
@@ -67,9 +69,12 @@ private:
     /// Encapsulation of determination of residuals to given unknowns
     void calcFunction(const double* y, double* residual);
 
-    /// Encapsulation of determination of Jacobian
+    /// Encapsulation of determination of Jacobian (one residual evaluation per column color if the sparsity pattern is known)
     void calcJacobian();
 
+    /// Finite difference step for the j-th unknown
+    double calcStepSize(int j);
+
 
     // Member variables
     //---------------------------------------------------------------
@@ -93,8 +98,11 @@ private:
         *_f,                        ///< Temp        - Residuals
         *_yHelp,                    ///< Temp        - Auxillary variables
         *_fHelp,                    ///< Temp        - Auxillary variables
+        *_yNominal,                 ///< Temp        - Nominal values of unknowns
         *_jac,                        ///< Temp        - Jacobian
         * _zeroVec;
   long int *_iHelp;
+  sparse_matrix
+        *_sparseJac;                ///< Temp        - Jacobian of large sparse systems (same structure as the sparsity pattern of the algebraic loop)
 };
 /** @} */ // end of solverNewton
@@ -444,22 +444,57 @@ void  Hybrj::extrapolateVars()
 
 void Hybrj::calcJacobian(double *fjac)
 {
-	for(int j=0; j<_dimSys; ++j)
+	const int *colPtr, *rowIndex, *colorPtr, *colorCols;
+	int numColors;
+
+	if(_algLoop->getSparsityPattern(colPtr, rowIndex, colorPtr, colorCols, numColors))
+	{
+		// Entries outside of the pattern are zero, hybrj overwrites fjac with the QR factors
+		std::fill_n(fjac,_dimSys*_dimSys,0.0);
+		memcpy(_xHelp,_x,_dimSys*sizeof(double));
+
+		// Columns of one color share no row and are perturbed together
+		for(int c=0; c<numColors; ++c)
+		{
+			for(int k=colorPtr[c]; k<colorPtr[c+1]; ++k)
+				_xHelp[colorCols[k]] += calcStepSize(colorCols[k]);
+
+			calcFunction(_xHelp,_fHelp);
+
+			for(int k=colorPtr[c]; k<colorPtr[c+1]; ++k)
+			{
+				int j = colorCols[k];
+				double delta = _xHelp[j] - _x[j];
+				for(int l=colPtr[j]; l<colPtr[j+1]; ++l)
+					fjac[rowIndex[l]+j*_dimSys] = (_fHelp[rowIndex[l]] - _f[rowIndex[l]]) /delta;
+				_xHelp[j] = _x[j];
+			}
+		}
+	}
+	else
 	{
-		// Reset variables for every column
 		memcpy(_xHelp,_x,_dimSys*sizeof(double));
+		for(int j=0; j<_dimSys; ++j)
+		{
+			// Finite difference
+			_xHelp[j] += calcStepSize(j);
+			double delta = _xHelp[j] - _x[j];
 
-		// Finite difference
-		double delta =sqrt(UROUND*std::max(1e-5,std::abs(_x[j])));
-		_xHelp[j] +=delta;
+			calcFunction(_xHelp,_fHelp);
 
-		calcFunction(_xHelp,_fHelp);
+			// Build Jacobian in Fortran format
+			for(int i=0; i<_dimSys; ++i)
+				fjac[i+j*_dimSys] = (_fHelp[i] - _f[i]) /delta;
 
-		// Build Jacobian in Fortran format
-		for(int i=0; i<_dimSys; ++i)
-			fjac[i+j*_dimSys] = (_fHelp[i] - _f[i]) /delta;
+			_xHelp[j] = _x[j];
+		}
 	}
+}
 
+double Hybrj::calcStepSize(int j)
+{
+	// Step relative to the magnitude of the variable or its nominal value
+	return sqrt(UROUND)*std::max(std::max(std::abs(_x[j]),std::abs(_x_nom[j])),1e-8);
 }
 
 void Hybrj::fcn(const int *n, const double *x, double *fvec, double *fjac, const int *ldfjac, int *iflag, void* userdata)
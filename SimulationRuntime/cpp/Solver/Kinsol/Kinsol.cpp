@@ -7,6 +7,8 @@
 
 #include <Solver/Kinsol/Kinsol.h>
 #include <Solver/Kinsol/KinsolSettings.h>
+#include <Core/Math/Constants.h>        // definition of constants like uround
+#include <Core/Math/SparseMatrix.h>     // sparse LU factorization of large Jacobians
 
 //#include <Core/Utils/numeric/bindings/lapack/driver/gesv.hpp>
 #include <Core/Utils/numeric/bindings/ublas/matrix.hpp>
@@ -37,6 +39,24 @@ int kin_fCallback(N_Vector y,N_Vector fval, void *user_data)
 	return  myKinsol->kin_f(y,fval,user_data);
 }
 
+int kin_DlsDenseJacCallback(long int N, N_Vector u, N_Vector fu, DlsMat J, void *user_data, N_Vector tmp1, N_Vector tmp2)
+{
+	Kinsol* myKinsol =  (Kinsol*)(user_data);
+	return  myKinsol->kin_DlsDenseJac(N, u, fu, J);
+}
+
+int kin_PrecSetupCallback(N_Vector u, N_Vector uscale, N_Vector fu, N_Vector fscale, void *user_data, N_Vector tmp1, N_Vector tmp2)
+{
+	Kinsol* myKinsol =  (Kinsol*)(user_data);
+	return  myKinsol->kin_PrecSetup(u, fu);
+}
+
+int kin_PrecSolveCallback(N_Vector u, N_Vector uscale, N_Vector fu, N_Vector fscale, N_Vector v, void *user_data, N_Vector tmp)
+{
+	Kinsol* myKinsol =  (Kinsol*)(user_data);
+	return  myKinsol->kin_PrecSolve(v);
+}
+
 
 Kinsol::Kinsol(IAlgLoop* algLoop, INonLinSolverSettings* settings)
 	: _algLoop            (algLoop)
@@ -52,6 +72,8 @@ Kinsol::Kinsol(IAlgLoop* algLoop, INonLinSolverSettings* settings)
 	, _zeroVec            (NULL)
 	, _currentIterate     (NULL)
 	, _jac                (NULL)
+	, _sparseJac          (NULL)
+	, _sparseLinSolverSet (false)
 	, _fHelp              (NULL)
 	, _yHelp              (NULL)
 	, _dimSys             (0)
@@ -82,6 +104,7 @@ Kinsol::~Kinsol()
 	if(_ihelpArray)       delete []  _ihelpArray;
 	if (_jhelpArray)       delete[]  _jhelpArray;
 	if(_jac)              delete []  _jac;
+	if(_sparseJac)        delete     _sparseJac;
 	if(_fHelp)            delete []  _fHelp;
 	if(_zeroVec)          delete []  _zeroVec;
 	if(_currentIterate)   delete []  _currentIterate;
@@ -189,12 +212,40 @@ void Kinsol::initialize()
 			if (check_flag(&idid, (char *)"KINSetUserData", 1))
 				throw ModelicaSimulationError(ALGLOOP_SOLVER,"Kinsol::initialize()");
 
+			const int *colPtr, *rowIndex, *colorPtr, *colorCols;
+			int numColors;
+			bool hasPattern = _algLoop->getSparsityPattern(colPtr, rowIndex, colorPtr, colorCols, numColors);
+
+			if(_sparseJac) delete _sparseJac;
+			_sparseJac = NULL;
+#ifdef USE_UMFPACK
+			// Large algebraic loops with a sparse Jacobian: Krylov iteration preconditioned
+			// with the sparse LU factorization of the finite difference Jacobian
+			if(hasPattern && _dimSys >= SPARSE_MATRIX_MIN_DIM && colPtr[_dimSys] <= SPARSE_MATRIX_MAX_DENSITY*_dimSys*_dimSys)
+			{
+				_sparseJac = new sparse_matrix();
+				_sparseJac->setPattern(_dimSys, colPtr, rowIndex);
+				setSparseLinSolver();
+				Logger::write("Kinsol: using sparse LU factorization",LC_NLS,LL_DEBUG);
+			}
+			else
+#endif
+			{
 #ifdef USE_SUNDIALS_LAPACK
-			KINLapackDense(_kinMem, _dimSys);
+				KINLapackDense(_kinMem, _dimSys);
 #else
-			KINDense(_kinMem, _dimSys);
+				KINDense(_kinMem, _dimSys);
 #endif //USE_SUNDIALS_LAPACK
 
+				// Colored finite differences instead of one residual evaluation per column
+				if(hasPattern)
+				{
+					idid = KINDlsSetDenseJacFn(_kinMem, kin_DlsDenseJacCallback);
+					if (check_flag(&idid, (char *)"KINDlsSetDenseJacFn", 1))
+						throw ModelicaSimulationError(ALGLOOP_SOLVER,"Kinsol::initialize()");
+				}
+			}
+
 			idid = KINSetErrFile(_kinMem, NULL);
 			idid = KINSetNumMaxIters(_kinMem, 1000);
 			//idid = KINSetEtaForm(_kinMem, KIN_ETACHOICE2);
@@ -306,6 +357,10 @@ void Kinsol::solve()
 		_counter++;
 		_eventRetry = false;
 
+		// Reattach the preconditioned solver if a previous fallback has replaced it
+		if(_sparseJac && !_sparseLinSolverSet)
+			setSparseLinSolver();
+
 		// Try Dense first
 		////////////////////////////
 		for(int i=0;i<_dimSys;i++) // Reset Scaling
@@ -341,6 +396,7 @@ void Kinsol::solve()
 		_fScale[i] = 1.0;
 
 		KINSpgmr(_kinMem,_dimSys);
+		_sparseLinSolverSet = false;
 		_iterationStatus = CONTINUE;
 		solveNLS();
 
@@ -450,6 +506,86 @@ int Kinsol::kin_f(N_Vector y,N_Vector fval, void *user_data)
 
 
 
+int Kinsol::kin_DlsDenseJac(long int N, N_Vector u, N_Vector fu, DlsMat J)
+{
+	SetToZero(J);
+	return calcJacobianColored(NV_DATA_S(u), NV_DATA_S(fu), J, NULL);
+}
+
+int Kinsol::kin_PrecSetup(N_Vector u, N_Vector fu)
+{
+	int idid = calcJacobianColored(NV_DATA_S(u), NV_DATA_S(fu), NULL, &_sparseJac->Ax[0]);
+	if(idid != 0)
+		return idid;
+	// The structure is fixed, only the numeric factorization is repeated
+	return _sparseJac->factorize() == 0 ? 0 : 1;
+}
+
+int Kinsol::kin_PrecSolve(N_Vector v)
+{
+	if(_sparseJac->solve(NV_DATA_S(v), _fHelp) != 0)
+		return 1;
+	memcpy(NV_DATA_S(v), _fHelp, _dimSys*sizeof(double));
+	return 0;
+}
+
+void Kinsol::setSparseLinSolver()
+{
+	int idid = KINSpgmr(_kinMem, 0);
+	if (check_flag(&idid, (char *)"KINSpgmr", 1))
+		throw ModelicaSimulationError(ALGLOOP_SOLVER,"Kinsol::setSparseLinSolver()");
+	idid = KINSpilsSetPreconditioner(_kinMem, kin_PrecSetupCallback, kin_PrecSolveCallback);
+	if (check_flag(&idid, (char *)"KINSpilsSetPreconditioner", 1))
+		throw ModelicaSimulationError(ALGLOOP_SOLVER,"Kinsol::setSparseLinSolver()");
+	_sparseLinSolverSet = true;
+}
+
+int Kinsol::calcJacobianColored(const double* y, const double* f, DlsMat J, double* values)
+{
+	const int *colPtr, *rowIndex, *colorPtr, *colorCols;
+	int numColors;
+
+	if(!_algLoop->getSparsityPattern(colPtr, rowIndex, colorPtr, colorCols, numColors))
+		return -1;
+
+	memcpy(_yHelp, y, _dimSys*sizeof(double));
+
+	// Columns of one color share no row and are perturbed together
+	for(int c=0; c<numColors; ++c)
+	{
+		for(int k=colorPtr[c]; k<colorPtr[c+1]; ++k)
+		{
+			int j = colorCols[k];
+			// Step relative to the magnitude of the variable or its nominal value
+			_yHelp[j] += sqrt(UROUND)*std::max(std::max(std::abs(y[j]), std::abs(1.0/_yScale[j])), 1e-8);
+		}
+
+		calcFunction(_yHelp, _fHelp);
+		if(!_fValid)
+			return 1;
+
+		for(int k=colorPtr[c]; k<colorPtr[c+1]; ++k)
+		{
+			int j = colorCols[k];
+			double delta = _yHelp[j] - y[j];
+			if(values)
+			{
+				// Compressed column format with the structure of the sparsity pattern
+				for(int l=colPtr[j]; l<colPtr[j+1]; ++l)
+					values[l] = (_fHelp[rowIndex[l]] - f[rowIndex[l]]) / delta;
+			}
+			else
+			{
+				realtype *col = DENSE_COL(J, j);
+				for(int l=colPtr[j]; l<colPtr[j+1]; ++l)
+					col[rowIndex[l]] = (_fHelp[rowIndex[l]] - f[rowIndex[l]]) / delta;
+			}
+			_yHelp[j] = y[j];
+		}
+	}
+	return 0;
+}
+
 void Kinsol::stepCompleted(double time)
 {
 	memcpy(_y0,_y,_dimSys*sizeof(double));
@@ -8,6 +8,7 @@
 
 #include <Core/Math/ILapack.h>        // needed for solution of linear system with Lapack
 #include <Core/Math/Constants.h>        // definitializeion of constants like uround
+#include <Core/Math/SparseMatrix.h>     // sparse LU factorization of large Jacobians
 
 
 Newton::Newton(IAlgLoop* algLoop, INonLinSolverSettings* settings)
@@ -17,8 +18,10 @@ Newton::Newton(IAlgLoop* algLoop, INonLinSolverSettings* settings)
 	, _yHelp            (NULL)
 	, _f                (NULL)
 	, _fHelp            (NULL)
+	, _yNominal         (NULL)
 	,_iHelp        (NULL)
 	, _jac                (NULL)
+	, _sparseJac          (NULL)
 	, _zeroVec            (NULL)
 	, _dimSys            (0)
 	, _firstCall        (true)
@@ -32,8 +35,10 @@ Newton::~Newton()
 	if(_yHelp)    delete []    _yHelp;
 	if(_f)        delete []    _f;
 	if(_fHelp)    delete []    _fHelp;
+	if(_yNominal) delete []    _yNominal;
 	if(_iHelp)    delete []    _iHelp;
 	if(_jac)    delete []    _jac;
+	if(_sparseJac) delete    _sparseJac;
 	if(_zeroVec)  delete []   _zeroVec;
 
 }
@@ -63,6 +68,7 @@ void Newton::initialize()
 			if(_f)        delete []    _f;
 			if(_yHelp)    delete []    _yHelp;
 			if(_fHelp)    delete []    _fHelp;
+			if(_yNominal) delete []    _yNominal;
 			if(_iHelp)    delete []    _iHelp;
 			if(_jac)    delete []    _jac;
 			if(_zeroVec)  delete []   _zeroVec;
@@ -71,17 +77,34 @@ void Newton::initialize()
 			_f            = new double[_dimSys];
 			_yHelp        = new double[_dimSys];
 			_fHelp        = new double[_dimSys];
+			_yNominal     = new double[_dimSys];
 			_iHelp       = new long int[_dimSys];
 			_jac        = new double[_dimSys*_dimSys];
 			_zeroVec        = new double[_dimSys];
 
 
 			_algLoop->getReal(_y);
+			_algLoop->getNominalReal(_yNominal);
 			memset(_f,0,_dimSys*sizeof(double));
 			memset(_yHelp,0,_dimSys*sizeof(double));
 			memset(_fHelp,0,_dimSys*sizeof(double));
 			memset(_jac,0,_dimSys*_dimSys*sizeof(double));
 			memset(_zeroVec,0,_dimSys*sizeof(double));
+
+			if(_sparseJac) delete _sparseJac;
+			_sparseJac = NULL;
+#ifdef USE_UMFPACK
+			// Sparse LU factorization for large algebraic loops with a sparse Jacobian
+			const int *colPtr, *rowIndex, *colorPtr, *colorCols;
+			int numColors;
+			if(_dimSys >= SPARSE_MATRIX_MIN_DIM && _algLoop->getSparsityPattern(colPtr, rowIndex, colorPtr, colorCols, numColors)
+			   && colPtr[_dimSys] <= SPARSE_MATRIX_MAX_DENSITY*_dimSys*_dimSys)
+			{
+				_sparseJac = new sparse_matrix();
+				_sparseJac->setPattern(_dimSys, colPtr, rowIndex);
+				Logger::write("Newton: using sparse LU factorization",LC_NLS,LL_DEBUG);
+			}
+#endif
 		}
 		else
 		{
@@ -208,7 +231,15 @@ void Newton::solve()
 					calcJacobian();
 
 					// Solve linear System
-					dgesv_(&_dimSys,&dimRHS,_jac,&_dimSys,_iHelp,_f,&_dimSys,&irtrn);
+					if(_sparseJac)
+					{
+						irtrn = _sparseJac->factorize();
+						if(irtrn == 0)
+							irtrn = _sparseJac->solve(_f,_fHelp);
+						memcpy(_f,_fHelp,_dimSys*sizeof(double));
+					}
+					else
+						dgesv_(&_dimSys,&dimRHS,_jac,&_dimSys,_iHelp,_f,&_dimSys,&irtrn);
 
 					if(irtrn!=0)
 					{
@@ -253,25 +284,65 @@ void Newton::stepCompleted(double time)
 
 void Newton::calcJacobian()
 {
-	for(int j=0; j<_dimSys; ++j)
+	const int *colPtr, *rowIndex, *colorPtr, *colorCols;
+	int numColors;
+
+	if(_algLoop->getSparsityPattern(colPtr, rowIndex, colorPtr, colorCols, numColors))
 	{
-		// Reset variables for every column
+		// Entries outside of the pattern are zero, dgesv overwrites the whole matrix.
+		// The sparse matrix has the same structure, its values are assembled in place.
+		double* values = _sparseJac ? &_sparseJac->Ax[0] : NULL;
+		if(!values)
+			memset(_jac,0,_dimSys*_dimSys*sizeof(double));
 		memcpy(_yHelp,_y,_dimSys*sizeof(double));
-		double stepsize=1.e-6;//+(1.e-6*_yHelp[j]);
 
+		// Columns of one color share no row and are perturbed together
+		for(int c=0; c<numColors; ++c)
+		{
+			for(int k=colorPtr[c]; k<colorPtr[c+1]; ++k)
+				_yHelp[colorCols[k]] += calcStepSize(colorCols[k]);
+
+			calcFunction(_yHelp,_fHelp);
 
-		// Finitializee difference
-		_yHelp[j] += stepsize;
+			for(int k=colorPtr[c]; k<colorPtr[c+1]; ++k)
+			{
+				int j = colorCols[k];
+				double stepsize = _yHelp[j] - _y[j];
+				if(values)
+					for(int l=colPtr[j]; l<colPtr[j+1]; ++l)
+						values[l] = (_fHelp[rowIndex[l]] - _f[rowIndex[l]]) / stepsize;
+				else
+					for(int l=colPtr[j]; l<colPtr[j+1]; ++l)
+						_jac[rowIndex[l]+j*_dimSys] = (_fHelp[rowIndex[l]] - _f[rowIndex[l]]) / stepsize;
+				_yHelp[j] = _y[j];
+			}
+		}
+	}
+	else
+	{
+		memcpy(_yHelp,_y,_dimSys*sizeof(double));
+		for(int j=0; j<_dimSys; ++j)
+		{
+			// Finitializee difference
+			_yHelp[j] += calcStepSize(j);
+			double stepsize = _yHelp[j] - _y[j];
 
-		calcFunction(_yHelp,_fHelp);
+			calcFunction(_yHelp,_fHelp);
 
-		// Build Jacobian in Fortran format
-		for(int i=0; i<_dimSys; ++i)
-			_jac[i+j*_dimSys] = (_fHelp[i] - _f[i]) / stepsize;
+			// Build Jacobian in Fortran format
+			for(int i=0; i<_dimSys; ++i)
+				_jac[i+j*_dimSys] = (_fHelp[i] - _f[i]) / stepsize;
 
-		_yHelp[j] -=stepsize;
+			_yHelp[j] = _y[j];
+		}
 	}
 }
 
+double Newton::calcStepSize(int j)
+{
+	// Step relative to the magnitude of the variable or its nominal value
+	return sqrt(UROUND) * max(max(fabs(_y[j]), fabs(_yNominal[j])), 1.0e-8);
+}
+
 /** @} */ // end of solverNewton
 
@@ -35,13 +35,20 @@
 #include "simulation/solver/linearSystem.h"
 #include "simulation/solver/mixedSystem.h"
 #include "simulation/solver/delay.h"
+#include "util/ringbuffer.h"
 #include "simulation/simulation_info_xml.h"
 #include "simulation/simulation_input_xml.h"
+#include "simulation/simulation_runtime.h"
+
+#include <math.h>
 /*
 DLLExport pthread_key_t fmu2_thread_data_key;
 */
 
 fmi2Boolean isCategoryLogged(ModelInstance *comp, int categoryIndex);
+static void invalidateDirectionalDerivatives(ModelInstance *comp);
+static void freeDirectionalDerivatives(ModelInstance *comp);
+static fmi2Status csEventIteration(ModelInstance *comp);
 
 static fmi2String logCategoriesNames[] = {"logEvents", "logSingularLinearSystems", "logNonlinearSystems", "logDynamicStateSelection",
     "logStatusWarning", "logStatusDiscard", "logStatusError", "logStatusFatal", "logStatusPending", "logAll", "logFmi2Call"};
@@ -58,9 +65,31 @@ fmi2ValueReference vrStates[NUMBER_OF_STATES] = STATES;
 fmi2ValueReference vrStatesDerivatives[NUMBER_OF_STATES] = STATESDERIVATIVES;
 #endif
 
+// arrays of value references of inputs and outputs
+#if NUMBER_OF_INPUTS>0
+fmi2ValueReference vrInputs[NUMBER_OF_INPUTS] = INPUTS;
+#else
+fmi2ValueReference *vrInputs = NULL;
+#endif
+#if NUMBER_OF_OUTPUTS>0
+fmi2ValueReference vrOutputs[NUMBER_OF_OUTPUTS] = OUTPUTS;
+#else
+fmi2ValueReference *vrOutputs = NULL;
+#endif
+
 // ---------------------------------------------------------------------------
 // Private helpers used below to validate function arguments
 // ---------------------------------------------------------------------------
+/* terminate() in the model equations sets terminationTerminate; the request
+ * is taken over by the instance that evaluated the equations */
+static fmi2Boolean terminateRequested(ModelInstance *comp) {
+  if (!terminationTerminate)
+    return fmi2False;
+  terminationTerminate = 0;
+  FILTERED_LOG(comp, fmi2OK, LOG_EVENTS, "terminate() called at time %g: %s", comp->fmuData->localData[0]->timeValue, TermMsg ? TermMsg : "")
+  return fmi2True;
+}
+
 static fmi2Boolean invalidNumber(ModelInstance *comp, const char *f, const char *arg, int n, int nExpected) {
   if (n != nExpected) {
     comp->state = modelError;
@@ -131,6 +160,7 @@ fmi2Status fmi2EventUpdate(fmi2Component c, fmi2EventInfo* eventInfo)
   if (nullPointer(comp, "fmi2EventUpdate", "eventInfo", eventInfo))
     return fmi2Error;
   eventInfo->valuesOfContinuousStatesChanged = fmi2False;
+  invalidateDirectionalDerivatives(comp);
 
   FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2EventUpdate: Start Event Update! Next Sample Event %g", eventInfo->nextEventTime)
 
@@ -186,6 +216,11 @@ fmi2Status fmi2EventUpdate(fmi2Component c, fmi2EventInfo* eventInfo)
       eventInfo->nominalsOfContinuousStatesChanged = fmi2False;
       eventInfo->terminateSimulation = fmi2False;
     }
+    if (terminateRequested(comp))
+    {
+      eventInfo->newDiscreteStatesNeeded = fmi2False;
+      eventInfo->terminateSimulation = fmi2True;
+    }
     FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2EventUpdate: newDiscreteStatesNeeded %s",eventInfo->newDiscreteStatesNeeded?"true":"false");
 
     /* due to an event overwrite old values */
@@ -353,6 +388,8 @@ void fmi2FreeInstance(fmi2Component c) {
     return;
   FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2FreeInstance")
 
+  freeDirectionalDerivatives(comp);
+  if (comp->_cs_work) comp->functions->freeMemory(comp->_cs_work);
   /* free fmuData */
   comp->functions->freeMemory(comp->fmuData->threadData);
   GC_free(comp->fmuData);
@@ -390,6 +427,7 @@ fmi2Status fmi2EnterInitializationMode(fmi2Component c) {
 
   setStartValues(comp);
   copyStartValuestoInitValues(comp->fmuData);
+  invalidateDirectionalDerivatives(comp);
 
   /* try */
   MMC_TRY_INTERNAL(simulationJumpBuffer)
@@ -409,7 +447,7 @@ fmi2Status fmi2EnterInitializationMode(fmi2Component c) {
       /* due to an event overwrite old values */
       overwriteOldSimulationData(comp->fmuData);
 
-      comp->eventInfo.terminateSimulation = fmi2False;
+      comp->eventInfo.terminateSimulation = terminateRequested(comp);
       comp->eventInfo.valuesOfContinuousStatesChanged = fmi2True;
 
       /* Get next event time (sample calls)*/
@@ -441,6 +479,11 @@ fmi2Status fmi2ExitInitializationMode(fmi2Component c) {
   FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2ExitInitializationMode...")
 
   comp->state = modelEventMode;
+  /* co-simulation continues with the event iteration of model exchange */
+  if (comp->type == fmi2CoSimulation && csEventIteration(comp) != fmi2OK) {
+    FILTERED_LOG(comp, fmi2Error, LOG_FMI2_CALL, "fmi2ExitInitializationMode: failed")
+    return fmi2Error;
+  }
   FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2ExitInitializationMode: succeed")
   return fmi2OK;
 }
@@ -461,6 +504,8 @@ fmi2Status fmi2Terminate(fmi2Component c) {
   freeLinearSystems(comp->fmuData);
   /* free stateset data */
   freeStateSetData(comp->fmuData);
+  /* free jacobian used for directional derivatives */
+  freeDirectionalDerivatives(comp);
 
   /* free data struct */
   deInitializeDataStruc(comp->fmuData);
@@ -487,6 +532,8 @@ fmi2Status fmi2Reset(fmi2Component c) {
   setDefaultStartValues(comp);
   setAllVarsToStart(comp->fmuData);
   setAllParamsToStart(comp->fmuData);
+  invalidateDirectionalDerivatives(comp);
+  comp->_cs_step_size = 0;
 
   comp->state = modelInstantiated;
   return fmi2OK;
@@ -655,33 +702,619 @@ fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[], size_t
   return fmi2OK;
 }
 
+// ---------------------------------------------------------------------------
+// FMU states
+// ---------------------------------------------------------------------------
+// An FMU state is kept in its serialized form: a header followed by the
+// dynamic part of the instance (ring buffer, pre and old values, relations,
+// zero-crossings, samples, parameters, delay buffers and the step size of the
+// co-simulation solver). Getting, setting and (de)serializing a state is a
+// single pass over this buffer.
+#define FMU_STATE_MAGIC "OMFMUST2"
+
+typedef struct {
+  char magic[8];
+  size_t size;        // size of the whole buffer, including this header
+} FMUStateHeader;
+
+typedef struct {
+  fmi2Byte *data;     // NULL to only compute the size
+  size_t size;
+  size_t pos;
+  int restore;        // copy from data to the instance instead of the other way round
+  int error;
+} FMUStateCursor;
+
+static void stateCopy(FMUStateCursor *cur, void *p, size_t n) {
+  if (cur->error || n == 0)
+    return;
+  if (cur->data) {
+    if (cur->pos + n > cur->size) {
+      cur->error = 1;
+      return;
+    }
+    if (cur->restore)
+      memcpy(p, cur->data + cur->pos, n);
+    else
+      memcpy(cur->data + cur->pos, p, n);
+  }
+  cur->pos += n;
+}
+
+static void stateCopyStrings(FMUStateCursor *cur, modelica_string *s, long n) {
+  long i;
+  for (i = 0; i < n && !cur->error; i++) {
+    size_t len = (!cur->restore && s[i]) ? MMC_STRLEN(s[i]) : (size_t)-1;
+    stateCopy(cur, &len, sizeof(size_t));
+    if (!cur->restore) {
+      if (s[i])
+        stateCopy(cur, MMC_STRINGDATA(s[i]), len);
+    } else if (len == (size_t)-1) {
+      s[i] = NULL;
+    } else if (!cur->error) {
+      if (cur->pos + len > cur->size) {
+        cur->error = 1;
+        return;
+      }
+      s[i] = mmc_mk_scon_len(len);
+      stateCopy(cur, MMC_STRINGDATA(s[i]), len);
+      MMC_STRINGDATA(s[i])[len] = '\0';
+    }
+  }
+}
+
+static void stateCopyDelayBuffers(FMUStateCursor *cur, DATA *data) {
+  long i;
+  int j, n;
+  for (i = 0; i < data->modelData.nDelayExpressions && !cur->error; i++) {
+    RINGBUFFER *delayStruct = data->simulationInfo.delayStructure[i];
+    n = ringBufferLength(delayStruct);
+    stateCopy(cur, &n, sizeof(int));
+    if (cur->error)
+      return;
+    if (cur->restore) {
+      if (n < 0 || cur->pos + n*sizeof(TIME_AND_VALUE) > cur->size) {
+        cur->error = 1;
+        return;
+      }
+      freeRingBuffer(delayStruct);
+      delayStruct = allocRingBuffer(n > 1024 ? n : 1024, sizeof(TIME_AND_VALUE));
+      data->simulationInfo.delayStructure[i] = delayStruct;
+      for (j = 0; j < n; j++) {
+        TIME_AND_VALUE tpl;
+        stateCopy(cur, &tpl, sizeof(TIME_AND_VALUE));
+        appendRingData(delayStruct, &tpl);
+      }
+    } else {
+      for (j = 0; j < n; j++) {
+        stateCopy(cur, getRingData(delayStruct, j), sizeof(TIME_AND_VALUE));
+      }
+    }
+  }
+}
+
+// Saves (or restores) everything after the header in a fixed order
+static void stateCopyInstance(FMUStateCursor *cur, ModelInstance *comp) {
+  DATA *data = comp->fmuData;
+  MODEL_DATA *mData = &data->modelData;
+  SIMULATION_INFO *sInfo = &data->simulationInfo;
+  int i, nRing = ringBufferLength(data->simulationData);
+
+  stateCopy(cur, &comp->state, sizeof(ModelState));
+  stateCopy(cur, &comp->eventInfo, sizeof(fmi2EventInfo));
+  stateCopy(cur, &comp->_need_update, sizeof(int));
+  stateCopy(cur, &comp->toleranceDefined, sizeof(fmi2Boolean));
+  stateCopy(cur, &comp->tolerance, sizeof(fmi2Real));
+  stateCopy(cur, &comp->startTime, sizeof(fmi2Real));
+  stateCopy(cur, &comp->stopTimeDefined, sizeof(fmi2Boolean));
+  stateCopy(cur, &comp->stopTime, sizeof(fmi2Real));
+  // _cs_work only holds scratch values of the current fmi2DoStep
+  stateCopy(cur, &comp->_cs_step_size, sizeof(fmi2Real));
+
+  for (i = 0; i < nRing; i++) {
+    SIMULATION_DATA *sData = data->localData[i];
+    stateCopy(cur, &sData->timeValue, sizeof(modelica_real));
+    stateCopy(cur, sData->realVars, mData->nVariablesReal*sizeof(modelica_real));
+    stateCopy(cur, sData->integerVars, mData->nVariablesInteger*sizeof(modelica_integer));
+    stateCopy(cur, sData->booleanVars, mData->nVariablesBoolean*sizeof(modelica_boolean));
+    stateCopyStrings(cur, sData->stringVars, mData->nVariablesString);
+  }
+
+  stateCopy(cur, sInfo->realVarsPre, mData->nVariablesReal*sizeof(modelica_real));
+  stateCopy(cur, sInfo->integerVarsPre, mData->nVariablesInteger*sizeof(modelica_integer));
+  stateCopy(cur, sInfo->booleanVarsPre, mData->nVariablesBoolean*sizeof(modelica_boolean));
+  stateCopyStrings(cur, sInfo->stringVarsPre, mData->nVariablesString);
+
+  stateCopy(cur, &sInfo->timeValueOld, sizeof(modelica_real));
+  stateCopy(cur, sInfo->realVarsOld, mData->nVariablesReal*sizeof(modelica_real));
+  stateCopy(cur, sInfo->integerVarsOld, mData->nVariablesInteger*sizeof(modelica_integer));
+  stateCopy(cur, sInfo->booleanVarsOld, mData->nVariablesBoolean*sizeof(modelica_boolean));
+  stateCopyStrings(cur, sInfo->stringVarsOld, mData->nVariablesString);
+
+  stateCopy(cur, sInfo->realParameter, mData->nParametersReal*sizeof(modelica_real));
+  stateCopy(cur, sInfo->integerParameter, mData->nParametersInteger*sizeof(modelica_integer));
+  stateCopy(cur, sInfo->booleanParameter, mData->nParametersBoolean*sizeof(modelica_boolean));
+  stateCopyStrings(cur, sInfo->stringParameter, mData->nParametersString);
+  stateCopy(cur, sInfo->inputVars, mData->nInputVars*sizeof(modelica_real));
+  stateCopy(cur, sInfo->outputVars, mData->nOutputVars*sizeof(modelica_real));
+
+  stateCopy(cur, sInfo->zeroCrossings, mData->nZeroCrossings*sizeof(modelica_real));
+  stateCopy(cur, sInfo->zeroCrossingsPre, mData->nZeroCrossings*sizeof(modelica_real));
+  stateCopy(cur, sInfo->relations, mData->nRelations*sizeof(modelica_boolean));
+  stateCopy(cur, sInfo->relationsPre, mData->nRelations*sizeof(modelica_boolean));
+  stateCopy(cur, sInfo->storedRelations, mData->nRelations*sizeof(modelica_boolean));
+  stateCopy(cur, sInfo->mathEventsValuePre, mData->nMathEvents*sizeof(modelica_real));
+
+  stateCopy(cur, &sInfo->nextSampleEvent, sizeof(double));
+  stateCopy(cur, sInfo->nextSampleTimes, mData->nSamples*sizeof(double));
+  stateCopy(cur, sInfo->samples, mData->nSamples*sizeof(modelica_boolean));
+
+  stateCopy(cur, &sInfo->initial, sizeof(modelica_boolean));
+  stateCopy(cur, &sInfo->terminal, sizeof(modelica_boolean));
+  stateCopy(cur, &sInfo->discreteCall, sizeof(modelica_boolean));
+  stateCopy(cur, &sInfo->needToIterate, sizeof(modelica_boolean));
+  stateCopy(cur, &sInfo->sampleActivated, sizeof(modelica_boolean));
+  stateCopy(cur, &sInfo->chatteringInfo.currentIndex, sizeof(int));
+  stateCopy(cur, &sInfo->chatteringInfo.lastStepsNumStateEvents, sizeof(int));
+  stateCopy(cur, sInfo->chatteringInfo.lastSteps, sInfo->chatteringInfo.numEventLimit*sizeof(int));
+  stateCopy(cur, sInfo->chatteringInfo.lastTimes, sInfo->chatteringInfo.numEventLimit*sizeof(double));
+
+  stateCopy(cur, &sInfo->tStart, sizeof(double));
+  stateCopyDelayBuffers(cur, data);
+}
+
+// Checks the header and the GUID; returns the position after them or 0
+static size_t stateCheckHeader(const fmi2Byte *buffer, size_t size) {
+  FMUStateHeader header;
+  size_t len;
+  if (size < sizeof(FMUStateHeader) + sizeof(size_t))
+    return 0;
+  memcpy(&header, buffer, sizeof(FMUStateHeader));
+  memcpy(&len, buffer + sizeof(FMUStateHeader), sizeof(size_t));
+  if (memcmp(header.magic, FMU_STATE_MAGIC, sizeof(header.magic)) || header.size != size)
+    return 0;
+  if (len != strlen(MODEL_GUID) || sizeof(FMUStateHeader) + sizeof(size_t) + len > size)
+    return 0;
+  if (memcmp(buffer + sizeof(FMUStateHeader) + sizeof(size_t), MODEL_GUID, len))
+    return 0;
+  return sizeof(FMUStateHeader) + sizeof(size_t) + len;
+}
+
 fmi2Status fmi2GetFMUstate(fmi2Component c, fmi2FMUstate* FMUstate) {
-  return unsupportedFunction(c, "fmi2GetFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  FMUStateCursor cur = {NULL, 0, 0, 0, 0};
+  FMUStateHeader header;
+  size_t guidLength = strlen(MODEL_GUID);
+  fmi2Byte *buffer;
+  if (invalidState(comp, "fmi2GetFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2GetFMUstate", "FMUstate", FMUstate))
+    return fmi2Error;
+
+  // the first pass only computes the size
+  cur.pos = sizeof(FMUStateHeader) + sizeof(size_t) + guidLength;
+  stateCopyInstance(&cur, comp);
+  memcpy(header.magic, FMU_STATE_MAGIC, sizeof(header.magic));
+  header.size = cur.pos;
+
+  // reuse the given state if it has the same size
+  buffer = (fmi2Byte *)*FMUstate;
+  if (buffer && ((FMUStateHeader *)buffer)->size != header.size) {
+    comp->functions->freeMemory(buffer);
+    buffer = NULL;
+  }
+  if (!buffer)
+    buffer = (fmi2Byte *)comp->functions->allocateMemory(1, header.size);
+  if (!buffer) {
+    *FMUstate = NULL;
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2GetFMUstate: Out of memory.")
+    return fmi2Error;
+  }
+  memcpy(buffer, &header, sizeof(FMUStateHeader));
+  memcpy(buffer + sizeof(FMUStateHeader), &guidLength, sizeof(size_t));
+  memcpy(buffer + sizeof(FMUStateHeader) + sizeof(size_t), MODEL_GUID, guidLength);
+  cur.data = buffer;
+  cur.size = header.size;
+  cur.pos = sizeof(FMUStateHeader) + sizeof(size_t) + guidLength;
+  stateCopyInstance(&cur, comp);
+  *FMUstate = buffer;
+
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2GetFMUstate: %u bytes", (unsigned int)header.size)
+  return fmi2OK;
 }
 
 fmi2Status fmi2SetFMUstate(fmi2Component c, fmi2FMUstate FMUstate) {
-  return unsupportedFunction(c, "fmi2SetFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  FMUStateCursor cur = {NULL, 0, 0, 1, 0};
+  if (invalidState(comp, "fmi2SetFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2SetFMUstate", "FMUstate", FMUstate))
+    return fmi2Error;
+
+  cur.data = (fmi2Byte *)FMUstate;
+  cur.size = ((FMUStateHeader *)FMUstate)->size;
+  cur.pos = stateCheckHeader(cur.data, cur.size);
+  if (cur.pos == 0) {
+    comp->state = modelError;
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2SetFMUstate: Invalid FMU state.")
+    return fmi2Error;
+  }
+  stateCopyInstance(&cur, comp);
+  if (cur.error || cur.pos != cur.size) {
+    comp->state = modelError;
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2SetFMUstate: Corrupt FMU state.")
+    return fmi2Error;
+  }
+
+  invalidateDirectionalDerivatives(comp);
+
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2SetFMUstate: time = %g", comp->fmuData->localData[0]->timeValue)
+  return fmi2OK;
 }
 
 fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* FMUstate) {
-  return unsupportedFunction(c, "fmi2FreeFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  if (invalidState(comp, "fmi2FreeFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2FreeFMUstate", "FMUstate", FMUstate))
+    return fmi2Error;
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2FreeFMUstate")
+
+  if (*FMUstate)
+    comp->functions->freeMemory(*FMUstate);
+  *FMUstate = NULL;
+  return fmi2OK;
 }
 
 fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate FMUstate, size_t *size) {
-  return unsupportedFunction(c, "fmi2SerializedFMUstateSize", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  if (invalidState(comp, "fmi2SerializedFMUstateSize", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2SerializedFMUstateSize", "FMUstate", FMUstate) || nullPointer(comp, "fmi2SerializedFMUstateSize", "size", size))
+    return fmi2Error;
+
+  *size = ((FMUStateHeader *)FMUstate)->size;
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2SerializedFMUstateSize: %u bytes", (unsigned int)*size)
+  return fmi2OK;
 }
 
 fmi2Status fmi2SerializeFMUstate(fmi2Component c, fmi2FMUstate FMUstate, fmi2Byte serializedState[], size_t size) {
-  return unsupportedFunction(c, "fmi2SerializeFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  if (invalidState(comp, "fmi2SerializeFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2SerializeFMUstate", "FMUstate", FMUstate) || nullPointer(comp, "fmi2SerializeFMUstate", "serializedState", serializedState))
+    return fmi2Error;
+  if (invalidNumber(comp, "fmi2SerializeFMUstate", "size", size, ((FMUStateHeader *)FMUstate)->size))
+    return fmi2Error;
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2SerializeFMUstate")
+
+  memcpy(serializedState, FMUstate, size);
+  return fmi2OK;
 }
 
 fmi2Status fmi2DeSerializeFMUstate(fmi2Component c, const fmi2Byte serializedState[], size_t size, fmi2FMUstate* FMUstate) {
-  return unsupportedFunction(c, "fmi2DeSerializeFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  fmi2Byte *buffer;
+  if (invalidState(comp, "fmi2DeSerializeFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2DeSerializeFMUstate", "serializedState", serializedState) || nullPointer(comp, "fmi2DeSerializeFMUstate", "FMUstate", FMUstate))
+    return fmi2Error;
+  if (stateCheckHeader(serializedState, size) == 0) {
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2DeSerializeFMUstate: Invalid serialized FMU state (not created by this FMU?).")
+    return fmi2Error;
+  }
+
+  buffer = (fmi2Byte *)*FMUstate;
+  if (buffer && ((FMUStateHeader *)buffer)->size != size) {
+    comp->functions->freeMemory(buffer);
+    buffer = NULL;
+  }
+  if (!buffer)
+    buffer = (fmi2Byte *)comp->functions->allocateMemory(1, size);
+  if (!buffer) {
+    *FMUstate = NULL;
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2DeSerializeFMUstate: Out of memory.")
+    return fmi2Error;
+  }
+  memcpy(buffer, serializedState, size);
+  *FMUstate = buffer;
+
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2DeSerializeFMUstate: %u bytes", (unsigned int)size)
+  return fmi2OK;
+}
+
+// ---------------------------------------------------------------------------
+// Directional derivatives
+// ---------------------------------------------------------------------------
+// Directional derivatives of the state derivatives with respect to the states
+// are evaluated with the generated symbolic jacobian A: the seed vector is the
+// direction and one column call gives the derivatives of all unknowns. The
+// importer passes one direction per call; if it keeps asking at the same point
+// (e.g. to build the whole jacobian) the sparse jacobian is computed once with
+// one column call per color and the following calls are answered from it.
+// Inputs as knowns and outputs as unknowns use one column call of the
+// jacobians B (inputs -> state derivatives), C (states -> outputs) and
+// D (inputs -> outputs) each.
+static void freeJacobian(DATA *data, int index) {
+  ANALYTIC_JACOBIAN *jac = &(data->simulationInfo.analyticJacobians[index]);
+  free(jac->seedVars);
+  free(jac->resultVars);
+  free(jac->tmpVars);
+  free(jac->sparsePattern.leadindex);
+  free(jac->sparsePattern.index);
+  free(jac->sparsePattern.colorCols);
+  memset(jac, 0, sizeof(ANALYTIC_JACOBIAN));
+}
+
+static void invalidateDirectionalDerivatives(ModelInstance *comp) {
+  comp->_jacobian_valid = 0;
+  comp->_directional_calls = 0;
+}
+
+static void freeDirectionalDerivatives(ModelInstance *comp) {
+  DATA *data = comp->fmuData;
+  if (comp->_has_jacobian == 1)
+    freeJacobian(data, data->callback->INDEX_JAC_A);
+  if (comp->_jacobian)
+    comp->functions->freeMemory(comp->_jacobian);
+  comp->_jacobian = NULL;
+  comp->_has_jacobian = 0;
+  if (comp->_has_jacobian_io == 1) {
+    if (NUMBER_OF_INPUTS > 0)
+      freeJacobian(data, data->callback->INDEX_JAC_B);
+    if (NUMBER_OF_OUTPUTS > 0)
+      freeJacobian(data, data->callback->INDEX_JAC_C);
+    if (NUMBER_OF_INPUTS > 0 && NUMBER_OF_OUTPUTS > 0)
+      freeJacobian(data, data->callback->INDEX_JAC_D);
+  }
+  comp->_has_jacobian_io = 0;
+  invalidateDirectionalDerivatives(comp);
 }
 
+#if NUMBER_OF_STATES>0
+static fmi2Boolean initJacobian(DATA *data, int index, int (*initialAnalyticJacobian)(void*), unsigned int sizeCols, unsigned int sizeRows) {
+  ANALYTIC_JACOBIAN *jac = &(data->simulationInfo.analyticJacobians[index]);
+  if (initialAnalyticJacobian(data))
+    return fmi2False;
+  /* without symbolic linearization only the sparse pattern is generated */
+  if (jac->sizeCols != sizeCols || jac->sizeRows != sizeRows) {
+    freeJacobian(data, index);
+    return fmi2False;
+  }
+  return fmi2True;
+}
+
+static fmi2Boolean initDirectionalDerivatives(ModelInstance *comp) {
+  DATA *data = comp->fmuData;
+  ANALYTIC_JACOBIAN *jac = &(data->simulationInfo.analyticJacobians[data->callback->INDEX_JAC_A]);
+
+  if (comp->_has_jacobian != 0)
+    return comp->_has_jacobian == 1;
+
+  comp->_has_jacobian = -1;
+  if (!initJacobian(data, data->callback->INDEX_JAC_A, data->callback->initialAnalyticJacobianA, NUMBER_OF_STATES, NUMBER_OF_STATES))
+    return fmi2False;
+  comp->_jacobian = (fmi2Real *)comp->functions->allocateMemory(jac->sparsePattern.numberOfNoneZeros + NUMBER_OF_STATES, sizeof(fmi2Real));
+  if (!comp->_jacobian) {
+    freeJacobian(data, data->callback->INDEX_JAC_A);
+    return fmi2False;
+  }
+  comp->_has_jacobian = 1;
+  return fmi2True;
+}
+
+/* the jacobians B, C and D, as far as the model has inputs and outputs */
+static fmi2Boolean initDirectionalDerivativesIO(ModelInstance *comp) {
+  DATA *data = comp->fmuData;
+
+  if (comp->_has_jacobian_io != 0)
+    return comp->_has_jacobian_io == 1;
+
+  comp->_has_jacobian_io = -1;
+  if (NUMBER_OF_INPUTS > 0 && !initJacobian(data, data->callback->INDEX_JAC_B, data->callback->initialAnalyticJacobianB, NUMBER_OF_INPUTS, NUMBER_OF_STATES))
+    return fmi2False;
+  if (NUMBER_OF_OUTPUTS > 0 && !initJacobian(data, data->callback->INDEX_JAC_C, data->callback->initialAnalyticJacobianC, NUMBER_OF_STATES, NUMBER_OF_OUTPUTS)) {
+    if (NUMBER_OF_INPUTS > 0)
+      freeJacobian(data, data->callback->INDEX_JAC_B);
+    return fmi2False;
+  }
+  if (NUMBER_OF_INPUTS > 0 && NUMBER_OF_OUTPUTS > 0 && !initJacobian(data, data->callback->INDEX_JAC_D, data->callback->initialAnalyticJacobianD, NUMBER_OF_INPUTS, NUMBER_OF_OUTPUTS)) {
+    freeJacobian(data, data->callback->INDEX_JAC_B);
+    freeJacobian(data, data->callback->INDEX_JAC_C);
+    return fmi2False;
+  }
+  comp->_has_jacobian_io = 1;
+  return fmi2True;
+}
+
+static int refIndex(const fmi2ValueReference *refs, int n, fmi2ValueReference vr) {
+  int i;
+  for (i = 0; i < n; i++)
+    if (refs[i] == vr)
+      return i;
+  return -1;
+}
+
+static void updateJacobianA(ModelInstance *comp) {
+  DATA *data = comp->fmuData;
+  ANALYTIC_JACOBIAN *jac = &(data->simulationInfo.analyticJacobians[data->callback->INDEX_JAC_A]);
+  unsigned int color, j, ii;
+
+  for (color = 1; color <= jac->sparsePattern.maxColors; color++) {
+    for (j = 0; j < jac->sizeCols; j++)
+      if (jac->sparsePattern.colorCols[j] == color)
+        jac->seedVars[j] = 1.0;
+
+    data->callback->functionJacA_column(data);
+
+    for (j = 0; j < jac->sizeCols; j++) {
+      if (jac->sparsePattern.colorCols[j] == color) {
+        for (ii = (j == 0 ? 0 : jac->sparsePattern.leadindex[j-1]); ii < jac->sparsePattern.leadindex[j]; ii++)
+          comp->_jacobian[ii] = jac->resultVars[jac->sparsePattern.index[ii]];
+        jac->seedVars[j] = 0.0;
+      }
+    }
+  }
+  comp->_jacobian_valid = 1;
+}
+
+static void clearSeedVars(DATA *data, int index) {
+  ANALYTIC_JACOBIAN *jac = &(data->simulationInfo.analyticJacobians[index]);
+  if (jac->seedVars)
+    memset(jac->seedVars, 0, jac->sizeCols*sizeof(modelica_real));
+}
+
+/* adds one column call of the jacobian, seeded with the knowns among
+ * seedRefs, to the unknowns among resultRefs */
+static void addJacobianColumn(DATA *data, int index, int (*functionJac_column)(void*),
+    const fmi2ValueReference *resultRefs, int nResults, const fmi2ValueReference *seedRefs, int nSeeds,
+    const fmi2ValueReference vUnknown_ref[], size_t nUnknown, const fmi2ValueReference vKnown_ref[], size_t nKnown,
+    const fmi2Real dvKnown[], fmi2Real dvUnknown[]) {
+  ANALYTIC_JACOBIAN *jac = &(data->simulationInfo.analyticJacobians[index]);
+  size_t i;
+  int j;
+
+  for (i = 0; i < nKnown; i++)
+    if ((j = refIndex(seedRefs, nSeeds, vKnown_ref[i])) >= 0)
+      jac->seedVars[j] += dvKnown[i];
+  functionJac_column(data);
+  clearSeedVars(data, index);
+  for (i = 0; i < nUnknown; i++)
+    if ((j = refIndex(resultRefs, nResults, vUnknown_ref[i])) >= 0)
+      dvUnknown[i] += jac->resultVars[j];
+}
+#endif
+
 fmi2Status fmi2GetDirectionalDerivative(fmi2Component c, const fmi2ValueReference vUnknown_ref[], size_t nUnknown, const fmi2ValueReference vKnown_ref[] , size_t nKnown,
     const fmi2Real dvKnown[], fmi2Real dvUnknown[]) {
-  return unsupportedFunction(c, "fmi2GetDirectionalDerivative", modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  size_t i;
+  ModelInstance *comp = (ModelInstance *)c;
+#if NUMBER_OF_STATES>0
+  threadData_t *threadData;
+  DATA *data;
+  ANALYTIC_JACOBIAN *jac;
+  int index;
+  fmi2Boolean knownStates = fmi2False, knownInputs = fmi2False, unknownDerivatives = fmi2False, unknownOutputs = fmi2False;
+#endif
+  if (invalidState(comp, "fmi2GetDirectionalDerivative", modelInitializationMode|modelEventMode|modelContinuousTimeMode))
+    return fmi2Error;
+  if (nUnknown > 0 && nullPointer(comp, "fmi2GetDirectionalDerivative", "vUnknown_ref[]", vUnknown_ref))
+    return fmi2Error;
+  if (nUnknown > 0 && nullPointer(comp, "fmi2GetDirectionalDerivative", "dvUnknown[]", dvUnknown))
+    return fmi2Error;
+  if (nKnown > 0 && nullPointer(comp, "fmi2GetDirectionalDerivative", "vKnown_ref[]", vKnown_ref))
+    return fmi2Error;
+  if (nKnown > 0 && nullPointer(comp, "fmi2GetDirectionalDerivative", "dvKnown[]", dvKnown))
+    return fmi2Error;
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2GetDirectionalDerivative: nUnknown=%u nKnown=%u", (unsigned int)nUnknown, (unsigned int)nKnown)
+
+#if NUMBER_OF_STATES>0
+  threadData = comp->fmuData->threadData;
+  data = comp->fmuData;
+
+  if (!initDirectionalDerivatives(comp)) {
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2GetDirectionalDerivative: No symbolic jacobian available, the FMU was generated with -d=disableSymbolicLinearization.")
+    return fmi2Error;
+  }
+  jac = &(data->simulationInfo.analyticJacobians[data->callback->INDEX_JAC_A]);
+
+  /* knowns are states or inputs, unknowns state derivatives or outputs;
+   * errors here do not invalidate the instance */
+  for (i = 0; i < nKnown; i++) {
+    if (refIndex(vrStates, NUMBER_OF_STATES, vKnown_ref[i]) >= 0) {
+      knownStates = fmi2True;
+    } else if (refIndex(vrInputs, NUMBER_OF_INPUTS, vKnown_ref[i]) >= 0) {
+      knownInputs = fmi2True;
+    } else {
+      FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2GetDirectionalDerivative: Known value reference %u is not a state or an input.", vKnown_ref[i])
+      return fmi2Error;
+    }
+  }
+  for (i = 0; i < nUnknown; i++) {
+    if (refIndex(vrStatesDerivatives, NUMBER_OF_STATES, vUnknown_ref[i]) >= 0) {
+      unknownDerivatives = fmi2True;
+    } else if (refIndex(vrOutputs, NUMBER_OF_OUTPUTS, vUnknown_ref[i]) >= 0) {
+      unknownOutputs = fmi2True;
+    } else {
+      FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2GetDirectionalDerivative: Unknown value reference %u is not a state derivative or an output.", vUnknown_ref[i])
+      return fmi2Error;
+    }
+  }
+  if ((knownInputs || unknownOutputs) && !initDirectionalDerivativesIO(comp)) {
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2GetDirectionalDerivative: No symbolic jacobians B, C and D available, the FMU was generated with -d=disableSymbolicLinearization.")
+    return fmi2Error;
+  }
+
+  /* try */
+  MMC_TRY_INTERNAL(simulationJumpBuffer)
+
+    if (comp->_need_update) {
+      comp->fmuData->callback->functionODE(comp->fmuData);
+      if (NUMBER_OF_OUTPUTS > 0)
+        comp->fmuData->callback->functionAlgebraics(comp->fmuData);
+      overwriteOldSimulationData(comp->fmuData);
+      comp->_need_update = 0;
+      invalidateDirectionalDerivatives(comp);
+    }
+
+    for (i = 0; i < nUnknown; i++)
+      dvUnknown[i] = 0.0;
+
+    if (knownStates && unknownDerivatives) {
+      /* after as many single directions as there are colors the whole jacobian is cheaper */
+      if (!comp->_jacobian_valid && comp->_directional_calls >= jac->sparsePattern.maxColors)
+        updateJacobianA(comp);
+      comp->_directional_calls++;
+
+      if (comp->_jacobian_valid) {
+        fmi2Real *work = comp->_jacobian + jac->sparsePattern.numberOfNoneZeros;
+        unsigned int ii;
+        memset(work, 0, NUMBER_OF_STATES*sizeof(fmi2Real));
+        for (i = 0; i < nKnown; i++) {
+          if ((index = refIndex(vrStates, NUMBER_OF_STATES, vKnown_ref[i])) < 0)
+            continue;
+          for (ii = (index == 0 ? 0 : jac->sparsePattern.leadindex[index-1]); ii < jac->sparsePattern.leadindex[index]; ii++)
+            work[jac->sparsePattern.index[ii]] += comp->_jacobian[ii] * dvKnown[i];
+        }
+        for (i = 0; i < nUnknown; i++)
+          if ((index = refIndex(vrStatesDerivatives, NUMBER_OF_STATES, vUnknown_ref[i])) >= 0)
+            dvUnknown[i] = work[index];
+      } else {
+        addJacobianColumn(data, data->callback->INDEX_JAC_A, data->callback->functionJacA_column, vrStatesDerivatives, NUMBER_OF_STATES, vrStates, NUMBER_OF_STATES,
+                          vUnknown_ref, nUnknown, vKnown_ref, nKnown, dvKnown, dvUnknown);
+      }
+    }
+    if (knownInputs && unknownDerivatives)
+      addJacobianColumn(data, data->callback->INDEX_JAC_B, data->callback->functionJacB_column, vrStatesDerivatives, NUMBER_OF_STATES, vrInputs, NUMBER_OF_INPUTS,
+                        vUnknown_ref, nUnknown, vKnown_ref, nKnown, dvKnown, dvUnknown);
+    if (knownStates && unknownOutputs)
+      addJacobianColumn(data, data->callback->INDEX_JAC_C, data->callback->functionJacC_column, vrOutputs, NUMBER_OF_OUTPUTS, vrStates, NUMBER_OF_STATES,
+                        vUnknown_ref, nUnknown, vKnown_ref, nKnown, dvKnown, dvUnknown);
+    if (knownInputs && unknownOutputs)
+      addJacobianColumn(data, data->callback->INDEX_JAC_D, data->callback->functionJacD_column, vrOutputs, NUMBER_OF_OUTPUTS, vrInputs, NUMBER_OF_INPUTS,
+                        vUnknown_ref, nUnknown, vKnown_ref, nKnown, dvKnown, dvUnknown);
+
+    for (i = 0; i < nUnknown; i++)
+      FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2GetDirectionalDerivative: d#r%u# = %.16g", vUnknown_ref[i], dvUnknown[i])
+    return fmi2OK;
+
+  /* catch */
+  MMC_CATCH_INTERNAL(simulationJumpBuffer)
+
+  clearSeedVars(data, data->callback->INDEX_JAC_A);
+  if (comp->_has_jacobian_io == 1) {
+    clearSeedVars(data, data->callback->INDEX_JAC_B);
+    clearSeedVars(data, data->callback->INDEX_JAC_C);
+    clearSeedVars(data, data->callback->INDEX_JAC_D);
+  }
+  FILTERED_LOG(comp, fmi2Error, LOG_FMI2_CALL, "fmi2GetDirectionalDerivative: terminated by an assertion.")
+  return fmi2Error;
+#else
+  if (nUnknown == 0)
+    return fmi2OK;
+  FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2GetDirectionalDerivative: Unknown value reference %u is not a state derivative.", vUnknown_ref[0])
+  return fmi2Error;
+#endif
 }
 
 /***************************************************
@@ -745,7 +1378,7 @@ fmi2Status fmi2CompletedIntegratorStep(fmi2Component c, fmi2Boolean noSetFMUStat
     comp->fmuData->callback->function_storeDelayed(comp->fmuData);
     storePreValues(comp->fmuData);
     *enterEventMode = fmi2False;
-    *terminateSimulation = fmi2False;
+    *terminateSimulation = comp->eventInfo.terminateSimulation = terminateRequested(comp);
     /******** check state selection ********/
     if (stateSelection(comp->fmuData,1, 0))
     {
@@ -820,6 +1453,7 @@ fmi2Status fmi2GetDerivatives(fmi2Component c, fmi2Real derivatives[], size_t nx
       comp->fmuData->callback->functionODE(comp->fmuData);
       overwriteOldSimulationData(comp->fmuData);
       comp->_need_update = 0;
+      invalidateDirectionalDerivatives(comp);
     }
 
 #if NUMBER_OF_STATES>0
@@ -859,6 +1493,7 @@ fmi2Status fmi2GetEventIndicators(fmi2Component c, fmi2Real eventIndicators[], s
     if (comp->_need_update){
       comp->fmuData->callback->functionODE(comp->fmuData);
       comp->_need_update = 0;
+      invalidateDirectionalDerivatives(comp);
     }
     comp->fmuData->callback->function_ZeroCrossings(comp->fmuData,comp->fmuData->simulationInfo.zeroCrossings);
     for (i = 0; i < nx; i++) {
@@ -913,6 +1548,106 @@ fmi2Status fmi2GetNominalsOfContinuousStates(fmi2Component c, fmi2Real x_nominal
 /***************************************************
 Functions for FMI2 for Co-Simulation
 ****************************************************/
+// A co-simulation FMU integrates its model exchange interface with a built-in
+// explicit Runge-Kutta method (Bogacki-Shampine 3(2), the embedded second
+// order solution controls the step size). Time events are hit exactly, state
+// events are located by bisection on the event indicators and both are handled
+// with the event iteration of model exchange. A whole communication interval
+// is integrated inside the FMU.
+#define CS_DEFAULT_TOLERANCE 1e-6
+#define CS_EVENT_TOLERANCE 1e-10      // relative to the time, width of the interval a state event is located in
+#define CS_MAX_EVENT_ITERATIONS 100
+
+static int csEvaluate(ModelInstance *comp) {
+  DATA *data = comp->fmuData;
+  threadData_t *threadData = data->threadData;
+  int retValue = -1;
+
+  /* try */
+  MMC_TRY_INTERNAL(simulationJumpBuffer)
+    data->callback->functionODE(data);
+    data->callback->function_ZeroCrossings(data, data->simulationInfo.zeroCrossings);
+    retValue = 0;
+  /* catch */
+  MMC_CATCH_INTERNAL(simulationJumpBuffer)
+
+  return retValue;
+}
+
+// One step of size h from t0, the start values x0 and derivatives k1 are in
+// the work vectors. Afterwards the model is evaluated at t0+h and error is the
+// weighted RMS norm of the local error estimate.
+static int csAttemptStep(ModelInstance *comp, fmi2Real t0, fmi2Real h, fmi2Real *error) {
+  DATA *data = comp->fmuData;
+  threadData_t *threadData = data->threadData;
+  SIMULATION_DATA *sData = data->localData[0];
+  long i, n = data->modelData.nStates;
+  fmi2Real *x0 = comp->_cs_work, *k1 = x0 + n, *k2 = k1 + n, *k3 = k2 + n, *k4 = k3 + n;
+  fmi2Real *x = sData->realVars, *der = sData->realVars + n;
+  fmi2Real tol = comp->toleranceDefined ? comp->tolerance : CS_DEFAULT_TOLERANCE;
+  fmi2Real e, sum = 0;
+  int retValue = -1;
+
+  /* try */
+  MMC_TRY_INTERNAL(simulationJumpBuffer)
+    for (i = 0; i < n; i++)
+      x[i] = x0[i] + 0.5*h*k1[i];
+    sData->timeValue = t0 + 0.5*h;
+    data->callback->functionODE(data);
+    memcpy(k2, der, n*sizeof(fmi2Real));
+
+    for (i = 0; i < n; i++)
+      x[i] = x0[i] + 0.75*h*k2[i];
+    sData->timeValue = t0 + 0.75*h;
+    data->callback->functionODE(data);
+    memcpy(k3, der, n*sizeof(fmi2Real));
+
+    for (i = 0; i < n; i++)
+      x[i] = x0[i] + h*(2.0/9.0*k1[i] + 1.0/3.0*k2[i] + 4.0/9.0*k3[i]);
+    sData->timeValue = t0 + h;
+    data->callback->functionODE(data);
+    memcpy(k4, der, n*sizeof(fmi2Real));
+    data->callback->function_ZeroCrossings(data, data->simulationInfo.zeroCrossings);
+
+    for (i = 0; i < n; i++) {
+      e = h*(-5.0/72.0*k1[i] + 1.0/12.0*k2[i] + 1.0/9.0*k3[i] - 1.0/8.0*k4[i]) / (tol + tol*fmax(fabs(x0[i]), fabs(x[i])));
+      sum += e*e;
+    }
+    *error = n > 0 ? sqrt(sum/n) : 0.0;
+    retValue = 0;
+  /* catch */
+  MMC_CATCH_INTERNAL(simulationJumpBuffer)
+
+  return retValue;
+}
+
+static fmi2Boolean csStateEvent(const fmi2Real *z0, const fmi2Real *z, long nz) {
+  long i;
+  for (i = 0; i < nz; i++)
+    if ((z0[i] > 0) != (z[i] > 0))
+      return fmi2True;
+  return fmi2False;
+}
+
+static fmi2Status csEventIteration(ModelInstance *comp) {
+  int iter = 0;
+  fmi2Status status;
+
+  comp->state = modelEventMode;
+  do {
+    status = fmi2NewDiscreteStates(comp, &comp->eventInfo);
+    if (status != fmi2OK)
+      return status;
+  } while (comp->eventInfo.newDiscreteStatesNeeded && !comp->eventInfo.terminateSimulation && ++iter < CS_MAX_EVENT_ITERATIONS);
+
+  if (comp->eventInfo.newDiscreteStatesNeeded && !comp->eventInfo.terminateSimulation) {
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "Event iteration did not converge within %d iterations at time %g.", CS_MAX_EVENT_ITERATIONS, comp->fmuData->localData[0]->timeValue)
+    return fmi2Error;
+  }
+  comp->state = modelContinuousTimeMode;
+  return fmi2OK;
+}
+
 fmi2Status fmi2SetRealInputDerivatives(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer order[], const fmi2Real value[]) {
   // TODO Write code here
   return fmi2OK;
@@ -924,38 +1659,196 @@ fmi2Status fmi2GetRealOutputDerivatives (fmi2Component c, const fmi2ValueReferen
 }
 
 fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize, fmi2Boolean noSetFMUStatePriorToCurrentPoint) {
-  // TODO Write code here
+  ModelInstance *comp = (ModelInstance *)c;
+  DATA *data;
+  SIMULATION_DATA *sData;
+  long n, nz;
+  fmi2Real t, tEnd, tEps, h, hNext, lo, hi, error, *x0, *k1, *z0;
+  fmi2Boolean timeEvent, stateEvent, lastStep, enterEventMode, terminateSimulation;
+  fmi2Status status;
+
+  if (invalidState(comp, "fmi2DoStep", modelContinuousTimeMode))
+    return fmi2Error;
+  if (comp->type != fmi2CoSimulation) {
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2DoStep: The FMU was instantiated for model exchange.")
+    return fmi2Error;
+  }
+  if (communicationStepSize < 0) {
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2DoStep: Invalid argument communicationStepSize = %g.", communicationStepSize)
+    return fmi2Error;
+  }
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2DoStep: currentCommunicationPoint=%.16g communicationStepSize=%.16g noSetFMUStatePriorToCurrentPoint=%d",
+      currentCommunicationPoint, communicationStepSize, noSetFMUStatePriorToCurrentPoint)
+
+  data = comp->fmuData;
+  sData = data->localData[0];
+  n = data->modelData.nStates;
+  nz = data->modelData.nZeroCrossings;
+  if (!comp->_cs_work) {
+    comp->_cs_work = (fmi2Real *)comp->functions->allocateMemory(5*n + nz + 1, sizeof(fmi2Real));
+    if (!comp->_cs_work) {
+      FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2DoStep: Out of memory.")
+      return fmi2Error;
+    }
+  }
+  x0 = comp->_cs_work;
+  k1 = x0 + n;
+  z0 = x0 + 5*n;
+
+  t = sData->timeValue;
+  tEnd = currentCommunicationPoint + communicationStepSize;
+  tEps = CS_EVENT_TOLERANCE * fmax(1.0, fabs(tEnd));
+  if (fabs(currentCommunicationPoint - t) > tEps)
+    FILTERED_LOG(comp, fmi2Warning, LOG_STATUSWARNING, "fmi2DoStep: currentCommunicationPoint = %.16g, but the FMU is at time %.16g.", currentCommunicationPoint, t)
+
+  invalidateDirectionalDerivatives(comp);
+  if (csEvaluate(comp))
+    goto assertion;
+  comp->_need_update = 0;
+  memcpy(z0, data->simulationInfo.zeroCrossings, nz*sizeof(fmi2Real));
+  h = comp->_cs_step_size > 0 ? comp->_cs_step_size : communicationStepSize;
+
+  while (t < tEnd - tEps) {
+    memcpy(x0, sData->realVars, n*sizeof(fmi2Real));
+    memcpy(k1, sData->realVars + n, n*sizeof(fmi2Real));
+
+    /* stop at the end of the interval or at the next time event */
+    h = fmin(h, tEnd - t);
+    timeEvent = fmi2False;
+    if (comp->eventInfo.nextEventTimeDefined && comp->eventInfo.nextEventTime <= t + h) {
+      h = comp->eventInfo.nextEventTime - t;
+      timeEvent = fmi2True;
+    }
+
+    /* step size control */
+    hNext = h;
+    if (h > tEps) {
+      for (;;) {
+        if (csAttemptStep(comp, t, h, &error))
+          goto assertion;
+        if (error <= 1.0)
+          break;
+        h *= fmax(0.2, 0.9*pow(error, -1.0/3.0));
+        timeEvent = fmi2False;
+        if (h < tEps) {
+          FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2DoStep: Step size too small at time %g.", t)
+          return fmi2Error;
+        }
+      }
+      hNext = h * fmin(5.0, 0.9*pow(fmax(error, 1e-6), -1.0/3.0));
+    }
+
+    /* locate state events */
+    stateEvent = h > tEps && csStateEvent(z0, data->simulationInfo.zeroCrossings, nz);
+    if (stateEvent) {
+      lo = 0;
+      hi = h;
+      while (hi - lo > tEps) {
+        if (csAttemptStep(comp, t, 0.5*(lo + hi), &error))
+          goto assertion;
+        if (csStateEvent(z0, data->simulationInfo.zeroCrossings, nz))
+          hi = 0.5*(lo + hi);
+        else
+          lo = 0.5*(lo + hi);
+      }
+      if (csAttemptStep(comp, t, hi, &error))
+        goto assertion;
+      h = hi;
+      timeEvent = fmi2False;
+    }
+
+    t = timeEvent ? comp->eventInfo.nextEventTime : (t + h >= tEnd - tEps ? tEnd : t + h);
+    sData->timeValue = t;
+
+    /* the master can only go back to communication points */
+    lastStep = !timeEvent && !stateEvent && t >= tEnd - tEps;
+    status = fmi2CompletedIntegratorStep(comp, lastStep ? noSetFMUStatePriorToCurrentPoint : fmi2True, &enterEventMode, &terminateSimulation);
+    if (status != fmi2OK)
+      return status;
+    if (terminateSimulation) {
+      FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2DoStep: terminated at time %.16g", t)
+      return fmi2Discard;
+    }
+
+    if (timeEvent || stateEvent || enterEventMode) {
+      FILTERED_LOG(comp, fmi2OK, LOG_EVENTS, "fmi2DoStep: %s event at time %.16g", stateEvent ? "state" : "time", t)
+      status = csEventIteration(comp);
+      if (status != fmi2OK)
+        return status;
+      if (comp->eventInfo.terminateSimulation) {
+        FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2DoStep: terminated at time %.16g", t)
+        return fmi2Discard;
+      }
+      if (csEvaluate(comp))
+        goto assertion;
+    }
+    memcpy(z0, data->simulationInfo.zeroCrossings, nz*sizeof(fmi2Real));
+
+    /* steps cut short by the interval or by an event do not limit the next one */
+    if (!lastStep && !timeEvent && !stateEvent)
+      comp->_cs_step_size = hNext;
+    h = fmax(hNext, comp->_cs_step_size);
+  }
+
   return fmi2OK;
+
+assertion:
+  FILTERED_LOG(comp, fmi2Error, LOG_FMI2_CALL, "fmi2DoStep: terminated by an assertion.")
+  comp->_need_update = 1;
+  return fmi2Error;
 }
 
 fmi2Status fmi2CancelStep(fmi2Component c) {
-  // TODO Write code here
-  return fmi2OK;
+  ModelInstance *comp = (ModelInstance *)c;
+  if (invalidState(comp, "fmi2CancelStep", modelContinuousTimeMode))
+    return fmi2Error;
+  // fmi2DoStep never returns fmi2Pending
+  FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2CancelStep: No asynchronous step in progress.")
+  return fmi2Error;
 }
 
 fmi2Status fmi2GetStatus(fmi2Component c, const fmi2StatusKind s, fmi2Status* value) {
-  // TODO Write code here
+  ModelInstance *comp = (ModelInstance *)c;
+  if (invalidState(comp, "fmi2GetStatus", modelContinuousTimeMode|modelEventMode|modelTerminated|modelError))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2GetStatus", "value", value))
+    return fmi2Error;
+  if (s != fmi2DoStepStatus)
+    return fmi2Discard;
+  *value = fmi2OK;
   return fmi2OK;
 }
 
 fmi2Status fmi2GetRealStatus(fmi2Component c, const fmi2StatusKind s, fmi2Real* value) {
-  // TODO Write code here
+  ModelInstance *comp = (ModelInstance *)c;
+  if (invalidState(comp, "fmi2GetRealStatus", modelContinuousTimeMode|modelEventMode|modelTerminated|modelError))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2GetRealStatus", "value", value))
+    return fmi2Error;
+  if (s != fmi2LastSuccessfulTime)
+    return fmi2Discard;
+  *value = comp->fmuData->localData[0]->timeValue;
   return fmi2OK;
 }
 
 fmi2Status fmi2GetIntegerStatus(fmi2Component c, const fmi2StatusKind s, fmi2Integer* value) {
-  // TODO Write code here
-  return fmi2OK;
+  return fmi2Discard;
 }
 
 fmi2Status fmi2GetBooleanStatus(fmi2Component c, const fmi2StatusKind s, fmi2Boolean* value) {
-  // TODO Write code here
+  ModelInstance *comp = (ModelInstance *)c;
+  if (invalidState(comp, "fmi2GetBooleanStatus", modelContinuousTimeMode|modelEventMode|modelTerminated|modelError))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2GetBooleanStatus", "value", value))
+    return fmi2Error;
+  if (s != fmi2Terminated)
+    return fmi2Discard;
+  *value = comp->eventInfo.terminateSimulation;
   return fmi2OK;
 }
 
 fmi2Status fmi2GetStringStatus(fmi2Component c, const fmi2StatusKind s, fmi2String* value) {
-  // TODO Write code here
-  return fmi2OK;
+  return fmi2Discard;
 }
 
 // ---------------------------------------------------------------------------
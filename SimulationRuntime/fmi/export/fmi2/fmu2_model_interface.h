@@ -82,6 +82,15 @@ typedef struct {
   fmi2Real stopTime;
 
   int _need_update;
+
+  int _has_jacobian;          // 0: not checked yet, 1: symbolic jacobian A available, -1: not available
+  int _has_jacobian_io;       // 0: not checked yet, 1: symbolic jacobians B, C and D available (as far as there are inputs and outputs), -1: not available
+  int _jacobian_valid;        // _jacobian holds the jacobian of the current point
+  int _directional_calls;     // calls of fmi2GetDirectionalDerivative at the current point
+  fmi2Real *_jacobian;        // non-zero values of jacobian A in the order of its sparse pattern, followed by a work vector of NUMBER_OF_STATES
+
+  fmi2Real _cs_step_size;     // co-simulation: step size proposed by the built-in solver for its next step
+  fmi2Real *_cs_work;         // co-simulation: work vectors of the built-in solver
 } ModelInstance;
 
 #ifdef __cplusplus